@@ -0,0 +1,162 @@
+#include "TMROctForest.h"
+#include <stdio.h>
+
+/*
+  Benchmark for the octant queue, the octant hash and the balance
+  operation on a forest of random octrees
+
+  Usage:
+
+  mpirun -np 4 ./balance_bench nrand=12000 max_level=12 corner
+
+  nrand:      the number of random octants per block
+  min_level:  the minimum random refinement level
+  max_level:  the maximum random refinement level
+  corner:     balance across corners and edges (not just faces)
+*/
+
+/*
+  The box problem
+
+  Bottom surface      Top surface
+  12-------- 14       13 ------- 15
+  | \      / |        | \      / |
+  |  2 -- 3  |        |  6 -- 7  |
+  |  |    |  |        |  |    |  |
+  |  0 -- 1  |        |  4 -- 5  |
+  | /      \ |        | /      \ |
+  8 -------- 10       9 -------- 11
+*/
+const int box_npts = 16;
+const int box_nelems = 7;
+
+const int box_conn[] =
+  {0, 1, 2, 3, 4, 5, 6, 7,
+   8, 10, 0, 1, 9, 11, 4, 5,
+   5, 11, 1, 10, 7, 15, 3, 14,
+   7, 15, 3, 14, 6, 13, 2, 12,
+   9, 13, 4, 6, 8, 12, 0, 2,
+   10, 14, 8, 12, 1, 3, 0, 2,
+   4, 5, 6, 7, 9, 11, 13, 15};
+
+/*
+  Time the queue and hash operations used within balance() using the
+  local octants from the forest
+*/
+void benchQueueAndHash( TMROctantArray *octants, int mpi_rank ){
+  int size;
+  TMROctant *array;
+  octants->getArray(&array, &size);
+
+  // Push all of the octants and their parents through the queue
+  double tqueue = MPI_Wtime();
+  TMROctantQueue *queue = new TMROctantQueue();
+  for ( int i = 0; i < size; i++ ){
+    TMROctant p;
+    array[i].parent(&p);
+    queue->push(&array[i]);
+    queue->push(&p);
+    queue->pop();
+  }
+  while (queue->length() > 0){
+    queue->pop();
+  }
+  delete queue;
+  tqueue = MPI_Wtime() - tqueue;
+
+  // Add the octants and their 0-siblings to the hash table. Roughly
+  // half of the additions are duplicates.
+  double thash = MPI_Wtime();
+  TMROctantHash *hash = new TMROctantHash();
+  int num_added = 0;
+  for ( int i = 0; i < size; i++ ){
+    TMROctant s;
+    array[i].getSibling(0, &s);
+    num_added += hash->addOctant(&array[i]);
+    num_added += hash->addOctant(&s);
+  }
+  TMROctantArray *list = hash->toArray();
+  delete list;
+  delete hash;
+  thash = MPI_Wtime() - thash;
+
+  printf("[%d] Queue: %d octants %12.6f s %12.4e octants/s\n",
+         mpi_rank, 3*size, tqueue, (tqueue > 0.0 ? 3*size/tqueue : 0.0));
+  printf("[%d] Hash:  %d octants %12.6f s %12.4e octants/s (%d unique)\n",
+         mpi_rank, 2*size, thash, (thash > 0.0 ? 2*size/thash : 0.0),
+         num_added);
+}
+
+int main( int argc, char *argv[] ){
+  MPI_Init(&argc, &argv);
+  TMRInitialize();
+
+  MPI_Comm comm = MPI_COMM_WORLD;
+  int mpi_rank;
+  MPI_Comm_rank(comm, &mpi_rank);
+
+  // Set the default parameters for the random forest
+  int nrand = 12000;
+  int min_level = 0;
+  int max_level = 12;
+  int balance_corner = 0;
+  for ( int k = 0; k < argc; k++ ){
+    if (sscanf(argv[k], "nrand=%d", &nrand) == 1){
+      if (nrand < 1){ nrand = 1; }
+    }
+    if (sscanf(argv[k], "min_level=%d", &min_level) == 1){
+      if (min_level < 0){ min_level = 0; }
+    }
+    if (sscanf(argv[k], "max_level=%d", &max_level) == 1){
+      if (max_level >= TMR_MAX_LEVEL){ max_level = TMR_MAX_LEVEL-1; }
+    }
+    if (strcmp(argv[k], "corner") == 0){
+      balance_corner = 1;
+    }
+  }
+  if (min_level > max_level){
+    min_level = max_level;
+  }
+
+  // Create the random forest
+  TMROctForest *forest = new TMROctForest(comm);
+  forest->incref();
+  forest->setConnectivity(box_npts, box_conn, box_nelems);
+
+  srand(mpi_rank+1);
+  forest->createRandomTrees(nrand, min_level, max_level);
+  forest->repartition();
+
+  // Time the queue/hash operations on the unbalanced octants
+  TMROctantArray *octants;
+  forest->getOctants(&octants);
+  benchQueueAndHash(octants, mpi_rank);
+
+  // Balance the forest
+  MPI_Barrier(comm);
+  double tbal = MPI_Wtime();
+  forest->balance(balance_corner);
+  tbal = MPI_Wtime() - tbal;
+
+  // Find the total number of octants and the maximum time
+  int size;
+  forest->getOctants(&octants);
+  octants->getArray(NULL, &size);
+
+  int total_size = 0;
+  double max_time = 0.0;
+  MPI_Reduce(&size, &total_size, 1, MPI_INT, MPI_SUM, 0, comm);
+  MPI_Reduce(&tbal, &max_time, 1, MPI_DOUBLE, MPI_MAX, 0, comm);
+
+  if (mpi_rank == 0){
+    printf("Balance: %d octants %12.6f s %12.4e octants/s\n",
+           total_size, max_time,
+           (max_time > 0.0 ? total_size/max_time : 0.0));
+  }
+
+  forest->decref();
+
+  TMRFinalize();
+  MPI_Finalize();
+  return (0);
+}
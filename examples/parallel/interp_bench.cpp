@@ -0,0 +1,201 @@
+#include "TMRBase.h"
+#include "TMRInterpolation.h"
+#include <stdio.h>
+#include <math.h>
+
+/*
+  Benchmark the batched, fixed-order shape function kernels and the
+  sum-factorized interpolation against the scalar per-point functions
+
+  Usage:
+
+  ./interp_bench npts=100000 nelems=2000
+
+  npts:    the number of 1-D points used for the basis evaluation
+  nelems:  the number of elements used for the interpolation benchmark
+*/
+
+// The maximum order tested in the benchmark
+static const int MAX_ORDER = 6;
+
+/*
+  Set the Gauss-Lobatto-Chebyshev knots for the given order
+*/
+void setKnots( int order, double *knots ){
+  for ( int i = 0; i < order; i++ ){
+    knots[i] = -cos(M_PI*i/(order-1));
+  }
+}
+
+/*
+  Time the 1-D basis evaluation and report the points per second
+*/
+void benchBasis( int order, int npts, const double *u ){
+  double knots[MAX_ORDER];
+  setKnots(order, knots);
+
+  double *N = new double[ order*npts ];
+  double *Nd = new double[ order*npts ];
+
+  // The scalar Lagrange functions
+  double t0 = MPI_Wtime();
+  for ( int n = 0; n < npts; n++ ){
+    lagrange_shape_func_derivative(order, u[n], knots,
+                                   &N[order*n], &Nd[order*n]);
+  }
+  double tls = MPI_Wtime() - t0;
+
+  // The batched Lagrange functions
+  t0 = MPI_Wtime();
+  lagrange_shape_functions_batch(order, npts, u, knots, N, Nd);
+  double tlb = MPI_Wtime() - t0;
+
+  // The scalar Bernstein functions
+  t0 = MPI_Wtime();
+  for ( int n = 0; n < npts; n++ ){
+    bernstein_shape_func_derivative(order, u[n],
+                                    &N[order*n], &Nd[order*n]);
+  }
+  double tbs = MPI_Wtime() - t0;
+
+  // The batched Bernstein functions
+  t0 = MPI_Wtime();
+  bernstein_shape_functions_batch(order, npts, u, N, Nd);
+  double tbb = MPI_Wtime() - t0;
+
+  printf("%5d %12.4e %12.4e %12.4e %12.4e\n", order,
+         npts/tls, npts/tlb, npts/tbs, npts/tbb);
+
+  delete [] N;
+  delete [] Nd;
+}
+
+/*
+  Time the interpolation of the element values to a tensor-product
+  grid of points with one more point than the order in each direction
+*/
+void benchInterp( int order, int nelems ){
+  double knots[MAX_ORDER];
+  setKnots(order, knots);
+
+  // Set the points
+  const int np = order+1;
+  double u[MAX_ORDER+1];
+  for ( int i = 0; i < np; i++ ){
+    u[i] = -cos(M_PI*i/(np-1));
+  }
+
+  // Set the element values
+  const int nvars = 3;
+  const int nnodes = order*order*order;
+  const int nout = np*np*np;
+  double *uelem = new double[ nvars*nnodes ];
+  for ( int i = 0; i < nvars*nnodes; i++ ){
+    uelem[i] = sin(1.3*i);
+  }
+  double *uout = new double[ nvars*nout ];
+  double *work = new double[ nvars*np*order*(order + np) ];
+
+  // Interpolate point by point with the full tensor-product
+  // shape functions
+  double err = 0.0;
+  double t0 = MPI_Wtime();
+  for ( int e = 0; e < nelems; e++ ){
+    for ( int c = 0; c < np; c++ ){
+      for ( int b = 0; b < np; b++ ){
+        for ( int a = 0; a < np; a++ ){
+          double Nu[MAX_ORDER], Nv[MAX_ORDER], Nw[MAX_ORDER];
+          lagrange_shape_functions(order, u[a], knots, Nu);
+          lagrange_shape_functions(order, u[b], knots, Nv);
+          lagrange_shape_functions(order, u[c], knots, Nw);
+
+          double *out = &uout[nvars*(a + np*b + np*np*c)];
+          for ( int k = 0; k < nvars; k++ ){
+            out[k] = 0.0;
+          }
+          for ( int kk = 0; kk < order; kk++ ){
+            for ( int jj = 0; jj < order; jj++ ){
+              for ( int ii = 0; ii < order; ii++ ){
+                double N = Nu[ii]*Nv[jj]*Nw[kk];
+                const double *ue =
+                  &uelem[nvars*(ii + order*jj + order*order*kk)];
+                for ( int k = 0; k < nvars; k++ ){
+                  out[k] += N*ue[k];
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+  double tscalar = MPI_Wtime() - t0;
+
+  // Keep a copy to check the result
+  double *ucheck = new double[ nvars*nout ];
+  memcpy(ucheck, uout, nvars*nout*sizeof(double));
+
+  // Interpolate using the batched bases and sum factorization
+  t0 = MPI_Wtime();
+  for ( int e = 0; e < nelems; e++ ){
+    double N[MAX_ORDER*(MAX_ORDER+1)];
+    lagrange_shape_functions_batch(order, np, u, knots, N);
+    tensor_interp3d(order, np, np, np, N, N, N,
+                    nvars, uelem, uout, work);
+  }
+  double tsum = MPI_Wtime() - t0;
+
+  for ( int i = 0; i < nvars*nout; i++ ){
+    err = fmax(err, fabs(uout[i] - ucheck[i]));
+  }
+
+  double total = 1.0*nelems*nout;
+  printf("%5d %12.4e %12.4e %12.4e\n", order,
+         total/tscalar, total/tsum, err);
+
+  delete [] uelem;
+  delete [] uout;
+  delete [] ucheck;
+  delete [] work;
+}
+
+int main( int argc, char *argv[] ){
+  MPI_Init(&argc, &argv);
+  TMRInitialize();
+
+  int npts = 100000;
+  int nelems = 2000;
+  for ( int k = 0; k < argc; k++ ){
+    if (sscanf(argv[k], "npts=%d", &npts) == 1){
+      if (npts < 1){ npts = 1; }
+    }
+    if (sscanf(argv[k], "nelems=%d", &nelems) == 1){
+      if (nelems < 1){ nelems = 1; }
+    }
+  }
+
+  // Set random points within the parameter interval
+  double *u = new double[ npts ];
+  for ( int n = 0; n < npts; n++ ){
+    u[n] = -1.0 + 2.0*rand()/RAND_MAX;
+  }
+
+  printf("1-D basis and derivative evaluation [points/s]\n");
+  printf("%5s %12s %12s %12s %12s\n", "order",
+         "lagrange", "batch", "bernstein", "batch");
+  for ( int order = 2; order <= 6; order++ ){
+    benchBasis(order, npts, u);
+  }
+
+  printf("\nInterpolation to a tensor-product grid [points/s]\n");
+  printf("%5s %12s %12s %12s\n", "order", "scalar", "sum-fact", "error");
+  for ( int order = 2; order <= 6; order++ ){
+    benchInterp(order, nelems);
+  }
+
+  delete [] u;
+
+  TMRFinalize();
+  MPI_Finalize();
+  return 0;
+}
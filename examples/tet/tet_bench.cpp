@@ -0,0 +1,276 @@
+#include "TMRTetrahedralize.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/*
+  Create the triangulated surface of the unit cube with n x n
+  squares on each face. Each square is split into two triangles and
+  the triangles are oriented with their normals pointing out of the
+  cube.
+*/
+void create_cube_surface( int n, int *_npts, TMRPoint **_X,
+                          int *_ntris, int **_tris ){
+  // Number the points on the surface of the (n+1)^3 lattice
+  int nl = n+1;
+  int *index = new int[ nl*nl*nl ];
+  int npts = 0;
+  for ( int k = 0; k < nl; k++ ){
+    for ( int j = 0; j < nl; j++ ){
+      for ( int i = 0; i < nl; i++ ){
+        int ijk = i + nl*(j + nl*k);
+        if (i == 0 || j == 0 || k == 0 ||
+            i == n || j == n || k == n){
+          index[ijk] = npts;
+          npts++;
+        }
+        else {
+          index[ijk] = -1;
+        }
+      }
+    }
+  }
+
+  TMRPoint *X = new TMRPoint[ npts ];
+  for ( int k = 0; k < nl; k++ ){
+    for ( int j = 0; j < nl; j++ ){
+      for ( int i = 0; i < nl; i++ ){
+        int ijk = i + nl*(j + nl*k);
+        if (index[ijk] >= 0){
+          X[index[ijk]].x = 1.0*i/n;
+          X[index[ijk]].y = 1.0*j/n;
+          X[index[ijk]].z = 1.0*k/n;
+        }
+      }
+    }
+  }
+
+  int ntris = 12*n*n;
+  int *tris = new int[ 3*ntris ];
+  int *t = tris;
+  for ( int face = 0; face < 6; face++ ){
+    // The direction normal to the face and the in-plane directions
+    int d = face/2;
+    int d1 = (d+1) % 3, d2 = (d+2) % 3;
+    int side = (face % 2)*n;
+
+    for ( int b = 0; b < n; b++ ){
+      for ( int a = 0; a < n; a++ ){
+        int q[4];
+        int ab[4][2] = {{a, b}, {a+1, b}, {a+1, b+1}, {a, b+1}};
+        for ( int c = 0; c < 4; c++ ){
+          int ijk[3];
+          ijk[d] = side;
+          ijk[d1] = ab[c][0];
+          ijk[d2] = ab[c][1];
+          q[c] = index[ijk[0] + nl*(ijk[1] + nl*ijk[2])];
+        }
+
+        // The (d1, d2) ordering is counter-clockwise when viewed from
+        // the positive d direction: flip the faces on the low side
+        if (side == 0){
+          int tmp = q[1];
+          q[1] = q[3];
+          q[3] = tmp;
+        }
+
+        // Alternate the diagonals across the face
+        if ((a + b) % 2 == 0){
+          t[0] = q[0];  t[1] = q[1];  t[2] = q[2];
+          t[3] = q[0];  t[4] = q[2];  t[5] = q[3];
+        }
+        else {
+          t[0] = q[0];  t[1] = q[1];  t[2] = q[3];
+          t[3] = q[1];  t[4] = q[2];  t[5] = q[3];
+        }
+        t += 6;
+      }
+    }
+  }
+
+  delete [] index;
+
+  *_npts = npts;
+  *_X = X;
+  *_ntris = ntris;
+  *_tris = tris;
+}
+
+/*
+  Compute the volume and the minimum dihedral angle (in degrees) of
+  the tetrahedron with the vertices a, b, c and d
+*/
+double tet_volume_and_angle( const TMRPoint *a, const TMRPoint *b,
+                             const TMRPoint *c, const TMRPoint *d,
+                             double *min_angle ){
+  const TMRPoint *p[4] = {a, b, c, d};
+
+  // The vertices of the face opposite each vertex
+  const int faces[4][3] = {{1, 2, 3}, {0, 3, 2}, {0, 1, 3}, {0, 2, 1}};
+
+  // Compute the area-weighted face normals
+  double n[4][3];
+  for ( int k = 0; k < 4; k++ ){
+    const TMRPoint *u = p[faces[k][0]];
+    const TMRPoint *v = p[faces[k][1]];
+    const TMRPoint *w = p[faces[k][2]];
+    double d1[3] = {v->x - u->x, v->y - u->y, v->z - u->z};
+    double d2[3] = {w->x - u->x, w->y - u->y, w->z - u->z};
+    n[k][0] = d1[1]*d2[2] - d1[2]*d2[1];
+    n[k][1] = d1[2]*d2[0] - d1[0]*d2[2];
+    n[k][2] = d1[0]*d2[1] - d1[1]*d2[0];
+  }
+
+  // The dihedral angle at the edge shared by two faces is pi minus
+  // the angle between their normals
+  double amin = 180.0;
+  for ( int i = 0; i < 4; i++ ){
+    for ( int j = i+1; j < 4; j++ ){
+      double ni = sqrt(n[i][0]*n[i][0] + n[i][1]*n[i][1] +
+                       n[i][2]*n[i][2]);
+      double nj = sqrt(n[j][0]*n[j][0] + n[j][1]*n[j][1] +
+                       n[j][2]*n[j][2]);
+      double angle = 0.0;
+      if (ni > 0.0 && nj > 0.0){
+        double cs = -(n[i][0]*n[j][0] + n[i][1]*n[j][1] +
+                      n[i][2]*n[j][2])/(ni*nj);
+        if (cs > 1.0){ cs = 1.0; }
+        if (cs < -1.0){ cs = -1.0; }
+        angle = 180.0*acos(cs)/M_PI;
+      }
+      if (angle < amin){
+        amin = angle;
+      }
+    }
+  }
+  *min_angle = amin;
+
+  double d1[3] = {b->x - a->x, b->y - a->y, b->z - a->z};
+  double d2[3] = {c->x - a->x, c->y - a->y, c->z - a->z};
+  double d3[3] = {d->x - a->x, d->y - a->y, d->z - a->z};
+  return (d1[0]*(d2[1]*d3[2] - d2[2]*d3[1]) -
+          d1[1]*(d2[0]*d3[2] - d2[2]*d3[0]) +
+          d1[2]*(d2[0]*d3[1] - d2[1]*d3[0]))/6.0;
+}
+
+int main( int argc, char *argv[] ){
+  MPI_Init(&argc, &argv);
+  TMRInitialize();
+
+  // The number of surface divisions along each edge of the cube and
+  // the target mesh spacing in the interior
+  int n = 20;
+  double htarget = -1.0;
+  int write_vtk = 0;
+
+  // The smallest acceptable dihedral angle (in degrees) and the
+  // smallest acceptable volume relative to a regular tetrahedron
+  double angle_tol = 1.0;
+  double volume_tol = 1e-6;
+  for ( int k = 0; k < argc; k++ ){
+    if (sscanf(argv[k], "n=%d", &n) == 1){
+      if (n < 1){ n = 1; }
+    }
+    if (sscanf(argv[k], "h=%lf", &htarget) == 1){}
+    if (strcmp(argv[k], "--write_vtk") == 0){
+      write_vtk = 1;
+    }
+  }
+  if (htarget <= 0.0){
+    htarget = 1.0/n;
+  }
+
+  int npts, ntris;
+  TMRPoint *X;
+  int *tris;
+  create_cube_surface(n, &npts, &X, &ntris, &tris);
+
+  double t0 = MPI_Wtime();
+  TMRTetrahedralize *tet =
+    new TMRTetrahedralize(npts, X, ntris, tris);
+  tet->incref();
+  double t1 = MPI_Wtime();
+
+  int fail = tet->recoverBoundary();
+  double t2 = MPI_Wtime();
+
+  int num_points = 0, num_tets = 0;
+  double min_volume = 0.0, min_angle = 0.0;
+  double total_volume = 0.0;
+  if (fail == 0){
+    TMRMeshOptions options;
+    options.triangularize_print_level = 1;
+    options.triangularize_print_iter = 100000;
+    TMRElementFeatureSize *fs = new TMRElementFeatureSize(htarget);
+    fs->incref();
+    tet->refine(options, fs);
+    fs->decref();
+  }
+  double t3 = MPI_Wtime();
+
+  if (fail == 0){
+    int *conn;
+    TMRPoint *Xtet;
+    tet->getMesh(&num_points, &num_tets, &conn, &Xtet);
+
+    // Compute the smallest volume and dihedral angle in the mesh
+    min_volume = 1e300;
+    min_angle = 180.0;
+    for ( int i = 0; i < num_tets; i++ ){
+      const int *c = &conn[4*i];
+      double angle;
+      double vol = tet_volume_and_angle(&Xtet[c[0]], &Xtet[c[1]],
+                                        &Xtet[c[2]], &Xtet[c[3]],
+                                        &angle);
+      total_volume += vol;
+      if (vol < min_volume){
+        min_volume = vol;
+      }
+      if (angle < min_angle){
+        min_angle = angle;
+      }
+    }
+    delete [] conn;
+    delete [] Xtet;
+
+    if (write_vtk){
+      tet->writeToVTK("tet_bench.vtk");
+    }
+  }
+
+  printf("Surface points:            %d\n", npts);
+  printf("Surface triangles:         %d\n", ntris);
+  printf("Unrecovered triangles:     %d\n", fail);
+  printf("Volume points:             %d\n", num_points);
+  printf("Volume tetrahedra:         %d\n", num_tets);
+  printf("Total volume:              %12.6f\n", total_volume);
+  printf("Minimum volume:            %12.4e\n", min_volume);
+  printf("Minimum dihedral angle:    %12.4f deg\n", min_angle);
+  printf("Delaunay time:             %12.4f s\n", t1 - t0);
+  printf("Boundary recovery time:    %12.4f s\n", t2 - t1);
+  printf("Refinement time:           %12.4f s\n", t3 - t2);
+  if (t3 > t0){
+    printf("Tetrahedra per second:     %12.0f\n", num_tets/(t3 - t0));
+  }
+
+  // Check that the mesh is valid and contains no slivers. The volume
+  // of a regular tetrahedron with edge length h is h^3/(6*sqrt(2)).
+  int flag = (fail != 0);
+  double vol_regular = htarget*htarget*htarget/(6.0*sqrt(2.0));
+  if (fail == 0 && (min_volume < volume_tol*vol_regular ||
+                    min_angle < angle_tol)){
+    fprintf(stderr, "tet_bench: Mesh contains slivers with a minimum "
+            "volume of %e and a minimum dihedral angle of %f\n",
+            min_volume, min_angle);
+    flag = 1;
+  }
+
+  tet->decref();
+  delete [] X;
+  delete [] tris;
+
+  TMRFinalize();
+  MPI_Finalize();
+  return flag;
+}
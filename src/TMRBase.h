@@ -35,6 +35,11 @@
 */
 static const int TMR_MAX_LEVEL = 30;
 
+/*
+  The version of the forest checkpoint file format
+*/
+static const int TMR_CHECKPOINT_VERSION = 1;
+
 /*
   Set the type of interpolation to use (only makes a difference
   for order >= 4)
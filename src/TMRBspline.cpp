@@ -273,6 +273,431 @@ void bspline_basis_derivative( double *N, const int idx, const double u,
   }
 }
 
+/*
+  Bounding volume hierarchy for the knot spans of a B-spline curve or
+  surface
+
+  Each non-empty knot span is bounded by the box that encloses the
+  control points that are non-zero on the span. By the convex hull
+  property, the curve or surface over the span lies within this box.
+  The boxes are stored in a binary tree that is built by splitting
+  the spans at the median of the box centers along the longest
+  direction.
+
+  The tree is used to find a starting point for the Newton iteration
+  for the closest point. The spans are visited in order of the
+  distance to their boxes. Within each span, the curve/surface is
+  evaluated at the Greville point of the closest control point
+  (clamped to the span) and at the center of the span. Spans whose
+  box is farther away than the closest point found so far cannot
+  contain the closest point and are skipped.
+
+  A curve is treated as a surface with nv = kv = 1. The knot vectors
+  and control points are owned by the curve/surface.
+*/
+class TMRBsplineSpanTree {
+ public:
+  TMRBsplineSpanTree( int _nu, int _ku, const double *_Tu,
+                      int _nv, int _kv, const double *_Tv,
+                      const TMRPoint *_pts );
+  ~TMRBsplineSpanTree();
+
+  // Find the closest seed point. On input, u, v and dist contain the
+  // best known point (dist = 1e40 if there is none) and on output
+  // they contain the closest point found.
+  void findSeed( TMRCurve *curve, TMRSurface *surf, TMRPoint p,
+                 double *u, double *v, double *dist );
+
+ private:
+  // Build the tree for the spans from start to end
+  int build( int start, int end, int depth, const double *boxes,
+             const double *centers );
+
+  // Compute the squared distance between a box and a point
+  static double boxDistance( const double *box, TMRPoint p ){
+    double d = 0.0;
+    double x[3] = {p.x, p.y, p.z};
+    for ( int k = 0; k < 3; k++ ){
+      if (x[k] < box[k]){
+        d += (box[k] - x[k])*(box[k] - x[k]);
+      }
+      else if (x[k] > box[3+k]){
+        d += (x[k] - box[3+k])*(x[k] - box[3+k]);
+      }
+    }
+    return d;
+  }
+
+  // The tree nodes: Each leaf stores a range of spans
+  class SpanTreeNode {
+   public:
+    double box[6]; // The bounding box (xmin, ymin, zmin, xmax, ...)
+    int left, right; // The child nodes (-1 for a leaf)
+    int start, end; // The range of spans within the node
+  };
+
+  // The B-spline data
+  int nu, ku, nv, kv;
+  const double *Tu, *Tv;
+  const TMRPoint *pts;
+
+  // The Greville points for each control point
+  double *gu, *gv;
+
+  // The knot intervals for each span
+  int num_spans;
+  int *span_intu, *span_intv;
+
+  // The spans in the order of the tree
+  int *span_index;
+
+  // The tree nodes and the maximum depth of a leaf
+  int num_nodes, max_depth;
+  SpanTreeNode *nodes;
+};
+
+/*
+  Create the span tree
+
+  input:
+  nu, ku, Tu:  number of control points, order and knots along u
+  nv, kv, Tv:  number of control points, order and knots along v
+  pts:         the control points
+*/
+TMRBsplineSpanTree::TMRBsplineSpanTree( int _nu, int _ku,
+                                        const double *_Tu,
+                                        int _nv, int _kv,
+                                        const double *_Tv,
+                                        const TMRPoint *_pts ){
+  nu = _nu;  ku = _ku;  Tu = _Tu;
+  nv = _nv;  kv = _kv;  Tv = _Tv;
+  pts = _pts;
+
+  // Compute the Greville points for each direction
+  gu = new double[ nu ];
+  for ( int i = 0; i < nu; i++ ){
+    gu[i] = Tu[i];
+    if (ku > 1){
+      gu[i] = 0.0;
+      for ( int k = 1; k < ku; k++ ){
+        gu[i] += Tu[i+k];
+      }
+      gu[i] = gu[i]/(ku-1);
+    }
+  }
+  gv = new double[ nv ];
+  for ( int j = 0; j < nv; j++ ){
+    gv[j] = 0.0;
+    if (Tv && kv > 1){
+      for ( int k = 1; k < kv; k++ ){
+        gv[j] += Tv[j+k];
+      }
+      gv[j] = gv[j]/(kv-1);
+    }
+  }
+
+  // Count up the non-empty knot spans
+  int nspu = 0, nspv = 0;
+  int *intu = new int[ nu ];
+  int *intv = new int[ nv ];
+  for ( int i = ku-1; i < nu; i++ ){
+    if (Tu[i] < Tu[i+1]){
+      intu[nspu] = i;
+      nspu++;
+    }
+  }
+  if (Tv){
+    for ( int j = kv-1; j < nv; j++ ){
+      if (Tv[j] < Tv[j+1]){
+        intv[nspv] = j;
+        nspv++;
+      }
+    }
+  }
+  else {
+    intv[0] = 0;
+    nspv = 1;
+  }
+
+  // Set the knot intervals for each span
+  num_spans = nspu*nspv;
+  span_intu = new int[ num_spans ];
+  span_intv = new int[ num_spans ];
+  span_index = new int[ num_spans ];
+  for ( int j = 0; j < nspv; j++ ){
+    for ( int i = 0; i < nspu; i++ ){
+      span_intu[i + j*nspu] = intu[i];
+      span_intv[i + j*nspu] = intv[j];
+      span_index[i + j*nspu] = i + j*nspu;
+    }
+  }
+  delete [] intu;
+  delete [] intv;
+
+  // Compute the bounding box and center of each span from the
+  // control points that are non-zero on the span
+  double *boxes = new double[ 6*num_spans ];
+  double *centers = new double[ 3*num_spans ];
+  for ( int span = 0; span < num_spans; span++ ){
+    double *box = &boxes[6*span];
+    box[0] = box[1] = box[2] = 1e40;
+    box[3] = box[4] = box[5] = -1e40;
+    int iu = span_intu[span] - ku + 1;
+    int iv = span_intv[span] - kv + 1;
+    for ( int j = iv; j < iv + kv; j++ ){
+      for ( int i = iu; i < iu + ku; i++ ){
+        const TMRPoint *pt = &pts[i + j*nu];
+        double x[3] = {pt->x, pt->y, pt->z};
+        for ( int k = 0; k < 3; k++ ){
+          if (x[k] < box[k]){ box[k] = x[k]; }
+          if (x[k] > box[3+k]){ box[3+k] = x[k]; }
+        }
+      }
+    }
+    for ( int k = 0; k < 3; k++ ){
+      centers[3*span+k] = 0.5*(box[k] + box[3+k]);
+    }
+  }
+
+  // Allocate the nodes and build the tree
+  num_nodes = 0;
+  max_depth = 0;
+  nodes = new SpanTreeNode[ 2*num_spans ];
+  if (num_spans > 0){
+    build(0, num_spans, 0, boxes, centers);
+  }
+
+  delete [] boxes;
+  delete [] centers;
+}
+
+/*
+  Free the span tree
+*/
+TMRBsplineSpanTree::~TMRBsplineSpanTree(){
+  delete [] gu;
+  delete [] gv;
+  delete [] span_intu;
+  delete [] span_intv;
+  delete [] span_index;
+  delete [] nodes;
+}
+
+/*
+  Recursively build the tree for the spans from start to end and
+  return the index of the new node
+*/
+int TMRBsplineSpanTree::build( int start, int end, int depth,
+                               const double *boxes,
+                               const double *centers ){
+  int node = num_nodes;
+  num_nodes++;
+  if (depth > max_depth){
+    max_depth = depth;
+  }
+
+  // Compute the bounding box of all the spans in this node
+  double *box = nodes[node].box;
+  box[0] = box[1] = box[2] = 1e40;
+  box[3] = box[4] = box[5] = -1e40;
+  double cmin[3] = {1e40, 1e40, 1e40};
+  double cmax[3] = {-1e40, -1e40, -1e40};
+  for ( int i = start; i < end; i++ ){
+    const double *b = &boxes[6*span_index[i]];
+    const double *c = &centers[3*span_index[i]];
+    for ( int k = 0; k < 3; k++ ){
+      if (b[k] < box[k]){ box[k] = b[k]; }
+      if (b[3+k] > box[3+k]){ box[3+k] = b[3+k]; }
+      if (c[k] < cmin[k]){ cmin[k] = c[k]; }
+      if (c[k] > cmax[k]){ cmax[k] = c[k]; }
+    }
+  }
+
+  nodes[node].start = start;
+  nodes[node].end = end;
+  nodes[node].left = nodes[node].right = -1;
+
+  // Store up to two spans in each leaf
+  const int max_leaf_spans = 2;
+  if (end - start <= max_leaf_spans){
+    return node;
+  }
+
+  // Split along the longest direction of the centers
+  int dir = 0;
+  for ( int k = 1; k < 3; k++ ){
+    if (cmax[k] - cmin[k] > cmax[dir] - cmin[dir]){
+      dir = k;
+    }
+  }
+
+  // Partition the spans about the median center
+  int mid = start + (end - start)/2;
+  int lo = start, hi = end-1;
+  while (lo < hi){
+    double pivot = centers[3*span_index[lo + (hi - lo)/2] + dir];
+    int i = lo, j = hi;
+    while (i <= j){
+      while (centers[3*span_index[i] + dir] < pivot){ i++; }
+      while (centers[3*span_index[j] + dir] > pivot){ j--; }
+      if (i <= j){
+        int tmp = span_index[i];
+        span_index[i] = span_index[j];
+        span_index[j] = tmp;
+        i++;
+        j--;
+      }
+    }
+    if (mid <= j){
+      hi = j;
+    }
+    else if (mid >= i){
+      lo = i;
+    }
+    else {
+      break;
+    }
+  }
+
+  nodes[node].left = build(start, mid, depth+1, boxes, centers);
+  nodes[node].right = build(mid, end, depth+1, boxes, centers);
+
+  return node;
+}
+
+/*
+  Find the seed point that is closest to the given point
+
+  Either the curve or the surface is evaluated at the seed points
+  within each span that is visited.
+*/
+void TMRBsplineSpanTree::findSeed( TMRCurve *curve, TMRSurface *surf,
+                                   TMRPoint p, double *u, double *v,
+                                   double *dist ){
+  if (num_nodes == 0){
+    return;
+  }
+
+  // The stack of nodes to visit. Each level of the tree leaves at
+  // most one pending sibling on the stack, so the stack never holds
+  // more than max_depth+2 nodes. The tree is balanced so this is
+  // almost always small enough for the local array.
+  const int local_stack_size = 128;
+  int local_stack[local_stack_size];
+  int *stack = local_stack;
+  if (max_depth+2 > local_stack_size){
+    stack = new int[ max_depth+2 ];
+  }
+  int size = 0;
+  stack[size] = 0;
+  size++;
+
+  while (size > 0){
+    size--;
+    int node = stack[size];
+    if (boxDistance(nodes[node].box, p) >= *dist){
+      continue;
+    }
+
+    if (nodes[node].left < 0){
+      for ( int ii = nodes[node].start; ii < nodes[node].end; ii++ ){
+        int span = span_index[ii];
+        int intu = span_intu[span];
+        int intv = span_intv[span];
+
+        // Find the closest control point within the span
+        const int iu = intu - ku + 1;
+        const int iv = intv - kv + 1;
+        int best_i = iu, best_j = iv;
+        double dpt = 1e40;
+        for ( int j = iv; j < iv + kv; j++ ){
+          for ( int i = iu; i < iu + ku; i++ ){
+            TMRPoint d;
+            d.x = pts[i + j*nu].x - p.x;
+            d.y = pts[i + j*nu].y - p.y;
+            d.z = pts[i + j*nu].z - p.z;
+            if (d.dot(d) < dpt){
+              dpt = d.dot(d);
+              best_i = i;
+              best_j = j;
+            }
+          }
+        }
+
+        // Set the seed parameters: The Greville point of the closest
+        // control point clamped to the span and a grid of points
+        // within the span
+        const int nseed = 3;
+        double useed[1 + nseed*nseed], vseed[1 + nseed*nseed];
+        useed[0] = gu[best_i];
+        if (useed[0] < Tu[intu]){ useed[0] = Tu[intu]; }
+        if (useed[0] > Tu[intu+1]){ useed[0] = Tu[intu+1]; }
+        vseed[0] = 0.0;
+        if (Tv){
+          vseed[0] = gv[best_j];
+          if (vseed[0] < Tv[intv]){ vseed[0] = Tv[intv]; }
+          if (vseed[0] > Tv[intv+1]){ vseed[0] = Tv[intv+1]; }
+        }
+
+        int num_seeds = 1;
+        for ( int j = 0; j < (Tv ? nseed : 1); j++ ){
+          for ( int i = 0; i < nseed; i++ ){
+            double su = (i + 0.5)/nseed;
+            useed[num_seeds] = (1.0 - su)*Tu[intu] + su*Tu[intu+1];
+            vseed[num_seeds] = 0.0;
+            if (Tv){
+              double sv = (j + 0.5)/nseed;
+              vseed[num_seeds] = (1.0 - sv)*Tv[intv] + sv*Tv[intv+1];
+            }
+            num_seeds++;
+          }
+        }
+
+        for ( int k = 0; k < num_seeds; k++ ){
+          TMRPoint X;
+          int fail = 1;
+          if (curve){
+            fail = curve->evalPoint(useed[k], &X);
+          }
+          else if (surf){
+            fail = surf->evalPoint(useed[k], vseed[k], &X);
+          }
+          if (!fail){
+            X.x -= p.x;
+            X.y -= p.y;
+            X.z -= p.z;
+            double d = X.dot(X);
+            if (d < *dist){
+              *dist = d;
+              *u = useed[k];
+              *v = vseed[k];
+            }
+          }
+        }
+      }
+    }
+    else {
+      // Push the closer child last so that it is visited first
+      int left = nodes[node].left;
+      int right = nodes[node].right;
+      if (boxDistance(nodes[left].box, p) <
+          boxDistance(nodes[right].box, p)){
+        stack[size] = right;
+        stack[size+1] = left;
+      }
+      else {
+        stack[size] = left;
+        stack[size+1] = right;
+      }
+      size += 2;
+    }
+  }
+
+  if (stack != local_stack){
+    delete [] stack;
+  }
+}
+
 /*
   Create a B-spline curve with a uniform knot vector
 */
@@ -295,6 +720,9 @@ TMRBsplineCurve::TMRBsplineCurve( int _n, int _k,
 
   // Uniform weights
   wts = NULL;
+
+  // Create the knot span tree
+  tree = new TMRBsplineSpanTree(nctl, ku, Tu, 1, 1, NULL, pts);
 }
 
 /*
@@ -329,6 +757,9 @@ TMRBsplineCurve::TMRBsplineCurve( int _n, int _k,
 
   // Uniform weights
   wts = NULL;
+
+  // Create the knot span tree
+  tree = new TMRBsplineSpanTree(nctl, ku, Tu, 1, 1, NULL, pts);
 }
 
 /*
@@ -366,12 +797,16 @@ TMRBsplineCurve::TMRBsplineCurve( int _n, int _k,
   // Copy over the points
   pts = new TMRPoint[ nctl ];
   memcpy(pts, _pts, nctl*sizeof(TMRPoint));
+
+  // Create the knot span tree
+  tree = new TMRBsplineSpanTree(nctl, ku, Tu, 1, 1, NULL, pts);
 }
 
 /*
   Free the curve
 */
 TMRBsplineCurve::~TMRBsplineCurve(){
+  delete tree;
   delete [] Tu;
   delete [] pts;
   if (wts){ delete [] wts; }
@@ -441,178 +876,95 @@ int TMRBsplineCurve::evalPoint( double t, TMRPoint *X ){
 
 /*
   Perform the inverse point evaluation
+
+  The starting point is the closest seed point from the knot span
+  tree. This is refined using Newton's method.
 */
 int TMRBsplineCurve::invEvalPoint( TMRPoint point, double *tf ){
-  // Did this evaluation fail or not?
-  int fail = 1;
-
-  // Set a default value for the output parameter value
-  *tf = 0.0;
-
-  // Temporary internal data
-  double Nu[3*MAX_BSPLINE_ORDER];
-  double work[2*MAX_BSPLINE_ORDER + MAX_BSPLINE_ORDER*MAX_BSPLINE_ORDER];
-  double t = 0.5*(Tu[0] + Tu[nctl+ku-1]);
-
-  // Get the bounds
-  double tmin, tmax;
-  getRange(&tmin, &tmax);
-  double tbest = 0.0;
-
-  // Set the number of trial points to use in the brute force method
-  // along each direction.
-  int nupts = 2*nctl+1;
-
-  // Using brute force, find the point that is closest to the input
-  // point by evaluating the surface at a series of locations.
+  // Find the closest seed point
+  double t = 0.5*(Tu[0] + Tu[nctl+ku-1]), v = 0.0;
   double dist = 1e40;
-  for ( int ii = 0; ii < nupts; ii++ ){
-    t = tmin + (1.0*ii/(nupts - 1))*(tmax - tmin);
-    int intu = bspline_interval(t, Tu, nctl, ku);
+  tree->findSeed(this, NULL, point, &t, &v, &dist);
 
-    // Evaluate the basis functions
-    bspline_basis(Nu, intu, t, Tu, ku, work);
+  return newtonProject(point, t, tf);
+}
 
-    // Set the interval to the initial control point
-    intu = intu - ku + 1;
+/*
+  Perform the inverse point evaluation for an array of points
 
-    // Evaluate the point
-    TMRPoint X;
-    X.zero();
+  The result from the previous point is used as an initial guess for
+  the next point. This reduces the number of knot spans that must be
+  searched when the points are ordered along the curve.
 
-    // If this is a NURBS surface add the effect of the weights
-    if (wts){
-      // Evaluate the b-spline
-      double w = 0.0;
-      for ( int i = 0; i < ku; i++ ){
-        int index = intu+i;
-        X.x += wts[index]*Nu[i]*pts[index].x;
-        X.y += wts[index]*Nu[i]*pts[index].y;
-        X.z += wts[index]*Nu[i]*pts[index].z;
-        w += wts[index]*Nu[i];
-      }
+  input:
+  n:      the number of points
+  X:      the physical locations of the points
 
-      // Divide through by the weights
-      if (w != 0.0){
-        w = 1.0/w;
-        X.x *= w;
-        X.y *= w;
-        X.z *= w;
-      }
-    }
-    else {
-      for ( int i = 0; i < ku; i++ ){
-        int index = intu+i;
-        X.x += Nu[i]*pts[index].x;
-        X.y += Nu[i]*pts[index].y;
-        X.z += Nu[i]*pts[index].z;
+  output:
+  tf:     the parametric locations
+*/
+int TMRBsplineCurve::invEvalPoints( int n, const TMRPoint *X,
+                                    double *tf ){
+  int fail = 0;
+  for ( int i = 0; i < n; i++ ){
+    double t = 0.5*(Tu[0] + Tu[nctl+ku-1]), v = 0.0;
+    double dist = 1e40;
+
+    // Use the previous result as the best known point
+    if (i > 0){
+      TMRPoint Y;
+      if (!evalPoint(tf[i-1], &Y)){
+        Y.x -= X[i].x;
+        Y.y -= X[i].y;
+        Y.z -= X[i].z;
+        t = tf[i-1];
+        dist = Y.dot(Y);
       }
     }
 
-    // Find the distance vector
-    X.x = point.x - X.x;
-    X.y = point.y - X.y;
-    X.z = point.z - X.z;
-
-    // Check whether the distance is closer
-    double d = X.dot(X);
-    if (d < dist){
-      dist = d;
-      tbest = t;
-    }
+    // Find the closest seed point and refine it
+    tree->findSeed(this, NULL, X[i], &t, &v, &dist);
+    fail = newtonProject(X[i], t, &tf[i]) || fail;
   }
 
-  // Set the new closest point
-  t = tbest;
-
-  // Perform a newton iteration until convergence
-  for ( int j = 0; j < max_newton_iters; j++ ){
-    // Compute the knot span
-    int intu = bspline_interval(t, Tu, nctl, ku);
+  return fail;
+}
 
-    // Compute the basis functions
-    int idu = 2;
-    bspline_basis_derivative(Nu, intu, t, idu, Tu, ku, work);
+/*
+  Find the closest point on the curve using Newton's method
 
-    // Set the interval to the initial control point
-    intu = intu - ku + 1;
+  The Newton step is computed using the exact second derivative when
+  it is positive, and otherwise using the Gauss-Newton approximation.
+  The step is halved until the distance to the point does not
+  increase. When no step reduces the distance, the current point is
+  the closest point to within the precision of the evaluation.
 
-    // The positions and their derivatives on the b-spline
-    // surface
-    TMRPoint X, Xt, Xtt;
-    X.zero();
-    Xt.zero();
-    Xtt.zero();
-
-    if (wts){
-      // Evaluate the weighted b-spline
-      TMRPoint p, pt, ptt;
-      p.zero();
-      pt.zero();
-      ptt.zero();
+  input:
+  point:  the point to project onto the curve
+  t0:     the starting parametric location
 
-      double w = 0.0, wt = 0.0, wtt = 0.0;
-      for ( int i = 0; i < ku; i++ ){
-        // Evaluate the numerator and its derivative
-        p.x += wts[intu + i]*Nu[i]*pts[intu + i].x;
-        p.y += wts[intu + i]*Nu[i]*pts[intu + i].y;
-        p.z += wts[intu + i]*Nu[i]*pts[intu + i].z;
-
-        pt.x += wts[intu + i]*Nu[ku + i]*pts[intu + i].x;
-        pt.y += wts[intu + i]*Nu[ku + i]*pts[intu + i].y;
-        pt.z += wts[intu + i]*Nu[ku + i]*pts[intu + i].z;
-
-        ptt.x += wts[intu + i]*Nu[2*ku + i]*pts[intu + i].x;
-        ptt.y += wts[intu + i]*Nu[2*ku + i]*pts[intu + i].y;
-        ptt.z += wts[intu + i]*Nu[2*ku + i]*pts[intu + i].z;
-
-        // Compute the weights and their derivatives
-        w += Nu[i]*wts[intu + i];
-        wt += Nu[ku + i]*wts[intu + i];
-        wtt += Nu[2*ku + i]*wts[intu + i];
-      }
+  output:
+  tf:     the parametric location of the closest point
+*/
+int TMRBsplineCurve::newtonProject( TMRPoint point, double t0,
+                                    double *tf ){
+  // The maximum number of step reductions
+  const int max_line_search_iters = 10;
 
-      // Divide through by the weights
-      if (w != 0.0){
-        // Compute the first and second derivatives of the inverse of
-        // the weights
-        w = 1.0/w;
-        wtt = 2.0*w*w*w*wt*wt - w*w*wtt;
-        wt = -w*w*wt;
-
-        // Evaluate the derivatives
-        X.x = w*p.x;
-        X.y = w*p.y;
-        X.z = w*p.z;
-
-        Xt.x = w*pt.x + wt*p.x;
-        Xt.y = w*pt.y + wt*p.y;
-        Xt.z = w*pt.z + wt*p.z;
-
-        Xtt.x = 2.0*wt*pt.x + w*ptt.x + wtt*p.x;
-        Xtt.y = 2.0*wt*pt.y + w*ptt.y + wtt*p.y;
-        Xtt.z = 2.0*wt*pt.z + w*ptt.z + wtt*p.z;
-      }
-      else {
-        fail = 1;
-        return fail;
-      }
-    }
-    else {
-      // Evaluate the b-spline
-      for ( int i = 0; i < ku; i++ ){
-        X.x += Nu[i]*pts[intu + i].x;
-        X.y += Nu[i]*pts[intu + i].y;
-        X.z += Nu[i]*pts[intu + i].z;
+  // Get the bounds
+  double tmin, tmax;
+  getRange(&tmin, &tmax);
 
-        Xt.x += Nu[ku + i]*pts[intu + i].x;
-        Xt.y += Nu[ku + i]*pts[intu + i].y;
-        Xt.z += Nu[ku + i]*pts[intu + i].z;
+  // Set the starting point
+  double t = t0;
+  *tf = t;
 
-        Xtt.x += Nu[2*ku + i]*pts[intu + i].x;
-        Xtt.y += Nu[2*ku + i]*pts[intu + i].y;
-        Xtt.z += Nu[2*ku + i]*pts[intu + i].z;
-      }
+  // Perform a newton iteration until convergence
+  for ( int j = 0; j < max_newton_iters; j++ ){
+    // The positions and their derivatives on the b-spline
+    TMRPoint X, Xt, Xtt;
+    if (eval2ndDeriv(t, &X, &Xt, &Xtt)){
+      return 1;
     }
 
     // Compute the dot product of the tangent w.r.t. the difference
@@ -625,8 +977,12 @@ int TMRBsplineCurve::invEvalPoint( TMRPoint point, double *tf ){
     // Compute the residual
     double res = Xt.dot(r);
 
-    // Compute the derivative of the dot product
+    // Compute the derivative of the dot product. Use the Gauss-Newton
+    // approximation if the derivative is not positive.
     double deriv = Xtt.dot(r) + Xt.dot(Xt);
+    if (deriv <= 0.0){
+      deriv = Xt.dot(Xt);
+    }
 
     // Compute the update for t
     double tnew = t;
@@ -635,15 +991,12 @@ int TMRBsplineCurve::invEvalPoint( TMRPoint point, double *tf ){
     }
 
     // Truncate the new value to the boundary
-    // if (open curve){
-    if (tnew < Tu[0]){
-      tnew = Tu[0];
+    if (tnew < tmin){
+      tnew = tmin;
     }
-    else if (tnew > Tu[nctl+ku-1]){
-      tnew = Tu[nctl+ku-1];
+    else if (tnew > tmax){
+      tnew = tmax;
     }
-    // }
-    // else { }
 
     // Check if the convergence test satisfied
     if (fabs(r.x) < eps_dist &&
@@ -667,13 +1020,32 @@ int TMRBsplineCurve::invEvalPoint( TMRPoint point, double *tf ){
       return 0;
     }
 
+    // Reduce the step until the distance does not increase
+    int decrease = 0;
+    for ( int k = 0; k < max_line_search_iters; k++ ){
+      TMRPoint Y;
+      evalPoint(tnew, &Y);
+      Y.x -= point.x;
+      Y.y -= point.y;
+      Y.z -= point.z;
+      if (Y.dot(Y) <= dot2){
+        decrease = 1;
+        break;
+      }
+      tnew = 0.5*(t + tnew);
+    }
+    if (!decrease){
+      *tf = t;
+      return 0;
+    }
+
     // Update the new parameter value
     t = tnew;
   }
 
   // The newton method has failed!!
-  fail = 1;
-  return fail;
+  *tf = t;
+  return 1;
 }
 
 /*
@@ -751,7 +1123,7 @@ int TMRBsplineCurve::evalDeriv( double t, TMRPoint *X, TMRPoint *Xt ){
 int TMRBsplineCurve::eval2ndDeriv( double t, TMRPoint *X,
                                    TMRPoint *Xt, TMRPoint *Xtt ){
 
-  double Nu[2*MAX_BSPLINE_ORDER];
+  double Nu[3*MAX_BSPLINE_ORDER];
   double work[2*MAX_BSPLINE_ORDER + MAX_BSPLINE_ORDER*MAX_BSPLINE_ORDER];
 
   // Compute the knot span
@@ -1497,6 +1869,9 @@ TMRBsplineSurface::TMRBsplineSurface( int _nu, int _nv,
   // Allocate the points array
   pts = new TMRPoint[ nu*nv ];
   memcpy(pts, _pts, nu*nv*sizeof(TMRPoint));
+
+  // Create the knot span tree
+  tree = new TMRBsplineSpanTree(nu, ku, Tu, nv, kv, Tv, pts);
 }
 
 /*
@@ -1541,6 +1916,9 @@ TMRBsplineSurface::TMRBsplineSurface( int _nu, int _nv,
   // Allocate the points array
   pts = new TMRPoint[ nu*nv ];
   memcpy(pts, _pts, nu*nv*sizeof(TMRPoint));
+
+  // Create the knot span tree
+  tree = new TMRBsplineSpanTree(nu, ku, Tu, nv, kv, Tv, pts);
 }
 
 TMRBsplineSurface::TMRBsplineSurface( int _nu, int _nv,
@@ -1583,12 +1961,16 @@ TMRBsplineSurface::TMRBsplineSurface( int _nu, int _nv,
   // Allocate the points array
   pts = new TMRPoint[ nu*nv ];
   memcpy(pts, _pts, nu*nv*sizeof(TMRPoint));
+
+  // Create the knot span tree
+  tree = new TMRBsplineSpanTree(nu, ku, Tu, nv, kv, Tv, pts);
 }
 
 /*
   Free the B-spline/NURBS surface
 */
 TMRBsplineSurface::~TMRBsplineSurface(){
+  delete tree;
   delete [] Tu;
   delete [] Tv;
   if (wts){ delete [] wts; }
@@ -1674,236 +2056,102 @@ int TMRBsplineSurface::evalPoint( double u, double v, TMRPoint *X ){
 
 /*
   Perform the inverse evaluation
+
+  The starting point is the closest seed point from the knot span
+  tree. This is refined using Newton's method.
 */
 int TMRBsplineSurface::invEvalPoint( TMRPoint point,
                                      double *uf, double *vf ){
-  // Did this evaluation fail or not?
-  int fail = 1;
-
-  // Set the default parameter values
-  *uf = *vf = 0.0;
-
-  // The basis functions/work arrays
-  double Nu[3*MAX_BSPLINE_ORDER], Nv[3*MAX_BSPLINE_ORDER];
-  double work[2*MAX_BSPLINE_ORDER + MAX_BSPLINE_ORDER*MAX_BSPLINE_ORDER];
-
-  // Get the bounds
-  double umin, vmin, umax, vmax;
-  getRange(&umin, &vmin, &umax, &vmax);
-  double u = 0.0, v = 0.0;
-  double ubest = 0.0, vbest = 0.0;
-
-  // Set the number of trial points to use in the brute force method
-  // along each direction.
-  int nupts = 2*nu+1;
-  int nvpts = 2*nv+1;
-
-  // Using brute force, find the point that is closest to the input
-  // point by evaluating the surface at a series of locations.
+  // Find the closest seed point
+  double u = 0.5*(Tu[0] + Tu[nu+ku-1]);
+  double v = 0.5*(Tv[0] + Tv[nv+kv-1]);
   double dist = 1e40;
-  for ( int jj = 0; jj < nvpts; jj++ ){
-    for ( int ii = 0; ii < nupts; ii++ ){
-      u = umin + (1.0*ii/(nupts - 1))*(umax - umin);
-      v = vmin + (1.0*jj/(nvpts - 1))*(vmax - vmin);
-      int intu = bspline_interval(u, Tu, nu, ku);
-      int intv = bspline_interval(v, Tv, nv, kv);
-
-      // Evaluate the basis functions
-      bspline_basis(Nu, intu, u, Tu, ku, work);
-      bspline_basis(Nv, intv, v, Tv, kv, work);
-
-      // Set the interval to the initial control point
-      intu = intu - ku + 1;
-      intv = intv - kv + 1;
+  tree->findSeed(NULL, this, point, &u, &v, &dist);
 
-      // Evaluate the point
-      TMRPoint X;
-      X.zero();
+  return newtonProject(point, u, v, uf, vf);
+}
 
-      // If this is a NURBS surface add the effect of the weights
-      if (wts){
-        // Evaluate the b-spline
-        double w = 0.0;
-        for ( int j = 0; j < kv; j++ ){
-          for ( int i = 0; i < ku; i++ ){
-            int index = intu+i + (intv+j)*nu;
-            X.x += wts[index]*Nu[i]*Nv[j]*pts[index].x;
-            X.y += wts[index]*Nu[i]*Nv[j]*pts[index].y;
-            X.z += wts[index]*Nu[i]*Nv[j]*pts[index].z;
-            w += wts[index]*Nu[i]*Nv[j];
-          }
-        }
+/*
+  Perform the inverse evaluation for an array of points
 
-        // Divide through by the weights
-        if (w != 0.0){
-          w = 1.0/w;
-          X.x *= w;
-          X.y *= w;
-          X.z *= w;
-        }
-      }
-      else {
-        // Evaluate the b-spline
-        for ( int j = 0; j < kv; j++ ){
-          for ( int i = 0; i < ku; i++ ){
-            int index = intu+i + (intv+j)*nu;
-            X.x += Nu[i]*Nv[j]*pts[index].x;
-            X.y += Nu[i]*Nv[j]*pts[index].y;
-            X.z += Nu[i]*Nv[j]*pts[index].z;
-          }
-        }
-      }
+  The result from the previous point is used as an initial guess for
+  the next point. This reduces the number of knot spans that must be
+  searched when neighboring points are close to one another.
+
+  input:
+  n:      the number of points
+  X:      the physical locations of the points
 
-      // Find the distance vector
-      X.x = point.x - X.x;
-      X.y = point.y - X.y;
-      X.z = point.z - X.z;
-
-      // Check whether the distance is closer
-      double d = X.dot(X);
-      if (d < dist){
-        dist = d;
-        ubest = u;
-        vbest = v;
+  output:
+  uv:     the parametric locations stored as (u,v) pairs
+*/
+int TMRBsplineSurface::invEvalPoints( int n, const TMRPoint *X,
+                                      double *uv ){
+  int fail = 0;
+  for ( int i = 0; i < n; i++ ){
+    double u = 0.5*(Tu[0] + Tu[nu+ku-1]);
+    double v = 0.5*(Tv[0] + Tv[nv+kv-1]);
+    double dist = 1e40;
+
+    // Use the previous result as the best known point
+    if (i > 0){
+      TMRPoint Y;
+      if (!evalPoint(uv[2*(i-1)], uv[2*(i-1)+1], &Y)){
+        Y.x -= X[i].x;
+        Y.y -= X[i].y;
+        Y.z -= X[i].z;
+        u = uv[2*(i-1)];
+        v = uv[2*(i-1)+1];
+        dist = Y.dot(Y);
       }
     }
+
+    // Find the closest seed point and refine it
+    tree->findSeed(NULL, this, X[i], &u, &v, &dist);
+    fail = newtonProject(X[i], u, v, &uv[2*i], &uv[2*i+1]) || fail;
   }
 
-  // Set the new closest point
-  u = ubest;
-  v = vbest;
+  return fail;
+}
 
-  // Perform a newton iteration until convergence
-  for ( int k = 0; k < max_newton_iters; k++ ){
-    // Compute the knot intervals
-    int intu = bspline_interval(u, Tu, nu, ku);
-    int intv = bspline_interval(v, Tv, nv, kv);
+/*
+  Find the closest point on the surface using Newton's method
 
-    // Evaluate the basis functions
-    int idu = 2, idv = 2;
-    bspline_basis_derivative(Nu, intu, u, idu, Tu, ku, work);
-    bspline_basis_derivative(Nv, intv, v, idv, Tv, kv, work);
+  The Newton step is computed using the exact Hessian of the distance
+  when it is positive definite, and otherwise using the Gauss-Newton
+  approximation. The step is halved until the distance to the point
+  does not increase. When no step reduces the distance, the current
+  point is the closest point to within the precision of the
+  evaluation.
 
-    // Set the interval to the initial control point
-    intu = intu - ku + 1;
-    intv = intv - kv + 1;
+  input:
+  point:   the point to project onto the surface
+  u0, v0:  the starting parametric location
 
-    // Set the point and their derivatives
-    TMRPoint X, Xu, Xv, Xuu, Xuv, Xvv;
-    X.zero();  Xu.zero();  Xv.zero();
-    Xuu.zero();  Xuv.zero();  Xvv.zero();
+  output:
+  uf, vf:  the parametric location of the closest point
+*/
+int TMRBsplineSurface::newtonProject( TMRPoint point,
+                                      double u0, double v0,
+                                      double *uf, double *vf ){
+  // The maximum number of step reductions
+  const int max_line_search_iters = 10;
 
-    // If this is a NURBS surface add the effect of the weights
-    if (wts){
-      // Evaluate the weighted b-spline
-      TMRPoint p, pu, pv, puu, puv, pvv;
-      p.zero();  pu.zero();  pv.zero();
-      puu.zero();  puv.zero();  pvv.zero();
-
-      double w = 0.0, wu = 0.0, wv = 0.0;
-      double wuu = 0.0, wuv = 0.0, wvv = 0.0;
-      for ( int j = 0; j < kv; j++ ){
-        for ( int i = 0; i < ku; i++ ){
-          // Evaluate the numerator and its derivative
-          int index = intu+i + (intv+j)*nu;
-          p.x += wts[index]*Nu[i]*Nv[j]*pts[index].x;
-          p.y += wts[index]*Nu[i]*Nv[j]*pts[index].y;
-          p.z += wts[index]*Nu[i]*Nv[j]*pts[index].z;
-
-          pu.x += wts[index]*Nu[ku+i]*Nv[j]*pts[index].x;
-          pu.y += wts[index]*Nu[ku+i]*Nv[j]*pts[index].y;
-          pu.z += wts[index]*Nu[ku+i]*Nv[j]*pts[index].z;
-
-          pv.x += wts[index]*Nu[i]*Nv[kv+j]*pts[index].x;
-          pv.y += wts[index]*Nu[i]*Nv[kv+j]*pts[index].y;
-          pv.z += wts[index]*Nu[i]*Nv[kv+j]*pts[index].z;
-
-          puu.x += wts[index]*Nu[2*ku+i]*Nv[j]*pts[index].x;
-          puu.y += wts[index]*Nu[2*ku+i]*Nv[j]*pts[index].y;
-          puu.z += wts[index]*Nu[2*ku+i]*Nv[j]*pts[index].z;
-
-          puv.x += wts[index]*Nu[ku+i]*Nv[kv+j]*pts[index].x;
-          puv.y += wts[index]*Nu[ku+i]*Nv[kv+j]*pts[index].y;
-          puv.z += wts[index]*Nu[ku+i]*Nv[kv+j]*pts[index].z;
-
-          pvv.x += wts[index]*Nu[i]*Nv[2*kv+j]*pts[index].x;
-          pvv.y += wts[index]*Nu[i]*Nv[2*kv+j]*pts[index].y;
-          pvv.z += wts[index]*Nu[i]*Nv[2*kv+j]*pts[index].z;
-
-          // Compute the weights and the derivatives of weights
-          w += wts[index]*Nu[i]*Nv[j];
-          wu += wts[index]*Nu[ku+i]*Nv[j];
-          wv += wts[index]*Nu[i]*Nv[kv+j];
-          wuu += wts[index]*Nu[2*ku+i]*Nv[j];
-          wuv += wts[index]*Nu[ku+i]*Nv[kv+j];
-          wvv += wts[index]*Nu[i]*Nv[2*kv+j];
-        }
-      }
+  // Get the bounds
+  double umin, vmin, umax, vmax;
+  getRange(&umin, &vmin, &umax, &vmax);
 
-      // Divide through by the weights
-      if (w != 0.0){
-        w = 1.0/w;
-        wuu = 2.0*w*w*w*wu*wu - w*w*wuu;
-        wuv = 2.0*w*w*w*wu*wv - w*w*wuv;
-        wvv = 2.0*w*w*w*wv*wv - w*w*wvv;
-        wu = -w*w*wu;
-        wv = -w*w*wv;
-
-        X.x = w*p.x;
-        X.y = w*p.y;
-        X.z = w*p.z;
-
-        Xu.x = w*pu.x + wu*p.x;
-        Xu.y = w*pu.y + wu*p.y;
-        Xu.z = w*pu.z + wu*p.z;
-
-        Xv.x = w*pv.x + wv*p.x;
-        Xv.y = w*pv.y + wv*p.y;
-        Xv.z = w*pv.z + wv*p.z;
-
-        Xuu.x = 2.0*wu*pu.x + w*puu.x + wuu*p.x;
-        Xuu.y = 2.0*wu*pu.y + w*puu.y + wuu*p.y;
-        Xuu.z = 2.0*wu*pu.z + w*puu.z + wuu*p.z;
-
-        Xuv.x = wu*pv.x + w*puv.x + wuv*p.x + wv*pu.x;
-        Xuv.y = wu*pv.y + w*puv.y + wuv*p.y + wv*pu.y;
-        Xuv.z = wu*pv.z + w*puv.z + wuv*p.z + wv*pu.z;
-
-        Xvv.x = 2.0*wv*pv.x + w*pvv.x + wvv*p.x;
-        Xvv.y = 2.0*wv*pv.y + w*pvv.y + wvv*p.y;
-        Xvv.z = 2.0*wv*pv.z + w*pvv.z + wvv*p.z;
-      }
-    }
-    else {
-      for ( int j = 0; j < kv; j++ ){
-        for ( int i = 0; i < ku; i++ ){
-          // Evaluate the numerator and its derivative
-          int index = intu+i + (intv+j)*nu;
-          X.x += Nu[i]*Nv[j]*pts[index].x;
-          X.y += Nu[i]*Nv[j]*pts[index].y;
-          X.z += Nu[i]*Nv[j]*pts[index].z;
-
-          Xu.x += Nu[ku+i]*Nv[j]*pts[index].x;
-          Xu.y += Nu[ku+i]*Nv[j]*pts[index].y;
-          Xu.z += Nu[ku+i]*Nv[j]*pts[index].z;
-
-          Xv.x += Nu[i]*Nv[kv+j]*pts[index].x;
-          Xv.y += Nu[i]*Nv[kv+j]*pts[index].y;
-          Xv.z += Nu[i]*Nv[kv+j]*pts[index].z;
-
-          Xuu.x += Nu[2*ku+i]*Nv[j]*pts[index].x;
-          Xuu.y += Nu[2*ku+i]*Nv[j]*pts[index].y;
-          Xuu.z += Nu[2*ku+i]*Nv[j]*pts[index].z;
-
-          Xuv.x += Nu[ku+i]*Nv[kv+j]*pts[index].x;
-          Xuv.y += Nu[ku+i]*Nv[kv+j]*pts[index].y;
-          Xuv.z += Nu[ku+i]*Nv[kv+j]*pts[index].z;
-
-          Xvv.x += Nu[i]*Nv[2*kv+j]*pts[index].x;
-          Xvv.y += Nu[i]*Nv[2*kv+j]*pts[index].y;
-          Xvv.z += Nu[i]*Nv[2*kv+j]*pts[index].z;
-        }
-      }
+  // Set the starting point
+  double u = u0, v = v0;
+  *uf = u;
+  *vf = v;
+
+  // Perform a newton iteration until convergence
+  for ( int k = 0; k < max_newton_iters; k++ ){
+    // Evaluate the point and its derivatives
+    TMRPoint X, Xu, Xv, Xuu, Xuv, Xvv;
+    if (eval2ndDeriv(u, v, &X, &Xu, &Xv, &Xuu, &Xuv, &Xvv)){
+      return 1;
     }
 
     // Compute the difference between the position on the surface
@@ -1922,6 +2170,14 @@ int TMRBsplineSurface::invEvalPoint( TMRPoint point,
     double Juv = Xuv.dot(r) + Xu.dot(Xv);
     double Jvv = Xvv.dot(r) + Xv.dot(Xv);
 
+    // Use the Gauss-Newton approximation if the Jacobian is not
+    // positive definite
+    if (Juu <= 0.0 || Jvv <= 0.0 || Juu*Jvv - Juv*Juv <= 0.0){
+      Juu = Xu.dot(Xu);
+      Juv = Xu.dot(Xv);
+      Jvv = Xv.dot(Xv);
+    }
+
     double du = 0.0, dv = 0.0;
 
     // Check for the bounds on u
@@ -1985,13 +2241,36 @@ int TMRBsplineSurface::invEvalPoint( TMRPoint point,
       return 0;
     }
 
+    // Reduce the step until the distance does not increase
+    int decrease = 0;
+    for ( int j = 0; j < max_line_search_iters; j++ ){
+      TMRPoint Y;
+      evalPoint(unew, vnew, &Y);
+      Y.x -= point.x;
+      Y.y -= point.y;
+      Y.z -= point.z;
+      if (Y.dot(Y) <= dotr){
+        decrease = 1;
+        break;
+      }
+      unew = 0.5*(u + unew);
+      vnew = 0.5*(v + vnew);
+    }
+    if (!decrease){
+      *uf = u;
+      *vf = v;
+      return 0;
+    }
+
     // Update the new parameter values
     u = unew;
     v = vnew;
   }
 
   // The newton method failed
-  return fail;
+  *uf = u;
+  *vf = v;
+  return 1;
 }
 
 /*
@@ -2108,7 +2387,7 @@ int TMRBsplineSurface::eval2ndDeriv( double u, double v,
                                      TMRPoint *Xuv,
                                      TMRPoint *Xvv ){
   // The basis functions/work arrays
-  double Nu[2*MAX_BSPLINE_ORDER], Nv[2*MAX_BSPLINE_ORDER];
+  double Nu[3*MAX_BSPLINE_ORDER], Nv[3*MAX_BSPLINE_ORDER];
   double work[2*MAX_BSPLINE_ORDER + MAX_BSPLINE_ORDER*MAX_BSPLINE_ORDER];
 
   // Compute the knot intervals
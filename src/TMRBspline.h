@@ -23,6 +23,9 @@
 
 #include "TMRGeometry.h"
 
+// The knot span bounding box tree used for inverse evaluation
+class TMRBsplineSpanTree;
+
 /*
   This file contains the TMRBsplineCurve and TMRBsplineSurface
   classes that define B-spline and NURBS curves/surfaces for
@@ -47,6 +50,7 @@ class TMRBsplineCurve : public TMRCurve {
 
   // Given the x,y,z location, find the parametric coordinates
   int invEvalPoint( TMRPoint X, double *t );
+  int invEvalPoints( int n, const TMRPoint *X, double *t );
 
   // Given the parametric point, evaluate the derivative
   int evalDeriv( double t, TMRPoint *X, TMRPoint *Xt );
@@ -72,6 +76,9 @@ class TMRBsplineCurve : public TMRCurve {
   }
 
  private:
+  // Find the closest point using Newton's method from a starting point
+  int newtonProject( TMRPoint p, double t0, double *t );
+
   // The number of control points and b-spline order
   int nctl, ku;
 
@@ -84,6 +91,9 @@ class TMRBsplineCurve : public TMRCurve {
   // The weighs (when it is a NURBS curve)
   double *wts;
 
+  // The bounding box tree for the knot spans
+  TMRBsplineSpanTree *tree;
+
   // Maximum number of newton iterations for the B-spline inverse
   // point code
   static int max_newton_iters;
@@ -113,6 +123,7 @@ class TMRBsplineSurface : public TMRSurface {
 
   // Perform the inverse evaluation
   int invEvalPoint( TMRPoint p, double *u, double *v );
+  int invEvalPoints( int n, const TMRPoint *p, double *uv );
 
   // Given the parametric point, evaluate the first derivative
   int evalDeriv( double u, double v,
@@ -138,6 +149,10 @@ class TMRBsplineSurface : public TMRSurface {
     if (_pts){ *_pts = pts; }
   }
  private:
+  // Find the closest point using Newton's method from a starting point
+  int newtonProject( TMRPoint p, double u0, double v0,
+                     double *u, double *v );
+
   // The number of control points and b-spline order
   int ku, kv;
   int nu, nv;
@@ -151,6 +166,9 @@ class TMRBsplineSurface : public TMRSurface {
   // The weighs (when it is a NURBS curve)
   double *wts;
 
+  // The bounding box tree for the knot spans
+  TMRBsplineSpanTree *tree;
+
   // Maximum number of newton iterations for the B-spline inverse
   // point code
   static int max_newton_iters;
@@ -276,14 +276,17 @@ TMREdgeMesh::TMREdgeMesh( MPI_Comm _comm, TMREdge *_edge,
     // Allocate space for the number of points
     npts = _npts;
 
+    // Find the parametric locations of the points
+    double *t = new double[ npts ];
+    edge->invEvalPoints(npts, _X, t);
+
     // Allocate an array of the edge points
     EdgePt *epts = new EdgePt[ npts ];
     for ( int i = 0; i < npts; i++ ){
-      double t;
-      edge->invEvalPoint(_X[i], &t);
       epts[i].p = _X[i];
-      epts[i].t = t;
+      epts[i].t = t[i];
     }
+    delete [] t;
 
     // Sort the edges
     qsort(epts, npts, sizeof(EdgePt), EdgePt::compare);
@@ -315,6 +318,9 @@ TMREdgeMesh::~TMREdgeMesh(){
 
 /*
   Find the points along the edge for the mesh
+
+  The mesh is created on the root processor and broadcast to all
+  other processors.
 */
 void TMREdgeMesh::mesh( TMRMeshOptions options,
                         TMRElementFeatureSize *fs ){
@@ -332,9 +338,8 @@ void TMREdgeMesh::mesh( TMRMeshOptions options,
   edge->getSource(&source);
   edge->getCopySource(&copy);
 
-  // Figure out if there is a source edge and whether or not it has
-  // been meshed.
-  npts = -1;
+  // If the edge mesh for the source or copy source does not yet
+  // exist, create it...
   if (source && source != edge){
     TMREdgeMesh *mesh;
     source->getMesh(&mesh);
@@ -343,12 +348,8 @@ void TMREdgeMesh::mesh( TMRMeshOptions options,
       mesh->mesh(options, fs);
       source->setMesh(mesh);
     }
-
-    // Retrieve the number of points along the source edge
-    mesh->getMeshPoints(&npts, NULL, NULL);
   }
   else if (copy && copy != edge){
-    // Set the edge mesh
     TMREdgeMesh *mesh;
     copy->getMesh(&mesh);
     if (!mesh){
@@ -356,6 +357,61 @@ void TMREdgeMesh::mesh( TMRMeshOptions options,
       mesh->mesh(options, fs);
       copy->setMesh(mesh);
     }
+  }
+
+  if (mpi_rank == 0){
+    createMesh(options, fs);
+  }
+
+  if (mpi_size > 1){
+    broadcastMesh(0);
+  }
+}
+
+/*
+  Create the mesh for the edge on this processor only
+
+  This code is not collective. The meshes for the source or copy
+  source edges should already exist. If they do not, the edge is
+  part of a cyclic source/copy dependency and is meshed independently.
+*/
+void TMREdgeMesh::createMesh( TMRMeshOptions options,
+                              TMRElementFeatureSize *fs ){
+  // Check if the mesh has already been allocated
+  if (prescribed_mesh){
+    return;
+  }
+
+  // Get the source edge
+  TMREdge *source, *copy;
+  edge->getSource(&source);
+  edge->getCopySource(&copy);
+
+  // Ignore a source or copy source edge that has no mesh
+  TMREdgeMesh *dep_mesh = NULL;
+  if (source){
+    source->getMesh(&dep_mesh);
+    if (!dep_mesh){ source = NULL; }
+  }
+  if (copy){
+    copy->getMesh(&dep_mesh);
+    if (!dep_mesh){ copy = NULL; }
+  }
+
+  // Figure out if there is a source edge and retrieve the number of
+  // points along it
+  npts = -1;
+  if (source && source != edge){
+    TMREdgeMesh *mesh;
+    source->getMesh(&mesh);
+
+    // Retrieve the number of points along the source edge
+    mesh->getMeshPoints(&npts, NULL, NULL);
+  }
+  else if (copy && copy != edge){
+    // Set the edge mesh
+    TMREdgeMesh *mesh;
+    copy->getMesh(&mesh);
 
     // Retrieve the vertices
     TMRVertex *v1, *v2, *t;
@@ -395,136 +451,142 @@ void TMREdgeMesh::mesh( TMRMeshOptions options,
     }
   }
 
-  if (mpi_rank == 0){
-    if (copy && copy != edge){
-      // Set the edge mesh
-      TMREdgeMesh *mesh;
-      copy->getMesh(&mesh);
+  if (copy && copy != edge){
+    // Set the edge mesh
+    TMREdgeMesh *mesh;
+    copy->getMesh(&mesh);
 
-      // Allocate space for the points/x locations
-      pts = new double[ npts ];
-      X = new TMRPoint[ npts ];
+    // Allocate space for the points/x locations
+    pts = new double[ npts ];
+    X = new TMRPoint[ npts ];
 
-      // Get the orientation of the copy
-      int orient = getEdgeCopyOrient(edge);
-      if (orient == 0){
-        fprintf(stderr, "TMREdgeMesh Error: Copy edge is not set correctly\n");
-      }
+    // Get the orientation of the copy
+    int orient = getEdgeCopyOrient(edge);
+    if (orient == 0){
+      fprintf(stderr, "TMREdgeMesh Error: Copy edge is not set correctly\n");
+    }
 
-      int edge_index = mesh->npts-2;
-      if (orient > 0){
-        edge_index = 1;
-      }
-      for ( int i = 1; i < npts-1; i++, edge_index += orient ){
-        int icode = edge->invEvalPoint(mesh->X[edge_index], &pts[i]);
-        if (icode){
-          fprintf(stderr,
-                  "TMREdgeMesh Error: Inverse evaluation failed with code %d\n",
-                  icode);
-        }
-        edge->evalPoint(pts[i], &X[i]);
+    int edge_index = mesh->npts-2;
+    if (orient > 0){
+      edge_index = 1;
+    }
+    for ( int i = 1; i < npts-1; i++, edge_index += orient ){
+      int icode = edge->invEvalPoint(mesh->X[edge_index], &pts[i]);
+      if (icode){
+        fprintf(stderr,
+                "TMREdgeMesh Error: Inverse evaluation failed with code %d\n",
+                icode);
       }
-
-      // Set the end points of the edge
-      double tmin, tmax;
-      edge->getRange(&tmin, &tmax);
-      pts[0] = tmin;
-      pts[npts-1] = tmax;
+      edge->evalPoint(pts[i], &X[i]);
     }
-    else {
-      // Get the limits of integration that will be used
-      double tmin, tmax;
-      edge->getRange(&tmin, &tmax);
-
-      // Get the associated vertices
-      TMRVertex *v1, *v2;
-      edge->getVertices(&v1, &v2);
-
-      if (!edge->isDegenerate()){
-        // Set the integration error tolerance
-        double integration_eps = 1e-8;
-
-        // Integrate along the curve to obtain the distance function such
-        // that dist(tvals[i]) = int_{tmin}^{tvals[i]} ||d{C(t)}dt||_{2} dt
-        int nvals;
-        double *dist, *tvals;
-        integrateEdge(edge, fs, tmin, tmax, integration_eps,
-                      &tvals, &dist, &nvals);
-
-        // Only compute the number of points if there is no source edge
-        if (npts < 0){
-          // Compute the number of points along this curve
-          npts = (int)(ceil(dist[nvals-1]));
-          if (npts < 2){ npts = 2; }
-
-          // If we have an even number of points, increment by one to ensure
-          // that we have an even number of segments along the boundary
-          if (npts % 2 != 1){ npts++; }
-
-          // If the start/end vertex are the same, then the minimum number
-          // of points is 5
-          if ((v1 == v2) && npts < 5){
-            npts = 5;
-          }
+
+    // Set the end points of the edge
+    double tmin, tmax;
+    edge->getRange(&tmin, &tmax);
+    pts[0] = tmin;
+    pts[npts-1] = tmax;
+  }
+  else {
+    // Get the limits of integration that will be used
+    double tmin, tmax;
+    edge->getRange(&tmin, &tmax);
+
+    // Get the associated vertices
+    TMRVertex *v1, *v2;
+    edge->getVertices(&v1, &v2);
+
+    if (!edge->isDegenerate()){
+      // Set the integration error tolerance
+      double integration_eps = 1e-8;
+
+      // Integrate along the curve to obtain the distance function such
+      // that dist(tvals[i]) = int_{tmin}^{tvals[i]} ||d{C(t)}dt||_{2} dt
+      int nvals;
+      double *dist, *tvals;
+      integrateEdge(edge, fs, tmin, tmax, integration_eps,
+                    &tvals, &dist, &nvals);
+
+      // Only compute the number of points if there is no source edge
+      if (npts < 0){
+        // Compute the number of points along this curve
+        npts = (int)(ceil(dist[nvals-1]));
+        if (npts < 2){ npts = 2; }
+
+        // If we have an even number of points, increment by one to ensure
+        // that we have an even number of segments along the boundary
+        if (npts % 2 != 1){ npts++; }
+
+        // If the start/end vertex are the same, then the minimum number
+        // of points is 5
+        if ((v1 == v2) && npts < 5){
+          npts = 5;
         }
+      }
 
-        // The average non-dimensional distance between points
-        double d = dist[nvals-1]/(npts-1);
+      // The average non-dimensional distance between points
+      double d = dist[nvals-1]/(npts-1);
 
-        // Allocate the parametric points that will be used
-        pts = new double[ npts ];
+      // Allocate the parametric points that will be used
+      pts = new double[ npts ];
 
-        // Set the starting/end location of the points
-        pts[0] = tmin;
-        pts[npts-1] = tmax;
+      // Set the starting/end location of the points
+      pts[0] = tmin;
+      pts[npts-1] = tmax;
 
-        // Perform the integration so that the points are evenly spaced
-        // along the curve
-        for ( int j = 1, k = 1; (j < nvals && k < npts-1); j++ ){
-          while ((k < npts-1) &&
-                 (dist[j-1] <= d*k && d*k < dist[j])){
-            double u = 0.0;
-            if (dist[j] > dist[j-1]){
-              u = (d*k - dist[j-1])/(dist[j] - dist[j-1]);
-            }
-            pts[k] = tvals[j-1] + (tvals[j] - tvals[j-1])*u;
-            k++;
+      // Perform the integration so that the points are evenly spaced
+      // along the curve
+      for ( int j = 1, k = 1; (j < nvals && k < npts-1); j++ ){
+        while ((k < npts-1) &&
+               (dist[j-1] <= d*k && d*k < dist[j])){
+          double u = 0.0;
+          if (dist[j] > dist[j-1]){
+            u = (d*k - dist[j-1])/(dist[j] - dist[j-1]);
           }
+          pts[k] = tvals[j-1] + (tvals[j] - tvals[j-1])*u;
+          k++;
         }
-
-        // Free the integration result
-        delete [] tvals;
-        delete [] dist;
-      }
-      else {
-        // This is a degenerate edge
-        npts = 2;
-        pts = new double[ npts ];
-        pts[0] = tmin;
-        pts[1] = tmax;
       }
 
-      // Allocate the points
-      X = new TMRPoint[ npts ];
-      for ( int i = 0; i < npts; i++ ){
-        edge->evalPoint(pts[i], &X[i]);
-      }
+      // Free the integration result
+      delete [] tvals;
+      delete [] dist;
+    }
+    else {
+      // This is a degenerate edge
+      npts = 2;
+      pts = new double[ npts ];
+      pts[0] = tmin;
+      pts[1] = tmax;
+    }
+
+    // Allocate the points
+    X = new TMRPoint[ npts ];
+    for ( int i = 0; i < npts; i++ ){
+      edge->evalPoint(pts[i], &X[i]);
     }
   }
+}
 
-  if (mpi_size > 1){
-    // Broadcast the number of points to all the processors
-    MPI_Bcast(&npts, 1, MPI_INT, 0, comm);
+/*
+  Broadcast the mesh from the root processor to all processors
+*/
+void TMREdgeMesh::broadcastMesh( int root ){
+  int mpi_rank;
+  MPI_Comm_rank(comm, &mpi_rank);
 
-    if (mpi_rank != 0){
-      pts = new double[ npts ];
-      X = new TMRPoint[ npts ];
-    }
+  // Broadcast the number of points to all the processors
+  MPI_Bcast(&npts, 1, MPI_INT, root, comm);
 
-    // Broadcast the parametric locations and points
-    MPI_Bcast(pts, npts, MPI_DOUBLE, 0, comm);
-    MPI_Bcast(X, npts, TMRPoint_MPI_type, 0, comm);
+  if (mpi_rank != root){
+    if (pts){ delete [] pts; }
+    if (X){ delete [] X; }
+    pts = new double[ npts ];
+    X = new TMRPoint[ npts ];
   }
+
+  // Broadcast the parametric locations and points
+  MPI_Bcast(pts, npts, MPI_DOUBLE, root, comm);
+  MPI_Bcast(X, npts, TMRPoint_MPI_type, root, comm);
 }
 
 /*
@@ -44,6 +44,11 @@ class TMREdgeMesh : public TMREntity {
   void mesh( TMRMeshOptions options,
              TMRElementFeatureSize *fs );
 
+  // Create the mesh on this processor and broadcast it to the others
+  void createMesh( TMRMeshOptions options,
+                   TMRElementFeatureSize *fs );
+  void broadcastMesh( int root );
+
   // Order the mesh points uniquely
   int setNodeNums( int *num );
   int getNodeNums( const int **_vars );
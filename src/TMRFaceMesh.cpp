@@ -332,13 +332,14 @@ void TMRFaceMesh::setPrescribedMesh( const TMRPoint *_X,
 
   // Set the point locations
   pts = new double[ 2*num_points ];
-  for ( int i = 0; i < num_points; i++ ){
-    face->invEvalPoint(X[i], &pts[2*i], &pts[2*i+1]);
-  }
+  face->invEvalPoints(num_points, X, pts);
 }
 
 /*
   Create the surface mesh
+
+  The mesh is created on the root processor and broadcast to all
+  other processors.
 */
 void TMRFaceMesh::mesh( TMRMeshOptions options,
                         TMRElementFeatureSize *fs ){
@@ -351,12 +352,6 @@ void TMRFaceMesh::mesh( TMRMeshOptions options,
   MPI_Comm_size(comm, &mpi_size);
   MPI_Comm_rank(comm, &mpi_rank);
 
-  // Set the default mesh type
-  TMRFaceMeshType _mesh_type = options.mesh_type_default;
-  if (_mesh_type == TMR_NO_MESH){
-    _mesh_type = TMR_STRUCTURED;
-  }
-
   // Get the source face and its orientation relative to this
   // face. Note that the source face may be NULL in which case the
   // source orientation is meaningless.
@@ -385,6 +380,54 @@ void TMRFaceMesh::mesh( TMRMeshOptions options,
     }
   }
 
+  if (mpi_rank == 0){
+    createMesh(options, fs);
+  }
+
+  if (mpi_size > 1){
+    broadcastMesh(0);
+  }
+}
+
+/*
+  Create the surface mesh on this processor only
+
+  This code is not collective. The meshes for the edges must already
+  exist. The meshes for the source or copy source faces should also
+  exist. If they do not, the face is part of a cyclic source/copy
+  dependency and is meshed independently.
+*/
+void TMRFaceMesh::createMesh( TMRMeshOptions options,
+                              TMRElementFeatureSize *fs ){
+  // Check if the mesh has already been allocated
+  if (prescribed_mesh){
+    return;
+  }
+
+  // Set the default mesh type
+  TMRFaceMeshType _mesh_type = options.mesh_type_default;
+  if (_mesh_type == TMR_NO_MESH){
+    _mesh_type = TMR_STRUCTURED;
+  }
+
+  // Get the source face and its orientation relative to this
+  // face. Note that the source face may be NULL in which case the
+  // source orientation is meaningless.
+  TMRFace *source, *copy;
+  face->getSource(NULL, &source);
+  face->getCopySource(NULL, &copy);
+
+  // Ignore a source or copy source face that has no mesh
+  TMRFaceMesh *dep_mesh = NULL;
+  if (source){
+    source->getMesh(&dep_mesh);
+    if (!dep_mesh){ source = NULL; }
+  }
+  if (copy){
+    copy->getMesh(&dep_mesh);
+    if (!dep_mesh){ copy = NULL; }
+  }
+
   // First check if the conditions for a structured mesh are satisfied
   if (_mesh_type == TMR_STRUCTURED){
     int nloops = face->getNumEdgeLoops();
@@ -440,367 +483,402 @@ void TMRFaceMesh::mesh( TMRMeshOptions options,
   // Record the mesh type
   mesh_type = _mesh_type;
 
-  if (mpi_rank == 0){
-    // Count up the number of points and segments from the curves that
-    // bound the surface. Keep track of the number of points = the
-    // number of segments.
-    int total_num_pts = 0;
+  // Count up the number of points and segments from the curves that
+  // bound the surface. Keep track of the number of points = the
+  // number of segments.
+  int total_num_pts = 0;
 
-    // Get the face orientation
-    int face_orient = face->getOrientation();
+  // Get the face orientation
+  int face_orient = face->getOrientation();
 
-    // Keep track of the number of closed loop cycles in the domain
-    int nloops = face->getNumEdgeLoops();
+  // Keep track of the number of closed loop cycles in the domain
+  int nloops = face->getNumEdgeLoops();
 
-    // The number of degenerate edges
-    int num_degen = 0;
+  // The number of degenerate edges
+  int num_degen = 0;
 
-    // Get all of the edges and count up the mesh points
-    for ( int k = 0; k < nloops; k++ ){
-      TMREdgeLoop *loop;
-      face->getEdgeLoop(k, &loop);
-      int nedges;
-      TMREdge **edges;
-      loop->getEdgeLoop(&nedges, &edges, NULL);
+  // Get all of the edges and count up the mesh points
+  for ( int k = 0; k < nloops; k++ ){
+    TMREdgeLoop *loop;
+    face->getEdgeLoop(k, &loop);
+    int nedges;
+    TMREdge **edges;
+    loop->getEdgeLoop(&nedges, &edges, NULL);
 
-      for ( int i = 0; i < nedges; i++ ){
-        // Count whether this edge is degenerate
-        if (edges[i]->isDegenerate()){
-          num_degen++;
-        }
+    for ( int i = 0; i < nedges; i++ ){
+      // Count whether this edge is degenerate
+      if (edges[i]->isDegenerate()){
+        num_degen++;
+      }
 
-        // Check whether the edge mesh exists - it has to!
-        TMREdgeMesh *mesh = NULL;
-        edges[i]->getMesh(&mesh);
-        if (!mesh){
-          fprintf(stderr,
-                  "TMRFaceMesh Error: Edge mesh does not exist\n");
-        }
+      // Check whether the edge mesh exists - it has to!
+      TMREdgeMesh *mesh = NULL;
+      edges[i]->getMesh(&mesh);
+      if (!mesh){
+        fprintf(stderr,
+                "TMRFaceMesh Error: Edge mesh does not exist\n");
+      }
 
-        // Get the number of points associated with the curve
-        int npts;
-        mesh->getMeshPoints(&npts, NULL, NULL);
+      // Get the number of points associated with the curve
+      int npts;
+      mesh->getMeshPoints(&npts, NULL, NULL);
 
-        // Update the total number of points
-        total_num_pts += npts-1;
-      }
+      // Update the total number of points
+      total_num_pts += npts-1;
     }
+  }
 
-    // The number of holes is equal to the number of loops-1. One loop
-    // bounds the domain, the other loops cut out holes in the domain.
-    // Note that the domain must be contiguous.
-    int nholes = nloops-1;
+  // The number of holes is equal to the number of loops-1. One loop
+  // bounds the domain, the other loops cut out holes in the domain.
+  // Note that the domain must be contiguous.
+  int nholes = nloops-1;
 
-    // All the boundary loops are closed, therefore, the total number
-    // of segments is equal to the total number of points
-    int nsegs = total_num_pts;
+  // All the boundary loops are closed, therefore, the total number
+  // of segments is equal to the total number of points
+  int nsegs = total_num_pts;
 
-    // Set the maximum number of extra segments that will be added to
-    // handle problematic corners
-    const int max_extra_segs = 128;
-    const int max_extra_pts = 128;
+  // Set the maximum number of extra segments that will be added to
+  // handle problematic corners
+  const int max_extra_segs = 128;
+  const int max_extra_pts = 128;
 
-    // Keep track of the beginning/end of each llop
-    int *loop_pt_offset = new int[ nloops+1 ];
+  // Keep track of the beginning/end of each llop
+  int *loop_pt_offset = new int[ nloops+1 ];
 
-    // Allocate the points and the number of segments based on the
-    // number of holes
-    double *params = new double[ 2*(total_num_pts + nholes + max_extra_pts) ];
-    int *segments = new int[ 2*(nsegs + max_extra_segs) ];
+  // Allocate the points and the number of segments based on the
+  // number of holes
+  double *params = new double[ 2*(total_num_pts + nholes + max_extra_pts) ];
+  int *segments = new int[ 2*(nsegs + max_extra_segs) ];
 
-    // Start entering the points from the end of the last hole entry in
-    // the parameter points array.
-    int pt = 0;
+  // Start entering the points from the end of the last hole entry in
+  // the parameter points array.
+  int pt = 0;
 
-    // Set up the degenerate edges
-    int *degen = NULL;
-    if (num_degen > 0){
-      degen = new int[ 2*num_degen ];
-    }
-    num_degen = 0;
+  // Set up the degenerate edges
+  int *degen = NULL;
+  if (num_degen > 0){
+    degen = new int[ 2*num_degen ];
+  }
+  num_degen = 0;
 
-    for ( int k = 0; k < nloops; k++ ){
-      // Set the offset to the initial point/segment on this loop
-      loop_pt_offset[k] = pt;
+  for ( int k = 0; k < nloops; k++ ){
+    // Set the offset to the initial point/segment on this loop
+    loop_pt_offset[k] = pt;
 
-      // Get the curve information for this loop segment
-      TMREdgeLoop *loop;
-      face->getEdgeLoop(k, &loop);
-      int nedges;
-      TMREdge **edges;
-      const int *edge_orient;
-      loop->getEdgeLoop(&nedges, &edges, &edge_orient);
+    // Get the curve information for this loop segment
+    TMREdgeLoop *loop;
+    face->getEdgeLoop(k, &loop);
+    int nedges;
+    TMREdge **edges;
+    const int *edge_orient;
+    loop->getEdgeLoop(&nedges, &edges, &edge_orient);
 
-      int edge_index = nedges-1;
-      if (face_orient > 0){
-        edge_index = 0;
-      }
+    int edge_index = nedges-1;
+    if (face_orient > 0){
+      edge_index = 0;
+    }
 
-      for ( int i = 0; i < nedges; i++, edge_index += face_orient ){
-        // Retrieve the underlying curve mesh
-        TMREdge *edge = edges[edge_index];
-        TMREdgeMesh *mesh = NULL;
-        edge->getMesh(&mesh);
+    for ( int i = 0; i < nedges; i++, edge_index += face_orient ){
+      // Retrieve the underlying curve mesh
+      TMREdge *edge = edges[edge_index];
+      TMREdgeMesh *mesh = NULL;
+      edge->getMesh(&mesh);
 
-        // Get the mesh points corresponding to this curve
-        int npts;
-        const double *tpts;
-        mesh->getMeshPoints(&npts, &tpts, NULL);
+      // Get the mesh points corresponding to this curve
+      int npts;
+      const double *tpts;
+      mesh->getMeshPoints(&npts, &tpts, NULL);
 
-        // Get the orientation of the edge
-        int orientation = face_orient*edge_orient[edge_index];
+      // Get the orientation of the edge
+      int orientation = face_orient*edge_orient[edge_index];
 
-        int index = npts-1;
-        if (orientation > 0){
-          index = 0;
-        }
+      int index = npts-1;
+      if (orientation > 0){
+        index = 0;
+      }
 
-        for ( int j = 0; j < npts-1; j++, index += orientation ){
-          int info = edge->getParamsOnFace(face, tpts[index],
-                                           edge_orient[edge_index],
-                                           &params[2*pt], &params[2*pt+1]);
-          if (info != 0){
-            fprintf(stderr, "TMRFaceMesh Error: getParamsOnFace "
-                    "failed with error code %d\n", info);
-          }
-          else {
-            segments[2*pt] = pt;
-            segments[2*pt+1] = pt+1;
-            if (edge->isDegenerate()){
-              degen[2*num_degen] = pt;
-              degen[2*num_degen+1] = pt+1;
-              num_degen++;
-            }
-            pt++;
+      for ( int j = 0; j < npts-1; j++, index += orientation ){
+        int info = edge->getParamsOnFace(face, tpts[index],
+                                         edge_orient[edge_index],
+                                         &params[2*pt], &params[2*pt+1]);
+        if (info != 0){
+          fprintf(stderr, "TMRFaceMesh Error: getParamsOnFace "
+                  "failed with error code %d\n", info);
+        }
+        else {
+          segments[2*pt] = pt;
+          segments[2*pt+1] = pt+1;
+          if (edge->isDegenerate()){
+            degen[2*num_degen] = pt;
+            degen[2*num_degen+1] = pt+1;
+            num_degen++;
           }
+          pt++;
         }
       }
-
-      // Close off the loop by connecting the segment back to the
-      // initial loop point
-      segments[2*(pt-1)+1] = loop_pt_offset[k];
     }
 
-    // Set the last loop
-    loop_pt_offset[nloops] = pt;
+    // Close off the loop by connecting the segment back to the
+    // initial loop point
+    segments[2*(pt-1)+1] = loop_pt_offset[k];
+  }
 
-    // Set the total number of fixed points. These are the points that
-    // will not be smoothed and constitute the boundary nodes. Note
-    // that the Triangularize class removes the holes from the domain
-    // automatically.  The boundary points are guaranteed to be
-    // ordered first.
-    num_fixed_pts = total_num_pts - num_degen;
+  // Set the last loop
+  loop_pt_offset[nloops] = pt;
 
-    if (source){
-      mapSourceToTarget(options, params);
-    }
-    else if (copy){
-      mapCopyToTarget(options, params);
-    }
-    else if (mesh_type == TMR_STRUCTURED){
-      createStructuredMesh(options, params);
-    }
-    else if (mesh_type == TMR_TRIANGLE){
-      // Compute hole points (inside the holes)
-      computeHolePts(nloops, total_num_pts, loop_pt_offset, segments, params);
+  // Set the total number of fixed points. These are the points that
+  // will not be smoothed and constitute the boundary nodes. Note
+  // that the Triangularize class removes the holes from the domain
+  // automatically.  The boundary points are guaranteed to be
+  // ordered first.
+  num_fixed_pts = total_num_pts - num_degen;
 
-      // Create an unstructured triangular mesh
-      createUnstructuredMesh(options, fs, mesh_type,
-                             total_num_pts, nholes,
-                             params, nsegs, segments, num_degen, degen,
-                             &num_points, &pts, &X, &num_quads, &quads,
-                             &num_tris, &tris);
-    }
-    else if (mesh_type == TMR_UNSTRUCTURED){
-      // Loop over the segments in the mesh to find corners
-      // with angles less than 60 degrees. These corners will be
-      // cut and replaced with a specified quadrilateral corner pattern
+  if (source){
+    mapSourceToTarget(options, params);
+  }
+  else if (copy){
+    mapCopyToTarget(options, params);
+  }
+  else if (mesh_type == TMR_STRUCTURED){
+    createStructuredMesh(options, params);
+  }
+  else if (mesh_type == TMR_TRIANGLE){
+    // Compute hole points (inside the holes)
+    computeHolePts(nloops, total_num_pts, loop_pt_offset, segments, params);
+
+    // Create an unstructured triangular mesh
+    createUnstructuredMesh(options, fs, mesh_type,
+                           total_num_pts, nholes,
+                           params, nsegs, segments, num_degen, degen,
+                           &num_points, &pts, &X, &num_quads, &quads,
+                           &num_tris, &tris);
+  }
+  else if (mesh_type == TMR_UNSTRUCTURED){
+    // Loop over the segments in the mesh to find corners
+    // with angles less than 60 degrees. These corners will be
+    // cut and replaced with a specified quadrilateral corner pattern
+
+    // Evaluate all of the points around the edge
+    TMRPoint *Xparam = new TMRPoint[ total_num_pts ];
+    for ( int i = 0; i < total_num_pts; i++ ){
+      face->evalPoint(params[2*i], params[2*i+1], &Xparam[i]);
+    }
+
+    // Go through the edge loops and find corners that will be problematic
+    // for the quadrilateral mesh generator. Add extra segments
+    // to alleviate the meshing issues in these corners.
+    for ( int loop = 0; loop < nloops; loop++ ){
+      for ( int p = loop_pt_offset[loop]; p < loop_pt_offset[loop+1]; ){
+        int incr = 1;
+        int next = p + 1;
+        int prev = p - 1;
+        if (next >= loop_pt_offset[loop+1]){
+          next = loop_pt_offset[loop];
+        }
+        if (prev < loop_pt_offset[loop]){
+          prev = loop_pt_offset[loop+1]-1;
+        }
 
-      // Evaluate all of the points around the edge
-      TMRPoint *Xparam = new TMRPoint[ total_num_pts ];
-      for ( int i = 0; i < total_num_pts; i++ ){
-        face->evalPoint(params[2*i], params[2*i+1], &Xparam[i]);
-      }
+        // Compute the difference
+        TMRPoint d1, d2;
+        d1.x = Xparam[p].x - Xparam[prev].x;
+        d1.y = Xparam[p].y - Xparam[prev].y;
+        d1.z = Xparam[p].z - Xparam[prev].z;
+        d2.x = Xparam[next].x - Xparam[p].x;
+        d2.y = Xparam[next].y - Xparam[p].y;
+        d2.z = Xparam[next].z - Xparam[p].z;
+
+        // Compute the dot product of the two vectors
+        double d1dist = sqrt(d1.dot(d1));
+        double d2dist = sqrt(d2.dot(d2));
+        double dot = -d1.dot(d2)/(d1dist*d2dist);
+
+        // If the dot product is such that the angle is
+        // less than about 75 degrees, add segments to ensure
+        // that elements are created on either side of the segment
+        if (dot > 0.25){
+          // Set the first point in the new segment list
+          segments[2*nsegs] = pt;
+          segments[2*nsegs+1] = pt+1;
+          nsegs++;
+
+          // Insert the new point
+          TMRPoint Xmid;
+          Xmid.x = 0.5*(Xparam[next].x + Xparam[prev].x);
+          Xmid.y = 0.5*(Xparam[next].y + Xparam[prev].y);
+          Xmid.z = 0.5*(Xparam[next].z + Xparam[prev].z);
+
+          face->invEvalPoint(Xmid, &params[2*pt], &params[2*pt+1]);
+          pt++;
 
-      // Go through the edge loops and find corners that will be problematic
-      // for the quadrilateral mesh generator. Add extra segments
-      // to alleviate the meshing issues in these corners.
-      for ( int loop = 0; loop < nloops; loop++ ){
-        for ( int p = loop_pt_offset[loop]; p < loop_pt_offset[loop+1]; ){
-          int incr = 1;
-          int next = p + 1;
-          int prev = p - 1;
-          if (next >= loop_pt_offset[loop+1]){
-            next = loop_pt_offset[loop];
-          }
-          if (prev < loop_pt_offset[loop]){
-            prev = loop_pt_offset[loop+1]-1;
-          }
+          const int max_new_corner_segments = 4;
+          for ( int i = 0; i < max_new_corner_segments; i++ ){
+            // Increment the pointers to the next/previous index
+            next++;
+            prev--;
+            if (next >= loop_pt_offset[loop+1]){
+              next = loop_pt_offset[loop];
+            }
+            if (prev < loop_pt_offset[loop]){
+              prev = loop_pt_offset[loop+1]-1;
+            }
 
-          // Compute the difference
-          TMRPoint d1, d2;
-          d1.x = Xparam[p].x - Xparam[prev].x;
-          d1.y = Xparam[p].y - Xparam[prev].y;
-          d1.z = Xparam[p].z - Xparam[prev].z;
-          d2.x = Xparam[next].x - Xparam[p].x;
-          d2.y = Xparam[next].y - Xparam[p].y;
-          d2.z = Xparam[next].z - Xparam[p].z;
-
-          // Compute the dot product of the two vectors
-          double d1dist = sqrt(d1.dot(d1));
-          double d2dist = sqrt(d2.dot(d2));
-          double dot = -d1.dot(d2)/(d1dist*d2dist);
-
-          // If the dot product is such that the angle is
-          // less than about 75 degrees, add segments to ensure
-          // that elements are created on either side of the segment
-          if (dot > 0.25){
-            // Set the first point in the new segment list
-            segments[2*nsegs] = pt;
-            segments[2*nsegs+1] = pt+1;
-            nsegs++;
-
-            // Insert the new point
-            TMRPoint Xmid;
+            // Compute the mid-point
             Xmid.x = 0.5*(Xparam[next].x + Xparam[prev].x);
             Xmid.y = 0.5*(Xparam[next].y + Xparam[prev].y);
             Xmid.z = 0.5*(Xparam[next].z + Xparam[prev].z);
 
+            // Find the mid-point in the parametric space
             face->invEvalPoint(Xmid, &params[2*pt], &params[2*pt+1]);
             pt++;
 
-            const int max_new_corner_segments = 4;
-            for ( int i = 0; i < max_new_corner_segments; i++ ){
-              // Increment the pointers to the next/previous index
-              next++;
-              prev--;
-              if (next >= loop_pt_offset[loop+1]){
-                next = loop_pt_offset[loop];
-              }
-              if (prev < loop_pt_offset[loop]){
-                prev = loop_pt_offset[loop+1]-1;
-              }
-
-              // Compute the mid-point
-              Xmid.x = 0.5*(Xparam[next].x + Xparam[prev].x);
-              Xmid.y = 0.5*(Xparam[next].y + Xparam[prev].y);
-              Xmid.z = 0.5*(Xparam[next].z + Xparam[prev].z);
-
-              // Find the mid-point in the parametric space
-              face->invEvalPoint(Xmid, &params[2*pt], &params[2*pt+1]);
-              pt++;
-
-              // Find the vector between the two points on the boundary
-              TMRPoint d3;
-              d3.x = Xparam[next].x - Xparam[prev].x;
-              d3.y = Xparam[next].y - Xparam[prev].y;
-              d3.z = Xparam[next].z - Xparam[prev].z;
-
-              // If the distance between the next/prev values
-              // is less than
-              double d3dist = sqrt(d3.dot(d3));
-              if (d3dist > 0.75*(d1dist + d2dist)){
-                break;
-              }
-              else if (i+1 < max_new_corner_segments){
-                // Add the next segment
-                segments[2*nsegs] = pt-1;
-                segments[2*nsegs+1] = pt;
-                nsegs++;
-              }
+            // Find the vector between the two points on the boundary
+            TMRPoint d3;
+            d3.x = Xparam[next].x - Xparam[prev].x;
+            d3.y = Xparam[next].y - Xparam[prev].y;
+            d3.z = Xparam[next].z - Xparam[prev].z;
+
+            // If the distance between the next/prev values
+            // is less than
+            double d3dist = sqrt(d3.dot(d3));
+            if (d3dist > 0.75*(d1dist + d2dist)){
+              break;
+            }
+            else if (i+1 < max_new_corner_segments){
+              // Add the next segment
+              segments[2*nsegs] = pt-1;
+              segments[2*nsegs+1] = pt;
+              nsegs++;
             }
           }
-
-          p += incr;
         }
-      }
 
-      // Reset the total number of points
-      total_num_pts = pt;
+        p += incr;
+      }
+    }
 
-      // Compute hole points (inside the holes)
-      computeHolePts(nloops, total_num_pts, loop_pt_offset, segments, params);
+    // Reset the total number of points
+    total_num_pts = pt;
 
-      // Create the unstructured mesh
-      createUnstructuredMesh(options, fs, mesh_type,
-                             total_num_pts, nholes,
-                             params, nsegs, segments, num_degen, degen,
-                             &num_points, &pts, &X, &num_quads, &quads,
-                             &num_tris, &tris);
+    // Compute hole points (inside the holes)
+    computeHolePts(nloops, total_num_pts, loop_pt_offset, segments, params);
 
-      // Free the triangles - these are not needed for this type of mesh
-      delete [] tris;
-      num_tris = 0;
-      tris = NULL;
+    // Create the unstructured mesh
+    createUnstructuredMesh(options, fs, mesh_type,
+                           total_num_pts, nholes,
+                           params, nsegs, segments, num_degen, degen,
+                           &num_points, &pts, &X, &num_quads, &quads,
+                           &num_tris, &tris);
 
-      // Build connectivity to smooth the quad mesh
-      int *pts_to_quad_ptr;
-      int *pts_to_quads;
-      TMR_ComputeNodeToElems(num_points, num_quads, 4, quads,
-                             &pts_to_quad_ptr, &pts_to_quads);
+    // Free the triangles - these are not needed for this type of mesh
+    delete [] tris;
+    num_tris = 0;
+    tris = NULL;
 
-      // Smooth the mesh using a local optimization of node locations
-      TMR_QuadSmoothing(options.num_smoothing_steps, num_fixed_pts,
-                        num_points, pts_to_quad_ptr, pts_to_quads,
-                        num_quads, quads, pts, X, face);
+    // Build connectivity to smooth the quad mesh
+    int *pts_to_quad_ptr;
+    int *pts_to_quads;
+    TMR_ComputeNodeToElems(num_points, num_quads, 4, quads,
+                           &pts_to_quad_ptr, &pts_to_quads);
 
-      // Free the connectivity information
-      delete [] pts_to_quad_ptr;
-      delete [] pts_to_quads;
+    // Smooth the mesh using a local optimization of node locations
+    TMR_QuadSmoothing(options.num_smoothing_steps, num_fixed_pts,
+                      num_points, pts_to_quad_ptr, pts_to_quads,
+                      num_quads, quads, pts, X, face);
 
-      if (options.write_post_smooth_quad){
-        char filename[256];
-        sprintf(filename, "post_smooth_quad%d.vtk",
-                face->getEntityId());
-        writeToVTK(filename);
-      }
-    }
+    // Free the connectivity information
+    delete [] pts_to_quad_ptr;
+    delete [] pts_to_quads;
 
-    if (num_degen > 0){
-      delete [] degen;
+    if (options.write_post_smooth_quad){
+      char filename[256];
+      sprintf(filename, "post_smooth_quad%d.vtk",
+              face->getEntityId());
+      writeToVTK(filename);
     }
+  }
 
-    // Free the parameter/segment information
-    delete [] loop_pt_offset;
-    delete [] params;
-    delete [] segments;
+  if (num_degen > 0){
+    delete [] degen;
   }
 
-  if (mpi_size > 1){
-    // Broadcast the number of points to all the processors
-    int temp[3];
-    temp[0] = num_points;
-    temp[1] = num_quads;
-    temp[2] = num_fixed_pts;
-    MPI_Bcast(temp, 3, MPI_INT, 0, comm);
-    num_points = temp[0];
-    num_quads = temp[1];
-    num_fixed_pts = temp[2];
-
-    if (mpi_rank != 0){
-      pts = new double[ 2*num_points ];
-      X = new TMRPoint[ num_points ];
-      quads = new int[ 4*num_quads ];
-    }
+  // Free the parameter/segment information
+  delete [] loop_pt_offset;
+  delete [] params;
+  delete [] segments;
+}
 
-    // Broadcast the parametric locations and points
-    MPI_Bcast(pts, 2*num_points, MPI_DOUBLE, 0, comm);
-    MPI_Bcast(X, num_points, TMRPoint_MPI_type, 0, comm);
-    MPI_Bcast(quads, 4*num_quads, MPI_INT, 0, comm);
+/*
+  Broadcast the surface mesh from the root processor to all
+  processors
+*/
+void TMRFaceMesh::broadcastMesh( int root ){
+  int mpi_rank;
+  MPI_Comm_rank(comm, &mpi_rank);
 
-    // Broadcast the source to target information
-    if (source){
-      if (mpi_rank != 0){
-        source_to_target = new int[ num_points ];
-      }
-      MPI_Bcast(source_to_target, num_points, MPI_INT, 0, comm);
+  // Broadcast the mesh type and the number of points/elements. Only
+  // send the triangle connectivity when it exists, since a copied
+  // face records the triangle count of its copy source without it.
+  int temp[7];
+  temp[0] = mesh_type;
+  temp[1] = num_points;
+  temp[2] = num_quads;
+  temp[3] = (tris ? num_tris : 0);
+  temp[4] = num_fixed_pts;
+  temp[5] = (source_to_target ? 1 : 0);
+  temp[6] = (copy_to_target ? 1 : 0);
+  MPI_Bcast(temp, 7, MPI_INT, root, comm);
+
+  if (mpi_rank != root){
+    mesh_type = (TMRFaceMeshType)temp[0];
+    num_points = temp[1];
+    num_quads = temp[2];
+    num_tris = temp[3];
+    num_fixed_pts = temp[4];
+
+    // Free any existing data and allocate the new arrays
+    if (pts){ delete [] pts; }
+    if (X){ delete [] X; }
+    if (quads){ delete [] quads; }
+    if (tris){ delete [] tris; }
+    if (source_to_target){ delete [] source_to_target; }
+    if (copy_to_target){ delete [] copy_to_target; }
+    pts = new double[ 2*num_points ];
+    X = new TMRPoint[ num_points ];
+    quads = NULL;
+    tris = NULL;
+    source_to_target = NULL;
+    copy_to_target = NULL;
+    if (num_quads > 0){
+      quads = new int[ 4*num_quads ];
     }
-    else if (copy){
-      if (mpi_rank != 0){
-        copy_to_target = new int[ num_points ];
-      }
-      MPI_Bcast(copy_to_target, num_points, MPI_INT, 0, comm);
+    if (num_tris > 0){
+      tris = new int[ 3*num_tris ];
     }
+    if (temp[5]){
+      source_to_target = new int[ num_points ];
+    }
+    if (temp[6]){
+      copy_to_target = new int[ num_points ];
+    }
+  }
+
+  // Broadcast the parametric locations and points
+  MPI_Bcast(pts, 2*num_points, MPI_DOUBLE, root, comm);
+  MPI_Bcast(X, num_points, TMRPoint_MPI_type, root, comm);
+  if (num_quads > 0){
+    MPI_Bcast(quads, 4*num_quads, MPI_INT, root, comm);
+  }
+  if (temp[3] > 0){
+    MPI_Bcast(tris, 3*num_tris, MPI_INT, root, comm);
+  }
+
+  // Broadcast the source to target information
+  if (temp[5]){
+    MPI_Bcast(source_to_target, num_points, MPI_INT, root, comm);
+  }
+  if (temp[6]){
+    MPI_Bcast(copy_to_target, num_points, MPI_INT, root, comm);
   }
 }
 
@@ -1511,17 +1589,20 @@ int TMRFaceMesh::mapCopyToTarget( TMRMeshOptions options,
     for ( int i = num_fixed_pts; i < num_points; i++ ){
       copy_to_target[i] = i;
       X[i] = copy_mesh->X[i];
-      double u, v;
-      int icode = face->invEvalPoint(X[i], &u, &v);
-      if (icode){
-        fprintf(stderr, "TMRFaceMesh Error: Inverse point evaluation "
-                "failed with code %d\n", icode);
-      }
+    }
+
+    // Find the parametric locations of the points on this face
+    int icode = face->invEvalPoints(num_points - num_fixed_pts,
+                                    &X[num_fixed_pts],
+                                    &pts[2*num_fixed_pts]);
+    if (icode){
+      fprintf(stderr, "TMRFaceMesh Error: Inverse point evaluation "
+              "failed with code %d\n", icode);
+    }
 
-      // Set the target index
-      pts[2*i] = u;
-      pts[2*i+1] = v;
-      face->evalPoint(u, v, &X[i]);
+    // Set the points on the surface
+    for ( int i = num_fixed_pts; i < num_points; i++ ){
+      face->evalPoint(pts[2*i], pts[2*i+1], &X[i]);
     }
 
     // Copy over the quadrilaterals
@@ -1539,6 +1620,22 @@ int TMRFaceMesh::mapCopyToTarget( TMRMeshOptions options,
         quads[4*i+3] = tmp;
       }
     }
+
+    // Copy over the triangles (if any)
+    if (num_tris > 0){
+      tris = new int[ 3*num_tris ];
+      for ( int i = 0; i < 3*num_tris; i++ ){
+        tris[i] = copy_to_target[copy_mesh->tris[i]];
+      }
+
+      if (orient < 0){
+        for ( int i = 0; i < num_tris; i++ ){
+          int tmp = tris[3*i+1];
+          tris[3*i+1] = tris[3*i+2];
+          tris[3*i+2] = tmp;
+        }
+      }
+    }
   }
 
   return 0;
@@ -43,6 +43,11 @@ class TMRFaceMesh : public TMREntity {
   void mesh( TMRMeshOptions options,
              TMRElementFeatureSize *fs );
 
+  // Create the mesh on this processor and broadcast it to the others
+  void createMesh( TMRMeshOptions options,
+                   TMRElementFeatureSize *fs );
+  void broadcastMesh( int root );
+
   // Return the type of the underlying mesh
   TMRFaceMeshType getMeshType(){
     return mesh_type;
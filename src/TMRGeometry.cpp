@@ -33,6 +33,24 @@ int TMRCurve::invEvalPoint( TMRPoint X, double *t ){
   return fail;
 }
 
+/*
+  Perform the inverse evaluation for an array of points
+
+  input:
+  n:      the number of points
+  X:      the physical locations of the points
+
+  output:
+  t:      the parametric locations
+*/
+int TMRCurve::invEvalPoints( int n, const TMRPoint *X, double *t ){
+  int fail = 0;
+  for ( int i = 0; i < n; i++ ){
+    fail = invEvalPoint(X[i], &t[i]) || fail;
+  }
+  return fail;
+}
+
 /*
   Set the step size for the derivative
 */
@@ -164,6 +182,24 @@ void TMRCurve::writeToVTK( const char *filename ){
   }
 }
 
+/*
+  Perform the inverse evaluation for an array of points
+
+  input:
+  n:      the number of points
+  p:      the physical locations of the points
+
+  output:
+  uv:     the parametric locations stored as (u,v) pairs
+*/
+int TMRSurface::invEvalPoints( int n, const TMRPoint *p, double *uv ){
+  int fail = 0;
+  for ( int i = 0; i < n; i++ ){
+    fail = invEvalPoint(p[i], &uv[2*i], &uv[2*i+1]) || fail;
+  }
+  return fail;
+}
+
 /*
   Set the step size for the derivative
 */
@@ -48,6 +48,9 @@ class TMRCurve : public TMREntity {
   // Given the point, find the parametric location
   virtual int invEvalPoint( TMRPoint X, double *t );
 
+  // Find the parametric locations for an array of points
+  virtual int invEvalPoints( int n, const TMRPoint *X, double *t );
+
   // Given the parametric point, evaluate the derivative
   virtual int evalDeriv( double t, TMRPoint *X, TMRPoint *Xt );
 
@@ -78,6 +81,9 @@ class TMRSurface : public TMREntity {
   // Perform the inverse evaluation
   virtual int invEvalPoint( TMRPoint p, double *u, double *v ) = 0;
 
+  // Perform the inverse evaluation for an array of points
+  virtual int invEvalPoints( int n, const TMRPoint *p, double *uv );
+
   // Given the parametric point, evaluate the first derivative
   virtual int evalDeriv( double u, double v,
                          TMRPoint *X,
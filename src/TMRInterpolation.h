@@ -21,6 +21,8 @@
 #ifndef TMR_INTERPOLATION_FUNCTIONS_H
 #define TMR_INTERPOLATION_FUNCTIONS_H
 
+#include <stddef.h>
+
 /*
   The following file defines the inline interpolation functions used
   by TMR.
@@ -289,6 +291,359 @@ inline void bernstein_shape_func_second_derivative( const int order,
   bernstein_shape_func_derivative(order, u, N, Nd);
 }
 
+/*
+  Evaluate the Lagrange shape functions and, optionally, their first
+  derivatives for a batch of points with a fixed order
+
+  The barycentric weights are computed once for the batch and the
+  products over the knots are fully unrolled by the compiler. The
+  derivative is accumulated with the product rule so that no division
+  by (u - knots[j]) is required.
+
+  input:
+  npts:   the number of parametric points
+  u:      the parametric coordinates
+  knots:  the interpolation knots in parameter space
+
+  output:
+  N:      the shape functions, N[order*n + i] for point n
+  Nd:     the derivatives (may be NULL)
+*/
+template <int order>
+inline void lagrange_shape_functions_batch( const int npts,
+                                            const double *u,
+                                            const double *knots,
+                                            double *N,
+                                            double *Nd=NULL ){
+  // Compute the barycentric weights
+  double w[order];
+  for ( int i = 0; i < order; i++ ){
+    w[i] = 1.0;
+    for ( int j = 0; j < order; j++ ){
+      if (i != j){
+        w[i] /= (knots[i] - knots[j]);
+      }
+    }
+  }
+
+  if (Nd){
+    for ( int n = 0; n < npts; n++ ){
+      double d[order];
+      for ( int j = 0; j < order; j++ ){
+        d[j] = u[n] - knots[j];
+      }
+
+      for ( int i = 0; i < order; i++ ){
+        double p = 1.0, dp = 0.0;
+        for ( int j = 0; j < order; j++ ){
+          if (i != j){
+            dp = dp*d[j] + p;
+            p *= d[j];
+          }
+        }
+        N[order*n + i] = w[i]*p;
+        Nd[order*n + i] = w[i]*dp;
+      }
+    }
+  }
+  else {
+    for ( int n = 0; n < npts; n++ ){
+      double d[order];
+      for ( int j = 0; j < order; j++ ){
+        d[j] = u[n] - knots[j];
+      }
+
+      for ( int i = 0; i < order; i++ ){
+        double p = w[i];
+        for ( int j = 0; j < order; j++ ){
+          if (i != j){
+            p *= d[j];
+          }
+        }
+        N[order*n + i] = p;
+      }
+    }
+  }
+}
+
+/*
+  Evaluate the Bernstein shape functions and, optionally, their first
+  derivatives for a batch of points with a fixed order
+
+  input:
+  npts:   the number of parametric points
+  u:      the parametric coordinates
+
+  output:
+  N:      the shape functions, N[order*n + i] for point n
+  Nd:     the derivatives (may be NULL)
+*/
+template <int order>
+inline void bernstein_shape_functions_batch( const int npts,
+                                             const double *u,
+                                             double *N,
+                                             double *Nd=NULL ){
+  for ( int n = 0; n < npts; n++ ){
+    double u1 = 0.5*(1.0 - u[n]);
+    double u2 = 0.5*(u[n] + 1.0);
+
+    // Compute the order-1 basis, then raise it by one order
+    double B[order];
+    B[0] = 1.0;
+    for ( int j = 1; j < order-1; j++ ){
+      double s = 0.0;
+      for ( int k = 0; k < j; k++ ){
+        double t = B[k];
+        B[k] = s + u1*t;
+        s = u2*t;
+      }
+      B[j] = s;
+    }
+
+    if (Nd){
+      for ( int j = 0; j < order; j++ ){
+        double d = 0.0;
+        if (j > 0){
+          d += 0.5*(order-1)*B[j-1];
+        }
+        if (j < order-1){
+          d -= 0.5*(order-1)*B[j];
+        }
+        Nd[order*n + j] = d;
+      }
+    }
+
+    double s = 0.0;
+    for ( int k = 0; k < order-1; k++ ){
+      double t = B[k];
+      N[order*n + k] = s + u1*t;
+      s = u2*t;
+    }
+    N[order*n + order-1] = s;
+  }
+}
+
+/*
+  Evaluate the Lagrange shape functions (and optionally their
+  derivatives) for a batch of points. Orders 2 through 6 use the
+  unrolled fixed-order kernels.
+
+  output:
+  N:      the shape functions, N[order*n + i] for point n
+  Nd:     the derivatives (may be NULL)
+*/
+inline void lagrange_shape_functions_batch( const int order,
+                                            const int npts,
+                                            const double *u,
+                                            const double *knots,
+                                            double *N,
+                                            double *Nd=NULL ){
+  switch (order){
+    case 2:
+      lagrange_shape_functions_batch<2>(npts, u, knots, N, Nd); break;
+    case 3:
+      lagrange_shape_functions_batch<3>(npts, u, knots, N, Nd); break;
+    case 4:
+      lagrange_shape_functions_batch<4>(npts, u, knots, N, Nd); break;
+    case 5:
+      lagrange_shape_functions_batch<5>(npts, u, knots, N, Nd); break;
+    case 6:
+      lagrange_shape_functions_batch<6>(npts, u, knots, N, Nd); break;
+    default:
+      for ( int n = 0; n < npts; n++ ){
+        if (Nd){
+          lagrange_shape_func_derivative(order, u[n], knots,
+                                         &N[order*n], &Nd[order*n]);
+        }
+        else {
+          lagrange_shape_functions(order, u[n], knots, &N[order*n]);
+        }
+      }
+  }
+}
+
+/*
+  Evaluate the Bernstein shape functions (and optionally their
+  derivatives) for a batch of points. Orders 2 through 6 use the
+  unrolled fixed-order kernels.
+
+  output:
+  N:      the shape functions, N[order*n + i] for point n
+  Nd:     the derivatives (may be NULL)
+*/
+inline void bernstein_shape_functions_batch( const int order,
+                                             const int npts,
+                                             const double *u,
+                                             double *N,
+                                             double *Nd=NULL ){
+  switch (order){
+    case 2:
+      bernstein_shape_functions_batch<2>(npts, u, N, Nd); break;
+    case 3:
+      bernstein_shape_functions_batch<3>(npts, u, N, Nd); break;
+    case 4:
+      bernstein_shape_functions_batch<4>(npts, u, N, Nd); break;
+    case 5:
+      bernstein_shape_functions_batch<5>(npts, u, N, Nd); break;
+    case 6:
+      bernstein_shape_functions_batch<6>(npts, u, N, Nd); break;
+    default:
+      for ( int n = 0; n < npts; n++ ){
+        if (Nd){
+          bernstein_shape_func_derivative(order, u[n],
+                                          &N[order*n], &Nd[order*n]);
+        }
+        else {
+          bernstein_shape_functions(order, u[n], &N[order*n]);
+        }
+      }
+  }
+}
+
+/*
+  Interpolate the element values to a tensor-product grid of points
+  using sum factorization
+
+  The element values are ordered with the first parametric direction
+  varying fastest, uelem[nvars*(i + order*j)] and the output is
+  ordered in the same way, uout[nvars*(a + nu*b)]. The 1-D bases are
+  stored point-wise as computed by the batch functions above. The cost
+  is O(order^3) per element instead of O(order^4) for the full
+  tensor-product shape functions.
+
+  input:
+  order:   the order of the element
+  nu, nv:  the number of points in each direction
+  Nu, Nv:  the 1-D shape functions at the points
+  nvars:   the number of variables per node
+  uelem:   the element values
+  work:    work array of size nvars*nv*order
+
+  output:
+  uout:    the values at the points
+*/
+template <class ScalarType>
+inline void tensor_interp2d( const int order,
+                             const int nu, const int nv,
+                             const double *Nu, const double *Nv,
+                             const int nvars, const ScalarType *uelem,
+                             ScalarType *uout, ScalarType *work ){
+  // Contract over the second direction: t[b][i] = sum_j Nv[b][j]*u[j][i]
+  for ( int b = 0; b < nv; b++ ){
+    const double *N = &Nv[order*b];
+    ScalarType *t = &work[nvars*order*b];
+    for ( int k = 0; k < nvars*order; k++ ){
+      t[k] = 0.0;
+    }
+    for ( int j = 0; j < order; j++ ){
+      const ScalarType *ue = &uelem[nvars*order*j];
+      for ( int k = 0; k < nvars*order; k++ ){
+        t[k] += N[j]*ue[k];
+      }
+    }
+  }
+
+  // Contract over the first direction
+  for ( int b = 0; b < nv; b++ ){
+    const ScalarType *t = &work[nvars*order*b];
+    for ( int a = 0; a < nu; a++ ){
+      const double *N = &Nu[order*a];
+      ScalarType *u = &uout[nvars*(a + nu*b)];
+      for ( int k = 0; k < nvars; k++ ){
+        u[k] = 0.0;
+      }
+      for ( int i = 0; i < order; i++ ){
+        for ( int k = 0; k < nvars; k++ ){
+          u[k] += N[i]*t[nvars*i + k];
+        }
+      }
+    }
+  }
+}
+
+/*
+  Interpolate the element values to a tensor-product grid of points
+  using sum factorization
+
+  The element values are ordered uelem[nvars*(i + order*j +
+  order*order*k)] and the output is ordered uout[nvars*(a + nu*b +
+  nu*nv*c)]. Derivatives may be obtained by passing the derivative of
+  the 1-D bases in the appropriate direction.
+
+  input:
+  order:       the order of the element
+  nu, nv, nw:  the number of points in each direction
+  Nu, Nv, Nw:  the 1-D shape functions at the points
+  nvars:       the number of variables per node
+  uelem:       the element values
+  work:        work array of size nvars*nw*order*(order + nv)
+
+  output:
+  uout:        the values at the points
+*/
+template <class ScalarType>
+inline void tensor_interp3d( const int order,
+                             const int nu, const int nv, const int nw,
+                             const double *Nu, const double *Nv,
+                             const double *Nw,
+                             const int nvars, const ScalarType *uelem,
+                             ScalarType *uout, ScalarType *work ){
+  const int plane = nvars*order*order;
+  ScalarType *t1 = work;
+  ScalarType *t2 = &work[nw*plane];
+
+  // Contract over the third direction
+  for ( int c = 0; c < nw; c++ ){
+    const double *N = &Nw[order*c];
+    ScalarType *t = &t1[plane*c];
+    for ( int k = 0; k < plane; k++ ){
+      t[k] = 0.0;
+    }
+    for ( int m = 0; m < order; m++ ){
+      const ScalarType *ue = &uelem[plane*m];
+      for ( int k = 0; k < plane; k++ ){
+        t[k] += N[m]*ue[k];
+      }
+    }
+  }
+
+  // Contract over the second direction
+  for ( int c = 0; c < nw; c++ ){
+    for ( int b = 0; b < nv; b++ ){
+      const double *N = &Nv[order*b];
+      ScalarType *t = &t2[nvars*order*(b + nv*c)];
+      for ( int k = 0; k < nvars*order; k++ ){
+        t[k] = 0.0;
+      }
+      for ( int j = 0; j < order; j++ ){
+        const ScalarType *ue = &t1[plane*c + nvars*order*j];
+        for ( int k = 0; k < nvars*order; k++ ){
+          t[k] += N[j]*ue[k];
+        }
+      }
+    }
+  }
+
+  // Contract over the first direction
+  for ( int c = 0; c < nw; c++ ){
+    for ( int b = 0; b < nv; b++ ){
+      const ScalarType *t = &t2[nvars*order*(b + nv*c)];
+      for ( int a = 0; a < nu; a++ ){
+        const double *N = &Nu[order*a];
+        ScalarType *u = &uout[nvars*(a + nu*b + nu*nv*c)];
+        for ( int k = 0; k < nvars; k++ ){
+          u[k] = 0.0;
+        }
+        for ( int i = 0; i < order; i++ ){
+          for ( int k = 0; k < nvars; k++ ){
+            u[k] += N[i]*t[nvars*i + k];
+          }
+        }
+      }
+    }
+  }
+}
+
 /*
   Evaluate the constraint weights for a Bernstein polynomial along an
   edge for the given mesh order.
@@ -935,43 +935,376 @@ void TMRMesh::resetMesh(){
 }
 
 /*
-  Mesh the underlying geometry
+  Compute the level of an edge in the graph of source/copy
+  dependencies. Edges that are meshed or that are not in the model
+  have level -1. Edges without a source have level 0, and all other
+  edges have a level one greater than their source or copy source.
+
+  The level array is initialized to -2 for edges with an unknown
+  level. Edges whose level is being computed are marked with -3 so
+  that cyclic dependencies are detected. The cycle is reported and
+  broken at the edge where it is detected: the edge that depends on
+  it is placed at level 0 and meshed independently, and the remaining
+  edges in the cycle are meshed from it.
 */
-void TMRMesh::mesh( TMRMeshOptions options,
-                    TMRElementFeatureSize *fs ){
-  // Reset the meshes within the mesh
-  if (options.reset_mesh_objects){
-    resetMesh();
+static int get_edge_mesh_level( TMRModel *geo, TMREdge *edge,
+                                int *level ){
+  int index = geo->getEdgeIndex(edge);
+  if (index < 0){
+    return -1;
   }
 
-  // Mesh the curves
+  if (level[index] == -3){
+    fprintf(stderr, "TMRMesh Error: Cyclic source/copy dependency "
+            "detected at edge %d. Meshing the cycle independently\n",
+            index);
+    return -1;
+  }
+  else if (level[index] == -2){
+    level[index] = -3;
+
+    int lev = -1;
+    TMREdgeMesh *mesh = NULL;
+    edge->getMesh(&mesh);
+    if (!mesh){
+      TMREdge *source, *copy;
+      edge->getSource(&source);
+      edge->getCopySource(&copy);
+      lev = 0;
+      if (source && source != edge){
+        lev = get_edge_mesh_level(geo, source, level) + 1;
+      }
+      else if (copy && copy != edge){
+        lev = get_edge_mesh_level(geo, copy, level) + 1;
+      }
+    }
+    level[index] = lev;
+  }
+
+  return level[index];
+}
+
+/*
+  Compute the level of a face in the graph of source/copy
+  dependencies using the same convention as for the edges
+*/
+static int get_face_mesh_level( TMRModel *geo, TMRFace *face,
+                                int *level ){
+  int index = geo->getFaceIndex(face);
+  if (index < 0){
+    return -1;
+  }
+
+  if (level[index] == -3){
+    fprintf(stderr, "TMRMesh Error: Cyclic source/copy dependency "
+            "detected at face %d. Meshing the cycle independently\n",
+            index);
+    return -1;
+  }
+  else if (level[index] == -2){
+    level[index] = -3;
+
+    int lev = -1;
+    TMRFaceMesh *mesh = NULL;
+    face->getMesh(&mesh);
+    if (!mesh){
+      TMRFace *source, *copy;
+      face->getSource(NULL, &source);
+      face->getCopySource(NULL, &copy);
+      lev = 0;
+      if (source && source != face){
+        lev = get_face_mesh_level(geo, source, level) + 1;
+      }
+      else if (copy && copy != face){
+        lev = get_face_mesh_level(geo, copy, level) + 1;
+      }
+    }
+    level[index] = lev;
+  }
+
+  return level[index];
+}
+
+/*
+  Assign objects to processors so that the estimated cost on each
+  processor is balanced. The objects are assigned in order of
+  decreasing cost to the processor with the lowest total cost. Ties
+  are broken by index so that all processors compute the same
+  assignment.
+
+  input:
+  n:         the number of objects
+  cost:      the estimated cost of each object
+  mpi_size:  the number of processors
+
+  output:
+  owner:     the processor that owns each object
+*/
+static void assign_mesh_owners( int n, const double *cost,
+                                int mpi_size, int *owner ){
+  // Sort the objects by decreasing cost
+  int *order = new int[ n ];
+  for ( int i = 0; i < n; i++ ){
+    order[i] = i;
+  }
+  for ( int i = 1; i < n; i++ ){
+    int index = order[i];
+    int j = i;
+    for ( ; j > 0 && cost[order[j-1]] < cost[index]; j-- ){
+      order[j] = order[j-1];
+    }
+    order[j] = index;
+  }
+
+  // Assign the objects to the processor with the lowest cost
+  double *load = new double[ mpi_size ];
+  memset(load, 0, mpi_size*sizeof(double));
+  for ( int i = 0; i < n; i++ ){
+    int rank = 0;
+    for ( int k = 1; k < mpi_size; k++ ){
+      if (load[k] < load[rank]){
+        rank = k;
+      }
+    }
+    owner[order[i]] = rank;
+    load[rank] += cost[order[i]];
+  }
+
+  delete [] order;
+  delete [] load;
+}
+
+/*
+  Mesh the edges in the model
+
+  The edges are meshed in levels such that the source and copy source
+  of each edge are meshed before the edge itself. The edges within
+  each level are independent. These are distributed across the
+  processors and the result is broadcast from the owner to all
+  processors. The result is identical to meshing all edges on a
+  single processor.
+*/
+void TMRMesh::meshEdges( TMRMeshOptions options,
+                         TMRElementFeatureSize *fs ){
+  int mpi_rank, mpi_size;
+  MPI_Comm_rank(comm, &mpi_rank);
+  MPI_Comm_size(comm, &mpi_size);
+
   int num_edges;
   TMREdge **edges;
   geo->getEdges(&num_edges, &edges);
+
+  // Mesh edges that depend on edges outside of the model using the
+  // collective code
   for ( int i = 0; i < num_edges; i++ ){
     TMREdgeMesh *mesh = NULL;
     edges[i]->getMesh(&mesh);
     if (!mesh){
-      mesh = new TMREdgeMesh(comm, edges[i]);
-      mesh->mesh(options, fs);
-      edges[i]->setMesh(mesh);
+      TMREdge *source, *copy, *dep = NULL;
+      edges[i]->getSource(&source);
+      edges[i]->getCopySource(&copy);
+      if (source && source != edges[i]){
+        dep = source;
+      }
+      else if (copy && copy != edges[i]){
+        dep = copy;
+      }
+      if (dep && geo->getEdgeIndex(dep) < 0){
+        mesh = new TMREdgeMesh(comm, edges[i]);
+        mesh->mesh(options, fs);
+        edges[i]->setMesh(mesh);
+      }
     }
   }
 
-  // Mesh the surface
+  // Compute the level of each edge
+  int max_level = -1;
+  int *level = new int[ num_edges ];
+  for ( int i = 0; i < num_edges; i++ ){
+    level[i] = -2;
+  }
+  for ( int i = 0; i < num_edges; i++ ){
+    int lev = get_edge_mesh_level(geo, edges[i], level);
+    if (lev > max_level){
+      max_level = lev;
+    }
+  }
+
+  int *list = new int[ num_edges ];
+  int *owner = new int[ num_edges ];
+  double *cost = new double[ num_edges ];
+  TMREdgeMesh **meshes = new TMREdgeMesh*[ num_edges ];
+
+  for ( int lev = 0; lev <= max_level; lev++ ){
+    // Find the edges at this level. The cost of meshing each edge is
+    // assumed to be the same.
+    int n = 0;
+    for ( int i = 0; i < num_edges; i++ ){
+      if (level[i] == lev){
+        list[n] = i;
+        cost[n] = 1.0;
+        n++;
+      }
+    }
+    assign_mesh_owners(n, cost, mpi_size, owner);
+
+    // Mesh the edges owned by this processor
+    for ( int k = 0; k < n; k++ ){
+      meshes[k] = new TMREdgeMesh(comm, edges[list[k]]);
+      if (owner[k] == mpi_rank){
+        meshes[k]->createMesh(options, fs);
+      }
+    }
+
+    // Distribute the meshes to all processors
+    for ( int k = 0; k < n; k++ ){
+      if (mpi_size > 1){
+        meshes[k]->broadcastMesh(owner[k]);
+      }
+      edges[list[k]]->setMesh(meshes[k]);
+    }
+  }
+
+  delete [] level;
+  delete [] list;
+  delete [] owner;
+  delete [] cost;
+  delete [] meshes;
+}
+
+/*
+  Mesh the faces in the model
+
+  The faces are meshed in levels based on the source and copy source
+  faces, in the same manner as the edges. The cost of meshing each
+  face is estimated from the square of the number of boundary nodes.
+*/
+void TMRMesh::meshFaces( TMRMeshOptions options,
+                         TMRElementFeatureSize *fs ){
+  int mpi_rank, mpi_size;
+  MPI_Comm_rank(comm, &mpi_rank);
+  MPI_Comm_size(comm, &mpi_size);
+
   int num_faces;
   TMRFace **faces;
   geo->getFaces(&num_faces, &faces);
+
+  // Mesh faces that depend on faces outside of the model using the
+  // collective code
   for ( int i = 0; i < num_faces; i++ ){
     TMRFaceMesh *mesh = NULL;
     faces[i]->getMesh(&mesh);
     if (!mesh){
-      mesh = new TMRFaceMesh(comm, faces[i]);
-      mesh->mesh(options, fs);
-      faces[i]->setMesh(mesh);
+      TMRFace *source, *copy, *dep = NULL;
+      faces[i]->getSource(NULL, &source);
+      faces[i]->getCopySource(NULL, &copy);
+      if (source){
+        dep = source;
+      }
+      else if (copy){
+        dep = copy;
+      }
+      if (dep && geo->getFaceIndex(dep) < 0){
+        mesh = new TMRFaceMesh(comm, faces[i]);
+        mesh->mesh(options, fs);
+        faces[i]->setMesh(mesh);
+      }
     }
   }
 
+  // Compute the level of each face
+  int max_level = -1;
+  int *level = new int[ num_faces ];
+  for ( int i = 0; i < num_faces; i++ ){
+    level[i] = -2;
+  }
+  for ( int i = 0; i < num_faces; i++ ){
+    int lev = get_face_mesh_level(geo, faces[i], level);
+    if (lev > max_level){
+      max_level = lev;
+    }
+  }
+
+  int *list = new int[ num_faces ];
+  int *owner = new int[ num_faces ];
+  double *cost = new double[ num_faces ];
+  TMRFaceMesh **meshes = new TMRFaceMesh*[ num_faces ];
+
+  for ( int lev = 0; lev <= max_level; lev++ ){
+    // Find the faces at this level and estimate their cost
+    int n = 0;
+    for ( int i = 0; i < num_faces; i++ ){
+      if (level[i] == lev){
+        int nbound = 0;
+        for ( int k = 0; k < faces[i]->getNumEdgeLoops(); k++ ){
+          TMREdgeLoop *loop;
+          faces[i]->getEdgeLoop(k, &loop);
+          int nedges;
+          TMREdge **loop_edges;
+          loop->getEdgeLoop(&nedges, &loop_edges, NULL);
+          for ( int j = 0; j < nedges; j++ ){
+            TMREdgeMesh *mesh = NULL;
+            loop_edges[j]->getMesh(&mesh);
+            if (mesh){
+              int npts;
+              mesh->getMeshPoints(&npts, NULL, NULL);
+              nbound += npts-1;
+            }
+          }
+        }
+        list[n] = i;
+        cost[n] = 1.0 + 1.0*nbound*nbound;
+        n++;
+      }
+    }
+    assign_mesh_owners(n, cost, mpi_size, owner);
+
+    // Mesh the faces owned by this processor
+    for ( int k = 0; k < n; k++ ){
+      meshes[k] = new TMRFaceMesh(comm, faces[list[k]]);
+      if (owner[k] == mpi_rank){
+        meshes[k]->createMesh(options, fs);
+      }
+    }
+
+    // Distribute the meshes to all processors
+    for ( int k = 0; k < n; k++ ){
+      if (mpi_size > 1){
+        meshes[k]->broadcastMesh(owner[k]);
+      }
+      faces[list[k]]->setMesh(meshes[k]);
+    }
+  }
+
+  delete [] level;
+  delete [] list;
+  delete [] owner;
+  delete [] cost;
+  delete [] meshes;
+}
+
+/*
+  Mesh the underlying geometry
+*/
+void TMRMesh::mesh( TMRMeshOptions options,
+                    TMRElementFeatureSize *fs ){
+  // Reset the meshes within the mesh
+  if (options.reset_mesh_objects){
+    resetMesh();
+  }
+
+  // Mesh the curves
+  int num_edges;
+  TMREdge **edges;
+  geo->getEdges(&num_edges, &edges);
+  meshEdges(options, fs);
+
+  // Mesh the surface
+  int num_faces;
+  TMRFace **faces;
+  geo->getFaces(&num_faces, &faces);
+  meshFaces(options, fs);
+
   // Update target/source relationships
   int num_volumes;
   TMRVolume **volumes;
@@ -981,7 +1314,7 @@ void TMRMesh::mesh( TMRMeshOptions options,
     volumes[i]->getMesh(&mesh);
     if (!mesh){
       mesh = new TMRVolumeMesh(comm, volumes[i]);
-      int fail = mesh->mesh(options);
+      int fail = mesh->mesh(options, fs);
       if (fail){
         const char *name = volumes[i]->getName();
         if (name){
@@ -993,6 +1326,7 @@ void TMRMesh::mesh( TMRMeshOptions options,
           fprintf(stderr,
                   "TMRMesh Error: Volume meshing failed for volume %d\n", i);
         }
+        delete mesh;
       }
       else {
         volumes[i]->setMesh(mesh);
@@ -1024,11 +1358,13 @@ void TMRMesh::mesh( TMRMeshOptions options,
     mesh->setNodeNums(&num);
   }
 
-  // Order the volumes
+  // Order the volumes. Volumes that failed to mesh have no mesh.
   for ( int i = 0; i < num_volumes; i++ ){
     TMRVolumeMesh *mesh = NULL;
     volumes[i]->getMesh(&mesh);
-    mesh->setNodeNums(&num);
+    if (mesh){
+      mesh->setNodeNums(&num);
+    }
   }
 
   // Set the number of nodes in the mesh
@@ -1044,8 +1380,10 @@ void TMRMesh::mesh( TMRMeshOptions options,
     for ( int i = 0; i < num_volumes; i++ ){
       TMRVolumeMesh *mesh = NULL;
       volumes[i]->getMesh(&mesh);
-      num_hex += mesh->getHexConnectivity(NULL);
-      num_tet += mesh->getTetConnectivity(NULL);
+      if (mesh){
+        num_hex += mesh->getHexConnectivity(NULL);
+        num_tet += mesh->getTetConnectivity(NULL);
+      }
     }
   }
   if (num_faces > 0){
@@ -1119,9 +1457,12 @@ void TMRMesh::initMesh( int count_nodes ){
     // Set the values into the global arrays
     int *h = hex;
     for ( int i = 0; i < num_volumes; i++ ){
-      // Get the mesh
+      // Get the mesh. Skip volumes that failed to mesh.
       TMRVolumeMesh *mesh = NULL;
       volumes[i]->getMesh(&mesh);
+      if (!mesh){
+        continue;
+      }
 
       // Get the local mesh points
       int npts;
@@ -1167,6 +1508,48 @@ void TMRMesh::initMesh( int count_nodes ){
       delete [] count;
     }
   }
+  if (num_tet > 0){
+    tet = new int[ 4*num_tet ];
+
+    // Retrieve the volume information
+    int num_volumes;
+    TMRVolume **volumes;
+    geo->getVolumes(&num_volumes, &volumes);
+
+    // Set the values into the global arrays
+    int *t = tet;
+    for ( int i = 0; i < num_volumes; i++ ){
+      // Get the mesh. Skip volumes that failed to mesh.
+      TMRVolumeMesh *mesh = NULL;
+      volumes[i]->getMesh(&mesh);
+      if (!mesh){
+        continue;
+      }
+
+      // Get the local mesh points
+      int npts;
+      TMRPoint *Xpts;
+      mesh->getMeshPoints(&npts, &Xpts);
+
+      // Get the local tetrahedral connectivity
+      const int *tet_local;
+      int nlocal = mesh->getTetConnectivity(&tet_local);
+
+      // Get the local to global variable numbering
+      const int *vars;
+      mesh->getNodeNums(&vars);
+
+      // Set the tetrahedral connectivity
+      for ( int j = 0; j < 4*nlocal; j++, t++ ){
+        t[0] = vars[tet_local[j]];
+      }
+
+      // Set the node locations
+      for ( int j = 0; j < npts; j++ ){
+        X[vars[j]] = Xpts[j];
+      }
+    }
+  }
   if (num_quads > 0 || num_tris > 0){
     if (num_tris > 0){
       tris = new int[ 3*num_tris ];
@@ -1287,6 +1670,15 @@ void TMRMesh::getHexConnectivity( int *_nhex, const int **_hex ){
   if (_hex){ *_hex = hex; }
 }
 
+/*
+  Get the tetrahedral connectivity
+*/
+void TMRMesh::getTetConnectivity( int *_ntet, const int **_tet ){
+  if (!X){ initMesh(); }
+  if (_ntet){ *_ntet = num_tet; }
+  if (_tet){ *_tet = tet; }
+}
+
 /*
   Print out the mesh to a VTK file
 */
@@ -1298,11 +1690,13 @@ void TMRMesh::writeToVTK( const char *filename, int flag ){
     int nquad = num_quads;
     int nhex = num_hex;
     int ntris = num_tris;
+    int ntet = num_tet;
     if (!(flag & TMR_QUAD)){
       nquad = 0;
     }
     if (!(flag & TMR_HEX)){
       nhex = 0;
+      ntet = 0;
     }
 
     if (!X){ initMesh(); }
@@ -1318,8 +1712,8 @@ void TMRMesh::writeToVTK( const char *filename, int flag ){
         fprintf(fp, "%e %e %e\n", X[k].x, X[k].y, X[k].z);
       }
 
-      fprintf(fp, "\nCELLS %d %d\n", nquad + ntris + nhex,
-              5*nquad + 4*ntris + 9*nhex);
+      fprintf(fp, "\nCELLS %d %d\n", nquad + ntris + nhex + ntet,
+              5*nquad + 4*ntris + 9*nhex + 5*ntet);
 
       // Write out the cell connectivities
       for ( int k = 0; k < nquad; k++ ){
@@ -1336,9 +1730,13 @@ void TMRMesh::writeToVTK( const char *filename, int flag ){
                 hex[8*k], hex[8*k+1], hex[8*k+2], hex[8*k+3],
                 hex[8*k+4], hex[8*k+5], hex[8*k+6], hex[8*k+7]);
       }
+      for ( int k = 0; k < ntet; k++ ){
+        fprintf(fp, "4 %d %d %d %d\n",
+                tet[4*k], tet[4*k+1], tet[4*k+2], tet[4*k+3]);
+      }
 
       // All quadrilaterals
-      fprintf(fp, "\nCELL_TYPES %d\n", nquad + ntris + nhex);
+      fprintf(fp, "\nCELL_TYPES %d\n", nquad + ntris + nhex + ntet);
       for ( int k = 0; k < nquad; k++ ){
         fprintf(fp, "%d\n", 9);
       }
@@ -1348,6 +1746,9 @@ void TMRMesh::writeToVTK( const char *filename, int flag ){
       for ( int k = 0; k < nhex; k++ ){
         fprintf(fp, "%d\n", 12);
       }
+      for ( int k = 0; k < ntet; k++ ){
+        fprintf(fp, "%d\n", 10);
+      }
 
       fclose(fp);
     }
@@ -1445,6 +1846,9 @@ void TMRMesh::writeToBDF( const char *filename, int flag ){
         for ( int i = 0, j = 0; i < num_volumes; i++ ){
           TMRVolumeMesh *mesh = NULL;
           volumes[i]->getMesh(&mesh);
+          if (!mesh){
+            continue;
+          }
 
           // Loop over all possible edges in the surface mesh
           const int *hex_local;
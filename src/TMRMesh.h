@@ -165,6 +165,7 @@ class TMRMesh : public TMREntity {
   void getQuadConnectivity( int *_nquads, const int **_quads );
   void getTriConnectivity( int *_ntris, const int **_tris );
   void getHexConnectivity( int *_nhex, const int **_hex );
+  void getTetConnectivity( int *_ntet, const int **_tet );
 
   // Create a topology object (with underlying mesh geometry)
   TMRModel* createModelFromMesh();
@@ -176,6 +177,10 @@ class TMRMesh : public TMREntity {
   // Reset the mesh
   void resetMesh();
 
+  // Distribute the edge and face meshing across the processors
+  void meshEdges( TMRMeshOptions options, TMRElementFeatureSize *fs );
+  void meshFaces( TMRMeshOptions options, TMRElementFeatureSize *fs );
+
   // The underlying geometry object
   MPI_Comm comm;
   TMRModel *geo;
@@ -21,6 +21,7 @@
 #include "TMRNativeTopology.h"
 #include <stdio.h>
 #include <math.h>
+#include <algorithm>
 
 /*
   Create a vertex from a point
@@ -929,6 +930,95 @@ int TMRTFIVolume::evalPoint( double u, double v, double w,
     }
   }
 
+  evalTFI(u, v, w, e, X);
+
+  return 1;
+}
+
+/*
+  Evaluate an array of points within the volume
+
+  Each edge of the volume depends on only one of the parametric
+  coordinates. The edges are evaluated once for each unique value of
+  that coordinate, and the results are shared by all the points. This
+  saves most of the edge evaluations when the points are the nodes of
+  a mesh, since many nodes lie on the same octant faces.
+*/
+int TMRTFIVolume::evalPoints( int n, const double *uvw, TMRPoint *X ){
+  if (n <= 0){
+    return 0;
+  }
+
+  int fail = 0;
+
+  // The unique parameter values along each coordinate direction and
+  // the index of each point into the unique values
+  int num_vals[3];
+  double *vals[3];
+  TMRPoint *e[3];
+  int *index = new int[ 3*n ];
+  double *t = new double[ n ];
+
+  for ( int d = 0; d < 3; d++ ){
+    // Find the unique parameter values
+    for ( int i = 0; i < n; i++ ){
+      t[i] = uvw[3*i+d];
+    }
+    std::sort(t, t + n);
+    int m = std::unique(t, t + n) - t;
+    num_vals[d] = m;
+    vals[d] = new double[ m ];
+    memcpy(vals[d], t, m*sizeof(double));
+
+    for ( int i = 0; i < n; i++ ){
+      index[3*i+d] =
+        std::lower_bound(vals[d], vals[d] + m, uvw[3*i+d]) - vals[d];
+    }
+
+    // Evaluate the four edges along this direction
+    e[d] = new TMRPoint[ 4*m ];
+    for ( int k = 0; k < 4; k++ ){
+      int edge = 4*d + k;
+      if (edge_dir[edge] > 0){
+        fail = edges[edge]->evalPoints(m, vals[d], &e[d][k*m]) || fail;
+      }
+      else {
+        for ( int j = 0; j < m; j++ ){
+          t[j] = 1.0 - vals[d][j];
+        }
+        fail = edges[edge]->evalPoints(m, t, &e[d][k*m]) || fail;
+      }
+    }
+  }
+
+  for ( int i = 0; i < n; i++ ){
+    TMRPoint ep[12];
+    for ( int d = 0; d < 3; d++ ){
+      const int m = num_vals[d];
+      const int j = index[3*i+d];
+      for ( int k = 0; k < 4; k++ ){
+        ep[4*d + k] = e[d][k*m + j];
+      }
+    }
+    evalTFI(uvw[3*i], uvw[3*i+1], uvw[3*i+2], ep, &X[i]);
+  }
+
+  for ( int d = 0; d < 3; d++ ){
+    delete [] vals[d];
+    delete [] e[d];
+  }
+  delete [] index;
+  delete [] t;
+
+  return fail;
+}
+
+/*
+  Compute the transfinite interpolation from the points on the 12
+  edges of the volume and the corners
+*/
+void TMRTFIVolume::evalTFI( double u, double v, double w,
+                            const TMRPoint e[], TMRPoint *X ){
   X->x = ((1.0-v)*(1.0-w)*e[0].x + v*(1.0-w)*e[1].x +
        (1.0-v)*w*e[2].x + v*w*e[3].x +
        (1.0-u)*(1.0-w)*e[4].x + u*(1.0-w)*e[5].x +
@@ -961,8 +1051,6 @@ int TMRTFIVolume::evalPoint( double u, double v, double w,
            (1.0-u)*v*(1.0-w)*c[2].z + u*v*(1.0-w)*c[3].z +
            (1.0-u)*(1.0-v)*w*c[4].z + u*(1.0-v)*w*c[5].z +
            (1.0-u)*v*w*c[6].z + u*v*w*c[7].z);
-
-  return 1;
 }
 
 /*
@@ -44,6 +44,9 @@ class TMREdgeFromCurve : public TMREdge {
   int invEvalPoint( TMRPoint p, double *t ){
     return curve->invEvalPoint(p, t);
   }
+  int invEvalPoints( int n, const TMRPoint *p, double *t ){
+    return curve->invEvalPoints(n, p, t);
+  }
   int evalDeriv( double t, TMRPoint *X, TMRPoint *Xt ){
     return curve->evalDeriv(t, X, Xt);
   }
@@ -73,6 +76,9 @@ class TMRFaceFromSurface : public TMRFace {
   int invEvalPoint( TMRPoint p, double *u, double *v ){
     return surf->invEvalPoint(p, u, v);
   }
+  int invEvalPoints( int n, const TMRPoint *p, double *uv ){
+    return surf->invEvalPoints(n, p, uv);
+  }
   int evalDeriv( double u, double v,
                  TMRPoint *X,
                  TMRPoint *Xu, TMRPoint *Xv ){
@@ -321,10 +327,15 @@ class TMRTFIVolume : public TMRVolume {
   void getRange( double *umin, double *vmin, double *wmin,
                  double *umax, double *vmax, double *wmax );
   int evalPoint( double u, double v, double w, TMRPoint *X );
+  int evalPoints( int n, const double *uvw, TMRPoint *X );
   void getEntities( TMRFace ***_faces, TMREdge ***_edges,
                     TMRVertex ***_verts );
 
  private:
+  // Evaluate the interpolation from the edge points
+  void evalTFI( double u, double v, double w,
+                const TMRPoint e[], TMRPoint *X );
+
   // Faces surrounding the volume: coordinate ordered
   TMRFace *faces[6];
 
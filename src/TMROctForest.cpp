@@ -20,6 +20,10 @@
 
 #include "TMROctForest.h"
 #include "TMRInterpolation.h"
+#include "TMR_VTKTools.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 /*
   Map from a block edge number to the local node numbers
@@ -349,6 +353,34 @@ static int compare_octant_tags( const void *a, const void *b ){
   return A->tag - B->tag;
 }
 
+/*
+  Compare the Morton positions of octants for sorting
+*/
+static int compare_octant_position( const void *a, const void *b ){
+  const TMROctant *A = static_cast<const TMROctant*>(a);
+  const TMROctant *B = static_cast<const TMROctant*>(b);
+  return A->comparePosition(B);
+}
+
+/*
+  Match two sorted arrays of octants. For each octant in the first
+  array, find the index of the identical octant in the second array,
+  or -1 if it does not exist.
+*/
+static void match_octants( int na, const TMROctant *a,
+                           int nb, const TMROctant *b, int *index ){
+  int j = 0;
+  for ( int i = 0; i < na; i++ ){
+    index[i] = -1;
+    while (j < nb && b[j].compare(&a[i]) < 0){
+      j++;
+    }
+    if (j < nb && b[j].compare(&a[i]) == 0){
+      index[i] = j;
+    }
+  }
+}
+
 /*
   Convert from the integer coordinate system to a physical coordinate
   with the off-by-one check.
@@ -396,6 +428,11 @@ TMROctForest::TMROctForest( MPI_Comm _comm, int _mesh_order,
   adjacent = NULL;
   X = NULL;
 
+  // The octants are not balanced yet
+  balance_state = -1;
+  refine_balance_state = -1;
+  refine_octants = NULL;
+
   // Set data for the number of elements/nodes/dependents
   conn = NULL;
   node_numbers = NULL;
@@ -404,6 +441,8 @@ TMROctForest::TMROctForest( MPI_Comm _comm, int _mesh_order,
   num_owned_nodes = 0;
   num_dep_nodes = 0;
   ext_pre_offset = 0;
+  node_hash_size = 0;
+  node_hash = NULL;
 
   dep_ptr = NULL;
   dep_conn = NULL;
@@ -434,10 +473,12 @@ void TMROctForest::freeData(){
   // Free the octants/adjacency/dependency data
   if (owners){ delete [] owners; }
   if (octants){ delete octants; }
+  if (refine_octants){ delete refine_octants; }
   if (adjacent){ delete adjacent; }
   if (X){ delete [] X; }
 
   if (node_range){ delete [] node_range; }
+  if (node_hash){ delete [] node_hash; }
   if (dep_ptr){ delete [] dep_ptr; }
   if (dep_conn){ delete [] dep_conn; }
   if (dep_weights){ delete [] dep_weights; }
@@ -447,6 +488,9 @@ void TMROctForest::freeData(){
   octants = NULL;
   adjacent = NULL;
   X = NULL;
+  balance_state = -1;
+  refine_balance_state = -1;
+  refine_octants = NULL;
 
   // Set data for the number of elements/nodes/dependents
   conn = NULL;
@@ -456,6 +500,8 @@ void TMROctForest::freeData(){
   num_owned_nodes = 0;
   num_dep_nodes = 0;
   ext_pre_offset = 0;
+  node_hash_size = 0;
+  node_hash = NULL;
 
   dep_ptr = NULL;
   dep_conn = NULL;
@@ -473,7 +519,11 @@ void TMROctForest::freeMeshData( int free_octs,
   }
   if (free_octs){
     if (octants){ delete octants; }
+    if (refine_octants){ delete refine_octants; }
     octants = NULL;
+    refine_octants = NULL;
+    balance_state = -1;
+    refine_balance_state = -1;
   }
 
   // Free the octants/adjacency/dependency data
@@ -483,6 +533,7 @@ void TMROctForest::freeMeshData( int free_octs,
   if (conn){ delete [] conn; }
   if (node_numbers){ delete [] node_numbers; }
   if (node_range){ delete [] node_range; }
+  if (node_hash){ delete [] node_hash; }
   if (dep_ptr){ delete [] dep_ptr; }
   if (dep_conn){ delete [] dep_conn; }
   if (dep_weights){ delete [] dep_weights; }
@@ -499,6 +550,8 @@ void TMROctForest::freeMeshData( int free_octs,
   num_owned_nodes = 0;
   num_dep_nodes = 0;
   ext_pre_offset = 0;
+  node_hash_size = 0;
+  node_hash = NULL;
 
   dep_ptr = NULL;
   dep_conn = NULL;
@@ -1396,6 +1449,107 @@ void TMROctForest::writeForestToVTK( const char *filename ){
   }
 }
 
+/*
+  Write the refined forest to a binary VTK XML (.vtu) file in parallel
+
+  Each processor writes the points for its owned and dependent nodes,
+  and the corner connectivity, level, block and MPI rank of its local
+  elements. All the data is written directly to the file using MPI/IO
+  through TMR_WriteVTUFile(). This is a collective call and requires
+  that the nodes have been created.
+*/
+int TMROctForest::writeForestToVTU( const char *filename ){
+  if (!conn || !X){
+    fprintf(stderr, "TMROctForest Error: Cannot call writeForestToVTU(), "
+            "the nodes have not been created\n");
+    return 1;
+  }
+
+  // Compute the offset to the points on each processor. The owned
+  // nodes are followed by the dependent nodes.
+  int npts = num_owned_nodes + num_dep_nodes;
+  int *pt_range = new int[ mpi_size+1 ];
+  pt_range[0] = 0;
+  MPI_Allgather(&npts, 1, MPI_INT, &pt_range[1], 1, MPI_INT, comm);
+  for ( int i = 0; i < mpi_size; i++ ){
+    pt_range[i+1] += pt_range[i];
+  }
+
+  // Copy the owned and dependent node locations. The dependent nodes
+  // are stored first in the local ordering.
+  TMRPoint *Xpts = new TMRPoint[ npts ];
+  for ( int i = 0; i < num_owned_nodes; i++ ){
+    Xpts[i] = X[ext_pre_offset + i];
+  }
+  for ( int i = 0; i < num_dep_nodes; i++ ){
+    Xpts[num_owned_nodes + i] = X[i];
+  }
+
+  // Get the octants
+  int num_elements;
+  TMROctant *octs;
+  octants->getArray(&octs, &num_elements);
+
+  // Set the connectivity from the corner nodes of each element
+  const int m = mesh_order-1;
+  const int corner[8] = {
+    0, m, m + m*mesh_order, m*mesh_order,
+    m*mesh_order*mesh_order, m + m*mesh_order*mesh_order,
+    m + m*mesh_order + m*mesh_order*mesh_order,
+    m*mesh_order + m*mesh_order*mesh_order};
+  int64_t *cell_conn = new int64_t[ 8*num_elements ];
+  for ( int i = 0; i < num_elements; i++ ){
+    const int *c = &conn[mesh_order*mesh_order*mesh_order*i];
+    for ( int j = 0; j < 8; j++ ){
+      int node = c[corner[j]];
+      int64_t index = 0;
+      if (node < 0){
+        index = pt_range[mpi_rank] + num_owned_nodes + num_dep_nodes + node;
+      }
+      else {
+        // Find the owner of the node
+        int owner = 0, high = mpi_size;
+        while (high - owner > 1){
+          int mid = owner + (high - owner)/2;
+          if (node_range[mid] <= node){
+            owner = mid;
+          }
+          else {
+            high = mid;
+          }
+        }
+        index = pt_range[owner] + (node - node_range[owner]);
+      }
+      cell_conn[8*i + j] = index;
+    }
+  }
+
+  // Set the cell data
+  int *level = new int[ num_elements ];
+  int *block = new int[ num_elements ];
+  int *partition = new int[ num_elements ];
+  for ( int i = 0; i < num_elements; i++ ){
+    level[i] = octs[i].level;
+    block[i] = octs[i].block;
+    partition[i] = mpi_rank;
+  }
+
+  const char *names[] = {"level", "block", "partition"};
+  const int *data[] = {level, block, partition};
+  int fail = TMR_WriteVTUFile(comm, filename, npts, Xpts,
+                              num_elements, 8, 12, cell_conn,
+                              3, names, data);
+
+  delete [] pt_range;
+  delete [] Xpts;
+  delete [] cell_conn;
+  delete [] level;
+  delete [] block;
+  delete [] partition;
+
+  return fail;
+}
+
 /*
   Free the mesh element data if it exists
 */
@@ -1493,20 +1647,102 @@ int TMROctForest::getPoints( TMRPoint **_X ){
   return num_local_nodes;
 }
 
+/*
+  Hash a global node number. The multiplier is odd, so consecutive
+  node numbers map to distinct slots in a power-of-two table.
+*/
+static inline uint32_t node_number_hash( int node ){
+  return (uint32_t)node*2654435761u;
+}
+
 /*
   Retrieve the local node number
+
+  The owned nodes are numbered contiguously so their local numbers
+  are computed directly. The dependent and external nodes are found
+  in the hash table created by createNodes().
 */
 int TMROctForest::getLocalNodeNumber( int node ){
   if (node_numbers){
-    int *item = (int*)bsearch(&node, node_numbers, num_local_nodes,
-                              sizeof(int), compare_integers);
-    if (item){
-      return item - node_numbers;
+    if (node >= node_range[mpi_rank] && node < node_range[mpi_rank+1]){
+      return ext_pre_offset + (node - node_range[mpi_rank]);
+    }
+
+    if (node_hash){
+      const uint32_t mask = node_hash_size-1;
+      uint32_t slot = node_number_hash(node) & mask;
+      while (node_hash[slot] >= 0){
+        if (node_numbers[node_hash[slot]] == node){
+          return node_hash[slot];
+        }
+        slot = (slot + 1) & mask;
+      }
     }
   }
   return -1;
 }
 
+/*
+  Retrieve the local node numbers for an array of global node numbers
+
+  input:
+  size:         the number of nodes
+  nodes:        the global node numbers
+
+  output:
+  local_nodes:  the local node numbers (-1 when not on this proc)
+*/
+void TMROctForest::getLocalNodeNumbers( int size, const int *nodes,
+                                       int *local_nodes ){
+  for ( int i = 0; i < size; i++ ){
+    local_nodes[i] = getLocalNodeNumber(nodes[i]);
+  }
+}
+
+/*
+  Create the hash table for the dependent and external nodes
+
+  The table stores the local index of each node that is not owned by
+  this processor. It uses linear probing and is kept at most half
+  full, with empty slots set to -1.
+*/
+void TMROctForest::createNodeHash(){
+  if (node_hash){ delete [] node_hash; }
+  node_hash = NULL;
+  node_hash_size = 0;
+
+  int num_ext_nodes = num_local_nodes - num_owned_nodes;
+  if (num_ext_nodes <= 0){
+    return;
+  }
+
+  node_hash_size = 1 << 4;
+  while (node_hash_size < 2*num_ext_nodes){
+    node_hash_size *= 2;
+  }
+  node_hash = new int[ node_hash_size ];
+  for ( int i = 0; i < node_hash_size; i++ ){
+    node_hash[i] = -1;
+  }
+
+  // The owned nodes occupy the local indices [ext_pre_offset,
+  // owned_end). This range is empty when no nodes are owned.
+  const uint32_t mask = node_hash_size-1;
+  const int owned_end = ext_pre_offset + num_owned_nodes;
+  for ( int i = 0; i < num_local_nodes; i++ ){
+    if (i >= ext_pre_offset && i < owned_end){
+      // Skip over the owned nodes
+      i = owned_end-1;
+      continue;
+    }
+    uint32_t slot = node_number_hash(node_numbers[i]) & mask;
+    while (node_hash[slot] >= 0){
+      slot = (slot + 1) & mask;
+    }
+    node_hash[slot] = i;
+  }
+}
+
 /*
   Get the knot points for the interpolation
 */
@@ -1517,6 +1753,23 @@ int TMROctForest::getInterpKnots( const double **_knots ){
   return mesh_order;
 }
 
+/*
+  Evaluate the 1-D interpolant (and optionally its derivative) at a
+  batch of parametric points. The shape functions for point n are
+  stored in N[mesh_order*n + i]. These can be combined with the
+  sum-factorized tensor_interp functions in TMRInterpolation.h.
+*/
+void TMROctForest::evalInterp1D( int npts, const double u[], double N[],
+                                  double Nd[] ){
+  if (interp_type == TMR_BERNSTEIN_POINTS){
+    bernstein_shape_functions_batch(mesh_order, npts, u, N, Nd);
+  }
+  else {
+    lagrange_shape_functions_batch(mesh_order, npts, u, interp_knots,
+                                   N, Nd);
+  }
+}
+
 /*
   Evaluate the interpolant at the given parametric point
 */
@@ -1882,11 +2135,267 @@ void TMROctForest::createRandomTrees( int nrand,
 }
 
 /*
-  Repartition the octants across all processors
+  Write the forest to a checkpoint file
+
+  The checkpoint stores the block connectivity, the mesh order and
+  interpolation type, the ownership ranges and the octants themselves
+  in the global Morton ordering. The file layout is:
+
+  char[8]:           "TMROCTF"
+  int32[6]:          version, mesh_order, interp_type, num_nodes,
+                     num_blocks and the number of processors
+  int32[8*nblocks]:  the block to node connectivity
+  int64[nprocs+1]:   the octant ranges on each processor
+  TMROctant[]:       the octants (block, x, y, z, tag, level, info)
+
+  All data is written in the native byte order using MPI/IO. The
+  mesh data (nodes, dependent nodes etc.) is not stored and must be
+  re-created after the forest is read. This is a collective call.
 */
-void TMROctForest::repartition( int max_rank ){
+int TMROctForest::writeCheckpoint( const char *filename ){
+  if (!bdata || !octants){
+    fprintf(stderr, "TMROctForest Error: Cannot call writeCheckpoint(), "
+            "the octants have not been created\n");
+    return 1;
+  }
   const int num_blocks = bdata->num_blocks;
 
+  // Get the octants
+  int size;
+  TMROctant *array;
+  octants->getArray(&array, &size);
+
+  // Compute the octant ranges on each processor
+  int64_t local_size = size;
+  int64_t *range = new int64_t[ mpi_size+1 ];
+  range[0] = 0;
+  MPI_Allgather(&local_size, 1, MPI_INT64_T,
+                &range[1], 1, MPI_INT64_T, comm);
+  for ( int i = 0; i < mpi_size; i++ ){
+    range[i+1] += range[i];
+  }
+
+  // Copy the filename to a non-const array
+  char *fname = new char[ strlen(filename)+1 ];
+  strcpy(fname, filename);
+
+  // Create the file, removing any existing contents
+  MPI_File fp = NULL;
+  int fail = 0;
+  if (MPI_File_open(comm, fname, MPI_MODE_WRONLY | MPI_MODE_CREATE,
+                    MPI_INFO_NULL, &fp) != MPI_SUCCESS){
+    fail = 1;
+  }
+  delete [] fname;
+  if (fail){
+    fprintf(stderr, "TMROctForest Error: Could not open file %s\n",
+            filename);
+    delete [] range;
+    return fail;
+  }
+  MPI_File_set_size(fp, 0);
+
+  // The offsets to the ranges and the octants within the file
+  MPI_Offset range_offset =
+    8 + (6 + 8*num_blocks)*sizeof(int32_t);
+  MPI_Offset oct_offset =
+    range_offset + (mpi_size+1)*sizeof(int64_t);
+
+  // Write the header, connectivity and ranges from the root
+  if (mpi_rank == 0){
+    char magic[8] = "TMROCTF";
+    int header[6];
+    header[0] = TMR_CHECKPOINT_VERSION;
+    header[1] = mesh_order;
+    header[2] = interp_type;
+    header[3] = bdata->num_nodes;
+    header[4] = num_blocks;
+    header[5] = mpi_size;
+    MPI_File_write_at(fp, 0, magic, 8, MPI_CHAR, MPI_STATUS_IGNORE);
+    MPI_File_write_at(fp, 8, header, 6, MPI_INT, MPI_STATUS_IGNORE);
+    MPI_File_write_at(fp, 8 + 6*sizeof(int32_t), bdata->block_conn,
+                      8*num_blocks, MPI_INT, MPI_STATUS_IGNORE);
+    MPI_File_write_at(fp, range_offset, range, mpi_size+1,
+                      MPI_INT64_T, MPI_STATUS_IGNORE);
+  }
+
+  // Write the octants in the global order
+  MPI_Offset offset = oct_offset + range[mpi_rank]*sizeof(TMROctant);
+  MPI_File_write_at_all(fp, offset, array, size, TMROctant_MPI_type,
+                        MPI_STATUS_IGNORE);
+  MPI_File_close(&fp);
+
+  delete [] range;
+
+  return fail;
+}
+
+/*
+  Read the forest from a checkpoint file written by writeCheckpoint()
+
+  If no connectivity has been set, the block connectivity is set from
+  the file. Otherwise the connectivity stored in the file must match
+  the existing connectivity. This allows the topology to be set before
+  the forest is restored so that the geometry is available.
+
+  When the file was written on the same number of processors, each
+  processor reads back its original octants. Otherwise the octants are
+  evenly repartitioned across the processors as they are read. Any
+  existing octants and mesh data are destroyed. This is a collective
+  call.
+*/
+int TMROctForest::readCheckpoint( const char *filename ){
+  // Copy the filename to a non-const array
+  char *fname = new char[ strlen(filename)+1 ];
+  strcpy(fname, filename);
+
+  // Open the file for reading
+  MPI_File fp = NULL;
+  int fail = 0;
+  if (MPI_File_open(comm, fname, MPI_MODE_RDONLY,
+                    MPI_INFO_NULL, &fp) != MPI_SUCCESS){
+    fail = 1;
+  }
+  delete [] fname;
+  if (fail){
+    fprintf(stderr, "TMROctForest Error: Could not open file %s\n",
+            filename);
+    return fail;
+  }
+
+  // Read and check the header
+  char magic[8];
+  int header[6];
+  memset(magic, 0, sizeof(magic));
+  memset(header, 0, sizeof(header));
+  MPI_File_read_at_all(fp, 0, magic, 8, MPI_CHAR, MPI_STATUS_IGNORE);
+  MPI_File_read_at_all(fp, 8, header, 6, MPI_INT, MPI_STATUS_IGNORE);
+  if (strncmp(magic, "TMROCTF", 8) != 0 ||
+      header[0] != TMR_CHECKPOINT_VERSION ||
+      header[4] < 0 || header[5] <= 0){
+    fprintf(stderr, "TMROctForest Error: %s is not a valid "
+            "checkpoint file\n", filename);
+    MPI_File_close(&fp);
+    return 1;
+  }
+
+  int _mesh_order = header[1];
+  TMRInterpolationType _interp_type = (TMRInterpolationType)header[2];
+  int _num_nodes = header[3];
+  int num_blocks = header[4];
+  int write_size = header[5];
+
+  // Read the block connectivity and set or check it
+  int *_block_conn = new int[ 8*num_blocks ];
+  MPI_File_read_at_all(fp, 8 + 6*sizeof(int32_t), _block_conn,
+                       8*num_blocks, MPI_INT, MPI_STATUS_IGNORE);
+  if (!bdata){
+    setConnectivity(_num_nodes, _block_conn, num_blocks);
+  }
+  else if (bdata->num_blocks != num_blocks ||
+           memcmp(bdata->block_conn, _block_conn,
+                  8*num_blocks*sizeof(int)) != 0){
+    fprintf(stderr, "TMROctForest Error: Block connectivity in %s "
+            "does not match the forest\n", filename);
+    fail = 1;
+  }
+  delete [] _block_conn;
+  if (fail){
+    MPI_File_close(&fp);
+    return fail;
+  }
+
+  // Read the ranges of the octants on the writing processors
+  int64_t *range = new int64_t[ write_size+1 ];
+  MPI_Offset range_offset =
+    8 + (6 + 8*num_blocks)*sizeof(int32_t);
+  MPI_Offset oct_offset =
+    range_offset + (write_size+1)*sizeof(int64_t);
+  MPI_File_read_at_all(fp, range_offset, range, write_size+1,
+                       MPI_INT64_T, MPI_STATUS_IGNORE);
+
+  // Determine the range of octants to read on this processor. If the
+  // number of processors has changed, repartition the octants evenly.
+  int64_t start = 0, end = 0;
+  int reset_tags = 0;
+  if (write_size == mpi_size){
+    start = range[mpi_rank];
+    end = range[mpi_rank+1];
+  }
+  else {
+    int64_t total = range[write_size];
+    int64_t average_count = total/mpi_size;
+    int64_t remain = total - average_count*mpi_size;
+    start = mpi_rank*average_count;
+    end = (mpi_rank+1)*average_count;
+    if (mpi_rank < remain){
+      start += mpi_rank;
+      end += mpi_rank+1;
+    }
+    else {
+      start += remain;
+      end += remain;
+    }
+    reset_tags = 1;
+  }
+  delete [] range;
+
+  // Free all of the mesh data and set the mesh order
+  freeMeshData();
+  if (_mesh_order != mesh_order || _interp_type != interp_type){
+    setMeshOrder(_mesh_order, _interp_type);
+  }
+
+  // Read in the octants
+  int size = end - start;
+  TMROctant *array = NULL;
+  if (size > 0){
+    array = new TMROctant[ size ];
+  }
+  MPI_Offset offset = oct_offset + start*sizeof(TMROctant);
+  MPI_File_read_at_all(fp, offset, array, size, TMROctant_MPI_type,
+                       MPI_STATUS_IGNORE);
+  MPI_File_close(&fp);
+
+  // Set the local reordering for the elements
+  if (reset_tags){
+    for ( int i = 0; i < size; i++ ){
+      array[i].tag = i;
+    }
+  }
+
+  // Set the last octant
+  TMROctant p;
+  p.block = num_blocks-1;
+  p.tag = -1;
+  p.level = 0;
+  p.info = 0;
+  p.x = p.y = p.z = 1 << TMR_MAX_LEVEL;
+  if (size > 0){
+    p = array[0];
+  }
+
+  octants = new TMROctantArray(array, size);
+
+  owners = new TMROctant[ mpi_size ];
+  MPI_Allgather(&p, 1, TMROctant_MPI_type,
+                owners, 1, TMROctant_MPI_type, comm);
+
+  // Set the offsets if some of the processors have zero
+  // octants
+  for ( int k = 1; k < mpi_size; k++ ){
+    if (owners[k].tag == -1){
+      owners[k] = owners[k-1];
+    }
+  }
+
+  return fail;
+}
+
+/*
+  Repartition the octants across all processors
+*/
+void TMROctForest::repartition( int max_rank ){
   // Free everything but the octants
   freeMeshData(0);
 
@@ -1899,8 +2408,7 @@ void TMROctForest::repartition( int max_rank ){
   // each processor
   int *ptr = new int[ mpi_size+1 ];
   int size;
-  TMROctant *array;
-  octants->getArray(&array, &size);
+  octants->getArray(NULL, &size);
 
   // Gather the sizes from all the arrays
   MPI_Allgather(&size, 1, MPI_INT, &ptr[1], 1, MPI_INT, comm);
@@ -1928,6 +2436,183 @@ void TMROctForest::repartition( int max_rank ){
     new_ptr[k+1] = new_ptr[k];
   }
 
+  // Move the octants to their new owners
+  repartitionOctants(ptr, new_ptr);
+
+  // Free the memory
+  delete [] ptr;
+  delete [] new_ptr;
+}
+
+/*
+  Repartition the octants across all processors based on a cost
+  associated with each element
+
+  The octants are split so that each of the first max_rank processors
+  owns a contiguous range of the Morton-ordered octants with nearly
+  equal total weight. The global weight offset of the local octants
+  is computed with a parallel prefix sum and each octant is assigned
+  to the processor whose weight interval contains its mid-point. This
+  preserves the ordering of the octants across processors.
+
+  The imbalance is the ratio of the maximum processor weight to the
+  average weight over all processors in the communicator. It is
+  computed for both the original and the new distribution of the
+  octants using the same processor count so that the two values can
+  be compared directly. A value of 1.0 indicates a perfectly balanced
+  partition. When max_rank < mpi_size, the best achievable value after
+  repartitioning is mpi_size/max_rank.
+
+  input:
+  weights:        the non-negative weight for each local octant
+  max_rank:       the number of processors to use
+
+  output:
+  imbalance:      the imbalance ratio before repartitioning
+  new_imbalance:  the imbalance ratio after repartitioning
+*/
+void TMROctForest::repartition( const double *weights, int max_rank,
+                                double *imbalance, double *new_imbalance ){
+  // Adjust the rank of the maximum rank
+  if (max_rank <= 0 || max_rank > mpi_size){
+    max_rank = mpi_size;
+  }
+
+  int size;
+  octants->getArray(NULL, &size);
+
+  // Compute the local weight of all the octants
+  double local_weight = 0.0;
+  if (weights){
+    for ( int i = 0; i < size; i++ ){
+      if (weights[i] > 0.0){
+        local_weight += weights[i];
+      }
+    }
+  }
+  else {
+    local_weight = size;
+  }
+
+  // Find the total weight and the maximum weight on any processor
+  double total_weight = 0.0, max_weight = 0.0;
+  MPI_Allreduce(&local_weight, &total_weight, 1, MPI_DOUBLE,
+                MPI_SUM, comm);
+  MPI_Allreduce(&local_weight, &max_weight, 1, MPI_DOUBLE,
+                MPI_MAX, comm);
+
+  if (imbalance){
+    *imbalance = 1.0;
+    if (total_weight > 0.0){
+      *imbalance = mpi_size*max_weight/total_weight;
+    }
+  }
+
+  // If there is no weight information, partition by the element count
+  if (!weights || total_weight <= 0.0){
+    repartition(max_rank);
+    if (new_imbalance){
+      *new_imbalance = 1.0;
+      if (!weights && total_weight > 0.0){
+        // Compute the new imbalance based on the element count
+        octants->getArray(NULL, &size);
+        local_weight = size;
+        MPI_Allreduce(&local_weight, &max_weight, 1, MPI_DOUBLE,
+                      MPI_MAX, comm);
+        *new_imbalance = mpi_size*max_weight/total_weight;
+      }
+    }
+    return;
+  }
+
+  // Free everything but the octants
+  freeMeshData(0);
+
+  // Compute the weight of the octants on the lower ranks
+  double offset = 0.0;
+  MPI_Exscan(&local_weight, &offset, 1, MPI_DOUBLE, MPI_SUM, comm);
+  if (mpi_rank == 0){
+    offset = 0.0;
+  }
+
+  // Count up the number of octants and their weight destined for
+  // each processor
+  int *count = new int[ mpi_size ];
+  double *load = new double[ mpi_size ];
+  memset(count, 0, mpi_size*sizeof(int));
+  memset(load, 0, mpi_size*sizeof(double));
+
+  for ( int i = 0; i < size; i++ ){
+    double w = (weights[i] > 0.0 ? weights[i] : 0.0);
+
+    // Find the processor that contains the mid-point of this octant
+    double mid = offset + 0.5*w;
+    int rank = (int)(max_rank*(mid/total_weight));
+    if (rank < 0){ rank = 0; }
+    if (rank >= max_rank){ rank = max_rank-1; }
+
+    count[rank]++;
+    load[rank] += w;
+    offset += w;
+  }
+
+  // Sum the contributions across all processors
+  MPI_Allreduce(MPI_IN_PLACE, count, mpi_size, MPI_INT, MPI_SUM, comm);
+  MPI_Allreduce(MPI_IN_PLACE, load, mpi_size, MPI_DOUBLE, MPI_SUM, comm);
+
+  if (new_imbalance){
+    double max_load = 0.0;
+    for ( int k = 0; k < mpi_size; k++ ){
+      if (load[k] > max_load){
+        max_load = load[k];
+      }
+    }
+    *new_imbalance = mpi_size*max_load/total_weight;
+  }
+
+  // Gather the current sizes of all the arrays
+  int *ptr = new int[ mpi_size+1 ];
+  MPI_Allgather(&size, 1, MPI_INT, &ptr[1], 1, MPI_INT, comm);
+
+  // Set the current and new pointers into the global octant array
+  int *new_ptr = new int[ mpi_size+1 ];
+  ptr[0] = 0;
+  new_ptr[0] = 0;
+  for ( int k = 0; k < mpi_size; k++ ){
+    ptr[k+1] += ptr[k];
+    new_ptr[k+1] = new_ptr[k] + count[k];
+  }
+
+  // Move the octants to their new owners
+  repartitionOctants(ptr, new_ptr);
+
+  // Free the memory
+  delete [] count;
+  delete [] load;
+  delete [] ptr;
+  delete [] new_ptr;
+}
+
+/*
+  Move the octants from the current distribution to the new
+  distribution
+
+  Both distributions are described by pointers into the global
+  Morton-ordered array of octants such that processor k owns the
+  octants in the interval [ptr[k], ptr[k+1]).
+
+  input:
+  ptr:       the current distribution of octants
+  new_ptr:   the new distribution of octants
+*/
+void TMROctForest::repartitionOctants( const int *ptr,
+                                       const int *new_ptr ){
+  const int num_blocks = bdata->num_blocks;
+
+  int size;
+  TMROctant *array;
+  octants->getArray(&array, &size);
+
   // Allocate the new array of octants
   int new_size = new_ptr[mpi_rank+1] - new_ptr[mpi_rank];
   TMROctant *new_array = NULL;
@@ -2011,10 +2696,6 @@ void TMROctForest::repartition( int max_rank ){
     }
   }
 
-  // Free the memory
-  delete [] ptr;
-  delete [] new_ptr;
-
   // Wait for any remaining sends to complete
   MPI_Waitall(send_count, send_requests, MPI_STATUSES_IGNORE);
   delete [] send_requests;
@@ -2060,6 +2741,7 @@ TMROctForest *TMROctForest::duplicate(){
 
     // Copy the octants
     dup->octants = octants->duplicate();
+    dup->balance_state = balance_state;
     dup->owners = new TMROctant[ mpi_size ];
     memcpy(dup->owners, owners, sizeof(TMROctant)*mpi_size);
   }
@@ -2137,6 +2819,15 @@ void TMROctForest::refine( const int refinement[],
   TMROctantHash *hash = new TMROctantHash();
   TMROctantHash *ext_hash = new TMROctantHash();
 
+  // If the octants are balanced, keep track of the new locally owned
+  // octants so that the next balance can be performed incrementally.
+  // This is only possible when no octants are coarsened.
+  int coarsened = 0;
+  TMROctantQueue *created = NULL;
+  if (refinement && balance_state >= 0){
+    created = new TMROctantQueue();
+  }
+
   // Get the current array of octants
   int size;
   TMROctant *array;
@@ -2161,6 +2852,7 @@ void TMROctForest::refine( const int refinement[],
           TMROctant oct = array[i];
           oct.level = new_level;
           oct.info = 0;
+          coarsened = 1;
 
           // Compute the new side-length of the quadrant
           const int32_t h = 1 << (TMR_MAX_LEVEL - oct.level);
@@ -2214,7 +2906,9 @@ void TMROctForest::refine( const int refinement[],
                 oct.y = y + 2*jj*h;
                 oct.z = z + 2*kk*h;
                 if (mpi_rank == getOctantMPIOwner(&oct)){
-                  hash->addOctant(&oct);
+                  if (hash->addOctant(&oct) && created){
+                    created->push(&oct);
+                  }
                 }
                 else {
                   ext_hash->addOctant(&oct);
@@ -2269,10 +2963,27 @@ void TMROctForest::refine( const int refinement[],
   // Get the local octants and add them to the hash table
   local->getArray(&array, &size);
   for ( int i = 0; i < size; i++ ){
-    hash->addOctant(&array[i]);
+    if (hash->addOctant(&array[i]) && created){
+      created->push(&array[i]);
+    }
   }
   delete local;
 
+  // Record the new octants for the next balance
+  if (refine_octants){
+    delete refine_octants;
+    refine_octants = NULL;
+  }
+  refine_balance_state = balance_state;
+  balance_state = -1;
+  if (created){
+    if (!coarsened){
+      refine_octants = created->toArray();
+      refine_octants->sort();
+    }
+    delete created;
+  }
+
   // Cover the hash table to a list and uniquely sort it
   octants = hash->toArray();
   octants->sort();
@@ -2920,6 +3631,12 @@ void TMROctForest::balanceOctant( TMROctant *oct,
   of the elements and corner balances across corners. The code always
   balances faces and edges (so that there is at most one depdent node
   per edge) and balances across corners optionally.
+
+  If the forest was balanced before the last call to refine() and no
+  octants were coarsened on any processor, only the octants created by
+  refine() are used to seed the hash/queue. The result is identical
+  to a full balance. Note that modifications made directly to the
+  array returned by getOctants() are not tracked.
 */
 void TMROctForest::balance( int balance_corner ){
   if (!octants){
@@ -2928,15 +3645,33 @@ void TMROctForest::balance( int balance_corner ){
     return;
   }
 
+  // The balance can be performed incrementally if the octants were
+  // balanced before the last call to refine() and no octants were
+  // coarsened on any processor
+  int incremental = 0;
+  if (refine_octants && refine_balance_state >= balance_corner){
+    incremental = 1;
+  }
+  MPI_Allreduce(MPI_IN_PLACE, &incremental, 1, MPI_INT, MPI_MIN, comm);
+
   // Create a hash table for the balanced tree
   TMROctantHash *hash = new TMROctantHash();
   TMROctantHash *ext_hash = new TMROctantHash();
   TMROctantQueue *queue = new TMROctantQueue();
 
-  // Get the array of octants
+  // Get the array of octants. When balancing incrementally, only the
+  // octants created by refine() are used to seed the balance. The
+  // remaining octants are already balanced with respect to one
+  // another so the 2:1 constraint only propagates outward from the
+  // new octants.
   int oct_size;
   TMROctant *oct_array;
-  octants->getArray(&oct_array, &oct_size);
+  if (incremental){
+    refine_octants->getArray(&oct_array, &oct_size);
+  }
+  else {
+    octants->getArray(&oct_array, &oct_size);
+  }
 
   // Add all the elements
   for ( int i = 0; i < oct_size; i++ ){
@@ -2960,9 +3695,13 @@ void TMROctForest::balance( int balance_corner ){
                   balance_corner, balance_tree);
   }
 
-  // Free the original octant array and set it to NULL
-  delete octants;
-
+  // Free the original octant array. The octants are still needed
+  // when balancing incrementally.
+  if (!incremental){
+    delete octants;
+    octants = NULL;
+  }
+
   while (queue->length() > 0){
     // Now continue until the queue of added octants is
     // empty. At each iteration, pop an octant and add
@@ -3085,9 +3824,25 @@ void TMROctForest::balance( int balance_corner ){
   }
   delete local;
 
+  // Add the octants that existed before the balance. Any octant that
+  // was refined by the balance shares its position with a finer
+  // octant and is removed when the octants are sorted.
+  if (incremental){
+    octants->getArray(&array, &size);
+    for ( int i = 0; i < size; i++ ){
+      hash->addOctant(&array[i]);
+    }
+    delete octants;
+  }
+  if (refine_octants){
+    delete refine_octants;
+    refine_octants = NULL;
+  }
+
   // Set the elements into the octree
   octants = hash->toArray();
   octants->sort();
+  balance_state = balance_corner;
 
   // Get the octants and order their labels
   octants->getArray(&array, &size);
@@ -4312,6 +5067,7 @@ void TMROctForest::createNodes(){
   int num_elements;
   octants->getArray(NULL, &num_elements);
   int size = mesh_order*mesh_order*mesh_order*num_elements;
+  #pragma omp parallel for schedule(static)
   for ( int i = 0; i < size; i++ ){
     conn[i] = node_numbers[conn[i]];
   }
@@ -4332,6 +5088,9 @@ void TMROctForest::createNodes(){
                             num_local_nodes, sizeof(int), compare_integers);
   ext_pre_offset = item - node_numbers;
 
+  // Create the hash table for the non-owned nodes
+  createNodeHash();
+
   // Evaluate the node locations
   evaluateNodeLocations();
 }
@@ -4356,36 +5115,30 @@ void TMROctForest::createNodes(){
   2. info represents the label (node/edge/face)
   3. level represents the number of nodes represented by the quad
 */
-TMROctantArray *TMROctForest::createLocalNodes(){
-  // Allocate the array of elements
-  int num_elements;
-  TMROctant *octs;
-  octants->getArray(&octs, &num_elements);
+/*
+  Add the nodes of the local octants with indices start <= i < end
+  to the hash table
 
-  // Create all the nodes/edges/faces
-  const int use_node_index = 1;
-  TMROctantHash *local_nodes = new TMROctantHash(use_node_index);
+  The node tags are set to the rank of this processor since the
+  nodes are created from a local element.
+*/
+void TMROctForest::addElementNodes( TMROctantHash *hash,
+                                    const int label_type[],
+                                    int start, int end ){
+  // Retrieve the octants on this processor
+  TMROctant *octs;
+  octants->getArray(&octs, NULL);
 
   // Set the node, edge, face and block labels
-  int node_label, edge_label, face_label, block_label;
-  node_label = edge_label = face_label = block_label =
-    TMR_OCT_NODE_LABEL;
+  const int node_label = label_type[0];
+  const int edge_label = label_type[1];
+  const int face_label = label_type[2];
+  const int block_label = label_type[3];
 
-  int label_type[4];
-  // If the mesh order is high enough, we will have multiple nodes
-  // per edge/face
-  initLabel(mesh_order, interp_type, label_type);
-
-  node_label = label_type[0];
-  edge_label = label_type[1];
-  face_label = label_type[2];
-  block_label = label_type[3];
-
-  // Set the node locations
   if (mesh_order == 2){
     // First add all the nodes from the local elements on this
     // processor
-    for ( int i = 0; i < num_elements; i++ ){
+    for ( int i = start; i < end; i++ ){
       const int32_t h = 1 << (TMR_MAX_LEVEL - octs[i].level);
       for ( int kk = 0; kk < 2; kk++ ){
         for ( int jj = 0; jj < 2; jj++ ){
@@ -4399,14 +5152,14 @@ TMROctantArray *TMROctForest::createLocalNodes(){
             node.tag = mpi_rank;
             node.info = node_label;
             transformNode(&node);
-            local_nodes->addOctant(&node);
+            hash->addOctant(&node);
           }
         }
       }
     }
   }
   else {
-    for ( int i = 0; i < num_elements; i++ ){
+    for ( int i = start; i < end; i++ ){
       const int32_t h = 1 << (TMR_MAX_LEVEL - octs[i].level - 1);
       for ( int kk = 0; kk < 3; kk++ ){
         for ( int jj = 0; jj < 3; jj++ ){
@@ -4439,15 +5192,34 @@ TMROctantArray *TMROctForest::createLocalNodes(){
             }
             node.tag = mpi_rank;
             transformNode(&node);
-            local_nodes->addOctant(&node);
+            hash->addOctant(&node);
           }
         }
       }
     }
   }
+}
 
-  // Add the independent nodes that the dependent nodes rely on
-  for ( int i = 0; i < num_elements; i++ ){
+/*
+  Add the independent nodes that the dependent nodes rely on for the
+  local octants with indices start <= i < end to the hash table
+
+  These nodes are created from the parent of the octant and are
+  assigned a negative tag since they may be owned elsewhere.
+*/
+void TMROctForest::addDependentNodes( TMROctantHash *hash,
+                                      const int label_type[],
+                                      int start, int end ){
+  // Retrieve the octants on this processor
+  TMROctant *octs;
+  octants->getArray(&octs, NULL);
+
+  // Set the node, edge, face and block labels
+  const int node_label = label_type[0];
+  const int edge_label = label_type[1];
+  const int face_label = label_type[2];
+
+  for ( int i = start; i < end; i++ ){
     // Add the external nodes from dependent edges
     if (octs[i].info){
       // Decode the information about the dependent edge/faces for
@@ -4492,7 +5264,7 @@ TMROctantArray *TMROctForest::createLocalNodes(){
               node.info = node_label;
               node.level = 1;
               transformNode(&node);
-              local_nodes->addOctant(&node);
+              hash->addOctant(&node);
             }
           }
         }
@@ -4530,7 +5302,7 @@ TMROctantArray *TMROctForest::createLocalNodes(){
                 node.level = mesh_order-2;
               }
               transformNode(&node);
-              local_nodes->addOctant(&node);
+              hash->addOctant(&node);
             }
           }
         }
@@ -4565,7 +5337,7 @@ TMROctantArray *TMROctForest::createLocalNodes(){
                 node.info = node_label;
                 node.level = 1;
                 transformNode(&node);
-                local_nodes->addOctant(&node);
+                hash->addOctant(&node);
               }
             }
           }
@@ -4611,7 +5383,7 @@ TMROctantArray *TMROctForest::createLocalNodes(){
                   node.level = (mesh_order-2)*(mesh_order-2);
                 }
                 transformNode(&node);
-                local_nodes->addOctant(&node);
+                hash->addOctant(&node);
               }
             }
           }
@@ -4619,12 +5391,98 @@ TMROctantArray *TMROctForest::createLocalNodes(){
       }
     }
   }
+}
+
+TMROctantArray *TMROctForest::createLocalNodes(){
+  // Allocate the array of elements
+  int num_elements;
+  octants->getArray(NULL, &num_elements);
+
+  // Get the node, edge, face and block labels. If the mesh order is
+  // high enough, we will have multiple nodes per edge/face
+  int label_type[4];
+  initLabel(mesh_order, interp_type, label_type);
+
+  // Set the number of threads used to create the nodes
+  const int min_elements_per_thread = 1 << 12;
+  int num_threads = 1;
+#ifdef _OPENMP
+  num_threads = omp_get_max_threads();
+  if (num_threads > num_elements/min_elements_per_thread){
+    num_threads = num_elements/min_elements_per_thread;
+  }
+  if (num_threads < 1){
+    num_threads = 1;
+  }
+#endif // _OPENMP
+
+  // Create all the nodes/edges/faces
+  const int use_node_index = 1;
+  TMROctantArray *nodes = NULL;
+
+  if (num_threads == 1){
+    TMROctantHash *local_nodes = new TMROctantHash(use_node_index);
+    addElementNodes(local_nodes, label_type, 0, num_elements);
+    addDependentNodes(local_nodes, label_type, 0, num_elements);
 
-  // Now the local_nodes hash table contains all of the nodes
-  // (dependent, indepdnent and non-local) that are referenced by this
-  // processor
-  TMROctantArray *nodes = local_nodes->toArray();
-  delete local_nodes;
+    // Now the local_nodes hash table contains all of the nodes
+    // (dependent, indepdnent and non-local) that are referenced by
+    // this processor
+    nodes = local_nodes->toArray();
+    delete local_nodes;
+  }
+  else {
+    // Each thread creates the element nodes and the dependent nodes
+    // from a contiguous chunk of the octants in separate hash tables.
+    // The hash tables keep the first instance of each node, so the
+    // lists are ordered so that the element nodes come before the
+    // dependent nodes, and lower chunks come before higher chunks,
+    // which matches the order in which they are added in serial.
+    TMROctantArray **lists = new TMROctantArray*[ 2*num_threads ];
+
+    #pragma omp parallel num_threads(num_threads)
+    {
+      int thread = 0;
+#ifdef _OPENMP
+      thread = omp_get_thread_num();
+#endif // _OPENMP
+      int start = (int)(((int64_t)num_elements*thread)/num_threads);
+      int end = (int)(((int64_t)num_elements*(thread+1))/num_threads);
+
+      TMROctantHash *hash = new TMROctantHash(use_node_index);
+      addElementNodes(hash, label_type, start, end);
+      lists[thread] = hash->toArray();
+      delete hash;
+
+      hash = new TMROctantHash(use_node_index);
+      addDependentNodes(hash, label_type, start, end);
+      lists[num_threads + thread] = hash->toArray();
+      delete hash;
+    }
+
+    // Concatenate the lists in reverse order. The sort is stable and
+    // keeps the last of any duplicate nodes, so the node that is kept
+    // is the one that would have been added first in serial.
+    int size = 0;
+    for ( int k = 0; k < 2*num_threads; k++ ){
+      int list_size;
+      lists[k]->getArray(NULL, &list_size);
+      size += list_size;
+    }
+
+    TMROctant *array = new TMROctant[ size ];
+    for ( int k = 2*num_threads-1, offset = 0; k >= 0; k-- ){
+      int list_size;
+      TMROctant *list_array;
+      lists[k]->getArray(&list_array, &list_size);
+      memcpy(&array[offset], list_array, list_size*sizeof(TMROctant));
+      offset += list_size;
+      delete lists[k];
+    }
+    delete [] lists;
+
+    nodes = new TMROctantArray(array, size, use_node_index);
+  }
   nodes->sort();
 
   // Now, determine the node ownership - if nodes that are not
@@ -4783,6 +5641,9 @@ void TMROctForest::createLocalConn( TMROctantArray *nodes,
   conn = new int[ size ];
   memset(conn, 0, size*sizeof(int));
 
+  // The node array is sorted and is only searched here, so each
+  // element can be processed independently
+  #pragma omp parallel for schedule(static)
   for ( int i = 0; i < num_elements; i++ ){
     int *c = &conn[mesh_order*mesh_order*mesh_order*i];
     const int32_t h = 1 << (TMR_MAX_LEVEL - octs[i].level - 1);
@@ -5292,12 +6153,13 @@ void TMROctForest::createDependentConn( const int *node_nums,
   nodes->getArray(&node_array, &node_size);
 
   // Allocate space to store the free node variables
-  int *edge_nodes = new int[ mesh_order ];
   int *dep_edge_nodes = new int[ mesh_order ];
-  int *face_nodes = new int[ mesh_order*mesh_order ];
   int *dep_face_nodes = new int[ mesh_order*mesh_order ];
-  double *Nu = new double[ mesh_order ];
-  double *Nv = new double[ mesh_order ];
+
+  // The last element that sets the connectivity for each dependent
+  // node. Only this element writes the connectivity so that the
+  // result does not depend on the order the elements are visited.
+  int *dep_elem = new int[ num_dep_nodes ];
 
   for ( int i = 0; i < num_elements; i++ ){
     if (octs[i].info){
@@ -5345,6 +6207,7 @@ void TMROctForest::createDependentConn( const int *node_nums,
               if (dep_ptr[index+1] == 0){
                 dep_ptr[index+1] = mesh_order;
               }
+              dep_elem[index] = i;
             }
           }
         }
@@ -5400,6 +6263,9 @@ void TMROctForest::createDependentConn( const int *node_nums,
               if (dep_ptr[index+1] == 0){
                 dep_ptr[index+1] = mesh_order*mesh_order;
               }
+              if (dep_ptr[index+1] == mesh_order*mesh_order){
+                dep_elem[index] = i;
+              }
             }
           }
         }
@@ -5418,225 +6284,237 @@ void TMROctForest::createDependentConn( const int *node_nums,
 
   // Loop over the elements again, this time setting the local
   // connectivity
-  for ( int i = 0; i < num_elements; i++ ){
-    if (octs[i].info){
-      // Decode the dependent edge/face information
-      int face_info, edge_info;
-      decode_index_from_info(&octs[i], octs[i].info,
-                             &face_info, &edge_info);
-
-      // Get the parent
-      TMROctant parent;
-      octs[i].parent(&parent);
-
-      // Get the child identifier
-      int id = octs[i].childId();
-
-      // Set the offset into the local connectivity array
-      const int *c = &conn[mesh_order*mesh_order*mesh_order*i];
-
-      for ( int edge_index = 0; edge_index < 12; edge_index++ ){
-        if (edge_info & 1 << edge_index){
-          // Get the edges node numbers from the dependent edge
-          if (edge_index < 4){
-            const int jj = (mesh_order-1)*(edge_index % 2);
-            const int kk = (mesh_order-1)*(edge_index / 2);
-            for ( int ii = 0; ii < mesh_order; ii++ ){
-              int offset = ii + jj*mesh_order + kk*mesh_order*mesh_order;
-              dep_edge_nodes[ii] = c[offset];
-            }
-          }
-          else if (edge_index < 8){
-            const int ii = (mesh_order-1)*(edge_index % 2);
-            const int kk = (mesh_order-1)*((edge_index - 4)/2);
-            for ( int jj = 0; jj < mesh_order; jj++ ){
-              int offset = ii + jj*mesh_order + kk*mesh_order*mesh_order;
-              dep_edge_nodes[jj] = c[offset];
-            }
-          }
-          else {
-            const int ii = (mesh_order-1)*(edge_index % 2);
-            const int jj = (mesh_order-1)*((edge_index - 8)/2);
-            for ( int kk = 0; kk < mesh_order; kk++ ){
-              int offset = ii + jj*mesh_order + kk*mesh_order*mesh_order;
-              dep_edge_nodes[kk] = c[offset];
-            }
-          }
+  #pragma omp parallel
+  {
+    int *edge_nodes = new int[ mesh_order ];
+    int *dep_edge_nodes = new int[ mesh_order ];
+    int *face_nodes = new int[ mesh_order*mesh_order ];
+    int *dep_face_nodes = new int[ mesh_order*mesh_order ];
+    double *Nu = new double[ mesh_order ];
+    double *Nv = new double[ mesh_order ];
+
+    #pragma omp for schedule(static)
+    for ( int i = 0; i < num_elements; i++ ){
+      if (octs[i].info){
+        // Decode the dependent edge/face information
+        int face_info, edge_info;
+        decode_index_from_info(&octs[i], octs[i].info,
+                               &face_info, &edge_info);
 
-          // Find the node indices of the parent
-          getEdgeNodes(&parent, edge_index, nodes, node_offset,
-                       edge_nodes);
+        // Get the parent
+        TMROctant parent;
+        octs[i].parent(&parent);
 
-          for ( int k = 0; k < mesh_order; k++ ){
-            // If it's a negative number, it's a dependent node
-            // whose interpolation must be set
-            int index = node_nums[dep_edge_nodes[k]];
-            if (index < 0){
-              index = -index-1;
+        // Get the child identifier
+        int id = octs[i].childId();
 
-              int len = dep_ptr[index+1] - dep_ptr[index];
-              if (len == mesh_order){
-                // Compute the offsets to add (if any)
-                int x = id % 2;
-                int y = ((id % 4)/2);
-                int z = id/4;
-
-                // Compute the shape functions
-                int ptr = dep_ptr[index];
-                for ( int j = 0; j < mesh_order; j++ ){
-                  dep_conn[ptr + j] = edge_nodes[j];
-                }
+        // Set the offset into the local connectivity array
+        const int *c = &conn[mesh_order*mesh_order*mesh_order*i];
 
-                // Evaluate the weights based on the interpolation type
-                if (interp_type == TMR_BERNSTEIN_POINTS){
-                  int u = 0;
-                  if (edge_index < 4){
-                    u = (mesh_order-1)*(x-1) + k;
-                  }
-                  else if (edge_index < 8){
-                    u = (mesh_order-1)*(y-1) + k;
-                  }
-                  else {
-                    u = (mesh_order-1)*(z-1) + k;
-                  }
-                  // Evaluate dependent weights
-                  eval_bernstein_weights(mesh_order, u, &dep_weights[ptr]);
-                }
-                else {
-                  // Compute parametric location along the edge
-                  double u = 0.0;
-                  if (edge_index < 4){
-                    u = 1.0*(x-1) + 0.5*(1.0 + interp_knots[k]);
-                  }
-                  else if (edge_index < 8){
-                    u = 1.0*(y-1) + 0.5*(1.0 + interp_knots[k]);
-                  }
-                  else {
-                    u = 1.0*(z-1) + 0.5*(1.0 + interp_knots[k]);
-                  }
-                  // Evaluate the shape functions
-                  lagrange_shape_functions(mesh_order, u, interp_knots,
-                                           &dep_weights[ptr]);
-                }
-              }
-            }
-          }
-        }
-      }
-
-      for ( int face_index = 0; face_index < 6; face_index++ ){
-        if (face_info & 1 << face_index){
-          // Get the edges node numbers from the dependent edge
-          if (face_index < 2){
-            const int ii = (mesh_order-1)*(face_index % 2);
-            for ( int kk = 0; kk < mesh_order; kk++ ){
-              for ( int jj = 0; jj < mesh_order; jj++ ){
+        for ( int edge_index = 0; edge_index < 12; edge_index++ ){
+          if (edge_info & 1 << edge_index){
+            // Get the edges node numbers from the dependent edge
+            if (edge_index < 4){
+              const int jj = (mesh_order-1)*(edge_index % 2);
+              const int kk = (mesh_order-1)*(edge_index / 2);
+              for ( int ii = 0; ii < mesh_order; ii++ ){
                 int offset = ii + jj*mesh_order + kk*mesh_order*mesh_order;
-                dep_face_nodes[jj + kk*mesh_order] = c[offset];
+                dep_edge_nodes[ii] = c[offset];
               }
             }
-          }
-          else if (face_index < 4){
-            const int jj = (mesh_order-1)*(face_index % 2);
-            for ( int kk = 0; kk < mesh_order; kk++ ){
-              for ( int ii = 0; ii < mesh_order; ii++ ){
+            else if (edge_index < 8){
+              const int ii = (mesh_order-1)*(edge_index % 2);
+              const int kk = (mesh_order-1)*((edge_index - 4)/2);
+              for ( int jj = 0; jj < mesh_order; jj++ ){
                 int offset = ii + jj*mesh_order + kk*mesh_order*mesh_order;
-                dep_face_nodes[ii + kk*mesh_order] = c[offset];
+                dep_edge_nodes[jj] = c[offset];
               }
             }
-          }
-          else {
-            const int kk = (mesh_order-1)*(face_index % 2);
-            for ( int jj = 0; jj < mesh_order; jj++ ){
-              for ( int ii = 0; ii < mesh_order; ii++ ){
+            else {
+              const int ii = (mesh_order-1)*(edge_index % 2);
+              const int jj = (mesh_order-1)*((edge_index - 8)/2);
+              for ( int kk = 0; kk < mesh_order; kk++ ){
                 int offset = ii + jj*mesh_order + kk*mesh_order*mesh_order;
-                dep_face_nodes[ii + jj*mesh_order] = c[offset];
+                dep_edge_nodes[kk] = c[offset];
               }
             }
-          }
-
-          // Get the face nodes associated with the parent face
-          getFaceNodes(&parent, face_index, nodes, node_offset,
-                       face_nodes);
 
-          // Set the node index in the mesh
-          for ( int jj = 0; jj < mesh_order; jj++ ){
-            for ( int ii = 0; ii < mesh_order; ii++ ){
-              // Get the dependent edge nodes
-              int offset = ii + jj*mesh_order;
+            // Find the node indices of the parent
+            getEdgeNodes(&parent, edge_index, nodes, node_offset,
+                         edge_nodes);
 
-              int index = node_nums[dep_face_nodes[offset]];
+            for ( int k = 0; k < mesh_order; k++ ){
+              // If it's a negative number, it's a dependent node
+              // whose interpolation must be set
+              int index = node_nums[dep_edge_nodes[k]];
               if (index < 0){
                 index = -index-1;
 
                 int len = dep_ptr[index+1] - dep_ptr[index];
-                if (len == mesh_order*mesh_order){
+                if (len == mesh_order && dep_elem[index] == i){
                   // Compute the offsets to add (if any)
                   int x = id % 2;
                   int y = ((id % 4)/2);
                   int z = id/4;
 
-                  // Compute the distance along the edges
-                  double u = 0.0;
-                  double v = 0.0;
+                  // Compute the shape functions
+                  int ptr = dep_ptr[index];
+                  for ( int j = 0; j < mesh_order; j++ ){
+                    dep_conn[ptr + j] = edge_nodes[j];
+                  }
 
-                  // Evaluate the parametric point differently depending on the
-                  // interpolation type
+                  // Evaluate the weights based on the interpolation type
                   if (interp_type == TMR_BERNSTEIN_POINTS){
-                    int u = -(mesh_order-1) + ii;
-                    int v = -(mesh_order-1) + jj;
-
-                    if (face_index < 2){
-                      // add the y/z components
-                      u += (mesh_order-1)*y;
-                      v += (mesh_order-1)*z;
+                    int u = 0;
+                    if (edge_index < 4){
+                      u = (mesh_order-1)*(x-1) + k;
                     }
-                    else if (face_index < 4){
-                      // add the x/z components
-                      u += (mesh_order-1)*x;
-                      v += (mesh_order-1)*z;
+                    else if (edge_index < 8){
+                      u = (mesh_order-1)*(y-1) + k;
                     }
                     else {
-                      // add the x/y components
-                      u += (mesh_order-1)*x;
-                      v += (mesh_order-1)*y;
+                      u = (mesh_order-1)*(z-1) + k;
                     }
-
                     // Evaluate dependent weights
-                    eval_bernstein_weights(mesh_order, u, Nu);
-                    eval_bernstein_weights(mesh_order, v, Nv);
+                    eval_bernstein_weights(mesh_order, u, &dep_weights[ptr]);
                   }
                   else {
-                    u = -1.0 + 0.5*(1.0 + interp_knots[ii]);
-                    v = -1.0 + 0.5*(1.0 + interp_knots[jj]);
-
-                    if (face_index < 2){
-                      // add the y/z components
-                      u += 1.0*y;
-                      v += 1.0*z;
+                    // Compute parametric location along the edge
+                    double u = 0.0;
+                    if (edge_index < 4){
+                      u = 1.0*(x-1) + 0.5*(1.0 + interp_knots[k]);
                     }
-                    else if (face_index < 4){
-                      // add the x/z components
-                      u += 1.0*x;
-                      v += 1.0*z;
+                    else if (edge_index < 8){
+                      u = 1.0*(y-1) + 0.5*(1.0 + interp_knots[k]);
                     }
                     else {
-                      // add the x/y components
-                      u += 1.0*x;
-                      v += 1.0*y;
+                      u = 1.0*(z-1) + 0.5*(1.0 + interp_knots[k]);
                     }
-
                     // Evaluate the shape functions
-                    lagrange_shape_functions(mesh_order, u, interp_knots, Nu);
-                    lagrange_shape_functions(mesh_order, v, interp_knots, Nv);
+                    lagrange_shape_functions(mesh_order, u, interp_knots,
+                                             &dep_weights[ptr]);
                   }
+                }
+              }
+            }
+          }
+        }
 
-                  // Add the appropriate offset along the u/v directions
-                  int ptr = dep_ptr[index];
-                  for ( int j = 0; j < mesh_order*mesh_order; j++ ){
-                    dep_conn[ptr + j] = face_nodes[j];
-                    dep_weights[ptr + j] =
-                      Nu[j % mesh_order]*Nv[j / mesh_order];
+        for ( int face_index = 0; face_index < 6; face_index++ ){
+          if (face_info & 1 << face_index){
+            // Get the edges node numbers from the dependent edge
+            if (face_index < 2){
+              const int ii = (mesh_order-1)*(face_index % 2);
+              for ( int kk = 0; kk < mesh_order; kk++ ){
+                for ( int jj = 0; jj < mesh_order; jj++ ){
+                  int offset = ii + jj*mesh_order + kk*mesh_order*mesh_order;
+                  dep_face_nodes[jj + kk*mesh_order] = c[offset];
+                }
+              }
+            }
+            else if (face_index < 4){
+              const int jj = (mesh_order-1)*(face_index % 2);
+              for ( int kk = 0; kk < mesh_order; kk++ ){
+                for ( int ii = 0; ii < mesh_order; ii++ ){
+                  int offset = ii + jj*mesh_order + kk*mesh_order*mesh_order;
+                  dep_face_nodes[ii + kk*mesh_order] = c[offset];
+                }
+              }
+            }
+            else {
+              const int kk = (mesh_order-1)*(face_index % 2);
+              for ( int jj = 0; jj < mesh_order; jj++ ){
+                for ( int ii = 0; ii < mesh_order; ii++ ){
+                  int offset = ii + jj*mesh_order + kk*mesh_order*mesh_order;
+                  dep_face_nodes[ii + jj*mesh_order] = c[offset];
+                }
+              }
+            }
+
+            // Get the face nodes associated with the parent face
+            getFaceNodes(&parent, face_index, nodes, node_offset,
+                         face_nodes);
+
+            // Set the node index in the mesh
+            for ( int jj = 0; jj < mesh_order; jj++ ){
+              for ( int ii = 0; ii < mesh_order; ii++ ){
+                // Get the dependent edge nodes
+                int offset = ii + jj*mesh_order;
+
+                int index = node_nums[dep_face_nodes[offset]];
+                if (index < 0){
+                  index = -index-1;
+
+                  int len = dep_ptr[index+1] - dep_ptr[index];
+                  if (len == mesh_order*mesh_order &&
+                      dep_elem[index] == i){
+                    // Compute the offsets to add (if any)
+                    int x = id % 2;
+                    int y = ((id % 4)/2);
+                    int z = id/4;
+
+                    // Compute the distance along the edges
+                    double u = 0.0;
+                    double v = 0.0;
+
+                    // Evaluate the parametric point differently depending
+                    // on the interpolation type
+                    if (interp_type == TMR_BERNSTEIN_POINTS){
+                      int u = -(mesh_order-1) + ii;
+                      int v = -(mesh_order-1) + jj;
+
+                      if (face_index < 2){
+                        // add the y/z components
+                        u += (mesh_order-1)*y;
+                        v += (mesh_order-1)*z;
+                      }
+                      else if (face_index < 4){
+                        // add the x/z components
+                        u += (mesh_order-1)*x;
+                        v += (mesh_order-1)*z;
+                      }
+                      else {
+                        // add the x/y components
+                        u += (mesh_order-1)*x;
+                        v += (mesh_order-1)*y;
+                      }
+
+                      // Evaluate dependent weights
+                      eval_bernstein_weights(mesh_order, u, Nu);
+                      eval_bernstein_weights(mesh_order, v, Nv);
+                    }
+                    else {
+                      u = -1.0 + 0.5*(1.0 + interp_knots[ii]);
+                      v = -1.0 + 0.5*(1.0 + interp_knots[jj]);
+
+                      if (face_index < 2){
+                        // add the y/z components
+                        u += 1.0*y;
+                        v += 1.0*z;
+                      }
+                      else if (face_index < 4){
+                        // add the x/z components
+                        u += 1.0*x;
+                        v += 1.0*z;
+                      }
+                      else {
+                        // add the x/y components
+                        u += 1.0*x;
+                        v += 1.0*y;
+                      }
+
+                      // Evaluate the shape functions
+                      lagrange_shape_functions(mesh_order, u, interp_knots, Nu);
+                      lagrange_shape_functions(mesh_order, v, interp_knots, Nv);
+                    }
+
+                    // Add the appropriate offset along the u/v directions
+                    int ptr = dep_ptr[index];
+                    for ( int j = 0; j < mesh_order*mesh_order; j++ ){
+                      dep_conn[ptr + j] = face_nodes[j];
+                      dep_weights[ptr + j] =
+                        Nu[j % mesh_order]*Nv[j / mesh_order];
+                    }
                   }
                 }
               }
@@ -5645,14 +6523,18 @@ void TMROctForest::createDependentConn( const int *node_nums,
         }
       }
     }
+
+    delete [] edge_nodes;
+    delete [] dep_edge_nodes;
+    delete [] face_nodes;
+    delete [] dep_face_nodes;
+    delete [] Nu;
+    delete [] Nv;
   }
 
-  delete [] edge_nodes;
   delete [] dep_edge_nodes;
-  delete [] face_nodes;
   delete [] dep_face_nodes;
-  delete [] Nu;
-  delete [] Nv;
+  delete [] dep_elem;
 }
 
 /*
@@ -5674,42 +6556,72 @@ void TMROctForest::evaluateNodeLocations(){
   const double *knots = interp_knots;
 
   if (topo){
-    for ( int i = 0; i < num_elements; i++ ){
-      // Get the right surface
+    // Allocate space for the parametric locations of the nodes that
+    // are evaluated together within each volume
+    double *uvw = new double[ 3*num_local_nodes ];
+    int *index = new int[ num_local_nodes ];
+    TMRPoint *Xv = new TMRPoint[ num_local_nodes ];
+
+    // The octants are sorted by block, so loop over the range of
+    // octants within each block
+    for ( int start = 0; start < num_elements; ){
+      int end = start+1;
+      while (end < num_elements && octs[end].block == octs[start].block){
+        end++;
+      }
+
+      // Get the right volume
       TMRVolume *vol;
-      topo->getVolume(octs[i].block, &vol);
+      topo->getVolume(octs[start].block, &vol);
 
-      // Compute the edge length
-      const int32_t h = 1 << (TMR_MAX_LEVEL - octs[i].level);
+      // Collect the nodes that are not yet assigned
+      int n = 0;
+      for ( int i = start; i < end; i++ ){
+        // Compute the edge length
+        const int32_t h = 1 << (TMR_MAX_LEVEL - octs[i].level);
 
-      // Compute the origin of the element in parametric space
-      // and the edge length of the element
-      double d = convert_to_coordinate(h);
-      double u = convert_to_coordinate(octs[i].x);
-      double v = convert_to_coordinate(octs[i].y);
-      double w = convert_to_coordinate(octs[i].z);
+        // Compute the origin of the element in parametric space
+        // and the edge length of the element
+        double d = convert_to_coordinate(h);
+        double u = convert_to_coordinate(octs[i].x);
+        double v = convert_to_coordinate(octs[i].y);
+        double w = convert_to_coordinate(octs[i].z);
 
-      // Set the offset into the connectivity array
-      const int *c = &conn[mesh_order*mesh_order*mesh_order*i];
+        // Set the offset into the connectivity array
+        const int *c = &conn[mesh_order*mesh_order*mesh_order*i];
 
-      // Look for nodes that are not assigned
-      for ( int kk = 0; kk < mesh_order; kk++ ){
-        for ( int jj = 0; jj < mesh_order; jj++ ){
-          for ( int ii = 0; ii < mesh_order; ii++ ){
-            // Compute the mesh index
-            int node = c[ii + jj*mesh_order + kk*mesh_order*mesh_order];
-            int index = getLocalNodeNumber(node);
-            if (!flags[index]){
-              flags[index] = 1;
-              vol->evalPoint(u + 0.5*d*(1.0 + knots[ii]),
-                             v + 0.5*d*(1.0 + knots[jj]),
-                             w + 0.5*d*(1.0 + knots[kk]),
-                             &X[index]);
+        // Look for nodes that are not assigned
+        for ( int kk = 0; kk < mesh_order; kk++ ){
+          for ( int jj = 0; jj < mesh_order; jj++ ){
+            for ( int ii = 0; ii < mesh_order; ii++ ){
+              // Compute the mesh index
+              int node = c[ii + jj*mesh_order + kk*mesh_order*mesh_order];
+              int local = getLocalNodeNumber(node);
+              if (!flags[local]){
+                flags[local] = 1;
+                uvw[3*n] = u + 0.5*d*(1.0 + knots[ii]);
+                uvw[3*n+1] = v + 0.5*d*(1.0 + knots[jj]);
+                uvw[3*n+2] = w + 0.5*d*(1.0 + knots[kk]);
+                index[n] = local;
+                n++;
+              }
             }
           }
         }
       }
+
+      // Evaluate all the points within this volume at once
+      vol->evalPoints(n, uvw, Xv);
+      for ( int i = 0; i < n; i++ ){
+        X[index[i]] = Xv[i];
+      }
+
+      start = end;
     }
+
+    delete [] uvw;
+    delete [] index;
+    delete [] Xv;
   }
 
   delete [] flags;
@@ -6224,6 +7136,127 @@ TMROctant* TMROctForest::findEnclosing( const int order,
                                         const double *knots,
                                         TMROctant *node,
                                         int *mpi_owner ){
+  // Retrieve the array of elements
+  int size = 0;
+  TMROctant *array = NULL;
+  octants->getArray(&array, &size);
+
+  // Set the low and high indices to the first and last element of the
+  // element array
+  int low = 0;
+  int high = size-1;
+  int mid = low + (int)((high - low)/2);
+
+  // Maintain values of low/high and mid such that the octant is
+  // between (elems[low], elems[high]).  Note that if high-low=1, then
+  // mid = low
+  while (mid != low){
+    // Check if the node is contained by the mid octant
+    if (array[mid].contains(node)){
+      break;
+    }
+
+    // Compare the ordering of the two octants - if the octant is less
+    // than the other, then adjust the mid point
+    int stat = array[mid].comparePosition(node);
+
+    // array[mid] ? node
+    if (stat == 0){
+      break;
+    }
+    else if (stat < 0){
+      low = mid+1;
+    }
+    else {
+      high = mid-1;
+    }
+
+    // Re compute the mid-point and repeat
+    mid = low + (int)((high - low)/2);
+  }
+
+  int index = findEnclosingFrom(order, knots, node, mid, mpi_owner);
+  if (index >= 0){
+    return &array[index];
+  }
+
+  // No octant was found, return NULL
+  return NULL;
+}
+
+/*
+  Find the octants enclosing an array of nodes
+
+  This performs the same search as findEnclosing for each node, but
+  the nodes are first sorted by their Morton position. The starting
+  point of the search for each node is then found by advancing through
+  the sorted array of local octants in a single sweep, instead of a
+  binary search per node. The input array of nodes is not modified.
+
+  input:
+  order:         the order of the node mesh
+  knots:         the knots for the node mesh
+  n:             the number of nodes
+  nodes:         the nodes (element octants with info = node index)
+
+  output:
+  octant_index:  the index of the enclosing local octant (or -1)
+  mpi_owner:     (optional) the owner of the node when not found
+*/
+void TMROctForest::findEnclosing( const int order,
+                                  const double *knots,
+                                  int n, TMROctant *nodes,
+                                  int *octant_index,
+                                  int *mpi_owner ){
+  // Retrieve the array of elements
+  int size = 0;
+  TMROctant *array = NULL;
+  octants->getArray(&array, &size);
+
+  // Sort a copy of the nodes, storing the original index in the tag
+  TMROctant *sorted = new TMROctant[ n ];
+  memcpy(sorted, nodes, n*sizeof(TMROctant));
+  for ( int i = 0; i < n; i++ ){
+    sorted[i].tag = i;
+  }
+  qsort(sorted, n, sizeof(TMROctant), compare_octant_position);
+
+  int start = 0;
+  for ( int i = 0; i < n; i++ ){
+    // Advance to the last octant that is not after the node
+    while (start+1 < size &&
+           array[start+1].comparePosition(&sorted[i]) <= 0){
+      start++;
+    }
+
+    const int index = sorted[i].tag;
+    if (mpi_owner){
+      octant_index[index] = findEnclosingFrom(order, knots, &sorted[i],
+                                              start, &mpi_owner[index]);
+    }
+    else {
+      octant_index[index] = findEnclosingFrom(order, knots, &sorted[i],
+                                              start, NULL);
+    }
+  }
+
+  delete [] sorted;
+}
+
+/*
+  Search the local octants for the octant enclosing the node, starting
+  from the given index in the octant array. Octants beyond the upper
+  corner of the node octant cannot enclose the node so the search
+  stops there.
+
+  If no octant is found, the MPI owner of the node is computed and -1
+  is returned. Otherwise, the index of the octant is returned.
+*/
+int TMROctForest::findEnclosingFrom( const int order,
+                                     const double *knots,
+                                     TMROctant *node,
+                                     int start,
+                                     int *mpi_owner ){
   // Assume that we'll find the node on this processor for now.
   if (mpi_owner){
     *mpi_owner = mpi_rank;
@@ -6273,40 +7306,6 @@ TMROctant* TMROctForest::findEnclosing( const int order,
   const double yd = node->y + 0.5*h*(1.0 + knots[jj]);
   const double zd = node->z + 0.5*h*(1.0 + knots[kk]);
 
-  // Set the low and high indices to the first and last element of the
-  // element array
-  int low = 0;
-  int high = size-1;
-  int mid = low + (int)((high - low)/2);
-
-  // Maintain values of low/high and mid such that the octant is
-  // between (elems[low], elems[high]).  Note that if high-low=1, then
-  // mid = low
-  while (mid != low){
-    // Check if the node is contained by the mid octant
-    if (array[mid].contains(node)){
-      break;
-    }
-
-    // Compare the ordering of the two octants - if the octant is less
-    // than the other, then adjust the mid point
-    int stat = array[mid].comparePosition(node);
-
-    // array[mid] ? node
-    if (stat == 0){
-      break;
-    }
-    else if (stat < 0){
-      low = mid+1;
-    }
-    else {
-      high = mid-1;
-    }
-
-    // Re compute the mid-point and repeat
-    mid = low + (int)((high - low)/2);
-  }
-
   // Compute the bounding octant. Octants greater than this octant
   // cannot own the node so a further search is futile.
   TMROctant oct;
@@ -6315,6 +7314,7 @@ TMROctant* TMROctForest::findEnclosing( const int order,
   oct.y = node->y + h;
   oct.z = node->z + h;
 
+  int mid = start;
   while (mid < size && array[mid].comparePosition(&oct) <= 0){
     // First, make sure that we're on the right block
     if (array[mid].block == block){
@@ -6345,7 +7345,7 @@ TMROctant* TMROctForest::findEnclosing( const int order,
 
       // If all the intervals are satisfied, return the array
       if (xinterval && yinterval && zinterval){
-        return &array[mid];
+        return mid;
       }
     }
     mid++;
@@ -6368,8 +7368,8 @@ TMROctant* TMROctForest::findEnclosing( const int order,
     *mpi_owner = getOctantMPIOwner(&n);
   }
 
-  // No octant was found, return NULL
-  return NULL;
+  // No octant was found
+  return -1;
 }
 
 /*
@@ -6604,6 +7604,43 @@ int TMROctForest::computeElemInterp( TMROctant *node,
   return nweights;
 }
 
+/*
+  Create an empty interpolation cache
+*/
+TMROctInterpCache::TMROctInterpCache(){
+  fine_order = coarse_order = 0;
+  interp_type = TMR_GAUSS_LOBATTO_POINTS;
+  num_fine = num_coarse = 0;
+  fine = coarse = NULL;
+  enclosing = NULL;
+  num_hits = num_misses = 0;
+}
+
+/*
+  Free the interpolation cache
+*/
+TMROctInterpCache::~TMROctInterpCache(){
+  if (fine){ delete [] fine; }
+  if (coarse){ delete [] coarse; }
+  if (enclosing){ delete [] enclosing; }
+}
+
+/*
+  Get the number of interpolation rows on this processor that were
+  found in the cache, and that had to be searched for
+*/
+void TMROctInterpCache::getStatistics( int *_num_hits, int *_num_misses ){
+  if (_num_hits){ *_num_hits = num_hits; }
+  if (_num_misses){ *_num_misses = num_misses; }
+}
+
+/*
+  Reset the cache statistics
+*/
+void TMROctInterpCache::resetStatistics(){
+  num_hits = num_misses = 0;
+}
+
 /*
   Create the interpolation operator from the coarse to the fine mesh.
 
@@ -6611,8 +7648,15 @@ int TMROctForest::computeElemInterp( TMROctant *node,
   in the mesh. This interpolation will refer to other nodes, but the
   output is local.
 
+  If a cache is provided, the coarse octant enclosing each fine node
+  is taken from the cache when both the fine octant and the coarse
+  octant are unchanged since the last call, otherwise the coarse
+  forest is searched. The cache is then updated for this pair of
+  forests.
+
   input:
   coarse:   the coarse octree forest that has the same layout as this
+  cache:    (optional) the cache of enclosing coarse octants
 
   output:
   ptr:      the pointer into the local rows
@@ -6620,7 +7664,8 @@ int TMROctForest::computeElemInterp( TMROctant *node,
   weights:  the interpolation weights for each point
 */
 void TMROctForest::createInterpolation( TMROctForest *coarse,
-                                        TACSBVecInterp *interp ){
+                                        TACSBVecInterp *interp,
+                                        TMROctInterpCache *cache ){
   // Ensure that the nodes are allocated on both octree forests
   createNodes();
   coarse->createNodes();
@@ -6662,6 +7707,41 @@ void TMROctForest::createInterpolation( TMROctForest *coarse,
   // Set the knots to use in the interpolation
   const double *knots = interp_knots;
 
+  // Get the coarse octants
+  int num_coarse;
+  TMROctant *coarse_octs;
+  coarse->octants->getArray(&coarse_octs, &num_coarse);
+
+  // Match the octants against the cached octants. The octant arrays
+  // are sorted so this takes a single pass over each array.
+  int *fine_cached = NULL;
+  int *coarse_index = NULL;
+  int *enclosing = NULL;
+  if (cache){
+    enclosing = new int[ nodes_per_element*num_elements ];
+    for ( int i = 0; i < nodes_per_element*num_elements; i++ ){
+      enclosing[i] = -1;
+    }
+
+    if (cache->enclosing &&
+        cache->fine_order == mesh_order &&
+        cache->coarse_order == coarse->mesh_order &&
+        cache->interp_type == interp_type){
+      fine_cached = new int[ num_elements ];
+      match_octants(num_elements, octs,
+                    cache->num_fine, cache->fine, fine_cached);
+      coarse_index = new int[ cache->num_coarse ];
+      match_octants(cache->num_coarse, cache->coarse,
+                    num_coarse, coarse_octs, coarse_index);
+    }
+  }
+
+  // The owned nodes that must be searched for in the coarse forest
+  // and their location (element index*nodes_per_element + node)
+  int num_search = 0;
+  TMROctant *search = new TMROctant[ local_size ];
+  int *search_loc = new int[ local_size ];
+
   for ( int i = 0; i < num_elements; i++ ){
     const int *c = &conn[nodes_per_element*i];
     for ( int j = 0; j < nodes_per_element; j++ ){
@@ -6673,18 +7753,23 @@ void TMROctForest::createInterpolation( TMROctForest *coarse,
           // We're going to handle this node now, mark it as done
           flags[index] = 1;
 
-          // Find the enclosing coarse octant on this
-          // processor if it exits
+          // Set the node octant
           TMROctant node = octs[i];
           node.info = j;
 
-          // Find the MPI owner or the
-          int mpi_owner = mpi_rank;
-          TMROctant *t = coarse->findEnclosing(mesh_order, knots,
-                                               &node, &mpi_owner);
+          // Check whether the enclosing octant is in the cache
+          TMROctant *t = NULL;
+          if (fine_cached && fine_cached[i] >= 0){
+            int k = cache->enclosing[nodes_per_element*fine_cached[i] + j];
+            if (k >= 0 && coarse_index[k] >= 0){
+              t = &coarse_octs[coarse_index[k]];
+              cache->num_hits++;
+            }
+          }
 
-          // The node is owned a coarse element on this processor
           if (t){
+            enclosing[nodes_per_element*i + j] = (int)(t - coarse_octs);
+
             // Compute the element interpolation
             int nweights = computeElemInterp(&node, coarse, t, weights, tmp);
 
@@ -6695,20 +7780,82 @@ void TMROctForest::createInterpolation( TMROctForest *coarse,
             interp->addInterp(c[j], wvals, vars, nweights);
           }
           else {
-            // We've got to transfer the node to the processor that
-            // owns an enclosing element. Do to that, add the
-            // octant to the list of externals and store its mpi owner
-            node.tag = mpi_owner;
-            ext_queue->push(&node);
+            // Add the node to the list to search for
+            search[num_search] = node;
+            search_loc[num_search] = nodes_per_element*i + j;
+            num_search++;
           }
         }
       }
     }
   }
 
+  // Find the enclosing coarse octants on this processor, or the MPI
+  // owners of the nodes, in a single sweep over the coarse octants
+  int *search_index = new int[ num_search ];
+  int *search_owner = new int[ num_search ];
+  coarse->findEnclosing(mesh_order, knots, num_search, search,
+                        search_index, search_owner);
+
+  for ( int i = 0; i < num_search; i++ ){
+    const int loc = search_loc[i];
+
+    // The node is owned a coarse element on this processor
+    if (search_index[i] >= 0){
+      TMROctant *t = &coarse_octs[search_index[i]];
+      if (cache){
+        enclosing[loc] = search_index[i];
+        cache->num_misses++;
+      }
+
+      // Compute the element interpolation
+      int nweights = computeElemInterp(&search[i], coarse, t,
+                                       weights, tmp);
+
+      for ( int k = 0; k < nweights; k++ ){
+        vars[k] = weights[k].index;
+        wvals[k] = weights[k].weight;
+      }
+      interp->addInterp(conn[loc], wvals, vars, nweights);
+    }
+    else {
+      // We've got to transfer the node to the processor that
+      // owns an enclosing element. Do to that, add the
+      // octant to the list of externals and store its mpi owner.
+      // Nodes that are sent to another processor are counted there.
+      search[i].tag = search_owner[i];
+      ext_queue->push(&search[i]);
+    }
+  }
+
+  delete [] search;
+  delete [] search_loc;
+  delete [] search_index;
+  delete [] search_owner;
+
   // Free the data
   delete [] flags;
 
+  // Update the cache with the octants for this pair of forests
+  if (cache){
+    if (fine_cached){ delete [] fine_cached; }
+    if (coarse_index){ delete [] coarse_index; }
+    if (cache->fine){ delete [] cache->fine; }
+    if (cache->coarse){ delete [] cache->coarse; }
+    if (cache->enclosing){ delete [] cache->enclosing; }
+
+    cache->fine_order = mesh_order;
+    cache->coarse_order = coarse->mesh_order;
+    cache->interp_type = interp_type;
+    cache->num_fine = num_elements;
+    cache->fine = new TMROctant[ num_elements ];
+    memcpy(cache->fine, octs, num_elements*sizeof(TMROctant));
+    cache->num_coarse = num_coarse;
+    cache->coarse = new TMROctant[ num_coarse ];
+    memcpy(cache->coarse, coarse_octs, num_coarse*sizeof(TMROctant));
+    cache->enclosing = enclosing;
+  }
+
   // Sort the sending octants by MPI rank
   TMROctantArray *ext_array = ext_queue->toArray();
   delete ext_queue;
@@ -6774,12 +7921,19 @@ void TMROctForest::createInterpolation( TMROctForest *coarse,
   TMROctant *recv_nodes;
   recv_array->getArray(&recv_nodes, &recv_size);
 
+  // Find the enclosing octants for the recv'd nodes
+  int *recv_index = new int[ recv_size ];
+  coarse->findEnclosing(mesh_order, knots, recv_size, recv_nodes,
+                        recv_index);
+
   // Recv the nodes and loop over the connectivity
   for ( int i = 0; i < recv_size; i++ ){
-    int mpi_owner;
-    TMROctant *t = coarse->findEnclosing(mesh_order, knots,
-                                         &recv_nodes[i], &mpi_owner);
-    if (t){
+    if (cache){
+      cache->num_misses++;
+    }
+    if (recv_index[i] >= 0){
+      TMROctant *t = &coarse_octs[recv_index[i]];
+
       // Compute the element interpolation
       int nweights = computeElemInterp(&recv_nodes[i], coarse, t,
                                        weights, tmp);
@@ -6798,6 +7952,7 @@ void TMROctForest::createInterpolation( TMROctForest *coarse,
   }
 
   // Free the recv array
+  delete [] recv_index;
   delete recv_array;
 
   // Free the temporary arrays
@@ -43,6 +43,45 @@
   multigrid solution algorithms.
 */
 
+/*
+  Cache of the coarse octants used to interpolate the nodes of a fine
+  forest
+
+  The cache records, for each node of each element in the fine forest,
+  the local coarse octant that was used to compute its row of the
+  interpolation operator. When the interpolation is created between a
+  new pair of forests, their octant arrays are matched against the
+  cached arrays. Only the rows for fine octants that were refined,
+  coarsened or migrated, or whose coarse octant no longer exists on
+  this processor, require a search of the coarse forest.
+*/
+class TMROctInterpCache : public TMREntity {
+ public:
+  TMROctInterpCache();
+  ~TMROctInterpCache();
+
+  // Get/reset the number of rows found in or missing from the cache
+  void getStatistics( int *_num_hits, int *_num_misses );
+  void resetStatistics();
+
+ private:
+  friend class TMROctForest;
+
+  // The mesh orders and interpolation for which the cache is valid
+  int fine_order, coarse_order;
+  TMRInterpolationType interp_type;
+
+  // The sorted fine and coarse octant arrays from the last call
+  int num_fine, num_coarse;
+  TMROctant *fine, *coarse;
+
+  // The index of the coarse octant for each fine node (or -1)
+  int *enclosing;
+
+  // The number of rows found in/missing from the cache
+  int num_hits, num_misses;
+};
+
 class TMROctForest : public TMREntity {
  public:
   // This is the max order of the mesh
@@ -80,9 +119,12 @@ class TMROctForest : public TMREntity {
   int getMeshOrder();
   TMRInterpolationType getInterpType();
 
-  // Re-partition the octrees based on element count
-  // -----------------------------------------------
+  // Re-partition the octrees based on element count or weight
+  // ---------------------------------------------------------
   void repartition( int max_rank=-1 );
+  void repartition( const double *weights, int max_rank=-1,
+                    double *imbalance=NULL,
+                    double *new_imbalance=NULL );
 
   // Create the forest of octrees
   // ----------------------------
@@ -90,6 +132,11 @@ class TMROctForest : public TMREntity {
   void createRandomTrees( int nrand=10,
                           int min_level=0, int max_level=8 );
 
+  // Write/read the forest to/from a parallel checkpoint file
+  // --------------------------------------------------------
+  int writeCheckpoint( const char *filename );
+  int readCheckpoint( const char *filename );
+
   // Duplicate or coarsen the forest
   // -------------------------------
   TMROctForest *duplicate();
@@ -121,7 +168,8 @@ class TMROctForest : public TMREntity {
   // Create interpolation/restriction operators
   // ------------------------------------------
   void createInterpolation( TMROctForest *coarse,
-                            TACSBVecInterp *interp );
+                            TACSBVecInterp *interp,
+                            TMROctInterpCache *cache=NULL );
 
   // Get the nodes or elements with a certain name
   // ---------------------------------------------
@@ -138,7 +186,11 @@ class TMROctForest : public TMREntity {
   int getNodeNumbers( const int **_node_numbers );
   int getPoints( TMRPoint **_X );
   int getLocalNodeNumber( int node );
+  void getLocalNodeNumbers( int size, const int *nodes,
+                            int *local_nodes );
   int getInterpKnots( const double **_knots );
+  void evalInterp1D( int npts, const double u[], double N[],
+                     double Nd[]=NULL );
   void evalInterp( const double pt[], double N[] );
   void evalInterp( const double pt[], double N[],
                    double Nxi[], double Neta[], double Nzeta[] );
@@ -166,6 +218,9 @@ class TMROctForest : public TMREntity {
   // ----------------------------------------
   TMROctant* findEnclosing( const int order, const double *knots,
                             TMROctant *node, int *mpi_owner=NULL );
+  void findEnclosing( const int order, const double *knots,
+                      int n, TMROctant *nodes, int *octant_index,
+                      int *mpi_owner=NULL );
 
   // Transform the octant to the global order
   // ----------------------------------------
@@ -194,6 +249,7 @@ class TMROctForest : public TMREntity {
   void writeToVTK( const char *filename );
   void writeToTecplot( const char *filename );
   void writeForestToVTK( const char *filename );
+  int writeForestToVTU( const char *filename );
 
  private:
   // Labels for the nodes
@@ -221,9 +277,16 @@ class TMROctForest : public TMREntity {
   // Set the owners - this determines how the mesh will be ordered
   void computeBlockOwners();
 
+  // Move the octants from one distribution to another
+  void repartitionOctants( const int *ptr, const int *new_ptr );
+
   // Get the octant owner
   int getOctantMPIOwner( TMROctant *oct );
 
+  // Search for the enclosing octant starting from the given index
+  int findEnclosingFrom( const int order, const double *knots,
+                         TMROctant *node, int start, int *mpi_owner );
+
   // match the ownership intervals
   void matchOctantIntervals( TMROctant *array,
                              int size, int *ptr );
@@ -284,6 +347,12 @@ class TMROctForest : public TMREntity {
   // Create the global node ownership data
   TMROctantArray* createLocalNodes();
 
+  // Add the nodes from a range of the local octants to the hash table
+  void addElementNodes( TMROctantHash *hash, const int label_type[],
+                        int start, int end );
+  void addDependentNodes( TMROctantHash *hash, const int label_type[],
+                          int start, int end );
+
   // Create the local connectivity based on the input node array
   void createLocalConn( TMROctantArray *nodes, const int *node_offset );
 
@@ -300,6 +369,9 @@ class TMROctForest : public TMREntity {
                             TMROctantArray *nodes,
                             const int *node_offset );
 
+  // Create the hash table used to find the non-owned local nodes
+  void createNodeHash();
+
   // Compute the node locations
   void evaluateNodeLocations();
 
@@ -341,6 +413,11 @@ class TMROctForest : public TMREntity {
   int num_owned_nodes; // Number of nodes that are owned by me
   int ext_pre_offset; // Number of nodes before pre
 
+  // Hash table of the local indices of the dependent and external
+  // nodes (the owned nodes are found directly)
+  int node_hash_size;
+  int *node_hash;
+
   // The dependent node information
   int *dep_ptr, *dep_conn;
   double *dep_weights;
@@ -348,6 +425,15 @@ class TMROctForest : public TMREntity {
   // The array of all octants
   TMROctantArray *octants;
 
+  // The type of balancing applied to the octants (-1 if the octants
+  // are not known to be balanced) and the balance of the octants
+  // before the last call to refine()
+  int balance_state, refine_balance_state;
+
+  // The locally owned octants created by the last call to refine().
+  // This is NULL if the next balance cannot be performed incrementally.
+  TMROctantArray *refine_octants;
+
   // The octants that are adjacent to this processor
   TMROctantArray *adjacent;
 
@@ -20,6 +20,10 @@
 
 #include "TMROctant.h"
 #include "TMRHashFunction.h"
+#include <algorithm>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 /*
   Get the child id of the octant
@@ -309,6 +313,59 @@ int TMROctant::contains( TMROctant *oct ){
   return 0;
 }
 
+/*
+  Spread the lower 21 bits of the input so that they occupy every
+  third bit of the output
+*/
+static inline uint64_t spread_bits3( uint32_t v ){
+  uint64_t u = v & 0x1fffff;
+  u = (u | u << 32) & 0x1f00000000ffffULL;
+  u = (u | u << 16) & 0x1f0000ff0000ffULL;
+  u = (u | u << 8) & 0x100f00f00f00f00fULL;
+  u = (u | u << 4) & 0x10c30c30c30c30c3ULL;
+  u = (u | u << 2) & 0x1249249249249249ULL;
+  return u;
+}
+
+/*
+  Compute the Morton key for the octant
+
+  The key consists of three words that are compared in order as
+  unsigned integers. The first word contains the block and the most
+  significant 32 bits of the 96-bit Morton code formed by interleaving
+  the bits of x, y and z (with x the most significant). The second
+  word contains the remaining 64 bits of the Morton code. The third
+  word contains the level (or the info when use_node_index is true) in
+  bits 32 to 47. The remaining bits are zero.
+
+  The signed values are offset so that comparing the keys gives the
+  same ordering as compare() or compareNode().
+*/
+void TMROctant::getMortonKey( uint64_t key[], int use_node_index ) const {
+  const uint32_t offset = 1U << 31;
+  uint32_t u = offset ^ block;
+  uint32_t xu = offset ^ x;
+  uint32_t yu = offset ^ y;
+  uint32_t zu = offset ^ z;
+
+  // Interleave the upper 11 bits and the lower 21 bits separately
+  uint64_t hi = ((spread_bits3(xu >> 21) << 2) |
+                 (spread_bits3(yu >> 21) << 1) |
+                 spread_bits3(zu >> 21));
+  uint64_t lo = ((spread_bits3(xu) << 2) |
+                 (spread_bits3(yu) << 1) |
+                 spread_bits3(zu));
+
+  key[0] = ((uint64_t)u << 32) | (hi >> 1);
+  key[1] = (hi << 63) | lo;
+  if (use_node_index){
+    key[2] = (uint64_t)(uint16_t)(0x8000 ^ info) << 32;
+  }
+  else {
+    key[2] = (uint64_t)(uint16_t)(0x8000 ^ level) << 32;
+  }
+}
+
 /*
   Compare two octants within the same sub-tree
 */
@@ -339,6 +396,201 @@ static int compare_nodes( const void *a, const void *b ){
   return ao->compareNode(bo);
 }
 
+/*
+  Compare octants or nodes for use with std::sort
+*/
+class TMROctantLess {
+ public:
+  bool operator()( const TMROctant& a, const TMROctant& b ) const {
+    return a.compare(&b) < 0;
+  }
+};
+
+class TMROctantNodeLess {
+ public:
+  bool operator()( const TMROctant& a, const TMROctant& b ) const {
+    return a.compareNode(&b) < 0;
+  }
+};
+
+/*
+  Sort an array of octants based on the Morton key
+
+  Short arrays are sorted in place using std::sort. Longer arrays are
+  sorted with a least-significant-digit radix sort on the Morton key
+  using 8-bit digits. The index of each octant is stored in the low
+  bits of the last word of the key so that the octants can be
+  permuted once the keys are in order. Digits that are the same for
+  all octants are skipped.
+*/
+static void sort_octants( TMROctant *array, int size,
+                          int use_node_index ){
+  // Use std::sort for short arrays
+  const int min_radix_sort_size = 256;
+  if (size < min_radix_sort_size){
+    if (use_node_index){
+      std::sort(array, array + size, TMROctantNodeLess());
+    }
+    else {
+      std::sort(array, array + size, TMROctantLess());
+    }
+    return;
+  }
+
+  // The digits to sort, from the least to most significant. The low
+  // 32 bits of the last word store the index and are not sorted.
+  const int num_digits = 18;
+  int digit_word[num_digits], digit_shift[num_digits];
+  for ( int k = 0; k < 2; k++ ){
+    digit_word[k] = 2;
+    digit_shift[k] = 32 + 8*k;
+  }
+  for ( int k = 0; k < 8; k++ ){
+    digit_word[2+k] = 1;
+    digit_shift[2+k] = 8*k;
+    digit_word[10+k] = 0;
+    digit_shift[10+k] = 8*k;
+  }
+
+  // Compute the keys and the histograms for all digits at once
+  uint64_t *keys = new uint64_t[ 3*size ];
+  uint64_t *temp = new uint64_t[ 3*size ];
+  int *count = new int[ 256*num_digits ];
+  memset(count, 0, 256*num_digits*sizeof(int));
+
+  for ( int i = 0; i < size; i++ ){
+    uint64_t *key = &keys[3*i];
+    array[i].getMortonKey(key, use_node_index);
+    key[2] |= (uint32_t)i;
+
+    for ( int k = 0; k < num_digits; k++ ){
+      count[256*k + ((key[digit_word[k]] >> digit_shift[k]) & 0xff)]++;
+    }
+  }
+
+  // Scatter the keys based on each digit in turn
+  for ( int k = 0; k < num_digits; k++ ){
+    int *c = &count[256*k];
+
+    // Skip this digit if it is the same for all octants
+    int nonzero = 0;
+    for ( int j = 0; j < 256; j++ ){
+      if (c[j] > 0){
+        nonzero++;
+      }
+    }
+    if (nonzero <= 1){
+      continue;
+    }
+
+    // Convert the counts to offsets
+    for ( int j = 0, offset = 0; j < 256; j++ ){
+      int tmp = c[j];
+      c[j] = offset;
+      offset += tmp;
+    }
+
+    const int word = digit_word[k];
+    const int shift = digit_shift[k];
+    for ( int i = 0; i < size; i++ ){
+      const uint64_t *key = &keys[3*i];
+      uint64_t *dest = &temp[3*c[(key[word] >> shift) & 0xff]++];
+      dest[0] = key[0];
+      dest[1] = key[1];
+      dest[2] = key[2];
+    }
+
+    // Swap the key arrays
+    uint64_t *tmp = keys;
+    keys = temp;
+    temp = tmp;
+  }
+
+  // Permute the octants into the sorted order
+  TMROctant *sorted = new TMROctant[ size ];
+  for ( int i = 0; i < size; i++ ){
+    sorted[i] = array[(uint32_t)keys[3*i+2]];
+  }
+  memcpy(array, sorted, size*sizeof(TMROctant));
+
+  delete [] sorted;
+  delete [] count;
+  delete [] keys;
+  delete [] temp;
+}
+
+/*
+  Sort an array of octants using the available threads
+
+  The array is split into contiguous chunks that are sorted
+  independently and then merged pairwise. Both the chunk sort and the
+  merge are stable, so the result is identical to sorting the whole
+  array on a single thread. Without OpenMP, or when called from within
+  a parallel region, this is equivalent to sort_octants().
+*/
+static void sort_octants_threaded( TMROctant *array, int size,
+                                   int use_node_index ){
+#ifdef _OPENMP
+  // The minimum number of octants sorted by each thread
+  const int min_chunk_size = 1 << 14;
+
+  int num_chunks = 1;
+  if (!omp_in_parallel()){
+    num_chunks = omp_get_max_threads();
+    if (num_chunks > size/min_chunk_size){
+      num_chunks = size/min_chunk_size;
+    }
+  }
+
+  if (num_chunks > 1){
+    // Split the array into contiguous chunks
+    int *ptr = new int[ num_chunks+1 ];
+    for ( int i = 0; i <= num_chunks; i++ ){
+      ptr[i] = (int)(((int64_t)size*i)/num_chunks);
+    }
+
+    #pragma omp parallel for schedule(static)
+    for ( int i = 0; i < num_chunks; i++ ){
+      sort_octants(&array[ptr[i]], ptr[i+1] - ptr[i], use_node_index);
+    }
+
+    // Merge adjacent pairs of sorted chunks until only one is left
+    TMROctant *temp = new TMROctant[ size ];
+    TMROctant *src = array, *dest = temp;
+    for ( int width = 1; width < num_chunks; width *= 2 ){
+      #pragma omp parallel for schedule(static)
+      for ( int i = 0; i < num_chunks; i += 2*width ){
+        int start = ptr[i];
+        int mid = ptr[(i + width < num_chunks ? i + width : num_chunks)];
+        int end = ptr[(i + 2*width < num_chunks ? i + 2*width : num_chunks)];
+        if (use_node_index){
+          std::merge(&src[start], &src[mid], &src[mid], &src[end],
+                     &dest[start], TMROctantNodeLess());
+        }
+        else {
+          std::merge(&src[start], &src[mid], &src[mid], &src[end],
+                     &dest[start], TMROctantLess());
+        }
+      }
+
+      TMROctant *tmp = src;
+      src = dest;
+      dest = tmp;
+    }
+
+    if (src != array){
+      memcpy(array, src, size*sizeof(TMROctant));
+    }
+
+    delete [] temp;
+    delete [] ptr;
+    return;
+  }
+#endif // _OPENMP
+
+  sort_octants(array, size, use_node_index);
+}
+
 /*
   Store a array of octants
 */
@@ -377,7 +629,7 @@ TMROctantArray* TMROctantArray::duplicate(){
 */
 void TMROctantArray::sort(){
   if (use_node_index){
-    qsort(array, size, sizeof(TMROctant), compare_nodes);
+    sort_octants_threaded(array, size, use_node_index);
 
     // Now that the Octants are sorted, remove duplicates
     int i = 0; // Location from which to take entries
@@ -398,7 +650,7 @@ void TMROctantArray::sort(){
     size = j;
   }
   else {
-    qsort(array, size, sizeof(TMROctant), compare_octants);
+    sort_octants_threaded(array, size, use_node_index);
 
     // Now that the Octants are sorted, remove duplicates
     int i = 0; // Location from which to take entries
@@ -536,20 +788,17 @@ void TMROctantArray::getArray( TMROctant **_array, int *_size ){
   Create an queue of octants
 */
 TMROctantQueue::TMROctantQueue(){
-  root = tip = NULL;
   num_elems = 0;
+  head = 0;
+  max_size = min_queue_size;
+  array = new TMROctant[ max_size ];
 }
 
 /*
   Free the queue
 */
 TMROctantQueue::~TMROctantQueue(){
-  OctQueueNode *node = root;
-  while (node){
-    OctQueueNode *tmp = node;
-    node = node->next;
-    delete tmp;
-  }
+  delete [] array;
 }
 
 /*
@@ -559,20 +808,34 @@ int TMROctantQueue::length(){
   return num_elems;
 }
 
+/*
+  Copy the entries from the ring buffer, in queue order, to the
+  destination array
+*/
+void TMROctantQueue::copyEntries( TMROctant *dest ){
+  int len = max_size - head;
+  if (len > num_elems){
+    len = num_elems;
+  }
+  memcpy(dest, &array[head], len*sizeof(TMROctant));
+  memcpy(&dest[len], array, (num_elems - len)*sizeof(TMROctant));
+}
+
 /*
   Push a value onto the octant queue
 */
 void TMROctantQueue::push( TMROctant *oct ){
-  if (!tip){
-    root = new OctQueueNode();
-    root->oct = *oct;
-    tip = root;
-  }
-  else {
-    tip->next = new OctQueueNode();
-    tip->next->oct = *oct;
-    tip = tip->next;
+  if (num_elems >= max_size){
+    // Double the size of the buffer and unwrap the entries
+    TMROctant *temp = new TMROctant[ 2*max_size ];
+    copyEntries(temp);
+    delete [] array;
+    array = temp;
+    head = 0;
+    max_size *= 2;
   }
+
+  array[(head + num_elems) & (max_size-1)] = *oct;
   num_elems++;
 }
 
@@ -580,16 +843,13 @@ void TMROctantQueue::push( TMROctant *oct ){
   Pop a value from the octant queue
 */
 TMROctant TMROctantQueue::pop(){
-  if (!root){
+  if (num_elems == 0){
     return TMROctant();
   }
   else {
+    TMROctant temp = array[head];
+    head = (head + 1) & (max_size-1);
     num_elems--;
-    TMROctant temp = root->oct;
-    OctQueueNode *tmp = root;
-    root = root->next;
-    delete tmp;
-    if (num_elems == 0){ tip = NULL; }
     return temp;
   }
 }
@@ -598,20 +858,12 @@ TMROctant TMROctantQueue::pop(){
   Convert the queue to an array
 */
 TMROctantArray* TMROctantQueue::toArray(){
-  // Allocate the array
-  TMROctant *array = new TMROctant[ num_elems ];
-
-  // Scan through the queue and retrieve the octants
-  OctQueueNode *node = root;
-  int index = 0;
-  while (node){
-    array[index] = node->oct;
-    node = node->next;
-    index++;
-  }
+  // Allocate the array and copy over the octants in order
+  TMROctant *arr = new TMROctant[ num_elems ];
+  copyEntries(arr);
 
   // Create the array object
-  TMROctantArray *list = new TMROctantArray(array, num_elems);
+  TMROctantArray *list = new TMROctantArray(arr, num_elems);
   return list;
 }
 
@@ -624,52 +876,38 @@ TMROctantArray* TMROctantQueue::toArray(){
 */
 TMROctantHash::TMROctantHash( int _use_node_index ){
   use_node_index = _use_node_index;
+
+  // Allocate the contiguous array of octants
   num_elems = 0;
-  num_buckets = min_num_buckets;
-  hash_buckets = new OctHashNode*[ num_buckets ];
-  memset(hash_buckets, 0, num_buckets*sizeof(OctHashNode*));
+  max_elems = min_table_size/2;
+  array = new TMROctant[ max_elems ];
+
+  // Allocate the table and set all the entries to empty
+  table_size = min_table_size;
+  table = new OctHashEntry[ table_size ];
+  for ( int i = 0; i < table_size; i++ ){
+    table[i].index = -1;
+  }
 }
 
 /*
   Free the memory allocated by the octant hash
 */
 TMROctantHash::~TMROctantHash(){
-  // Free all the elements in the hash
-  for ( int i = 0; i < num_buckets; i++ ){
-    OctHashNode *node = hash_buckets[i];
-    while (node){
-      // Delete the old guy
-      OctHashNode *tmp = node;
-      node = node->next;
-      delete tmp;
-    }
-  }
-
-  delete [] hash_buckets;
+  delete [] array;
+  delete [] table;
 }
 
 /*
   Covert the hash table to an array
 */
 TMROctantArray *TMROctantHash::toArray(){
-  // Create an array of octants
-  TMROctant *array = new TMROctant[ num_elems ];
-
-  // Loop over all the buckets
-  for ( int i = 0, index = 0; i < num_buckets; i++ ){
-    // Get the hash bucket and extract all the elements from this
-    // bucket into the array
-    OctHashNode *node = hash_buckets[i];
-
-    while (node){
-      array[index] = node->oct;
-      index++;
-      node = node->next;
-    }
-  }
+  // Create an array of octants in the order they were added
+  TMROctant *arr = new TMROctant[ num_elems ];
+  memcpy(arr, array, num_elems*sizeof(TMROctant));
 
   // Create an array object and add it to the list
-  TMROctantArray *list = new TMROctantArray(array, num_elems,
+  TMROctantArray *list = new TMROctantArray(arr, num_elems,
                                             use_node_index);
   return list;
 }
@@ -688,142 +926,94 @@ TMROctantArray *TMROctantHash::toArray(){
   true if the octant is added, false if it is not
 */
 int TMROctantHash::addOctant( TMROctant *oct ){
-  if (num_elems > 10*num_buckets){
-    // Redistribute the octants to new buckets
-    int num_old_buckets = num_buckets;
-    num_buckets = 2*num_buckets;
-    OctHashNode **new_buckets = new OctHashNode*[ num_buckets ];
-    memset(new_buckets, 0, num_buckets*sizeof(OctHashNode*));
-
-    // Keep track of the end bucket
-    OctHashNode **end_buckets = new OctHashNode*[ num_buckets ];
-
-    // Redistribute the octant nodes based on the new
-    // number of buckets within the hash data structure
-    for ( int i = 0; i < num_old_buckets; i++ ){
-      OctHashNode *node = hash_buckets[i];
-      while (node){
-        int bucket = getBucket(&(node->oct));
-
-        // If this is the first new bucket, create
-        // the new node
-        if (!new_buckets[bucket]){
-          new_buckets[bucket] = new OctHashNode;
-          new_buckets[bucket]->oct = node->oct;
-          end_buckets[bucket] = new_buckets[bucket];
-        }
-        else {
-          end_buckets[bucket]->next = new OctHashNode;
-          end_buckets[bucket]->next->oct = node->oct;
-          end_buckets[bucket] = end_buckets[bucket]->next;
-        }
-
-        // Delete the old guy
-        OctHashNode *tmp = node;
-
-        // Increment the node to the next hash
-        node = node->next;
-
-        // Free the node
-        delete tmp;
+  // Keep the table at most half full
+  if (2*(num_elems+1) > table_size){
+    resizeTable();
+  }
+
+  uint32_t hash = getHash(oct);
+  const uint32_t mask = table_size-1;
+
+  // Probe the table until an empty entry is found
+  uint32_t slot = hash & mask;
+  while (table[slot].index >= 0){
+    if (table[slot].hash == hash){
+      TMROctant *t = &array[table[slot].index];
+
+      // The octant is in the list, quit now and return false. Nodes
+      // are unique by position and info, elements by position and
+      // level.
+      if (t->block == oct->block &&
+          t->x == oct->x && t->y == oct->y && t->z == oct->z &&
+          (use_node_index ? (t->info == oct->info) :
+           (t->level == oct->level))){
+        return 0;
       }
     }
-
-    delete [] end_buckets;
-    delete [] hash_buckets;
-    hash_buckets = new_buckets;
+    slot = (slot + 1) & mask;
   }
 
-  int bucket = getBucket(oct);
-
-  // If no octant has been added to the bucket,
-  // create a new bucket
-  if (!hash_buckets[bucket]){
-    hash_buckets[bucket] = new OctHashNode;
-    hash_buckets[bucket]->oct = *oct;
-    num_elems++;
-    return 1;
+  // Extend the contiguous array of octants if needed
+  if (num_elems >= max_elems){
+    max_elems *= 2;
+    TMROctant *temp = new TMROctant[ max_elems ];
+    memcpy(temp, array, num_elems*sizeof(TMROctant));
+    delete [] array;
+    array = temp;
   }
-  else {
-    // Get the head node for the corresponding bucket
-    OctHashNode *node = hash_buckets[bucket];
-    if (use_node_index){
-      while (node){
-        // The octant is in the list, quit now and return false
-        if (node->oct.compareNode(oct) == 0){
-          return 0;
-        }
-
-        // If the next node does not exist, quit
-        // while node is the last node in the linked
-        // list
-        if (!node->next){
-          break;
-        }
-        node = node->next;
-      }
-    }
-    else {
-      while (node){
-        // The octant is in the list, quit now and return false
-        if (node->oct.compare(oct) == 0){
-          return 0;
-        }
 
-        // If the next node does not exist, quit
-        // while node is the last node in the linked
-        // list
-        if (!node->next){
-          break;
-        }
-        node = node->next;
-      }
-    }
-
-    // Add the octant as the last node
-    node->next = new OctHashNode;
-    node->next->oct = *oct;
-    num_elems++;
-  }
+  // Add the octant to the end of the array
+  array[num_elems] = *oct;
+  table[slot].hash = hash;
+  table[slot].index = num_elems;
+  num_elems++;
 
   return 1;
 }
 
 /*
-  Get a bucket to place the octant in.
-
-  This code creates a value based on the octant location within the
-  mesh and then takes the remainder of the number of buckets.
+  Double the size of the table and re-insert all the entries using
+  the stored hash values.
 */
-int TMROctantHash::getBucket( TMROctant *oct ){
-  // The has value
-  uint32_t val = 0;
-
-  if (use_node_index){
-    uint32_t u = 0, v = 0, w = 0, x = 0;
-    u = oct->block;
-    v = (1 << TMR_MAX_LEVEL) + oct->x;
-    w = (1 << TMR_MAX_LEVEL) + oct->y;
-    x = (1 << TMR_MAX_LEVEL) + oct->z;
-    // y = oct->info;
+void TMROctantHash::resizeTable(){
+  int old_size = table_size;
+  OctHashEntry *old_table = table;
 
-    // Compute the hash value
-    // val = TMRIntegerFiveTupleHash(u, v, w, x, y);
-    val = TMRIntegerFourTupleHash(u, v, w, x);
+  table_size = 2*table_size;
+  table = new OctHashEntry[ table_size ];
+  for ( int i = 0; i < table_size; i++ ){
+    table[i].index = -1;
   }
-  else {
-    uint32_t u = 0, v = 0, w = 0, x = 0;
-    u = oct->block;
-    v = (1 << TMR_MAX_LEVEL) + oct->x;
-    w = (1 << TMR_MAX_LEVEL) + oct->y;
-    x = (1 << TMR_MAX_LEVEL) + oct->z;
 
-    // Compute the hash value
-    val = TMRIntegerFourTupleHash(u, v, w, x);
+  const uint32_t mask = table_size-1;
+  for ( int i = 0; i < old_size; i++ ){
+    if (old_table[i].index >= 0){
+      uint32_t slot = old_table[i].hash & mask;
+      while (table[slot].index >= 0){
+        slot = (slot + 1) & mask;
+      }
+      table[slot] = old_table[i];
+    }
   }
 
-  // Compute the bucket value
-  int bucket = val % num_buckets;
+  delete [] old_table;
+}
+
+/*
+  Get the hash value for the octant
+
+  This code creates a value based on the block and the Morton
+  coordinates of the octant. The level and info are not included since
+  the comparison is based on either the level (elements) or the info
+  (nodes).
+*/
+uint32_t TMROctantHash::getHash( TMROctant *oct ){
+  uint32_t u = 0, v = 0, w = 0, x = 0;
+  u = oct->block;
+  v = (1 << TMR_MAX_LEVEL) + oct->x;
+  w = (1 << TMR_MAX_LEVEL) + oct->y;
+  x = (1 << TMR_MAX_LEVEL) + oct->z;
 
-  return bucket;
+  // Compute the hash value
+  return TMRIntegerFourTupleHash(u, v, w, x);
 }
@@ -44,6 +44,7 @@ class TMROctant {
   int comparePosition( const TMROctant *oct ) const;
   int compareNode( const TMROctant *oct ) const;
   int contains( TMROctant *oct );
+  void getMortonKey( uint64_t key[], int use_node_index=0 ) const;
 
   int32_t block; // The block that owns this octant
   int32_t x, y, z; // The x,y,z coordinates
@@ -84,7 +85,9 @@ class TMROctantArray {
   Create a queue of octants
 
   This class defines a queue of octants that are used for the balance
-  and coarsen operations.
+  and coarsen operations. The octants are stored in a contiguous ring
+  buffer that grows as needed, so pushing and popping octants does not
+  require any per-octant allocation.
 */
 class TMROctantQueue {
  public:
@@ -97,17 +100,18 @@ class TMROctantQueue {
   TMROctantArray* toArray();
 
  private:
-  // Class that defines an element within the queue
-  class OctQueueNode {
-  public:
-    OctQueueNode(){ next = NULL; }
-    TMROctant oct;
-    OctQueueNode *next;
-  };
+  // The initial size of the ring buffer (must be a power of two)
+  static const int min_queue_size = (1 << 10);
+
+  // Copy the entries in the queue, in order, to the array
+  void copyEntries( TMROctant *dest );
 
   // Keep track of the number of elements in the queue
   int num_elems;
-  OctQueueNode *root, *tip;
+
+  // The ring buffer of octants and the location of the first entry
+  int head, max_size;
+  TMROctant *array;
 };
 
 /*
@@ -116,6 +120,11 @@ class TMROctantQueue {
   This object enables the creation of a unique set of octants such
   that no two have the same position/level combination. This hash
   table can then be made into an array of unique elements or nodes.
+
+  The unique octants are stored contiguously in the order they are
+  added. An open-addressing table with linear probing stores the
+  hash of the octant's block and Morton coordinates together with
+  the index of the octant within the contiguous array.
 */
 class TMROctantHash {
  public:
@@ -126,28 +135,32 @@ class TMROctantHash {
   int addOctant( TMROctant *oct );
 
  private:
-  // The minimum bucket size
-  static const int min_num_buckets = (1 << 12)-1;
+  // The minimum table size (must be a power of two)
+  static const int min_table_size = (1 << 12);
 
-  class OctHashNode {
+  // An entry in the open-addressing table
+  class OctHashEntry {
   public:
-    OctHashNode(){ next = NULL; }
-    TMROctant oct;
-    OctHashNode *next;
+    uint32_t hash;
+    int index;
   };
 
   // Keep track of whether to use a node-based search
   int use_node_index;
 
-  // Keep track of the bucket size
-  int num_buckets;
-  OctHashNode **hash_buckets;
+  // The contiguous array of unique octants
+  int num_elems, max_elems;
+  TMROctant *array;
+
+  // The open-addressing table - unused entries have an index of -1
+  int table_size;
+  OctHashEntry *table;
 
-  // Keep track of the number of elements
-  int num_elems;
+  // Compute the hash value for the octant
+  uint32_t getHash( TMROctant *oct );
 
-  // Get the buckets to place the octant in
-  int getBucket( TMROctant *oct );
+  // Double the size of the table and re-insert the entries
+  void resizeTable();
 };
 
 #endif // TMR_OCTANT_H
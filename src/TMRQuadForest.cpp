@@ -20,6 +20,7 @@
 
 #include "TMRQuadForest.h"
 #include "TMRInterpolation.h"
+#include "TMR_VTKTools.h"
 #include <stdlib.h>
 
 /*
@@ -46,6 +47,34 @@ static int compare_quadrant_tags( const void *a, const void *b ){
   return A->tag - B->tag;
 }
 
+/*
+  Compare the Morton positions of quadrants for sorting
+*/
+static int compare_quadrant_position( const void *a, const void *b ){
+  const TMRQuadrant *A = static_cast<const TMRQuadrant*>(a);
+  const TMRQuadrant *B = static_cast<const TMRQuadrant*>(b);
+  return A->comparePosition(B);
+}
+
+/*
+  Match two sorted arrays of quadrants. For each quadrant in the first
+  array, find the index of the identical quadrant in the second array,
+  or -1 if it does not exist.
+*/
+static void match_quadrants( int na, const TMRQuadrant *a,
+                             int nb, const TMRQuadrant *b, int *index ){
+  int j = 0;
+  for ( int i = 0; i < na; i++ ){
+    index[i] = -1;
+    while (j < nb && b[j].compare(&a[i]) < 0){
+      j++;
+    }
+    if (j < nb && b[j].compare(&a[i]) == 0){
+      index[i] = j;
+    }
+  }
+}
+
 /*
   Convert from the integer coordinate system to a physical coordinate
   with the off-by-one check.
@@ -102,6 +131,8 @@ TMRQuadForest::TMRQuadForest( MPI_Comm _comm, int _mesh_order,
   num_owned_nodes = 0;
   num_dep_nodes = 0;
   ext_pre_offset = 0;
+  node_hash_size = 0;
+  node_hash = NULL;
 
   dep_ptr = NULL;
   dep_conn = NULL;
@@ -139,6 +170,7 @@ void TMRQuadForest::freeData(){
   if (conn){ delete [] conn; }
   if (node_numbers){ delete [] node_numbers; }
   if (node_range){ delete [] node_range; }
+  if (node_hash){ delete [] node_hash; }
   if (dep_ptr){ delete [] dep_ptr; }
   if (dep_conn){ delete [] dep_conn; }
   if (dep_weights){ delete [] dep_weights; }
@@ -157,6 +189,8 @@ void TMRQuadForest::freeData(){
   num_owned_nodes = 0;
   num_dep_nodes = 0;
   ext_pre_offset = 0;
+  node_hash_size = 0;
+  node_hash = NULL;
 
   dep_ptr = NULL;
   dep_conn = NULL;
@@ -184,6 +218,7 @@ void TMRQuadForest::freeMeshData( int free_quads,
   if (conn){ delete [] conn; }
   if (node_numbers){ delete [] node_numbers; }
   if (node_range){ delete [] node_range; }
+  if (node_hash){ delete [] node_hash; }
   if (dep_ptr){ delete [] dep_ptr; }
   if (dep_conn){ delete [] dep_conn; }
   if (dep_weights){ delete [] dep_weights; }
@@ -205,6 +240,8 @@ void TMRQuadForest::freeMeshData( int free_quads,
   num_owned_nodes = 0;
   num_dep_nodes = 0;
   ext_pre_offset = 0;
+  node_hash_size = 0;
+  node_hash = NULL;
 }
 
 /*
@@ -831,6 +868,103 @@ void TMRQuadForest::writeForestToVTK( const char *filename ){
   }
 }
 
+/*
+  Write the refined forest to a binary VTK XML (.vtu) file in parallel
+
+  Each processor writes the points for its owned and dependent nodes,
+  and the corner connectivity, level, face and MPI rank of its local
+  elements. All the data is written directly to the file using MPI/IO
+  through TMR_WriteVTUFile(). This is a collective call and requires
+  that the nodes have been created.
+*/
+int TMRQuadForest::writeForestToVTU( const char *filename ){
+  if (!conn || !X){
+    fprintf(stderr, "TMRQuadForest Error: Cannot call writeForestToVTU(), "
+            "the nodes have not been created\n");
+    return 1;
+  }
+
+  // Compute the offset to the points on each processor. The owned
+  // nodes are followed by the dependent nodes.
+  int npts = num_owned_nodes + num_dep_nodes;
+  int *pt_range = new int[ mpi_size+1 ];
+  pt_range[0] = 0;
+  MPI_Allgather(&npts, 1, MPI_INT, &pt_range[1], 1, MPI_INT, comm);
+  for ( int i = 0; i < mpi_size; i++ ){
+    pt_range[i+1] += pt_range[i];
+  }
+
+  // Copy the owned and dependent node locations. The dependent nodes
+  // are stored first in the local ordering.
+  TMRPoint *Xpts = new TMRPoint[ npts ];
+  for ( int i = 0; i < num_owned_nodes; i++ ){
+    Xpts[i] = X[ext_pre_offset + i];
+  }
+  for ( int i = 0; i < num_dep_nodes; i++ ){
+    Xpts[num_owned_nodes + i] = X[i];
+  }
+
+  // Get the quadrants
+  int num_elements;
+  TMRQuadrant *quads;
+  quadrants->getArray(&quads, &num_elements);
+
+  // Set the connectivity from the corner nodes of each element
+  const int m = mesh_order-1;
+  const int corner[4] = {0, m, m + m*mesh_order, m*mesh_order};
+  int64_t *cell_conn = new int64_t[ 4*num_elements ];
+  for ( int i = 0; i < num_elements; i++ ){
+    const int *c = &conn[mesh_order*mesh_order*i];
+    for ( int j = 0; j < 4; j++ ){
+      int node = c[corner[j]];
+      int64_t index = 0;
+      if (node < 0){
+        index = pt_range[mpi_rank] + num_owned_nodes + num_dep_nodes + node;
+      }
+      else {
+        // Find the owner of the node
+        int owner = 0, high = mpi_size;
+        while (high - owner > 1){
+          int mid = owner + (high - owner)/2;
+          if (node_range[mid] <= node){
+            owner = mid;
+          }
+          else {
+            high = mid;
+          }
+        }
+        index = pt_range[owner] + (node - node_range[owner]);
+      }
+      cell_conn[4*i + j] = index;
+    }
+  }
+
+  // Set the cell data
+  int *level = new int[ num_elements ];
+  int *face = new int[ num_elements ];
+  int *partition = new int[ num_elements ];
+  for ( int i = 0; i < num_elements; i++ ){
+    level[i] = quads[i].level;
+    face[i] = quads[i].face;
+    partition[i] = mpi_rank;
+  }
+
+  const char *names[] = {"level", "face", "partition"};
+  const int *data[] = {level, face, partition};
+  int fail = TMR_WriteVTUFile(comm, filename, npts, Xpts,
+                              num_elements, 4, 9, cell_conn,
+                              3, names, data);
+
+  delete [] pt_range;
+  delete [] Xpts;
+  delete [] cell_conn;
+  delete [] level;
+  delete [] face;
+  delete [] partition;
+
+  return fail;
+}
+
 /*
   Write the entire forest to a VTK file
 */
@@ -1000,20 +1134,102 @@ int TMRQuadForest::getPoints( TMRPoint **_X ){
   return num_local_nodes;
 }
 
+/*
+  Hash a global node number. The multiplier is odd, so consecutive
+  node numbers map to distinct slots in a power-of-two table.
+*/
+static inline uint32_t node_number_hash( int node ){
+  return (uint32_t)node*2654435761u;
+}
+
 /*
   Retrieve the local node number
+
+  The owned nodes are numbered contiguously so their local numbers
+  are computed directly. The dependent and external nodes are found
+  in the hash table created by createNodes().
 */
 int TMRQuadForest::getLocalNodeNumber( int node ){
   if (node_numbers){
-    int *item = (int*)bsearch(&node, node_numbers, num_local_nodes,
-                              sizeof(int), compare_integers);
-    if (item){
-      return item - node_numbers;
+    if (node >= node_range[mpi_rank] && node < node_range[mpi_rank+1]){
+      return ext_pre_offset + (node - node_range[mpi_rank]);
+    }
+
+    if (node_hash){
+      const uint32_t mask = node_hash_size-1;
+      uint32_t slot = node_number_hash(node) & mask;
+      while (node_hash[slot] >= 0){
+        if (node_numbers[node_hash[slot]] == node){
+          return node_hash[slot];
+        }
+        slot = (slot + 1) & mask;
+      }
     }
   }
   return -1;
 }
 
+/*
+  Retrieve the local node numbers for an array of global node numbers
+
+  input:
+  size:         the number of nodes
+  nodes:        the global node numbers
+
+  output:
+  local_nodes:  the local node numbers (-1 when not on this proc)
+*/
+void TMRQuadForest::getLocalNodeNumbers( int size, const int *nodes,
+                                       int *local_nodes ){
+  for ( int i = 0; i < size; i++ ){
+    local_nodes[i] = getLocalNodeNumber(nodes[i]);
+  }
+}
+
+/*
+  Create the hash table for the dependent and external nodes
+
+  The table stores the local index of each node that is not owned by
+  this processor. It uses linear probing and is kept at most half
+  full, with empty slots set to -1.
+*/
+void TMRQuadForest::createNodeHash(){
+  if (node_hash){ delete [] node_hash; }
+  node_hash = NULL;
+  node_hash_size = 0;
+
+  int num_ext_nodes = num_local_nodes - num_owned_nodes;
+  if (num_ext_nodes <= 0){
+    return;
+  }
+
+  node_hash_size = 1 << 4;
+  while (node_hash_size < 2*num_ext_nodes){
+    node_hash_size *= 2;
+  }
+  node_hash = new int[ node_hash_size ];
+  for ( int i = 0; i < node_hash_size; i++ ){
+    node_hash[i] = -1;
+  }
+
+  // The owned nodes occupy the local indices [ext_pre_offset,
+  // owned_end). This range is empty when no nodes are owned.
+  const uint32_t mask = node_hash_size-1;
+  const int owned_end = ext_pre_offset + num_owned_nodes;
+  for ( int i = 0; i < num_local_nodes; i++ ){
+    if (i >= ext_pre_offset && i < owned_end){
+      // Skip over the owned nodes
+      i = owned_end-1;
+      continue;
+    }
+    uint32_t slot = node_number_hash(node_numbers[i]) & mask;
+    while (node_hash[slot] >= 0){
+      slot = (slot + 1) & mask;
+    }
+    node_hash[slot] = i;
+  }
+}
+
 /*
   Get the knot points for the interpolation
 */
@@ -1024,6 +1240,23 @@ int TMRQuadForest::getInterpKnots( const double **_knots ){
   return mesh_order;
 }
 
+/*
+  Evaluate the 1-D interpolant (and optionally its derivative) at a
+  batch of parametric points. The shape functions for point n are
+  stored in N[mesh_order*n + i]. These can be combined with the
+  sum-factorized tensor_interp functions in TMRInterpolation.h.
+*/
+void TMRQuadForest::evalInterp1D( int npts, const double u[], double N[],
+                                   double Nd[] ){
+  if (interp_type == TMR_BERNSTEIN_POINTS){
+    bernstein_shape_functions_batch(mesh_order, npts, u, N, Nd);
+  }
+  else {
+    lagrange_shape_functions_batch(mesh_order, npts, u, interp_knots,
+                                   N, Nd);
+  }
+}
+
 /*
   Evaluate the interpolant at the given parametric point
 */
@@ -1254,6 +1487,264 @@ void TMRQuadForest::createTrees( int refine_level ){
   }
 }
 
+/*
+  Write the forest to a checkpoint file
+
+  The checkpoint stores the face connectivity, the mesh order and
+  interpolation type, the ownership ranges and the quadrants themselves
+  in the global Morton ordering. The file layout is:
+
+  char[8]:           "TMRQUAD"
+  int32[6]:          version, mesh_order, interp_type, num_nodes,
+                     num_faces and the number of processors
+  int32[4*nfaces]:   the face to node connectivity
+  int64[nprocs+1]:   the quadrant ranges on each processor
+  TMRQuadrant[]:     the quadrants (face, x, y, tag, level, info)
+
+  All data is written in the native byte order using MPI/IO. The
+  mesh data (nodes, dependent nodes etc.) is not stored and must be
+  re-created after the forest is read. This is a collective call.
+*/
+int TMRQuadForest::writeCheckpoint( const char *filename ){
+  if (!fdata || !quadrants){
+    fprintf(stderr, "TMRQuadForest Error: Cannot call writeCheckpoint(), "
+            "the quadrants have not been created\n");
+    return 1;
+  }
+  const int num_faces = fdata->num_faces;
+
+  // Get the quadrants
+  int size;
+  TMRQuadrant *array;
+  quadrants->getArray(&array, &size);
+
+  // Compute the quadrant ranges on each processor
+  int64_t local_size = size;
+  int64_t *range = new int64_t[ mpi_size+1 ];
+  range[0] = 0;
+  MPI_Allgather(&local_size, 1, MPI_INT64_T,
+                &range[1], 1, MPI_INT64_T, comm);
+  for ( int i = 0; i < mpi_size; i++ ){
+    range[i+1] += range[i];
+  }
+
+  // Copy the filename to a non-const array
+  char *fname = new char[ strlen(filename)+1 ];
+  strcpy(fname, filename);
+
+  // Create the file, removing any existing contents
+  MPI_File fp = NULL;
+  int fail = 0;
+  if (MPI_File_open(comm, fname, MPI_MODE_WRONLY | MPI_MODE_CREATE,
+                    MPI_INFO_NULL, &fp) != MPI_SUCCESS){
+    fail = 1;
+  }
+  delete [] fname;
+  if (fail){
+    fprintf(stderr, "TMRQuadForest Error: Could not open file %s\n",
+            filename);
+    delete [] range;
+    return fail;
+  }
+  MPI_File_set_size(fp, 0);
+
+  // The offsets to the ranges and the quadrants within the file
+  MPI_Offset range_offset =
+    8 + (6 + 4*num_faces)*sizeof(int32_t);
+  MPI_Offset quad_offset =
+    range_offset + (mpi_size+1)*sizeof(int64_t);
+
+  // Write the header, connectivity and ranges from the root
+  if (mpi_rank == 0){
+    char magic[8] = "TMRQUAD";
+    int header[6];
+    header[0] = TMR_CHECKPOINT_VERSION;
+    header[1] = mesh_order;
+    header[2] = interp_type;
+    header[3] = fdata->num_nodes;
+    header[4] = num_faces;
+    header[5] = mpi_size;
+    MPI_File_write_at(fp, 0, magic, 8, MPI_CHAR, MPI_STATUS_IGNORE);
+    MPI_File_write_at(fp, 8, header, 6, MPI_INT, MPI_STATUS_IGNORE);
+    MPI_File_write_at(fp, 8 + 6*sizeof(int32_t), fdata->face_conn,
+                      4*num_faces, MPI_INT, MPI_STATUS_IGNORE);
+    MPI_File_write_at(fp, range_offset, range, mpi_size+1,
+                      MPI_INT64_T, MPI_STATUS_IGNORE);
+  }
+
+  // Write the quadrants in the global order
+  MPI_Offset offset = quad_offset + range[mpi_rank]*sizeof(TMRQuadrant);
+  MPI_File_write_at_all(fp, offset, array, size, TMRQuadrant_MPI_type,
+                        MPI_STATUS_IGNORE);
+  MPI_File_close(&fp);
+
+  delete [] range;
+
+  return fail;
+}
+
+/*
+  Read the forest from a checkpoint file written by writeCheckpoint()
+
+  If no connectivity has been set, the face connectivity is set from
+  the file. Otherwise the connectivity stored in the file must match
+  the existing connectivity. This allows the topology to be set before
+  the forest is restored so that the geometry is available.
+
+  When the file was written on the same number of processors, each
+  processor reads back its original quadrants. Otherwise the quadrants are
+  evenly repartitioned across the processors as they are read. Any
+  existing quadrants and mesh data are destroyed. This is a collective
+  call.
+*/
+int TMRQuadForest::readCheckpoint( const char *filename ){
+  // Copy the filename to a non-const array
+  char *fname = new char[ strlen(filename)+1 ];
+  strcpy(fname, filename);
+
+  // Open the file for reading
+  MPI_File fp = NULL;
+  int fail = 0;
+  if (MPI_File_open(comm, fname, MPI_MODE_RDONLY,
+                    MPI_INFO_NULL, &fp) != MPI_SUCCESS){
+    fail = 1;
+  }
+  delete [] fname;
+  if (fail){
+    fprintf(stderr, "TMRQuadForest Error: Could not open file %s\n",
+            filename);
+    return fail;
+  }
+
+  // Read and check the header
+  char magic[8];
+  int header[6];
+  memset(magic, 0, sizeof(magic));
+  memset(header, 0, sizeof(header));
+  MPI_File_read_at_all(fp, 0, magic, 8, MPI_CHAR, MPI_STATUS_IGNORE);
+  MPI_File_read_at_all(fp, 8, header, 6, MPI_INT, MPI_STATUS_IGNORE);
+  if (strncmp(magic, "TMRQUAD", 8) != 0 ||
+      header[0] != TMR_CHECKPOINT_VERSION ||
+      header[4] < 0 || header[5] <= 0){
+    fprintf(stderr, "TMRQuadForest Error: %s is not a valid "
+            "checkpoint file\n", filename);
+    MPI_File_close(&fp);
+    return 1;
+  }
+
+  int _mesh_order = header[1];
+  TMRInterpolationType _interp_type = (TMRInterpolationType)header[2];
+  int _num_nodes = header[3];
+  int num_faces = header[4];
+  int write_size = header[5];
+
+  // Read the face connectivity and set or check it
+  int *_face_conn = new int[ 4*num_faces ];
+  MPI_File_read_at_all(fp, 8 + 6*sizeof(int32_t), _face_conn,
+                       4*num_faces, MPI_INT, MPI_STATUS_IGNORE);
+  if (!fdata){
+    setConnectivity(_num_nodes, _face_conn, num_faces);
+  }
+  else if (fdata->num_faces != num_faces ||
+           memcmp(fdata->face_conn, _face_conn,
+                  4*num_faces*sizeof(int)) != 0){
+    fprintf(stderr, "TMRQuadForest Error: Face connectivity in %s "
+            "does not match the forest\n", filename);
+    fail = 1;
+  }
+  delete [] _face_conn;
+  if (fail){
+    MPI_File_close(&fp);
+    return fail;
+  }
+
+  // Read the ranges of the quadrants on the writing processors
+  int64_t *range = new int64_t[ write_size+1 ];
+  MPI_Offset range_offset =
+    8 + (6 + 4*num_faces)*sizeof(int32_t);
+  MPI_Offset quad_offset =
+    range_offset + (write_size+1)*sizeof(int64_t);
+  MPI_File_read_at_all(fp, range_offset, range, write_size+1,
+                       MPI_INT64_T, MPI_STATUS_IGNORE);
+
+  // Determine the range of quadrants to read on this processor. If the
+  // number of processors has changed, repartition the quadrants evenly.
+  int64_t start = 0, end = 0;
+  int reset_tags = 0;
+  if (write_size == mpi_size){
+    start = range[mpi_rank];
+    end = range[mpi_rank+1];
+  }
+  else {
+    int64_t total = range[write_size];
+    int64_t average_count = total/mpi_size;
+    int64_t remain = total - average_count*mpi_size;
+    start = mpi_rank*average_count;
+    end = (mpi_rank+1)*average_count;
+    if (mpi_rank < remain){
+      start += mpi_rank;
+      end += mpi_rank+1;
+    }
+    else {
+      start += remain;
+      end += remain;
+    }
+    reset_tags = 1;
+  }
+  delete [] range;
+
+  // Free all of the mesh data and set the mesh order
+  freeMeshData();
+  if (_mesh_order != mesh_order || _interp_type != interp_type){
+    setMeshOrder(_mesh_order, _interp_type);
+  }
+
+  // Read in the quadrants
+  int size = end - start;
+  TMRQuadrant *array = NULL;
+  if (size > 0){
+    array = new TMRQuadrant[ size ];
+  }
+  MPI_Offset offset = quad_offset + start*sizeof(TMRQuadrant);
+  MPI_File_read_at_all(fp, offset, array, size, TMRQuadrant_MPI_type,
+                       MPI_STATUS_IGNORE);
+  MPI_File_close(&fp);
+
+  // Set the local reordering for the elements
+  if (reset_tags){
+    for ( int i = 0; i < size; i++ ){
+      array[i].tag = i;
+    }
+  }
+
+  // Set the last quadrant
+  TMRQuadrant p;
+  p.face = num_faces-1;
+  p.tag = -1;
+  p.level = 0;
+  p.info = 0;
+  p.x = p.y = 1 << TMR_MAX_LEVEL;
+  if (size > 0){
+    p = array[0];
+  }
+
+  quadrants = new TMRQuadrantArray(array, size);
+
+  owners = new TMRQuadrant[ mpi_size ];
+  MPI_Allgather(&p, 1, TMRQuadrant_MPI_type,
+                owners, 1, TMRQuadrant_MPI_type, comm);
+
+  // Set the offsets if some of the processors have zero
+  // quadrants
+  for ( int k = 1; k < mpi_size; k++ ){
+    if (owners[k].tag == -1){
+      owners[k] = owners[k-1];
+    }
+  }
+
+  return fail;
+}
+
 /*
   Create a forest with the specified refinement level
 */
@@ -1341,18 +1832,20 @@ void TMRQuadForest::createRandomTrees( int nrand,
   This does not repartition the nodes. You have to recreate the nodes
   after this call so be careful.
 */
-void TMRQuadForest::repartition(){
-  const int num_faces = fdata->num_faces;
-
+void TMRQuadForest::repartition( int max_rank ){
   // Free everything but the quadrants
   freeMeshData(0);
 
+  // Adjust the rank of the maximum rank
+  if (max_rank <= 0 || max_rank > mpi_size){
+    max_rank = mpi_size;
+  }
+
   // First, this stores the number of elements on quadtrees owned on
   // each processor
   int *ptr = new int[ mpi_size+1 ];
   int size;
-  TMRQuadrant *array;
-  quadrants->getArray(&array, &size);
+  quadrants->getArray(NULL, &size);
 
   // Gather the sizes from all the arrays
   MPI_Allgather(&size, 1, MPI_INT, &ptr[1], 1, MPI_INT, comm);
@@ -1364,22 +1857,205 @@ void TMRQuadForest::repartition(){
   }
 
   // Compute the average size of the new counts
-  int average_count = ptr[mpi_size]/mpi_size;
-  int remain = ptr[mpi_size] - average_count*mpi_size;
+  int average_count = ptr[mpi_size]/max_rank;
+  int remain = ptr[mpi_size] - average_count*max_rank;
 
   // Figure out what goes where on the new distribution of quadrants
   int *new_ptr = new int[ mpi_size+1 ];
   new_ptr[0] = 0;
-  for ( int k = 0; k < mpi_size; k++ ){
+  for ( int k = 0; k < max_rank; k++ ){
     new_ptr[k+1] = new_ptr[k] + average_count;
     if (k < remain){
       new_ptr[k+1] += 1;
     }
   }
+  for ( int k = max_rank; k < mpi_size; k++ ){
+    new_ptr[k+1] = new_ptr[k];
+  }
+
+  // Move the quadrants to their new owners
+  repartitionQuadrants(ptr, new_ptr);
+
+  // Free the memory
+  delete [] ptr;
+  delete [] new_ptr;
+}
+
+/*
+  Repartition the quadrants across all processors based on a cost
+  associated with each element
+
+  The quadrants are split so that each of the first max_rank processors
+  owns a contiguous range of the Morton-ordered quadrants with nearly
+  equal total weight. The global weight offset of the local quadrants
+  is computed with a parallel prefix sum and each quadrant is assigned
+  to the processor whose weight interval contains its mid-point. This
+  preserves the ordering of the quadrants across processors.
+
+  The imbalance is the ratio of the maximum processor weight to the
+  average weight over all processors in the communicator. It is
+  computed for both the original and the new distribution of the
+  quadrants using the same processor count so that the two values can
+  be compared directly. A value of 1.0 indicates a perfectly balanced
+  partition. When max_rank < mpi_size, the best achievable value after
+  repartitioning is mpi_size/max_rank.
+
+  input:
+  weights:        the non-negative weight for each local quadrant
+  max_rank:       the number of processors to use
+
+  output:
+  imbalance:      the imbalance ratio before repartitioning
+  new_imbalance:  the imbalance ratio after repartitioning
+*/
+void TMRQuadForest::repartition( const double *weights, int max_rank,
+                                 double *imbalance, double *new_imbalance ){
+  // Adjust the rank of the maximum rank
+  if (max_rank <= 0 || max_rank > mpi_size){
+    max_rank = mpi_size;
+  }
+
+  int size;
+  quadrants->getArray(NULL, &size);
+
+  // Compute the local weight of all the quadrants
+  double local_weight = 0.0;
+  if (weights){
+    for ( int i = 0; i < size; i++ ){
+      if (weights[i] > 0.0){
+        local_weight += weights[i];
+      }
+    }
+  }
+  else {
+    local_weight = size;
+  }
+
+  // Find the total weight and the maximum weight on any processor
+  double total_weight = 0.0, max_weight = 0.0;
+  MPI_Allreduce(&local_weight, &total_weight, 1, MPI_DOUBLE,
+                MPI_SUM, comm);
+  MPI_Allreduce(&local_weight, &max_weight, 1, MPI_DOUBLE,
+                MPI_MAX, comm);
+
+  if (imbalance){
+    *imbalance = 1.0;
+    if (total_weight > 0.0){
+      *imbalance = mpi_size*max_weight/total_weight;
+    }
+  }
+
+  // If there is no weight information, partition by the element count
+  if (!weights || total_weight <= 0.0){
+    repartition(max_rank);
+    if (new_imbalance){
+      *new_imbalance = 1.0;
+      if (!weights && total_weight > 0.0){
+        // Compute the new imbalance based on the element count
+        quadrants->getArray(NULL, &size);
+        local_weight = size;
+        MPI_Allreduce(&local_weight, &max_weight, 1, MPI_DOUBLE,
+                      MPI_MAX, comm);
+        *new_imbalance = mpi_size*max_weight/total_weight;
+      }
+    }
+    return;
+  }
+
+  // Free everything but the quadrants
+  freeMeshData(0);
+
+  // Compute the weight of the quadrants on the lower ranks
+  double offset = 0.0;
+  MPI_Exscan(&local_weight, &offset, 1, MPI_DOUBLE, MPI_SUM, comm);
+  if (mpi_rank == 0){
+    offset = 0.0;
+  }
+
+  // Count up the number of quadrants and their weight destined for
+  // each processor
+  int *count = new int[ mpi_size ];
+  double *load = new double[ mpi_size ];
+  memset(count, 0, mpi_size*sizeof(int));
+  memset(load, 0, mpi_size*sizeof(double));
+
+  for ( int i = 0; i < size; i++ ){
+    double w = (weights[i] > 0.0 ? weights[i] : 0.0);
+
+    // Find the processor that contains the mid-point of this quadrant
+    double mid = offset + 0.5*w;
+    int rank = (int)(max_rank*(mid/total_weight));
+    if (rank < 0){ rank = 0; }
+    if (rank >= max_rank){ rank = max_rank-1; }
+
+    count[rank]++;
+    load[rank] += w;
+    offset += w;
+  }
+
+  // Sum the contributions across all processors
+  MPI_Allreduce(MPI_IN_PLACE, count, mpi_size, MPI_INT, MPI_SUM, comm);
+  MPI_Allreduce(MPI_IN_PLACE, load, mpi_size, MPI_DOUBLE, MPI_SUM, comm);
+
+  if (new_imbalance){
+    double max_load = 0.0;
+    for ( int k = 0; k < mpi_size; k++ ){
+      if (load[k] > max_load){
+        max_load = load[k];
+      }
+    }
+    *new_imbalance = mpi_size*max_load/total_weight;
+  }
+
+  // Gather the current sizes of all the arrays
+  int *ptr = new int[ mpi_size+1 ];
+  MPI_Allgather(&size, 1, MPI_INT, &ptr[1], 1, MPI_INT, comm);
+
+  // Set the current and new pointers into the global quadrant array
+  int *new_ptr = new int[ mpi_size+1 ];
+  ptr[0] = 0;
+  new_ptr[0] = 0;
+  for ( int k = 0; k < mpi_size; k++ ){
+    ptr[k+1] += ptr[k];
+    new_ptr[k+1] = new_ptr[k] + count[k];
+  }
+
+  // Move the quadrants to their new owners
+  repartitionQuadrants(ptr, new_ptr);
+
+  // Free the memory
+  delete [] count;
+  delete [] load;
+  delete [] ptr;
+  delete [] new_ptr;
+}
+
+/*
+  Move the quadrants from the current distribution to the new
+  distribution
+
+  Both distributions are described by pointers into the global
+  Morton-ordered array of quadrants such that processor k owns the
+  quadrants in the interval [ptr[k], ptr[k+1]).
+
+  input:
+  ptr:       the current distribution of quadrants
+  new_ptr:   the new distribution of quadrants
+*/
+void TMRQuadForest::repartitionQuadrants( const int *ptr,
+                                          const int *new_ptr ){
+  const int num_faces = fdata->num_faces;
+
+  int size;
+  TMRQuadrant *array;
+  quadrants->getArray(&array, &size);
 
   // Allocate the new array of quadrants
   int new_size = new_ptr[mpi_rank+1] - new_ptr[mpi_rank];
-  TMRQuadrant *new_array = new TMRQuadrant[ new_size ];
+  TMRQuadrant *new_array = NULL;
+  if (new_size > 0){
+    new_array = new TMRQuadrant[ new_size ];
+  }
 
   // Ptr:      |----|---|--------------------|-|
   // New ptr:  |-------|-------|-------|-------|
@@ -1457,10 +2133,6 @@ void TMRQuadForest::repartition(){
     }
   }
 
-  // Free the memory
-  delete [] ptr;
-  delete [] new_ptr;
-
   // Wait for any remaining sends to complete
   MPI_Waitall(send_count, send_requests, MPI_STATUSES_IGNORE);
   delete [] send_requests;
@@ -1480,14 +2152,15 @@ void TMRQuadForest::repartition(){
   delete quadrants;
   quadrants = new TMRQuadrantArray(new_array, new_size);
 
+  if (owners){ delete [] owners; }
   owners = new TMRQuadrant[ mpi_size ];
   MPI_Allgather(&q, 1, TMRQuadrant_MPI_type,
                 owners, 1, TMRQuadrant_MPI_type, comm);
 
   // Set the local reordering for the elements
-  quadrants->getArray(&new_array, &new_size);
-  for ( int i = 0; i < new_size; i++ ){
-    new_array[i].tag = i;
+  quadrants->getArray(&array, &size);
+  for ( int i = 0; i < size; i++ ){
+    array[i].tag = i;
   }
 }
 
@@ -3170,6 +3843,9 @@ void TMRQuadForest::createNodes(){
                             num_local_nodes, sizeof(int), compare_integers);
   ext_pre_offset = item - node_numbers;
 
+  // Create the hash table for the non-owned nodes
+  createNodeHash();
+
   // Evaluate the node locations
   evaluateNodeLocations();
 }
@@ -3884,36 +4560,66 @@ void TMRQuadForest::evaluateNodeLocations(){
   const double *knots = interp_knots;
 
   if (topo){
-    for ( int i = 0; i < num_elements; i++ ){
+    // Allocate space for the parametric locations of the nodes that
+    // are evaluated together on each face
+    double *uv = new double[ 2*num_local_nodes ];
+    int *index = new int[ num_local_nodes ];
+    TMRPoint *Xf = new TMRPoint[ num_local_nodes ];
+
+    // The quadrants are sorted by face, so loop over the range of
+    // quadrants within each face
+    for ( int start = 0; start < num_elements; ){
+      int end = start+1;
+      while (end < num_elements && quads[end].face == quads[start].face){
+        end++;
+      }
+
       // Get the right surface
       TMRFace *surf;
-      topo->getFace(quads[i].face, &surf);
-
-      // Compute the edge length
-      const int32_t h = 1 << (TMR_MAX_LEVEL - quads[i].level);
+      topo->getFace(quads[start].face, &surf);
 
-      // Compute the origin of the element in parametric space
-      // and the edge length of the element
-      double d = convert_to_coordinate(h);
-      double u = convert_to_coordinate(quads[i].x);
-      double v = convert_to_coordinate(quads[i].y);
+      // Collect the nodes that are not yet assigned
+      int n = 0;
+      for ( int i = start; i < end; i++ ){
+        // Compute the edge length
+        const int32_t h = 1 << (TMR_MAX_LEVEL - quads[i].level);
 
-      // Look for nodes that are not assigned
-      for ( int jj = 0; jj < mesh_order; jj++ ){
-        for ( int ii = 0; ii < mesh_order; ii++ ){
-          // Compute the mesh index
-          int node = conn[mesh_order*mesh_order*i +
-                          ii + jj*mesh_order];
-          int index = getLocalNodeNumber(node);
-          if (!flags[index]){
-            flags[index] = 1;
-            surf->evalPoint(u + 0.5*d*(1.0 + knots[ii]),
-                            v + 0.5*d*(1.0 + knots[jj]),
-                            &X[index]);
+        // Compute the origin of the element in parametric space
+        // and the edge length of the element
+        double d = convert_to_coordinate(h);
+        double u = convert_to_coordinate(quads[i].x);
+        double v = convert_to_coordinate(quads[i].y);
+
+        // Look for nodes that are not assigned
+        for ( int jj = 0; jj < mesh_order; jj++ ){
+          for ( int ii = 0; ii < mesh_order; ii++ ){
+            // Compute the mesh index
+            int node = conn[mesh_order*mesh_order*i +
+                            ii + jj*mesh_order];
+            int local = getLocalNodeNumber(node);
+            if (!flags[local]){
+              flags[local] = 1;
+              uv[2*n] = u + 0.5*d*(1.0 + knots[ii]);
+              uv[2*n+1] = v + 0.5*d*(1.0 + knots[jj]);
+              index[n] = local;
+              n++;
+            }
           }
         }
       }
+
+      // Evaluate all the points on this face at once
+      surf->evalPoints(n, uv, Xf);
+      for ( int i = 0; i < n; i++ ){
+        X[index[i]] = Xf[i];
+      }
+
+      start = end;
     }
+
+    delete [] uv;
+    delete [] index;
+    delete [] Xf;
   }
 
   delete [] flags;
@@ -4244,6 +4950,122 @@ TMRQuadrant* TMRQuadForest::findEnclosing( const int order,
                                            const double *knots,
                                            TMRQuadrant *node,
                                            int *mpi_owner ){
+  // Retrieve the array of elements
+  int size = 0;
+  TMRQuadrant *array = NULL;
+  quadrants->getArray(&array, &size);
+
+  // Set the low and high indices to the first and last
+  // element of the element array
+  int low = 0;
+  int high = size-1;
+  int mid = low + (high - low)/2;
+
+  // Maintain values of low/high and mid such that the octant is
+  // between (elems[low], elems[high]).  Note that if high-low=1, then
+  // mid = low
+  while (mid != low){
+    // Check if the node is contained by the mid octant
+    if (array[mid].contains(node)){
+      break;
+    }
+
+    // Compare the ordering of the two octants - if the octant is less
+    // than the other, then adjust the mid point
+    int stat = array[mid].comparePosition(node);
+
+    // array[mid] ? node
+    if (stat == 0){
+      break;
+    }
+    else if (stat < 0){
+      low = mid+1;
+    }
+    else {
+      high = mid-1;
+    }
+
+    // Re compute the mid-point and repeat
+    mid = low + (int)((high - low)/2);
+  }
+
+  int index = findEnclosingFrom(order, knots, node, mid, mpi_owner);
+  if (index >= 0){
+    return &array[index];
+  }
+
+  // No quadrant was found, return NULL
+  return NULL;
+}
+
+/*
+  Find the quadrants enclosing an array of nodes
+
+  This performs the same search as findEnclosing for each node, but
+  the nodes are first sorted by their Morton position so that the
+  starting point for each search is found in a single sweep through
+  the local quadrants. The input array of nodes is not modified.
+
+  input:
+  order:       the order of the node mesh
+  knots:       the knots for the node mesh
+  n:           the number of nodes
+  nodes:       the nodes (element quadrants with info = node index)
+
+  output:
+  quad_index:  the index of the enclosing local quadrant (or -1)
+  mpi_owner:   (optional) the owner of the node when not found
+*/
+void TMRQuadForest::findEnclosing( const int order,
+                                   const double *knots,
+                                   int n, TMRQuadrant *nodes,
+                                   int *quad_index,
+                                   int *mpi_owner ){
+  // Retrieve the array of elements
+  int size = 0;
+  TMRQuadrant *array = NULL;
+  quadrants->getArray(&array, &size);
+
+  // Sort a copy of the nodes, storing the original index in the tag
+  TMRQuadrant *sorted = new TMRQuadrant[ n ];
+  memcpy(sorted, nodes, n*sizeof(TMRQuadrant));
+  for ( int i = 0; i < n; i++ ){
+    sorted[i].tag = i;
+  }
+  qsort(sorted, n, sizeof(TMRQuadrant), compare_quadrant_position);
+
+  int start = 0;
+  for ( int i = 0; i < n; i++ ){
+    // Advance to the last quadrant that is not after the node
+    while (start+1 < size &&
+           array[start+1].comparePosition(&sorted[i]) <= 0){
+      start++;
+    }
+
+    const int index = sorted[i].tag;
+    if (mpi_owner){
+      quad_index[index] = findEnclosingFrom(order, knots, &sorted[i],
+                                            start, &mpi_owner[index]);
+    }
+    else {
+      quad_index[index] = findEnclosingFrom(order, knots, &sorted[i],
+                                            start, NULL);
+    }
+  }
+
+  delete [] sorted;
+}
+
+/*
+  Search the local quadrants for the quadrant enclosing the node,
+  starting from the given index in the quadrant array. If no quadrant
+  is found, the MPI owner of the node is computed and -1 is returned.
+*/
+int TMRQuadForest::findEnclosingFrom( const int order,
+                                      const double *knots,
+                                      TMRQuadrant *node,
+                                      int start,
+                                      int *mpi_owner ){
   // Assume that we'll find octant on this processor for now..
   if (mpi_owner){
     *mpi_owner = mpi_rank;
@@ -4284,40 +5106,6 @@ TMRQuadrant* TMRQuadForest::findEnclosing( const int order,
   const double xd = node->x + 0.5*h*(1.0 + knots[ii]);
   const double yd = node->y + 0.5*h*(1.0 + knots[jj]);
 
-  // Set the low and high indices to the first and last
-  // element of the element array
-  int low = 0;
-  int high = size-1;
-  int mid = low + (high - low)/2;
-
-  // Maintain values of low/high and mid such that the octant is
-  // between (elems[low], elems[high]).  Note that if high-low=1, then
-  // mid = low
-  while (mid != low){
-    // Check if the node is contained by the mid octant
-    if (array[mid].contains(node)){
-      break;
-    }
-
-    // Compare the ordering of the two octants - if the octant is less
-    // than the other, then adjust the mid point
-    int stat = array[mid].comparePosition(node);
-
-    // array[mid] ? node
-    if (stat == 0){
-      break;
-    }
-    else if (stat < 0){
-      low = mid+1;
-    }
-    else {
-      high = mid-1;
-    }
-
-    // Re compute the mid-point and repeat
-    mid = low + (int)((high - low)/2);
-  }
-
   // Compute the bounding quadrant. Quadrants greater than this quad
   // cannot own the node so a further search is futile.
   TMRQuadrant quad;
@@ -4325,6 +5113,7 @@ TMRQuadrant* TMRQuadForest::findEnclosing( const int order,
   quad.x = node->x + h;
   quad.y = node->y + h;
 
+  int mid = start;
   while (mid < size && array[mid].comparePosition(&quad) <= 0){
     // Check if array[mid] contains the provided octant
     const int32_t hm = 1 << (TMR_MAX_LEVEL - array[mid].level);
@@ -4349,7 +5138,7 @@ TMRQuadrant* TMRQuadForest::findEnclosing( const int order,
 
       // If all the intervals are satisfied, return the array
       if (xinterval && yinterval){
-        return &array[mid];
+        return mid;
       }
     }
     mid++;
@@ -4369,8 +5158,8 @@ TMRQuadrant* TMRQuadForest::findEnclosing( const int order,
     *mpi_owner = getQuadrantMPIOwner(&n);
   }
 
-  // No quadrant was found, return NULL
-  return NULL;
+  // No quadrant was found
+  return -1;
 }
 
 /*
@@ -4560,6 +5349,43 @@ int TMRQuadForest::computeElemInterp( TMRQuadrant *node,
   return nweights;
 }
 
+/*
+  Create an empty interpolation cache
+*/
+TMRQuadInterpCache::TMRQuadInterpCache(){
+  fine_order = coarse_order = 0;
+  interp_type = TMR_GAUSS_LOBATTO_POINTS;
+  num_fine = num_coarse = 0;
+  fine = coarse = NULL;
+  enclosing = NULL;
+  num_hits = num_misses = 0;
+}
+
+/*
+  Free the interpolation cache
+*/
+TMRQuadInterpCache::~TMRQuadInterpCache(){
+  if (fine){ delete [] fine; }
+  if (coarse){ delete [] coarse; }
+  if (enclosing){ delete [] enclosing; }
+}
+
+/*
+  Get the number of interpolation rows on this processor that were
+  found in the cache, and that had to be searched for
+*/
+void TMRQuadInterpCache::getStatistics( int *_num_hits, int *_num_misses ){
+  if (_num_hits){ *_num_hits = num_hits; }
+  if (_num_misses){ *_num_misses = num_misses; }
+}
+
+/*
+  Reset the cache statistics
+*/
+void TMRQuadInterpCache::resetStatistics(){
+  num_hits = num_misses = 0;
+}
+
 /*
   Create the interpolation operator from the coarse to the fine mesh.
 
@@ -4567,8 +5393,15 @@ int TMRQuadForest::computeElemInterp( TMRQuadrant *node,
   in the mesh. This interpolation will refer to other nodes, but the
   output is local.
 
+  If a cache is provided, the coarse quadrant enclosing each fine node
+  is taken from the cache when both the fine quadrant and the coarse
+  quadrant are unchanged since the last call, otherwise the coarse
+  forest is searched. The cache is then updated for this pair of
+  forests.
+
   input:
   coarse:   the coarse quadtree forest that has the same layout as this
+  cache:    (optional) the cache of enclosing coarse quadrants
 
   output:
   ptr:      the pointer into the local rows
@@ -4576,7 +5409,8 @@ int TMRQuadForest::computeElemInterp( TMRQuadrant *node,
   weights:  the interpolation weights for each point
 */
 void TMRQuadForest::createInterpolation( TMRQuadForest *coarse,
-                                         TACSBVecInterp *interp ){
+                                         TACSBVecInterp *interp,
+                                         TMRQuadInterpCache *cache ){
   // Ensure that the nodes are allocated on both octree forests
   createNodes();
   coarse->createNodes();
@@ -4618,6 +5452,41 @@ void TMRQuadForest::createInterpolation( TMRQuadForest *coarse,
   // Set the knots to use in the interpolation
   const double *knots = interp_knots;
 
+  // Get the coarse quadrants
+  int num_coarse;
+  TMRQuadrant *coarse_quads;
+  coarse->quadrants->getArray(&coarse_quads, &num_coarse);
+
+  // Match the quadrants against the cached quadrants. The quadrant
+  // arrays are sorted so this takes a single pass over each array.
+  int *fine_cached = NULL;
+  int *coarse_index = NULL;
+  int *enclosing = NULL;
+  if (cache){
+    enclosing = new int[ nodes_per_element*num_elements ];
+    for ( int i = 0; i < nodes_per_element*num_elements; i++ ){
+      enclosing[i] = -1;
+    }
+
+    if (cache->enclosing &&
+        cache->fine_order == mesh_order &&
+        cache->coarse_order == coarse->mesh_order &&
+        cache->interp_type == interp_type){
+      fine_cached = new int[ num_elements ];
+      match_quadrants(num_elements, quads,
+                      cache->num_fine, cache->fine, fine_cached);
+      coarse_index = new int[ cache->num_coarse ];
+      match_quadrants(cache->num_coarse, cache->coarse,
+                      num_coarse, coarse_quads, coarse_index);
+    }
+  }
+
+  // The owned nodes that must be searched for in the coarse forest
+  // and their location (element index*nodes_per_element + node)
+  int num_search = 0;
+  TMRQuadrant *search = new TMRQuadrant[ local_size ];
+  int *search_loc = new int[ local_size ];
+
   for ( int i = 0; i < num_elements; i++ ){
     const int *c = &conn[nodes_per_element*i];
     for ( int j = 0; j < nodes_per_element; j++ ){
@@ -4628,43 +5497,103 @@ void TMRQuadForest::createInterpolation( TMRQuadForest *coarse,
         if (!flags[index]){
           // We're going to handle this node now, mark it as done
           flags[index] = 1;
-          
-          // Find the enclosing coarse quad on this
-          // processor if it exits
+
           TMRQuadrant node = quads[i];
           node.info = j;
-          
-          // Find the MPI owner or the
-          int mpi_owner = mpi_rank;
-          TMRQuadrant *t = coarse->findEnclosing(mesh_order, knots,
-                                                 &node, &mpi_owner);
-
-          // The node is owned a coarse element on this processor
-          if (t){
-            // Compute the element interpolation
-            int nweights = computeElemInterp(&node, coarse, t, weights, tmp);
-
-            for ( int k = 0; k < nweights; k++ ){
-              vars[k] = weights[k].index;
-              wvals[k] = weights[k].weight;             
+
+          // Check whether the enclosing quadrant is in the cache
+          if (fine_cached && fine_cached[i] >= 0){
+            int k = cache->enclosing[nodes_per_element*fine_cached[i] + j];
+            if (k >= 0 && coarse_index[k] >= 0){
+              TMRQuadrant *t = &coarse_quads[coarse_index[k]];
+              enclosing[nodes_per_element*i + j] = coarse_index[k];
+              cache->num_hits++;
+
+              // Compute the element interpolation
+              int nweights = computeElemInterp(&node, coarse, t,
+                                               weights, tmp);
+
+              for ( int kk = 0; kk < nweights; kk++ ){
+                vars[kk] = weights[kk].index;
+                wvals[kk] = weights[kk].weight;
+              }
+              interp->addInterp(c[j], wvals, vars, nweights);
+              continue;
             }
-            interp->addInterp(c[j], wvals, vars, nweights);
-          }
-          else {
-            // We've got to transfer the node to the processor that
-            // owns an enclosing element. To do that, add the quad to
-            // the list of externals and store its mpi owner
-            node.tag = mpi_owner;
-            ext_queue->push(&node);
           }
+
+          // Add the node to the list to search for
+          search[num_search] = node;
+          search_loc[num_search] = nodes_per_element*i + j;
+          num_search++;
         }
       }
     }
   }
 
+  // Find the enclosing coarse quadrants on this processor, or the
+  // MPI owners of the nodes, in a single sweep over the coarse quads
+  int *search_index = new int[ num_search ];
+  int *search_owner = new int[ num_search ];
+  coarse->findEnclosing(mesh_order, knots, num_search, search,
+                        search_index, search_owner);
+
+  for ( int i = 0; i < num_search; i++ ){
+    // The node is owned a coarse element on this processor
+    if (search_index[i] >= 0){
+      TMRQuadrant *t = &coarse_quads[search_index[i]];
+      if (enclosing){
+        enclosing[search_loc[i]] = search_index[i];
+        cache->num_misses++;
+      }
+
+      // Compute the element interpolation
+      int nweights = computeElemInterp(&search[i], coarse, t,
+                                       weights, tmp);
+
+      for ( int k = 0; k < nweights; k++ ){
+        vars[k] = weights[k].index;
+        wvals[k] = weights[k].weight;
+      }
+      interp->addInterp(conn[search_loc[i]], wvals, vars, nweights);
+    }
+    else {
+      // We've got to transfer the node to the processor that
+      // owns an enclosing element. To do that, add the quad to
+      // the list of externals and store its mpi owner
+      search[i].tag = search_owner[i];
+      ext_queue->push(&search[i]);
+    }
+  }
+
+  delete [] search;
+  delete [] search_loc;
+  delete [] search_index;
+  delete [] search_owner;
+
   // Free the data
   delete [] flags;
 
+  // Update the cache with the quadrants for this pair of forests
+  if (cache){
+    if (fine_cached){ delete [] fine_cached; }
+    if (coarse_index){ delete [] coarse_index; }
+    if (cache->fine){ delete [] cache->fine; }
+    if (cache->coarse){ delete [] cache->coarse; }
+    if (cache->enclosing){ delete [] cache->enclosing; }
+
+    cache->fine_order = mesh_order;
+    cache->coarse_order = coarse->mesh_order;
+    cache->interp_type = interp_type;
+    cache->num_fine = num_elements;
+    cache->fine = new TMRQuadrant[ num_elements ];
+    memcpy(cache->fine, quads, num_elements*sizeof(TMRQuadrant));
+    cache->num_coarse = num_coarse;
+    cache->coarse = new TMRQuadrant[ num_coarse ];
+    memcpy(cache->coarse, coarse_quads, num_coarse*sizeof(TMRQuadrant));
+    cache->enclosing = enclosing;
+  }
+
   // Sort the sending quadrants by MPI rank
   TMRQuadrantArray *ext_array = ext_queue->toArray();
   delete ext_queue;
@@ -4731,11 +5660,18 @@ void TMRQuadForest::createInterpolation( TMRQuadForest *coarse,
   TMRQuadrant *recv_nodes;
   recv_array->getArray(&recv_nodes, &recv_size);
 
+  // Find the enclosing quadrants for the recv'd nodes
+  int *recv_index = new int[ recv_size ];
+  coarse->findEnclosing(mesh_order, knots, recv_size, recv_nodes,
+                        recv_index);
+  if (cache){
+    cache->num_misses += recv_size;
+  }
+
   // Recv the nodes and loop over the connectivity
   for ( int i = 0; i < recv_size; i++ ){
-    TMRQuadrant *t = coarse->findEnclosing(mesh_order, knots,
-                                           &recv_nodes[i]);
-    if (t){
+    if (recv_index[i] >= 0){
+      TMRQuadrant *t = &coarse_quads[recv_index[i]];
       // Compute the element interpolation
       int nweights = computeElemInterp(&recv_nodes[i], coarse, t,
                                        weights, tmp);
@@ -4754,6 +5690,7 @@ void TMRQuadForest::createInterpolation( TMRQuadForest *coarse,
   }
  
   // Free the recv array
+  delete [] recv_index;
   delete recv_array;
 
   // Free the temporary arrays
@@ -25,6 +25,45 @@
 #include "TMRQuadrant.h"
 #include "BVecInterp.h"
 
+/*
+  Cache of the coarse quadrants used to interpolate the nodes of a
+  fine forest
+
+  The cache records, for each node of each element in the fine forest,
+  the local coarse quadrant that was used to compute its row of the
+  interpolation operator. When the interpolation is created between a
+  new pair of forests, their quadrant arrays are matched against the
+  cached arrays. Only the rows for fine quadrants that were refined,
+  coarsened or migrated, or whose coarse quadrant no longer exists on
+  this processor, require a search of the coarse forest.
+*/
+class TMRQuadInterpCache : public TMREntity {
+ public:
+  TMRQuadInterpCache();
+  ~TMRQuadInterpCache();
+
+  // Get/reset the number of rows found in or missing from the cache
+  void getStatistics( int *_num_hits, int *_num_misses );
+  void resetStatistics();
+
+ private:
+  friend class TMRQuadForest;
+
+  // The mesh orders and interpolation for which the cache is valid
+  int fine_order, coarse_order;
+  TMRInterpolationType interp_type;
+
+  // The sorted fine and coarse quadrant arrays from the last call
+  int num_fine, num_coarse;
+  TMRQuadrant *fine, *coarse;
+
+  // The index of the coarse quadrant for each fine node (or -1)
+  int *enclosing;
+
+  // The number of rows found in/missing from the cache
+  int num_hits, num_misses;
+};
+
 /*
   A parallel forest of quadtrees
 
@@ -74,9 +113,12 @@ class TMRQuadForest : public TMREntity {
   int getMeshOrder();
   TMRInterpolationType getInterpType();
 
-  // Re-partition the quadtrees based on element count
-  // -------------------------------------------------
-  void repartition();
+  // Re-partition the quadtrees based on element count or weight
+  // -----------------------------------------------------------
+  void repartition( int max_rank=-1 );
+  void repartition( const double *weights, int max_rank=-1,
+                    double *imbalance=NULL,
+                    double *new_imbalance=NULL );
 
   // Create the forest of quadtrees
   // ----------------------------
@@ -84,6 +126,11 @@ class TMRQuadForest : public TMREntity {
   void createRandomTrees( int nrand=10,
                           int min_level=0, int max_level=8 );
 
+  // Write/read the forest to/from a parallel checkpoint file
+  // --------------------------------------------------------
+  int writeCheckpoint( const char *filename );
+  int readCheckpoint( const char *filename );
+
   // Duplicate or coarsen the forest
   // -------------------------------
   TMRQuadForest *duplicate();
@@ -115,7 +162,8 @@ class TMRQuadForest : public TMREntity {
   // Create interpolation/restriction operators
   // ------------------------------------------
   void createInterpolation( TMRQuadForest *coarse,
-                            TACSBVecInterp *interp );
+                            TACSBVecInterp *interp,
+                            TMRQuadInterpCache *cache=NULL );
 
   // Get the nodes or elements with a certain name
   // ---------------------------------------------
@@ -132,7 +180,11 @@ class TMRQuadForest : public TMREntity {
   int getNodeNumbers( const int **_node_numbers );
   int getPoints( TMRPoint **_X );
   int getLocalNodeNumber( int node );
+  void getLocalNodeNumbers( int size, const int *nodes,
+                            int *local_nodes );
   int getInterpKnots( const double **_knots );
+  void evalInterp1D( int npts, const double u[], double N[],
+                     double Nd[]=NULL );
   void evalInterp( const double pt[], double N[] );
   void evalInterp( const double pt[], double N[],
                    double N1[], double N2[] );
@@ -154,6 +206,9 @@ class TMRQuadForest : public TMREntity {
   // ------------------------------------------
   TMRQuadrant* findEnclosing( const int order, const double *knots,
                               TMRQuadrant *node, int *mpi_owner=NULL );
+  void findEnclosing( const int order, const double *knots,
+                      int n, TMRQuadrant *nodes, int *quad_index,
+                      int *mpi_owner=NULL );
 
   // Distribute the quadrant array
   // -----------------------------
@@ -173,6 +228,7 @@ class TMRQuadForest : public TMREntity {
   void writeToVTK( const char *filename );
   void writeToTecplot( const char *filename );
   void writeForestToVTK( const char *filename );
+  int writeForestToVTU( const char *filename );
   void writeAdjacentToVTK( const char *filename );
 
  private:
@@ -196,9 +252,16 @@ class TMRQuadForest : public TMREntity {
   // Compute the faces that own the edges and nodes
   void computeFaceOwners();
 
+  // Move the quadrants from one distribution to another
+  void repartitionQuadrants( const int *ptr, const int *new_ptr );
+
   // Get the quadrant owner
   int getQuadrantMPIOwner( TMRQuadrant *quad );
 
+  // Search for the enclosing quadrant starting from the given index
+  int findEnclosingFrom( const int order, const double *knots,
+                         TMRQuadrant *node, int start, int *mpi_owner );
+
   // match the ownership intervals
   void matchQuadrantIntervals( TMRQuadrant *array,
                                int size, int *ptr );
@@ -263,6 +326,9 @@ class TMRQuadForest : public TMREntity {
                             TMRQuadrantArray *nodes,
                             const int *node_offset );
 
+  // Create the hash table used to find the non-owned local nodes
+  void createNodeHash();
+
   // Compute the node locations
   void evaluateNodeLocations();
 
@@ -304,6 +370,11 @@ class TMRQuadForest : public TMREntity {
   int num_owned_nodes; // Number of nodes that are owned by me
   int ext_pre_offset; // Number of nodes before pre
 
+  // Hash table of the local indices of the dependent and external
+  // nodes (the owned nodes are found directly)
+  int node_hash_size;
+  int *node_hash;
+
   // The dependent node information
   int *dep_ptr, *dep_conn;
   double *dep_weights;
@@ -20,6 +20,7 @@
 
 #include "TMRQuadrant.h"
 #include "TMRHashFunction.h"
+#include <algorithm>
 
 /*
   Get the child id of the quadrant
@@ -219,6 +220,52 @@ int TMRQuadrant::contains( TMRQuadrant *quad ){
   return 0;
 }
 
+/*
+  Spread the 32 bits of the input so that they occupy every second bit
+  of the output
+*/
+static inline uint64_t spread_bits2( uint32_t v ){
+  uint64_t u = v;
+  u = (u | u << 16) & 0x0000ffff0000ffffULL;
+  u = (u | u << 8) & 0x00ff00ff00ff00ffULL;
+  u = (u | u << 4) & 0x0f0f0f0f0f0f0f0fULL;
+  u = (u | u << 2) & 0x3333333333333333ULL;
+  u = (u | u << 1) & 0x5555555555555555ULL;
+  return u;
+}
+
+/*
+  Compute the Morton key for the quadrant
+
+  The key consists of two words that are compared in order as
+  unsigned integers. The first word contains the face and the most
+  significant 32 bits of the 64-bit Morton code formed by interleaving
+  the bits of x and y (with x the most significant). The second word
+  contains the remaining 32 bits of the Morton code in bits 32 to 63
+  and the level (or the info when use_node_index is true) in bits 16
+  to 31. The remaining bits are zero.
+
+  The signed values are offset so that comparing the keys gives the
+  same ordering as compare() or compareNode().
+*/
+void TMRQuadrant::getMortonKey( uint64_t key[], int use_node_index ) const {
+  const uint32_t offset = 1U << 31;
+  uint32_t u = offset ^ face;
+  uint32_t xu = offset ^ x;
+  uint32_t yu = offset ^ y;
+
+  uint64_t m = (spread_bits2(xu) << 1) | spread_bits2(yu);
+
+  key[0] = ((uint64_t)u << 32) | (m >> 32);
+  key[1] = m << 32;
+  if (use_node_index){
+    key[1] |= (uint64_t)(uint16_t)(0x8000 ^ info) << 16;
+  }
+  else {
+    key[1] |= (uint64_t)(uint16_t)(0x8000 ^ level) << 16;
+  }
+}
+
 /*
   Compare two quadrants within the same sub-tree
 */
@@ -249,6 +296,133 @@ static int compare_nodes( const void *a, const void *b ){
   return ao->compareNode(bo);
 }
 
+/*
+  Compare quadrants or nodes for use with std::sort
+*/
+class TMRQuadrantLess {
+ public:
+  bool operator()( const TMRQuadrant& a, const TMRQuadrant& b ) const {
+    return a.compare(&b) < 0;
+  }
+};
+
+class TMRQuadrantNodeLess {
+ public:
+  bool operator()( const TMRQuadrant& a, const TMRQuadrant& b ) const {
+    return a.compareNode(&b) < 0;
+  }
+};
+
+/*
+  Sort an array of quadrants based on the Morton key
+
+  Short arrays are sorted in place using std::sort. Longer arrays are
+  sorted with a least-significant-digit radix sort on the Morton key
+  using 8-bit digits. The original index of each quadrant is carried
+  along with the keys so that the quadrants can be permuted once the
+  keys are in order. Digits that are the same for all quadrants are
+  skipped.
+*/
+static void sort_quadrants( TMRQuadrant *array, int size,
+                            int use_node_index ){
+  // Use std::sort for short arrays
+  const int min_radix_sort_size = 256;
+  if (size < min_radix_sort_size){
+    if (use_node_index){
+      std::sort(array, array + size, TMRQuadrantNodeLess());
+    }
+    else {
+      std::sort(array, array + size, TMRQuadrantLess());
+    }
+    return;
+  }
+
+  // The digits to sort, from the least to most significant
+  const int num_digits = 14;
+  int digit_word[num_digits], digit_shift[num_digits];
+  for ( int k = 0; k < 6; k++ ){
+    digit_word[k] = 1;
+    digit_shift[k] = 16 + 8*k;
+  }
+  for ( int k = 0; k < 8; k++ ){
+    digit_word[6+k] = 0;
+    digit_shift[6+k] = 8*k;
+  }
+
+  // Compute the keys and the histograms for all digits at once
+  uint64_t *keys = new uint64_t[ 2*size ];
+  uint64_t *temp = new uint64_t[ 2*size ];
+  int *index = new int[ size ];
+  int *temp_index = new int[ size ];
+  int *count = new int[ 256*num_digits ];
+  memset(count, 0, 256*num_digits*sizeof(int));
+
+  for ( int i = 0; i < size; i++ ){
+    uint64_t *key = &keys[2*i];
+    array[i].getMortonKey(key, use_node_index);
+    index[i] = i;
+
+    for ( int k = 0; k < num_digits; k++ ){
+      count[256*k + ((key[digit_word[k]] >> digit_shift[k]) & 0xff)]++;
+    }
+  }
+
+  // Scatter the keys based on each digit in turn
+  for ( int k = 0; k < num_digits; k++ ){
+    int *c = &count[256*k];
+
+    // Skip this digit if it is the same for all quadrants
+    int nonzero = 0;
+    for ( int j = 0; j < 256; j++ ){
+      if (c[j] > 0){
+        nonzero++;
+      }
+    }
+    if (nonzero <= 1){
+      continue;
+    }
+
+    // Convert the counts to offsets
+    for ( int j = 0, offset = 0; j < 256; j++ ){
+      int tmp = c[j];
+      c[j] = offset;
+      offset += tmp;
+    }
+
+    const int word = digit_word[k];
+    const int shift = digit_shift[k];
+    for ( int i = 0; i < size; i++ ){
+      const uint64_t *key = &keys[2*i];
+      int loc = c[(key[word] >> shift) & 0xff]++;
+      temp[2*loc] = key[0];
+      temp[2*loc+1] = key[1];
+      temp_index[loc] = index[i];
+    }
+
+    // Swap the key and index arrays
+    uint64_t *tmp = keys;
+    keys = temp;
+    temp = tmp;
+    int *itmp = index;
+    index = temp_index;
+    temp_index = itmp;
+  }
+
+  // Permute the quadrants into the sorted order
+  TMRQuadrant *sorted = new TMRQuadrant[ size ];
+  for ( int i = 0; i < size; i++ ){
+    sorted[i] = array[index[i]];
+  }
+  memcpy(array, sorted, size*sizeof(TMRQuadrant));
+
+  delete [] sorted;
+  delete [] count;
+  delete [] keys;
+  delete [] temp;
+  delete [] index;
+  delete [] temp_index;
+}
+
 /*
   Store a array of quadrants
 */
@@ -287,7 +461,7 @@ TMRQuadrantArray* TMRQuadrantArray::duplicate(){
 */
 void TMRQuadrantArray::sort(){
   if (use_node_index){
-    qsort(array, size, sizeof(TMRQuadrant), compare_nodes);
+    sort_quadrants(array, size, use_node_index);
 
     // Now that the Quadrants are sorted, remove duplicates
     int i = 0; // Location from which to take entries
@@ -308,7 +482,7 @@ void TMRQuadrantArray::sort(){
     size = j;
   }
   else {
-    qsort(array, size, sizeof(TMRQuadrant), compare_quadrants);
+    sort_quadrants(array, size, use_node_index);
 
     // Now that the Quadrants are sorted, remove duplicates
     int i = 0; // Location from which to take entries
@@ -447,20 +621,17 @@ void TMRQuadrantArray::getArray( TMRQuadrant **_array, int *_size ){
   Create an queue of quadrants
 */
 TMRQuadrantQueue::TMRQuadrantQueue(){
-  root = tip = NULL;
   num_elems = 0;
+  head = 0;
+  max_size = min_queue_size;
+  array = new TMRQuadrant[ max_size ];
 }
 
 /*
   Free the queue
 */
 TMRQuadrantQueue::~TMRQuadrantQueue(){
-  QuadQueueNode *node = root;
-  while (node){
-    QuadQueueNode *tmp = node;
-    node = node->next;
-    delete tmp;
-  }
+  delete [] array;
 }
 
 /*
@@ -470,20 +641,34 @@ int TMRQuadrantQueue::length(){
   return num_elems;
 }
 
+/*
+  Copy the entries from the ring buffer, in queue order, to the
+  destination array
+*/
+void TMRQuadrantQueue::copyEntries( TMRQuadrant *dest ){
+  int len = max_size - head;
+  if (len > num_elems){
+    len = num_elems;
+  }
+  memcpy(dest, &array[head], len*sizeof(TMRQuadrant));
+  memcpy(&dest[len], array, (num_elems - len)*sizeof(TMRQuadrant));
+}
+
 /*
   Push a value onto the quadrant queue
 */
 void TMRQuadrantQueue::push( TMRQuadrant *quad ){
-  if (!tip){
-    root = new QuadQueueNode();
-    root->quad = *quad;
-    tip = root;
-  }
-  else {
-    tip->next = new QuadQueueNode();
-    tip->next->quad = *quad;
-    tip = tip->next;
+  if (num_elems >= max_size){
+    // Double the size of the buffer and unwrap the entries
+    TMRQuadrant *temp = new TMRQuadrant[ 2*max_size ];
+    copyEntries(temp);
+    delete [] array;
+    array = temp;
+    head = 0;
+    max_size *= 2;
   }
+
+  array[(head + num_elems) & (max_size-1)] = *quad;
   num_elems++;
 }
 
@@ -491,16 +676,13 @@ void TMRQuadrantQueue::push( TMRQuadrant *quad ){
   Pop a value from the quadrant queue
 */
 TMRQuadrant TMRQuadrantQueue::pop(){
-  if (!root){
+  if (num_elems == 0){
     return TMRQuadrant();
   }
   else {
+    TMRQuadrant temp = array[head];
+    head = (head + 1) & (max_size-1);
     num_elems--;
-    TMRQuadrant temp = root->quad;
-    QuadQueueNode *tmp = root;
-    root = root->next;
-    delete tmp;
-    if (num_elems == 0){ tip = NULL; }
     return temp;
   }
 }
@@ -509,20 +691,12 @@ TMRQuadrant TMRQuadrantQueue::pop(){
   Convert the queue to an array
 */
 TMRQuadrantArray* TMRQuadrantQueue::toArray(){
-  // Allocate the array
-  TMRQuadrant *array = new TMRQuadrant[ num_elems ];
-
-  // Scan through the queue and retrieve the quadrants
-  QuadQueueNode *node = root;
-  int index = 0;
-  while (node){
-    array[index] = node->quad;
-    node = node->next;
-    index++;
-  }
+  // Allocate the array and copy over the quadrants in order
+  TMRQuadrant *arr = new TMRQuadrant[ num_elems ];
+  copyEntries(arr);
 
   // Create the array object
-  TMRQuadrantArray *list = new TMRQuadrantArray(array, num_elems);
+  TMRQuadrantArray *list = new TMRQuadrantArray(arr, num_elems);
   return list;
 }
 
@@ -531,56 +705,42 @@ TMRQuadrantArray* TMRQuadrantQueue::toArray(){
 
   Note that this isn't a true hash table since it does not associate
   elements with other values. It is used to create unique lists of
-  elements and nodes within the quadree mesh.
+  elements and nodes within the quadtree mesh.
 */
 TMRQuadrantHash::TMRQuadrantHash( int _use_node_index ){
   use_node_index = _use_node_index;
+
+  // Allocate the contiguous array of quadrants
   num_elems = 0;
-  num_buckets = min_num_buckets;
-  hash_buckets = new QuadHashNode*[ num_buckets ];
-  memset(hash_buckets, 0, num_buckets*sizeof(QuadHashNode*));
+  max_elems = min_table_size/2;
+  array = new TMRQuadrant[ max_elems ];
+
+  // Allocate the table and set all the entries to empty
+  table_size = min_table_size;
+  table = new QuadHashEntry[ table_size ];
+  for ( int i = 0; i < table_size; i++ ){
+    table[i].index = -1;
+  }
 }
 
 /*
   Free the memory allocated by the quadrant hash
 */
 TMRQuadrantHash::~TMRQuadrantHash(){
-  // Free all the elements in the hash
-  for ( int i = 0; i < num_buckets; i++ ){
-    QuadHashNode *node = hash_buckets[i];
-    while (node){
-      // Delete the old guy
-      QuadHashNode *tmp = node;
-      node = node->next;
-      delete tmp;
-    }
-  }
-
-  delete [] hash_buckets;
+  delete [] array;
+  delete [] table;
 }
 
 /*
   Covert the hash table to an array
 */
-TMRQuadrantArray* TMRQuadrantHash::toArray(){
-  // Create an array of quadrants
-  TMRQuadrant *array = new TMRQuadrant[ num_elems ];
-
-  // Loop over all the buckets
-  for ( int i = 0, index = 0; i < num_buckets; i++ ){
-    // Get the hash bucket and extract all the elements from this
-    // bucket into the array
-    QuadHashNode *node = hash_buckets[i];
-
-    while (node){
-      array[index] = node->quad;
-      index++;
-      node = node->next;
-    }
-  }
+TMRQuadrantArray *TMRQuadrantHash::toArray(){
+  // Create an array of quadrants in the order they were added
+  TMRQuadrant *arr = new TMRQuadrant[ num_elems ];
+  memcpy(arr, array, num_elems*sizeof(TMRQuadrant));
 
   // Create an array object and add it to the list
-  TMRQuadrantArray *list = new TMRQuadrantArray(array, num_elems,
+  TMRQuadrantArray *list = new TMRQuadrantArray(arr, num_elems,
                                                 use_node_index);
   return list;
 }
@@ -599,134 +759,93 @@ TMRQuadrantArray* TMRQuadrantHash::toArray(){
   true if the quadrant is added, false if it is not
 */
 int TMRQuadrantHash::addQuadrant( TMRQuadrant *quad ){
-  if (num_elems > 10*num_buckets){
-    // Redistribute the quadrants to new buckets
-    int num_old_buckets = num_buckets;
-    num_buckets = 2*num_buckets;
-    QuadHashNode **new_buckets = new QuadHashNode*[ num_buckets ];
-    memset(new_buckets, 0, num_buckets*sizeof(QuadHashNode*));
-
-    // Keep track of the end bucket
-    QuadHashNode **end_buckets = new QuadHashNode*[ num_buckets ];
-
-    // Redistribute the quadrant nodes based on the new
-    // number of buckets within the hash data structure
-    for ( int i = 0; i < num_old_buckets; i++ ){
-      QuadHashNode *node = hash_buckets[i];
-      while (node){
-        int bucket = getBucket(&(node->quad));
-
-        // If this is the first new bucket, create
-        // the new node
-        if (!new_buckets[bucket]){
-          new_buckets[bucket] = new QuadHashNode;
-          new_buckets[bucket]->quad = node->quad;
-          end_buckets[bucket] = new_buckets[bucket];
-        }
-        else {
-          end_buckets[bucket]->next = new QuadHashNode;
-          end_buckets[bucket]->next->quad = node->quad;
-          end_buckets[bucket] = end_buckets[bucket]->next;
-        }
-
-        // Delete the old guy
-        QuadHashNode *tmp = node;
-
-        // Increment the node to the next hash
-        node = node->next;
-
-        // Free the node
-        delete tmp;
+  // Keep the table at most half full
+  if (2*(num_elems+1) > table_size){
+    resizeTable();
+  }
+
+  uint32_t hash = getHash(quad);
+  const uint32_t mask = table_size-1;
+
+  // Probe the table until an empty entry is found
+  uint32_t slot = hash & mask;
+  while (table[slot].index >= 0){
+    if (table[slot].hash == hash){
+      TMRQuadrant *t = &array[table[slot].index];
+
+      // The quadrant is in the list, quit now and return false. Nodes
+      // are unique by position and info, elements by position and
+      // level.
+      if (t->face == quad->face &&
+          t->x == quad->x && t->y == quad->y &&
+          (use_node_index ? (t->info == quad->info) :
+           (t->level == quad->level))){
+        return 0;
       }
     }
-
-    delete [] end_buckets;
-    delete [] hash_buckets;
-    hash_buckets = new_buckets;
+    slot = (slot + 1) & mask;
   }
 
-  int bucket = getBucket(quad);
-
-  // If no quadrant has been added to the bucket,
-  // create a new bucket
-  if (!hash_buckets[bucket]){
-    hash_buckets[bucket] = new QuadHashNode;
-    hash_buckets[bucket]->quad = *quad;
-    num_elems++;
-    return 1;
+  // Extend the contiguous array of quadrants if needed
+  if (num_elems >= max_elems){
+    max_elems *= 2;
+    TMRQuadrant *temp = new TMRQuadrant[ max_elems ];
+    memcpy(temp, array, num_elems*sizeof(TMRQuadrant));
+    delete [] array;
+    array = temp;
   }
-  else {
-    // Get the head node for the corresponding bucket
-    QuadHashNode *node = hash_buckets[bucket];
-    if (use_node_index){
-      // Search the bucket to see if there's another node in the list
-      while (node){
-        if (node->quad.compareNode(quad) == 0){
-          return 0;
-        }
-
-        // If the next node does not exist, quit while node
-        // is the last node in the linked list
-        if (!node->next){
-          break;
-        }
-        node = node->next;
-      }
-    }
-    else {
-      // Perform the same search, except using quads
-      while (node){
-        if (node->quad.compare(quad) == 0){
-          return 0;
-        }
-
-        if (!node->next){
-          break;
-        }
-        node = node->next;
-      }
-    }
 
-    // Add the quadrant as the last node
-    node->next = new QuadHashNode;
-    node->next->quad = *quad;
-    num_elems++;
-  }
+  // Add the quadrant to the end of the array
+  array[num_elems] = *quad;
+  table[slot].hash = hash;
+  table[slot].index = num_elems;
+  num_elems++;
 
   return 1;
 }
 
 /*
-  Get a bucket to place the quadrant in.
-
-  This code creates a value based on the quadrant location within the
-  mesh and then takes the remainder of the number of buckets.
+  Double the size of the table and re-insert all the entries using
+  the stored hash values.
 */
-int TMRQuadrantHash::getBucket( TMRQuadrant *quad ){
-  // The hash value
-  uint32_t val = 0;
-
-  if (use_node_index){
-    uint32_t u = 0, v = 0, w = 0;
-    u = quad->face;
-    v = (1 << TMR_MAX_LEVEL) + quad->x;
-    w = (1 << TMR_MAX_LEVEL) + quad->y;
-
-    // Compute the hash value
-    val = TMRIntegerTripletHash(u, v, w);
+void TMRQuadrantHash::resizeTable(){
+  int old_size = table_size;
+  QuadHashEntry *old_table = table;
+
+  table_size = 2*table_size;
+  table = new QuadHashEntry[ table_size ];
+  for ( int i = 0; i < table_size; i++ ){
+    table[i].index = -1;
+  }
+
+  const uint32_t mask = table_size-1;
+  for ( int i = 0; i < old_size; i++ ){
+    if (old_table[i].index >= 0){
+      uint32_t slot = old_table[i].hash & mask;
+      while (table[slot].index >= 0){
+        slot = (slot + 1) & mask;
+      }
+      table[slot] = old_table[i];
+    }
   }
-  else {
-    uint32_t u = 0, v = 0, w = 0;
-    u = quad->face;
-    v = (1 << TMR_MAX_LEVEL) + quad->x;
-    w = (1 << TMR_MAX_LEVEL) + quad->y;
 
-    // Compute the hash value
-    val = TMRIntegerTripletHash(u, v, w);
-  }
+  delete [] old_table;
+}
 
-  // Compute the bucket value
-  int bucket = val % num_buckets;
+/*
+  Get the hash value for the quadrant
 
-  return bucket;
+  This code creates a value based on the face and the Morton
+  coordinates of the quadrant. The level and info are not included since
+  the comparison is based on either the level (elements) or the info
+  (nodes).
+*/
+uint32_t TMRQuadrantHash::getHash( TMRQuadrant *quad ){
+  uint32_t u = 0, v = 0, w = 0;
+  u = quad->face;
+  v = (1 << TMR_MAX_LEVEL) + quad->x;
+  w = (1 << TMR_MAX_LEVEL) + quad->y;
+
+  // Compute the hash value
+  return TMRIntegerTripletHash(u, v, w);
 }
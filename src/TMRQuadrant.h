@@ -42,6 +42,7 @@ class TMRQuadrant {
   int comparePosition( const TMRQuadrant *quadrant ) const;
   int compareNode( const TMRQuadrant *quadrant ) const;
   int contains( TMRQuadrant *quad );
+  void getMortonKey( uint64_t key[], int use_node_index=0 ) const;
 
   int32_t face; // The face owner
   int32_t x, y; // The x,y coordinates
@@ -82,7 +83,9 @@ class TMRQuadrantArray {
   Create a queue of quadrants
 
   This class defines a queue of quadrants that are used for the balance
-  and coarsen operations.
+  and coarsen operations. The quadrants are stored in a contiguous ring
+  buffer that grows as needed, so pushing and popping quadrants does not
+  require any per-quadrant allocation.
 */
 class TMRQuadrantQueue {
  public:
@@ -95,17 +98,18 @@ class TMRQuadrantQueue {
   TMRQuadrantArray* toArray();
 
  private:
-  // Class that defines an element within the queue
-  class QuadQueueNode {
-  public:
-    QuadQueueNode(){ next = NULL; }
-    TMRQuadrant quad;
-    QuadQueueNode *next;
-  };
+  // The initial size of the ring buffer (must be a power of two)
+  static const int min_queue_size = (1 << 10);
+
+  // Copy the entries in the queue, in order, to the array
+  void copyEntries( TMRQuadrant *dest );
 
   // Keep track of the number of elements in the queue
   int num_elems;
-  QuadQueueNode *root, *tip;
+
+  // The ring buffer of quadrants and the location of the first entry
+  int head, max_size;
+  TMRQuadrant *array;
 };
 
 /*
@@ -114,6 +118,11 @@ class TMRQuadrantQueue {
   This object enables the creation of a unique set of quadrants such
   that no two have the same position/level combination. This hash
   table can then be made into an array of unique elements or nodes.
+
+  The unique quadrants are stored contiguously in the order they are
+  added. An open-addressing table with linear probing stores the
+  hash of the quadrant's face and Morton coordinates together with
+  the index of the quadrant within the contiguous array.
 */
 class TMRQuadrantHash {
  public:
@@ -124,28 +133,32 @@ class TMRQuadrantHash {
   int addQuadrant( TMRQuadrant *quad );
 
  private:
-  // The minimum bucket size
-  static const int min_num_buckets = (1 << 12)-1;
+  // The minimum table size (must be a power of two)
+  static const int min_table_size = (1 << 12);
 
-  class QuadHashNode {
+  // An entry in the open-addressing table
+  class QuadHashEntry {
   public:
-    QuadHashNode(){ next = NULL; }
-    TMRQuadrant quad;
-    QuadHashNode *next;
+    uint32_t hash;
+    int index;
   };
 
-  // Set the element index/node
+  // Keep track of whether to use a node-based search
   int use_node_index;
 
-  // Keep track of the bucket size
-  int num_buckets;
-  QuadHashNode **hash_buckets;
+  // The contiguous array of unique quadrants
+  int num_elems, max_elems;
+  TMRQuadrant *array;
+
+  // The open-addressing table - unused entries have an index of -1
+  int table_size;
+  QuadHashEntry *table;
 
-  // Keep track of the number of elements
-  int num_elems;
+  // Compute the hash value for the quadrant
+  uint32_t getHash( TMRQuadrant *quad );
 
-  // Get the buckets to place the quadrant in
-  int getBucket( TMRQuadrant *quad );
+  // Double the size of the table and re-insert the entries
+  void resizeTable();
 };
 
 #endif // TMR_QUADRANT_H
@@ -0,0 +1,2330 @@
+/*
+  This file is part of the package TMR for adaptive mesh refinement.
+
+  Copyright (C) 2015 Georgia Tech Research Corporation.
+  Additional copyright (C) 2015 Graeme Kennedy.
+  All rights reserved.
+
+  TMR is licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this software except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "TMRTetrahedralize.h"
+#include "TMRHashFunction.h"
+#include "predicates.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+/*
+  The faces of the tetrahedron (t0, t1, t2, t3). The k-th face is
+  opposite the k-th vertex. The vertices of each face are ordered so
+  that the face normal points out of a positively oriented
+  tetrahedron. A tetrahedron is positively oriented if
+  orient3d(t0, t1, t2, t3) > 0.
+*/
+static const int tet_faces[4][3] = {{1, 3, 2}, {0, 2, 3},
+                                    {0, 3, 1}, {0, 1, 2}};
+
+/*
+  The edges of the tetrahedron
+*/
+static const int tet_edges[6][2] = {{0, 1}, {0, 2}, {0, 3},
+                                    {1, 2}, {1, 3}, {2, 3}};
+
+/*
+  Wrappers for the geometric predicates
+*/
+static inline double orient( const double *a, const double *b,
+                             const double *c, const double *d ){
+  return orient3d((double*)a, (double*)b, (double*)c, (double*)d);
+}
+
+static inline double in_sphere( const double *a, const double *b,
+                                const double *c, const double *d,
+                                const double *e ){
+  return insphere((double*)a, (double*)b, (double*)c,
+                  (double*)d, (double*)e);
+}
+
+/*
+  Check whether the point p lies strictly inside the diametral sphere
+  of the triangle (a, b, c). This is the smallest sphere that passes
+  through the vertices of the triangle.
+*/
+static int encroaches_triangle( const double *a, const double *b,
+                                const double *c, const double *p ){
+  double d1[3], d2[3], n[3];
+  for ( int k = 0; k < 3; k++ ){
+    d1[k] = b[k] - a[k];
+    d2[k] = c[k] - a[k];
+  }
+  n[0] = d1[1]*d2[2] - d1[2]*d2[1];
+  n[1] = d1[2]*d2[0] - d1[0]*d2[2];
+  n[2] = d1[0]*d2[1] - d1[1]*d2[0];
+  double nn = n[0]*n[0] + n[1]*n[1] + n[2]*n[2];
+  if (nn == 0.0){
+    return 0;
+  }
+
+  // The circumcenter is a + ((|d1|^2 d2 - |d2|^2 d1) x n)/(2|n|^2)
+  double l1 = d1[0]*d1[0] + d1[1]*d1[1] + d1[2]*d1[2];
+  double l2 = d2[0]*d2[0] + d2[1]*d2[1] + d2[2]*d2[2];
+  double m[3];
+  for ( int k = 0; k < 3; k++ ){
+    m[k] = l1*d2[k] - l2*d1[k];
+  }
+  double r[3];
+  r[0] = (m[1]*n[2] - m[2]*n[1])/(2.0*nn);
+  r[1] = (m[2]*n[0] - m[0]*n[2])/(2.0*nn);
+  r[2] = (m[0]*n[1] - m[1]*n[0])/(2.0*nn);
+
+  double dp = 0.0, rr = 0.0;
+  for ( int k = 0; k < 3; k++ ){
+    double q = p[k] - a[k] - r[k];
+    dp += q*q;
+    rr += r[k]*r[k];
+  }
+  return (dp < rr);
+}
+
+/*
+  Resize an array, keeping the first size entries
+*/
+template <class ArrayType>
+static void resize_array( ArrayType **array, int size, int new_size ){
+  ArrayType *tmp = new ArrayType[ new_size ];
+  if (size > 0){
+    memcpy(tmp, *array, size*sizeof(ArrayType));
+  }
+  if (*array){ delete [] *array; }
+  *array = tmp;
+}
+
+/*
+  Sort three integers in increasing order
+*/
+static inline void sort3( int *a, int *b, int *c ){
+  if (*a > *b){ int tmp = *a; *a = *b; *b = tmp; }
+  if (*b > *c){ int tmp = *b; *b = *c; *c = tmp; }
+  if (*a > *b){ int tmp = *a; *a = *b; *b = tmp; }
+}
+
+/*
+  Spread the lower 21 bits of x so that there are two zero bits
+  between each bit. This is used to compute the Morton keys.
+*/
+static inline uint64_t spread_bits( uint64_t x ){
+  x &= 0x1fffffULL;
+  x = (x | x << 32) & 0x1f00000000ffffULL;
+  x = (x | x << 16) & 0x1f0000ff0000ffULL;
+  x = (x | x << 8) & 0x100f00f00f00f00fULL;
+  x = (x | x << 4) & 0x10c30c30c30c30c3ULL;
+  x = (x | x << 2) & 0x1249249249249249ULL;
+  return x;
+}
+
+/*
+  Point index and Morton key used to order the points
+*/
+class TMRMortonPoint {
+ public:
+  uint64_t key;
+  int index;
+};
+
+class TMRMortonPointLess {
+ public:
+  bool operator()( const TMRMortonPoint& a, const TMRMortonPoint& b ){
+    return a.key < b.key;
+  }
+};
+
+/*
+  Compute the quality of a tetrahedron. The quality is the volume
+  divided by the cube of the root-mean-square edge length and is
+  normalized to one for a regular tetrahedron.
+*/
+static double tet_quality( const double *a, const double *b,
+                           const double *c, const double *d ){
+  const double *p[4] = {a, b, c, d};
+  double l2 = 0.0;
+  for ( int k = 0; k < 6; k++ ){
+    const double *u = p[tet_edges[k][0]];
+    const double *v = p[tet_edges[k][1]];
+    l2 += ((u[0] - v[0])*(u[0] - v[0]) +
+           (u[1] - v[1])*(u[1] - v[1]) +
+           (u[2] - v[2])*(u[2] - v[2]));
+  }
+  l2 = l2/6.0;
+
+  // Compute the volume of the tetrahedron
+  double d1[3], d2[3], d3[3];
+  for ( int k = 0; k < 3; k++ ){
+    d1[k] = a[k] - d[k];
+    d2[k] = b[k] - d[k];
+    d3[k] = c[k] - d[k];
+  }
+  double vol = (d1[0]*(d2[1]*d3[2] - d2[2]*d3[1]) -
+                d1[1]*(d2[0]*d3[2] - d2[2]*d3[0]) +
+                d1[2]*(d2[0]*d3[1] - d2[1]*d3[0]))/6.0;
+
+  // 6*sqrt(2) scales the quality of a regular tetrahedron to one
+  return 6.0*sqrt(2.0)*vol/(l2*sqrt(l2));
+}
+
+/*
+  Create the Delaunay tetrahedralization of the boundary points
+
+  The boundary points are given in the inpts array and the boundary
+  triangles are given in the tris array. The triangles must form a
+  closed surface (or several closed surfaces), but their orientation
+  does not matter.
+*/
+TMRTetrahedralize::TMRTetrahedralize( int npts, const TMRPoint *inpts,
+                                      int ntris, const int tris[] ){
+  // Initialize the predicates code
+  exactinit();
+
+  // Allocate the points
+  num_points = 0;
+  max_num_points = 2*(npts + FIXED_POINT_OFFSET);
+  pts = new double[ 3*max_num_points ];
+  pts_to_tets = new int[ max_num_points ];
+
+  // Allocate the tetrahedra. The Delaunay tetrahedralization of
+  // randomly distributed points has about 6.5 tets per point.
+  num_tets = 0;
+  max_num_tets = 8*npts + 64;
+  tets = new int[ 4*max_num_tets ];
+  adj = new int[ 4*max_num_tets ];
+  flags = new unsigned char[ max_num_tets ];
+  marks = new unsigned char[ max_num_tets ];
+  tags = new int[ max_num_tets ];
+  memset(tags, 0, max_num_tets*sizeof(int));
+  num_free_tets = 0;
+  free_tets = new int[ max_num_tets ];
+  search_tag = 0;
+  last_tet = 0;
+  rand_state = 2463534242U;
+
+  // Allocate the work arrays
+  max_cavity = 256;
+  cavity = new int[ max_cavity ];
+  max_cavity_faces = 512;
+  cavity_faces = new int[ 6*max_cavity_faces ];
+  cavity_edge_table_size = 4096;
+  cavity_edge_table = new int[ 4*cavity_edge_table_size ];
+  for ( int i = 0; i < 4*cavity_edge_table_size; i++ ){
+    cavity_edge_table[i] = -1;
+  }
+  max_star = 256;
+  star = new int[ max_star ];
+
+  // Find the bounding box of the points
+  double xlow[3] = {0.0, 0.0, 0.0};
+  double xhigh[3] = {0.0, 0.0, 0.0};
+  if (npts > 0){
+    xlow[0] = xhigh[0] = inpts[0].x;
+    xlow[1] = xhigh[1] = inpts[0].y;
+    xlow[2] = xhigh[2] = inpts[0].z;
+  }
+  for ( int i = 1; i < npts; i++ ){
+    if (inpts[i].x < xlow[0]){ xlow[0] = inpts[i].x; }
+    if (inpts[i].y < xlow[1]){ xlow[1] = inpts[i].y; }
+    if (inpts[i].z < xlow[2]){ xlow[2] = inpts[i].z; }
+    if (inpts[i].x > xhigh[0]){ xhigh[0] = inpts[i].x; }
+    if (inpts[i].y > xhigh[1]){ xhigh[1] = inpts[i].y; }
+    if (inpts[i].z > xhigh[2]){ xhigh[2] = inpts[i].z; }
+  }
+
+  // Create a regular tetrahedron whose inscribed sphere contains the
+  // bounding box of the points
+  double center[3], r = 0.0;
+  for ( int k = 0; k < 3; k++ ){
+    center[k] = 0.5*(xlow[k] + xhigh[k]);
+    r += 0.25*(xhigh[k] - xlow[k])*(xhigh[k] - xlow[k]);
+  }
+  r = sqrt(r);
+  if (r == 0.0){
+    r = 1.0;
+  }
+  const double dir[4][3] = {{1.0, 1.0, 1.0}, {1.0, -1.0, -1.0},
+                            {-1.0, 1.0, -1.0}, {-1.0, -1.0, 1.0}};
+  for ( int i = 0; i < FIXED_POINT_OFFSET; i++ ){
+    double pt[3];
+    for ( int k = 0; k < 3; k++ ){
+      pt[k] = center[k] + 10.0*r*dir[i][k];
+    }
+    addPoint(pt);
+  }
+
+  int t = newTet();
+  tets[4*t] = 0;
+  tets[4*t+1] = 1;
+  tets[4*t+2] = 2;
+  tets[4*t+3] = 3;
+  if (orient(&pts[0], &pts[3], &pts[6], &pts[9]) < 0.0){
+    tets[4*t+2] = 3;
+    tets[4*t+3] = 2;
+  }
+  for ( int k = 0; k < 4; k++ ){
+    pts_to_tets[k] = t;
+  }
+
+  // Add the boundary points to the list of points
+  num_boundary_pts = npts;
+  for ( int i = 0; i < npts; i++ ){
+    double pt[3];
+    pt[0] = inpts[i].x;
+    pt[1] = inpts[i].y;
+    pt[2] = inpts[i].z;
+    addPoint(pt);
+  }
+
+  // Copy over the boundary triangles and create the hash tables for
+  // the boundary triangles and edges
+  num_boundary_tris = ntris;
+  boundary_tris = new int[ 3*ntris ];
+  for ( int i = 0; i < 3*ntris; i++ ){
+    boundary_tris[i] = tris[i] + FIXED_POINT_OFFSET;
+  }
+
+  face_table_size = 1024;
+  while (face_table_size < 2*ntris){
+    face_table_size *= 2;
+  }
+  face_table = new int[ 3*face_table_size ];
+  for ( int i = 0; i < 3*face_table_size; i++ ){
+    face_table[i] = -1;
+  }
+
+  edge_table_size = 1024;
+  while (edge_table_size < 4*ntris){
+    edge_table_size *= 2;
+  }
+  edge_table = new int[ 2*edge_table_size ];
+  for ( int i = 0; i < 2*edge_table_size; i++ ){
+    edge_table[i] = -1;
+  }
+
+  for ( int i = 0; i < ntris; i++ ){
+    int u = boundary_tris[3*i];
+    int v = boundary_tris[3*i+1];
+    int w = boundary_tris[3*i+2];
+    sort3(&u, &v, &w);
+
+    // Add the triangle to the face hash table
+    uint32_t index = TMRIntegerTripletHash(u, v, w) & (face_table_size-1);
+    while (face_table[3*index] >= 0 &&
+           !(face_table[3*index] == u && face_table[3*index+1] == v &&
+             face_table[3*index+2] == w)){
+      index = (index + 1) & (face_table_size-1);
+    }
+    face_table[3*index] = u;
+    face_table[3*index+1] = v;
+    face_table[3*index+2] = w;
+
+    // Add the edges to the edge hash table
+    int edges[3][2] = {{u, v}, {v, w}, {u, w}};
+    for ( int k = 0; k < 3; k++ ){
+      int e0 = edges[k][0], e1 = edges[k][1];
+      index = TMRIntegerPairHash(e0, e1) & (edge_table_size-1);
+      while (edge_table[2*index] >= 0 &&
+             !(edge_table[2*index] == e0 && edge_table[2*index+1] == e1)){
+        index = (index + 1) & (edge_table_size-1);
+      }
+      edge_table[2*index] = e0;
+      edge_table[2*index+1] = e1;
+    }
+  }
+
+  if (npts > 0){
+    // Order the points using a biased randomized insertion order. The
+    // points are shuffled and split into rounds that double in size.
+    // The points in each round are sorted along a Morton curve so that
+    // the walk to locate each point is short.
+    int *order = new int[ npts ];
+    for ( int i = 0; i < npts; i++ ){
+      order[i] = i;
+    }
+    for ( int i = npts-1; i > 0; i-- ){
+      rand_state ^= rand_state << 13;
+      rand_state ^= rand_state >> 17;
+      rand_state ^= rand_state << 5;
+      int j = rand_state % (i+1);
+      int tmp = order[i];
+      order[i] = order[j];
+      order[j] = tmp;
+    }
+
+    // Compute the Morton keys for the points
+    double scale = 0.0;
+    for ( int k = 0; k < 3; k++ ){
+      if (xhigh[k] - xlow[k] > scale){
+        scale = xhigh[k] - xlow[k];
+      }
+    }
+    if (scale > 0.0){
+      scale = ((1 << 21) - 1)/scale;
+    }
+
+    TMRMortonPoint *morton = new TMRMortonPoint[ npts ];
+    for ( int i = 0; i < npts; i++ ){
+      const TMRPoint *p = &inpts[order[i]];
+      uint64_t ix = (uint64_t)(scale*(p->x - xlow[0]));
+      uint64_t iy = (uint64_t)(scale*(p->y - xlow[1]));
+      uint64_t iz = (uint64_t)(scale*(p->z - xlow[2]));
+      morton[i].key = (spread_bits(ix) | (spread_bits(iy) << 1) |
+                       (spread_bits(iz) << 2));
+      morton[i].index = order[i];
+    }
+
+    int end = npts;
+    while (end > 0){
+      int start = end/2;
+      if (end <= 64){
+        start = 0;
+      }
+      std::sort(&morton[start], &morton[end], TMRMortonPointLess());
+      end = start;
+    }
+
+    // Insert the points into the mesh
+    int fail = 0;
+    for ( int i = 0; i < npts; i++ ){
+      int pt = morton[i].index + FIXED_POINT_OFFSET;
+      if (insertPoint(pt, last_tet, 0, 0.0)){
+        fail++;
+      }
+    }
+
+    if (fail > 0){
+      fprintf(stderr,
+              "TMRTetrahedralize Error: Failed to insert %d boundary points\n",
+              fail);
+    }
+
+    delete [] morton;
+    delete [] order;
+  }
+}
+
+/*
+  Free the tetrahedralization
+*/
+TMRTetrahedralize::~TMRTetrahedralize(){
+  delete [] pts;
+  delete [] pts_to_tets;
+  delete [] tets;
+  delete [] adj;
+  delete [] flags;
+  delete [] marks;
+  delete [] tags;
+  delete [] free_tets;
+  delete [] boundary_tris;
+  delete [] face_table;
+  delete [] edge_table;
+  delete [] cavity;
+  delete [] cavity_faces;
+  delete [] cavity_edge_table;
+  delete [] star;
+}
+
+/*
+  Add a point to the list of points. This does not add the point to
+  the mesh.
+*/
+int TMRTetrahedralize::addPoint( const double pt[] ){
+  if (num_points >= max_num_points){
+    int new_size = 2*max_num_points;
+    resize_array(&pts, 3*num_points, 3*new_size);
+    resize_array(&pts_to_tets, num_points, new_size);
+    max_num_points = new_size;
+  }
+
+  pts[3*num_points] = pt[0];
+  pts[3*num_points+1] = pt[1];
+  pts[3*num_points+2] = pt[2];
+  pts_to_tets[num_points] = -1;
+  num_points++;
+
+  return num_points-1;
+}
+
+/*
+  Allocate a new tetrahedron, re-using a deleted one if possible
+*/
+int TMRTetrahedralize::newTet(){
+  int t = 0;
+  if (num_free_tets > 0){
+    num_free_tets--;
+    t = free_tets[num_free_tets];
+  }
+  else {
+    if (num_tets >= max_num_tets){
+      int new_size = 2*max_num_tets;
+      resize_array(&tets, 4*num_tets, 4*new_size);
+      resize_array(&adj, 4*num_tets, 4*new_size);
+      resize_array(&flags, num_tets, new_size);
+      resize_array(&marks, num_tets, new_size);
+      resize_array(&tags, num_tets, new_size);
+      resize_array(&free_tets, num_free_tets, new_size);
+      memset(&tags[num_tets], 0, (new_size - num_tets)*sizeof(int));
+      max_num_tets = new_size;
+    }
+    t = num_tets;
+    num_tets++;
+  }
+
+  flags[t] = 0;
+  marks[t] = 0;
+  adj[4*t] = adj[4*t+1] = adj[4*t+2] = adj[4*t+3] = -1;
+
+  return t;
+}
+
+/*
+  Delete the tetrahedron and add it to the free list
+*/
+void TMRTetrahedralize::deleteTet( int t ){
+  flags[t] = TET_DELETED;
+  free_tets[num_free_tets] = t;
+  num_free_tets++;
+}
+
+/*
+  Locate the tetrahedron that contains the point by walking from the
+  tetrahedron t towards the point
+
+  The face that the walk crosses is selected at random from the faces
+  that separate the point from the current tetrahedron. This
+  guarantees that the walk terminates, even in a mesh that is not
+  Delaunay. If constrained is true, the walk will not cross a boundary
+  triangle. The code returns -1 if the point cannot be reached.
+*/
+int TMRTetrahedralize::locate( const double pt[], int t, int constrained ){
+  if (t < 0 || t >= num_tets || (flags[t] & TET_DELETED)){
+    t = -1;
+    for ( int i = num_tets-1; i >= 0; i-- ){
+      if (!(flags[i] & TET_DELETED)){
+        t = i;
+        break;
+      }
+    }
+    if (t < 0){
+      return -1;
+    }
+  }
+
+  for ( int iter = 0; iter < num_tets + 100; iter++ ){
+    rand_state ^= rand_state << 13;
+    rand_state ^= rand_state >> 17;
+    rand_state ^= rand_state << 5;
+    int k0 = rand_state & 3;
+
+    const int *tt = &tets[4*t];
+    int next = -1;
+    for ( int j = 0; j < 4; j++ ){
+      int k = (k0 + j) & 3;
+      const double *a = &pts[3*tt[tet_faces[k][0]]];
+      const double *b = &pts[3*tt[tet_faces[k][1]]];
+      const double *c = &pts[3*tt[tet_faces[k][2]]];
+      if (orient(a, b, c, pt) < 0.0){
+        next = k;
+        break;
+      }
+    }
+
+    if (next < 0){
+      return t;
+    }
+    if (constrained && (marks[t] & (1 << next))){
+      return -1;
+    }
+    t = adj[4*t + next];
+    if (t < 0){
+      return -1;
+    }
+  }
+
+  return -1;
+}
+
+/*
+  Insert the point into the mesh using the Bowyer-Watson algorithm
+
+  The cavity consists of the tetrahedra whose circumsphere contains
+  the point. If constrained is true, the cavity does not extend across
+  a boundary triangle. When hmin > 0, the point is rejected if it lies
+  closer than hmin to, or inside the diametral sphere of, any boundary
+  triangle on the cavity boundary. When rmin > 0, the point is
+  rejected if it lies closer than rmin to any vertex of the cavity.
+  The nearest vertex is always a vertex of the cavity, so this bounds
+  the distance to all points in the mesh. The cavity is expanded, if
+  necessary, so that the point is strictly visible from every face on
+  its boundary.
+
+  On success, the code returns 0 and the new tetrahedra are stored in
+  the cavity array. Otherwise, the mesh is not modified.
+*/
+int TMRTetrahedralize::insertPoint( int pt, int t, int constrained,
+                                    double hmin, double rmin,
+                                    int *num_new ){
+  const double *p = &pts[3*pt];
+  t = locate(p, t, constrained);
+  if (t < 0){
+    return 1;
+  }
+
+  // Check whether the point already exists in the mesh
+  for ( int k = 0; k < 4; k++ ){
+    const double *q = &pts[3*tets[4*t+k]];
+    if (p[0] == q[0] && p[1] == q[1] && p[2] == q[2]){
+      return 1;
+    }
+  }
+
+  // Dig the cavity from the enclosing tetrahedron
+  int num_cavity = 1;
+  cavity[0] = t;
+  flags[t] |= TET_CAVITY;
+  for ( int i = 0; i < num_cavity; i++ ){
+    int c = cavity[i];
+    for ( int k = 0; k < 4; k++ ){
+      int n = adj[4*c+k];
+      if (n < 0 || (flags[n] & TET_CAVITY)){
+        continue;
+      }
+      if (constrained && (marks[c] & (1 << k))){
+        continue;
+      }
+
+      const int *tn = &tets[4*n];
+      if (in_sphere(&pts[3*tn[0]], &pts[3*tn[1]],
+                    &pts[3*tn[2]], &pts[3*tn[3]], p) > 0.0){
+        if (num_cavity >= max_cavity){
+          resize_array(&cavity, num_cavity, 2*max_cavity);
+          max_cavity *= 2;
+        }
+        cavity[num_cavity] = n;
+        flags[n] |= TET_CAVITY;
+        num_cavity++;
+      }
+    }
+  }
+
+  // Find the faces on the boundary of the cavity. If the point is not
+  // strictly visible from a face, add the tetrahedron on the other
+  // side to the cavity and try again.
+  int fail = 0;
+  int num_faces = 0;
+  for ( int iter = 0; iter < 64; iter++ ){
+    int expanded = 0;
+    num_faces = 0;
+    int ncav = num_cavity;
+
+    for ( int i = 0; i < ncav && !fail; i++ ){
+      int c = cavity[i];
+      const int *tc = &tets[4*c];
+      for ( int k = 0; k < 4; k++ ){
+        int n = adj[4*c+k];
+        if (n >= 0 && (flags[n] & TET_CAVITY)){
+          continue;
+        }
+
+        int u = tc[tet_faces[k][0]];
+        int v = tc[tet_faces[k][1]];
+        int w = tc[tet_faces[k][2]];
+        int mark = (marks[c] >> k) & 1;
+
+        double o = orient(&pts[3*u], &pts[3*v], &pts[3*w], p);
+        if (o <= 0.0){
+          if (n >= 0 && !(constrained && mark)){
+            if (num_cavity >= max_cavity){
+              resize_array(&cavity, num_cavity, 2*max_cavity);
+              max_cavity *= 2;
+            }
+            cavity[num_cavity] = n;
+            flags[n] |= TET_CAVITY;
+            num_cavity++;
+            expanded = 1;
+          }
+          else {
+            fail = 1;
+            break;
+          }
+        }
+        else {
+          if (mark && hmin > 0.0){
+            // Compute the distance from the point to the plane of the
+            // boundary triangle
+            double d1[3], d2[3];
+            for ( int j = 0; j < 3; j++ ){
+              d1[j] = pts[3*v+j] - pts[3*u+j];
+              d2[j] = pts[3*w+j] - pts[3*u+j];
+            }
+            double nx = d1[1]*d2[2] - d1[2]*d2[1];
+            double ny = d1[2]*d2[0] - d1[0]*d2[2];
+            double nz = d1[0]*d2[1] - d1[1]*d2[0];
+            if (o < hmin*sqrt(nx*nx + ny*ny + nz*nz) ||
+                encroaches_triangle(&pts[3*u], &pts[3*v], &pts[3*w], p)){
+              fail = 1;
+              break;
+            }
+          }
+
+          if (num_faces >= max_cavity_faces){
+            resize_array(&cavity_faces, 6*num_faces, 12*max_cavity_faces);
+            max_cavity_faces *= 2;
+          }
+          int *f = &cavity_faces[6*num_faces];
+          f[0] = u;  f[1] = v;  f[2] = w;
+          f[3] = n;  f[4] = mark;  f[5] = c;
+          num_faces++;
+        }
+      }
+    }
+
+    if (fail || !expanded){
+      break;
+    }
+    if (iter == 63){
+      fail = 1;
+    }
+  }
+
+  // Check the distance to the vertices of the cavity
+  if (!fail && rmin > 0.0){
+    for ( int i = 0; i < num_faces && !fail; i++ ){
+      for ( int j = 0; j < 3; j++ ){
+        const double *q = &pts[3*cavity_faces[6*i+j]];
+        double d = ((p[0] - q[0])*(p[0] - q[0]) +
+                    (p[1] - q[1])*(p[1] - q[1]) +
+                    (p[2] - q[2])*(p[2] - q[2]));
+        if (d < rmin*rmin){
+          fail = 1;
+          break;
+        }
+      }
+    }
+  }
+
+  if (fail){
+    for ( int i = 0; i < num_cavity; i++ ){
+      flags[cavity[i]] &= ~TET_CAVITY;
+    }
+    return 1;
+  }
+
+  // Delete the tetrahedra in the cavity
+  for ( int i = 0; i < num_cavity; i++ ){
+    deleteTet(cavity[i]);
+  }
+  if (num_faces > max_cavity){
+    delete [] cavity;
+    max_cavity = 2*num_faces;
+    cavity = new int[ max_cavity ];
+  }
+
+  // Size the hash table for the edges of the cavity boundary
+  int table_size = 64;
+  while (table_size < 6*num_faces){
+    table_size *= 2;
+  }
+  if (table_size > cavity_edge_table_size){
+    delete [] cavity_edge_table;
+    cavity_edge_table_size = table_size;
+    cavity_edge_table = new int[ 4*table_size ];
+    for ( int i = 0; i < 4*table_size; i++ ){
+      cavity_edge_table[i] = -1;
+    }
+  }
+  int *table = cavity_edge_table;
+
+  // Connect each face on the boundary of the cavity to the new point
+  for ( int i = 0; i < num_faces; i++ ){
+    const int *f = &cavity_faces[6*i];
+    int u = f[0], v = f[1], w = f[2], n = f[3];
+
+    int nt = newTet();
+    cavity[i] = nt;
+    tets[4*nt] = u;
+    tets[4*nt+1] = v;
+    tets[4*nt+2] = w;
+    tets[4*nt+3] = pt;
+    marks[nt] = (f[4] ? 8 : 0);
+    pts_to_tets[u] = pts_to_tets[v] = pts_to_tets[w] = nt;
+
+    // Connect the new tetrahedron to the tetrahedron outside the cavity
+    adj[4*nt+3] = n;
+    if (n >= 0){
+      for ( int j = 0; j < 4; j++ ){
+        int q = tets[4*n+j];
+        if (q != u && q != v && q != w){
+          adj[4*n+j] = nt;
+          break;
+        }
+      }
+    }
+
+    // Connect the new tetrahedra to each other through the directed
+    // edges of the cavity boundary faces. The face opposite to
+    // vertex k of the new tetrahedron contains the point.
+    int edges[3][3] = {{u, v, 2}, {v, w, 0}, {w, u, 1}};
+    for ( int k = 0; k < 3; k++ ){
+      int e0 = edges[k][0], e1 = edges[k][1];
+
+      // Look for the edge with the opposite direction
+      uint32_t index = TMRIntegerPairHash(e1, e0) & (table_size-1);
+      int found = 0;
+      while (table[4*index] >= 0){
+        if (table[4*index] == e1 && table[4*index+1] == e0){
+          int ot = table[4*index+2];
+          int oface = table[4*index+3];
+          adj[4*nt + edges[k][2]] = ot;
+          adj[4*ot + oface] = nt;
+          found = 1;
+          break;
+        }
+        index = (index + 1) & (table_size-1);
+      }
+
+      if (!found){
+        index = TMRIntegerPairHash(e0, e1) & (table_size-1);
+        while (table[4*index] >= 0){
+          index = (index + 1) & (table_size-1);
+        }
+        table[4*index] = e0;
+        table[4*index+1] = e1;
+        table[4*index+2] = nt;
+        table[4*index+3] = edges[k][2];
+      }
+    }
+  }
+
+  // Clear the entries in the hash table
+  for ( int i = 0; i < 4*table_size; i++ ){
+    table[i] = -1;
+  }
+
+  pts_to_tets[pt] = cavity[num_faces-1];
+  last_tet = cavity[num_faces-1];
+  if (num_new){
+    *num_new = num_faces;
+  }
+
+  return 0;
+}
+
+/*
+  Replace the old tetrahedra with the new tetrahedra given by conn
+
+  The new tetrahedra must fill exactly the same region as the old
+  tetrahedra. The boundary triangle marks are transferred from the
+  faces of the old tetrahedra.
+*/
+void TMRTetrahedralize::replaceTets( int nold, const int old[],
+                                     int nnew, const int conn[] ){
+  for ( int i = 0; i < nold; i++ ){
+    flags[old[i]] |= TET_CAVITY;
+  }
+
+  // Record the faces on the boundary of the region
+  int num_faces = 0;
+  for ( int i = 0; i < nold; i++ ){
+    int o = old[i];
+    for ( int k = 0; k < 4; k++ ){
+      int n = adj[4*o+k];
+      if (n >= 0 && (flags[n] & TET_CAVITY)){
+        continue;
+      }
+      if (num_faces >= max_cavity_faces){
+        resize_array(&cavity_faces, 6*num_faces, 12*max_cavity_faces);
+        max_cavity_faces *= 2;
+      }
+      int *f = &cavity_faces[6*num_faces];
+      f[0] = tets[4*o + tet_faces[k][0]];
+      f[1] = tets[4*o + tet_faces[k][1]];
+      f[2] = tets[4*o + tet_faces[k][2]];
+      sort3(&f[0], &f[1], &f[2]);
+      f[3] = n;
+      f[4] = (marks[o] >> k) & 1;
+      f[5] = 0;
+      num_faces++;
+    }
+  }
+
+  for ( int i = 0; i < nold; i++ ){
+    deleteTet(old[i]);
+  }
+
+  // Create the new tetrahedra
+  int *new_tets = new int[ nnew ];
+  for ( int i = 0; i < nnew; i++ ){
+    int nt = newTet();
+    new_tets[i] = nt;
+    for ( int k = 0; k < 4; k++ ){
+      tets[4*nt+k] = conn[4*i+k];
+      pts_to_tets[conn[4*i+k]] = nt;
+    }
+  }
+
+  // Connect the new tetrahedra to the surrounding mesh and to each
+  // other
+  for ( int i = 0; i < nnew; i++ ){
+    int nt = new_tets[i];
+    for ( int k = 0; k < 4; k++ ){
+      int u = tets[4*nt + tet_faces[k][0]];
+      int v = tets[4*nt + tet_faces[k][1]];
+      int w = tets[4*nt + tet_faces[k][2]];
+      sort3(&u, &v, &w);
+
+      int found = 0;
+      for ( int j = 0; j < num_faces; j++ ){
+        int *f = &cavity_faces[6*j];
+        if (f[0] == u && f[1] == v && f[2] == w){
+          int n = f[3];
+          adj[4*nt+k] = n;
+          if (f[4]){
+            marks[nt] |= (1 << k);
+          }
+          if (n >= 0){
+            for ( int jj = 0; jj < 4; jj++ ){
+              int q = tets[4*n+jj];
+              if (q != u && q != v && q != w){
+                adj[4*n+jj] = nt;
+                break;
+              }
+            }
+          }
+          found = 1;
+          break;
+        }
+      }
+
+      for ( int j = i+1; j < nnew && !found; j++ ){
+        int ot = new_tets[j];
+        for ( int kk = 0; kk < 4; kk++ ){
+          int a = tets[4*ot + tet_faces[kk][0]];
+          int b = tets[4*ot + tet_faces[kk][1]];
+          int c = tets[4*ot + tet_faces[kk][2]];
+          sort3(&a, &b, &c);
+          if (a == u && b == v && c == w){
+            adj[4*nt+k] = ot;
+            adj[4*ot+kk] = nt;
+            found = 1;
+            break;
+          }
+        }
+      }
+    }
+  }
+
+  last_tet = new_tets[0];
+  delete [] new_tets;
+}
+
+/*
+  Find all of the tetrahedra that contain the vertex u. The result is
+  stored in the star array.
+*/
+int TMRTetrahedralize::getVertexStar( int u ){
+  int t = pts_to_tets[u];
+  if (t < 0 || (flags[t] & TET_DELETED)){
+    return 0;
+  }
+
+  search_tag++;
+  int nstar = 1;
+  star[0] = t;
+  tags[t] = search_tag;
+  for ( int i = 0; i < nstar; i++ ){
+    int s = star[i];
+    for ( int k = 0; k < 4; k++ ){
+      // The faces opposite to the other vertices contain u
+      if (tets[4*s+k] == u){
+        continue;
+      }
+      int n = adj[4*s+k];
+      if (n >= 0 && tags[n] != search_tag){
+        if (nstar >= max_star){
+          resize_array(&star, nstar, 2*max_star);
+          max_star *= 2;
+        }
+        tags[n] = search_tag;
+        star[nstar] = n;
+        nstar++;
+      }
+    }
+  }
+
+  return nstar;
+}
+
+/*
+  Find a tetrahedron that contains the face (u, v, w)
+*/
+int TMRTetrahedralize::findFace( int u, int v, int w ){
+  int nstar = getVertexStar(u);
+  for ( int i = 0; i < nstar; i++ ){
+    const int *t = &tets[4*star[i]];
+    int count = 0;
+    for ( int k = 0; k < 4; k++ ){
+      if (t[k] == v || t[k] == w){
+        count++;
+      }
+    }
+    if (count == 2){
+      return star[i];
+    }
+  }
+  return -1;
+}
+
+/*
+  Check whether the triangle (u, v, w) is a boundary triangle
+*/
+int TMRTetrahedralize::isBoundaryFace( int u, int v, int w ){
+  sort3(&u, &v, &w);
+  uint32_t index = TMRIntegerTripletHash(u, v, w) & (face_table_size-1);
+  while (face_table[3*index] >= 0){
+    if (face_table[3*index] == u && face_table[3*index+1] == v &&
+        face_table[3*index+2] == w){
+      return 1;
+    }
+    index = (index + 1) & (face_table_size-1);
+  }
+  return 0;
+}
+
+/*
+  Check whether the edge (u, v) is the edge of a boundary triangle
+*/
+int TMRTetrahedralize::isBoundaryEdge( int u, int v ){
+  if (u > v){
+    int tmp = u;  u = v;  v = tmp;
+  }
+  uint32_t index = TMRIntegerPairHash(u, v) & (edge_table_size-1);
+  while (edge_table[2*index] >= 0){
+    if (edge_table[2*index] == u && edge_table[2*index+1] == v){
+      return 1;
+    }
+    index = (index + 1) & (edge_table_size-1);
+  }
+  return 0;
+}
+
+/*
+  Check whether the edge (x, y) crosses the interior of the triangle
+  (u, v, w). This includes edges that lie in the plane of the
+  triangle and overlap with its interior.
+*/
+int TMRTetrahedralize::edgeCrossesFace( int x, int y,
+                                        int u, int v, int w ){
+  int xshared = (x == u || x == v || x == w);
+  int yshared = (y == u || y == v || y == w);
+  if (xshared && yshared){
+    return 0;
+  }
+
+  const double *pu = &pts[3*u];
+  const double *pv = &pts[3*v];
+  const double *pw = &pts[3*w];
+  const double *px = &pts[3*x];
+  const double *py = &pts[3*y];
+
+  double ox = (xshared ? 0.0 : orient(pu, pv, pw, px));
+  double oy = (yshared ? 0.0 : orient(pu, pv, pw, py));
+
+  if ((ox > 0.0 && oy < 0.0) || (ox < 0.0 && oy > 0.0)){
+    // The edge crosses the plane of the triangle
+    double s1 = orient(px, py, pu, pv);
+    double s2 = orient(px, py, pv, pw);
+    double s3 = orient(px, py, pw, pu);
+    return ((s1 >= 0.0 && s2 >= 0.0 && s3 >= 0.0) ||
+            (s1 <= 0.0 && s2 <= 0.0 && s3 <= 0.0));
+  }
+  else if (ox != 0.0 || oy != 0.0){
+    return 0;
+  }
+
+  // The edge lies in the plane of the triangle. Perform the
+  // orientation tests in the plane with a point above the triangle.
+  double d1[3], d2[3], q[3];
+  for ( int k = 0; k < 3; k++ ){
+    d1[k] = pv[k] - pu[k];
+    d2[k] = pw[k] - pu[k];
+  }
+  double n[3];
+  n[0] = d1[1]*d2[2] - d1[2]*d2[1];
+  n[1] = d1[2]*d2[0] - d1[0]*d2[2];
+  n[2] = d1[0]*d2[1] - d1[1]*d2[0];
+  double nrm = sqrt(n[0]*n[0] + n[1]*n[1] + n[2]*n[2]);
+  double len = sqrt(d1[0]*d1[0] + d1[1]*d1[1] + d1[2]*d1[2]);
+  if (nrm == 0.0){
+    return 0;
+  }
+  for ( int k = 0; k < 3; k++ ){
+    q[k] = pu[k] + len*n[k]/nrm;
+  }
+
+  if (xshared || yshared){
+    // The edge starts from a vertex of the triangle. It overlaps the
+    // triangle if the other end lies strictly inside the angle of the
+    // triangle at the shared vertex.
+    int s = (xshared ? x : y);
+    const double *pe = (xshared ? py : px);
+    int o1 = u, o2 = v;
+    if (s == u){ o1 = v; o2 = w; }
+    else if (s == v){ o1 = w; o2 = u; }
+    const double *ps = &pts[3*s];
+    const double *p1 = &pts[3*o1];
+    const double *p2 = &pts[3*o2];
+
+    double a1 = orient(ps, p1, q, pe);
+    double b1 = orient(ps, p1, q, p2);
+    double a2 = orient(ps, p2, q, pe);
+    double b2 = orient(ps, p2, q, p1);
+    return ((a1 > 0.0 && b1 > 0.0) || (a1 < 0.0 && b1 < 0.0)) &&
+      ((a2 > 0.0 && b2 > 0.0) || (a2 < 0.0 && b2 < 0.0));
+  }
+
+  // Check whether the edges of the triangle separate the edge from
+  // the triangle
+  const double *tri[3] = {pu, pv, pw};
+  for ( int k = 0; k < 3; k++ ){
+    const double *a = tri[k];
+    const double *b = tri[(k+1) % 3];
+    const double *c = tri[(k+2) % 3];
+    double sc = orient(a, b, q, c);
+    double sx = orient(a, b, q, px);
+    double sy = orient(a, b, q, py);
+    if (sc > 0.0 && sx <= 0.0 && sy <= 0.0){
+      return 0;
+    }
+    if (sc < 0.0 && sx >= 0.0 && sy >= 0.0){
+      return 0;
+    }
+  }
+
+  // Check whether the line through the edge separates the triangle
+  double su = orient(px, py, q, pu);
+  double sv = orient(px, py, q, pv);
+  double sw = orient(px, py, q, pw);
+  if ((su >= 0.0 && sv >= 0.0 && sw >= 0.0) ||
+      (su <= 0.0 && sv <= 0.0 && sw <= 0.0)){
+    return 0;
+  }
+
+  return 1;
+}
+
+/*
+  Remove the edge (x, y) contained in tetrahedron t
+
+  The tetrahedra about the edge are replaced with tetrahedra formed by
+  a triangulation of the ring of vertices about the edge, joined to x
+  and y. The triangulation is selected to maximize the minimum
+  tetrahedron quality. If the vertices of the boundary triangle
+  (u, v, w) lie in the ring, the triangulation is forced to contain the
+  triangle (or the corresponding ring diagonal when x or y is a vertex
+  of the triangle) so that the triangle is recovered.
+
+  If improve is set, the edge is only removed if the minimum quality
+  of the new tetrahedra exceeds that of the tetrahedra about the edge.
+
+  The code returns 1 if the edge is removed and 0 otherwise.
+*/
+int TMRTetrahedralize::removeEdge( int t, int x, int y,
+                                   int u, int v, int w, int improve ){
+  if (isBoundaryEdge(x, y)){
+    return 0;
+  }
+
+  // Find the ring of vertices about the edge
+  int ring[MAX_EDGE_RING+1];
+  int ring_tets[MAX_EDGE_RING];
+  int n = 0;
+
+  int r = -1;
+  for ( int k = 0; k < 4; k++ ){
+    if (tets[4*t+k] != x && tets[4*t+k] != y){
+      r = tets[4*t+k];
+      break;
+    }
+  }
+
+  int cur = t;
+  while (1){
+    if (n >= MAX_EDGE_RING){
+      return 0;
+    }
+
+    // Find the other vertex and the index of r in the tetrahedron
+    int kr = -1, next_r = -1;
+    for ( int k = 0; k < 4; k++ ){
+      int q = tets[4*cur+k];
+      if (q == r){
+        kr = k;
+      }
+      else if (q != x && q != y){
+        next_r = q;
+      }
+    }
+    if (kr < 0 || next_r < 0){
+      return 0;
+    }
+
+    // Do not destroy a boundary triangle
+    if (isBoundaryFace(x, y, next_r)){
+      return 0;
+    }
+
+    ring[n] = r;
+    ring_tets[n] = cur;
+    n++;
+
+    cur = adj[4*cur + kr];
+    if (cur < 0){
+      return 0;
+    }
+    r = next_r;
+    if (cur == t){
+      break;
+    }
+  }
+
+  // Order the ring so that (x, y, ring[0], ring[1]) is positive. A
+  // triangle (ring[i], ring[j], ring[k]) with i < j < k can then be
+  // joined to x and y if y lies above it and x lies below it.
+  if (orient(&pts[3*x], &pts[3*y],
+             &pts[3*ring[0]], &pts[3*ring[1]]) < 0.0){
+    // The tet ring_tets[i] contains the ring vertices i and i+1
+    int tmp_tets[MAX_EDGE_RING];
+    for ( int i = 0; i < n; i++ ){
+      tmp_tets[i] = ring_tets[(2*n-2-i) % n];
+    }
+    for ( int i = 0; i < n; i++ ){
+      ring_tets[i] = tmp_tets[i];
+    }
+    for ( int i = 0; i < n/2; i++ ){
+      int tmp = ring[i];
+      ring[i] = ring[n-1-i];
+      ring[n-1-i] = tmp;
+    }
+  }
+
+  // Find the positions of the triangle vertices in the ring
+  int tri[3] = {u, v, w};
+  int pos[3], npos = 0, nshared = 0;
+  for ( int j = 0; j < 3; j++ ){
+    if (tri[j] == x || tri[j] == y){
+      nshared++;
+      continue;
+    }
+    for ( int i = 0; i < n; i++ ){
+      if (ring[i] == tri[j]){
+        pos[npos] = i;
+        npos++;
+        break;
+      }
+    }
+  }
+
+  // Set the chains of the ring that will be triangulated. The ring
+  // is rotated so that the first forced vertex is at index zero.
+  int shift = 0;
+  int nchains = 1;
+  int chains[3][2] = {{0, n-1}, {0, 0}, {0, 0}};
+  int forced_tri = 0;
+  if (npos == 3 && nshared == 0){
+    std::sort(pos, pos+3);
+    shift = pos[0];
+    nchains = 3;
+    chains[0][0] = 0;  chains[0][1] = pos[1] - shift;
+    chains[1][0] = pos[1] - shift;  chains[1][1] = pos[2] - shift;
+    chains[2][0] = pos[2] - shift;  chains[2][1] = n;
+    forced_tri = 1;
+  }
+  else if (npos == 2 && nshared == 1){
+    std::sort(pos, pos+2);
+    shift = pos[0];
+    nchains = 2;
+    chains[0][0] = 0;  chains[0][1] = pos[1] - shift;
+    chains[1][0] = pos[1] - shift;  chains[1][1] = n;
+  }
+
+  int ext[MAX_EDGE_RING+1];
+  for ( int i = 0; i <= n; i++ ){
+    ext[i] = ring[(i + shift) % n];
+  }
+
+  const double *px = &pts[3*x];
+  const double *py = &pts[3*y];
+
+  // Compute the best triangulation of each chain of the ring using
+  // dynamic programming
+  double best[MAX_EDGE_RING+1][MAX_EDGE_RING+1];
+  int split[MAX_EDGE_RING+1][MAX_EDGE_RING+1];
+  for ( int len = 1; len <= n; len++ ){
+    for ( int i = 0; i + len <= n; i++ ){
+      int j = i + len;
+      if (len == 1){
+        best[i][j] = 1e20;
+        split[i][j] = -1;
+        continue;
+      }
+
+      best[i][j] = -1.0;
+      split[i][j] = -1;
+      for ( int k = i+1; k < j; k++ ){
+        double q = best[i][k];
+        if (best[k][j] < q){
+          q = best[k][j];
+        }
+        if (q <= best[i][j]){
+          continue;
+        }
+
+        const double *a = &pts[3*ext[i]];
+        const double *b = &pts[3*ext[k]];
+        const double *c = &pts[3*ext[j]];
+        if (orient(a, b, c, py) <= 0.0 || orient(a, b, c, px) >= 0.0){
+          continue;
+        }
+        double q1 = tet_quality(a, b, c, py);
+        double q2 = tet_quality(c, b, a, px);
+        if (q1 < q){ q = q1; }
+        if (q2 < q){ q = q2; }
+        if (q > best[i][j]){
+          best[i][j] = q;
+          split[i][j] = k;
+        }
+      }
+    }
+  }
+
+  // Find the minimum quality that the triangulation must exceed
+  double qmin = 0.0;
+  if (improve){
+    qmin = 1e20;
+    for ( int i = 0; i < n; i++ ){
+      const int *c = &tets[4*ring_tets[i]];
+      double q = tet_quality(&pts[3*c[0]], &pts[3*c[1]],
+                             &pts[3*c[2]], &pts[3*c[3]]);
+      if (q < qmin){
+        qmin = q;
+      }
+    }
+  }
+
+  // Check that a valid triangulation exists
+  int valid = 1;
+  for ( int i = 0; i < nchains; i++ ){
+    if (best[chains[i][0]][chains[i][1]] <= qmin){
+      valid = 0;
+    }
+  }
+  if (valid && forced_tri){
+    const double *a = &pts[3*ext[chains[0][0]]];
+    const double *b = &pts[3*ext[chains[1][0]]];
+    const double *c = &pts[3*ext[chains[2][0]]];
+    if (orient(a, b, c, py) <= 0.0 || orient(a, b, c, px) >= 0.0){
+      valid = 0;
+    }
+  }
+
+  if (!valid && improve){
+    return 0;
+  }
+  else if (!valid){
+    // Remove a vertex from the ring with a 2-3 flip of one of the
+    // faces about the edge and try again. This is required when
+    // several of the ring vertices are coplanar with the edge.
+    for ( int i = 0; i < n && n > 3; i++ ){
+      int r0 = ring[(i+n-1) % n], r1 = ring[i], r2 = ring[(i+1) % n];
+      if (r1 == u || r1 == v || r1 == w){
+        continue;
+      }
+      const double *p0 = &pts[3*r0];
+      const double *p1 = &pts[3*r1];
+      const double *p2 = &pts[3*r2];
+      if (orient(px, py, p0, p2) > 0.0 &&
+          orient(p0, p1, p2, py) > 0.0 &&
+          orient(p2, p1, p0, px) > 0.0){
+        int old[2];
+        old[0] = ring_tets[(i+n-1) % n];
+        old[1] = ring_tets[i];
+        int conn[12] = {x, y, r0, r2,
+                        r0, r1, r2, y,
+                        r2, r1, r0, x};
+        replaceTets(2, old, 3, conn);
+        return removeEdge(last_tet, x, y, u, v, w);
+      }
+    }
+
+    // The edge is a diagonal of the quadrilateral formed with the
+    // triangle. Fill the two sides of the quadrilateral separately.
+    if (nshared == 1 && npos == 2 &&
+        orient(px, py, &pts[3*ring[pos[0]]], &pts[3*ring[pos[1]]]) == 0.0){
+      return splitCoplanarRing(x, y, n, ring, ring_tets, pos[0], pos[1]);
+    }
+    return 0;
+  }
+
+  // Extract the new tetrahedra from the triangulation
+  int conn[8*MAX_EDGE_RING];
+  int nnew = 0;
+  int stack[4*MAX_EDGE_RING];
+  for ( int i = 0; i < nchains; i++ ){
+    int nstack = 1;
+    stack[0] = chains[i][0];
+    stack[1] = chains[i][1];
+    while (nstack > 0){
+      nstack--;
+      int a = stack[2*nstack], c = stack[2*nstack+1];
+      int b = split[a][c];
+      if (b < 0){
+        continue;
+      }
+      int *t1 = &conn[4*nnew];
+      t1[0] = ext[a];  t1[1] = ext[b];  t1[2] = ext[c];  t1[3] = y;
+      int *t2 = &conn[4*(nnew+1)];
+      t2[0] = ext[c];  t2[1] = ext[b];  t2[2] = ext[a];  t2[3] = x;
+      nnew += 2;
+
+      stack[2*nstack] = a;
+      stack[2*nstack+1] = b;
+      stack[2*nstack+2] = b;
+      stack[2*nstack+3] = c;
+      nstack += 2;
+    }
+  }
+  if (forced_tri){
+    int a = chains[0][0], b = chains[1][0], c = chains[2][0];
+    int *t1 = &conn[4*nnew];
+    t1[0] = ext[a];  t1[1] = ext[b];  t1[2] = ext[c];  t1[3] = y;
+    int *t2 = &conn[4*(nnew+1)];
+    t2[0] = ext[c];  t2[1] = ext[b];  t2[2] = ext[a];  t2[3] = x;
+    nnew += 2;
+  }
+
+  replaceTets(n, ring_tets, nnew, conn);
+
+  return 1;
+}
+
+/*
+  Replace the edge (x, y) by the edge (ring[ia], ring[ib]) where x, y,
+  ring[ia] and ring[ib] are coplanar
+
+  The plane through the edges splits the ring into two chains. The
+  region on each side of the plane is filled with the star of one of
+  its ring vertices or, if no ring vertex can see all of the faces,
+  with the star of a new point inside the region. The new point does
+  not lie on the plane, so it is never added to the boundary.
+
+  The code returns 1 if the edge is removed and 0 otherwise.
+*/
+int TMRTetrahedralize::splitCoplanarRing( int x, int y, int n,
+                                          const int ring[],
+                                          const int ring_tets[],
+                                          int ia, int ib ){
+  const double *px = &pts[3*x];
+  const double *py = &pts[3*y];
+  int a = ring[ia], b = ring[ib];
+
+  int conn[16*MAX_EDGE_RING];
+  int nnew = 0;
+  double steiner[2][3];
+  int nsteiner = 0;
+
+  for ( int side = 0; side < 2; side++ ){
+    // The chain of ring vertices from ring[start] to ring[end]
+    int start = (side == 0 ? ia : ib);
+    int end = (side == 0 ? ib : ia + n);
+    if (end - start < 2){
+      return 0;
+    }
+
+    // Collect the faces that bound the region on this side. The faces
+    // are ordered so that points in the region are above them.
+    int faces[2*MAX_EDGE_RING+2][3];
+    int nfaces = 0;
+    for ( int i = start; i < end; i++ ){
+      int r0 = ring[i % n], r1 = ring[(i+1) % n];
+      faces[nfaces][0] = x;
+      faces[nfaces][1] = r0;
+      faces[nfaces][2] = r1;
+      faces[nfaces+1][0] = y;
+      faces[nfaces+1][1] = r1;
+      faces[nfaces+1][2] = r0;
+      nfaces += 2;
+    }
+
+    // All the other vertices must lie strictly on one side
+    const double *pr = &pts[3*ring[(start+1) % n]];
+    for ( int i = start+1; i < end; i++ ){
+      const double *q = &pts[3*ring[i % n]];
+      double o1 = orient(&pts[3*a], &pts[3*b], px, pr);
+      double o2 = orient(&pts[3*a], &pts[3*b], px, q);
+      if (o1 == 0.0 || o2 == 0.0 || (o1 > 0.0) != (o2 > 0.0)){
+        return 0;
+      }
+    }
+    int pa = a, pb = b;
+    if (orient(&pts[3*a], &pts[3*b], px, pr) < 0.0){
+      pa = b;  pb = a;
+    }
+    faces[nfaces][0] = pa;
+    faces[nfaces][1] = pb;
+    faces[nfaces][2] = x;
+    faces[nfaces+1][0] = pb;
+    faces[nfaces+1][1] = pa;
+    faces[nfaces+1][2] = y;
+    nfaces += 2;
+
+    // Try the star of each of the ring vertices on this side
+    int apex = -1;
+    for ( int i = start+1; i < end && apex < 0; i++ ){
+      int r = ring[i % n];
+      const double *q = &pts[3*r];
+      int visible = 1;
+      for ( int j = 0; j < nfaces && visible; j++ ){
+        if (faces[j][0] == r || faces[j][1] == r || faces[j][2] == r){
+          continue;
+        }
+        if (orient(&pts[3*faces[j][0]], &pts[3*faces[j][1]],
+                   &pts[3*faces[j][2]], q) <= 0.0){
+          visible = 0;
+        }
+      }
+      if (visible){
+        apex = r;
+      }
+    }
+
+    // Otherwise, find a point that can see all of the faces. The
+    // candidates lie between the midpoint of the edge and the ring
+    // vertices. Select the point that is furthest from the faces.
+    double *p = steiner[nsteiner];
+    if (apex < 0){
+      double m[3];
+      for ( int k = 0; k < 3; k++ ){
+        m[k] = 0.5*(px[k] + py[k]);
+      }
+
+      double best = 0.0;
+      for ( int i = start+1; i < end; i++ ){
+        const double *q = &pts[3*ring[i % n]];
+        for ( double t = 0.5; t > 1e-6; t *= 0.5 ){
+          double c[3];
+          for ( int k = 0; k < 3; k++ ){
+            c[k] = m[k] + t*(q[k] - m[k]);
+          }
+
+          // Compute the minimum distance to the faces
+          double hmin = 1e300;
+          for ( int j = 0; j < nfaces && hmin > best; j++ ){
+            const double *f0 = &pts[3*faces[j][0]];
+            const double *f1 = &pts[3*faces[j][1]];
+            const double *f2 = &pts[3*faces[j][2]];
+            double o = orient(f0, f1, f2, c);
+            if (o <= 0.0){
+              hmin = 0.0;
+              break;
+            }
+            double d1[3], d2[3];
+            for ( int k = 0; k < 3; k++ ){
+              d1[k] = f1[k] - f0[k];
+              d2[k] = f2[k] - f0[k];
+            }
+            double nx = d1[1]*d2[2] - d1[2]*d2[1];
+            double ny = d1[2]*d2[0] - d1[0]*d2[2];
+            double nz = d1[0]*d2[1] - d1[1]*d2[0];
+            double h = o/sqrt(nx*nx + ny*ny + nz*nz);
+            if (h < hmin){
+              hmin = h;
+            }
+          }
+
+          if (hmin > best){
+            best = hmin;
+            p[0] = c[0];  p[1] = c[1];  p[2] = c[2];
+          }
+        }
+      }
+      if (best <= 0.0){
+        return 0;
+      }
+
+      // Use a placeholder index for the new point
+      apex = -1 - nsteiner;
+      nsteiner++;
+    }
+
+    for ( int j = 0; j < nfaces; j++ ){
+      if (faces[j][0] == apex || faces[j][1] == apex ||
+          faces[j][2] == apex){
+        continue;
+      }
+      conn[4*nnew] = faces[j][0];
+      conn[4*nnew+1] = faces[j][1];
+      conn[4*nnew+2] = faces[j][2];
+      conn[4*nnew+3] = apex;
+      nnew++;
+    }
+  }
+
+  // Add the new points and replace the tetrahedra about the edge
+  for ( int i = 0; i < nsteiner; i++ ){
+    int pt = addPoint(steiner[i]);
+    for ( int j = 0; j < 4*nnew; j++ ){
+      if (conn[j] == -1 - i){
+        conn[j] = pt;
+      }
+    }
+  }
+
+  replaceTets(n, ring_tets, nnew, conn);
+
+  return 1;
+}
+
+/*
+  Recover the boundary triangle (u, v, w) by removing the edges of the
+  mesh that cross it
+
+  The code returns 0 if the triangle is recovered and 1 otherwise.
+*/
+int TMRTetrahedralize::recoverFace( int u, int v, int w ){
+  const int max_iterations = 100;
+  for ( int iter = 0; iter < max_iterations; iter++ ){
+    if (findFace(u, v, w) >= 0){
+      return 0;
+    }
+
+    // Search the tetrahedra about the vertices of the triangle for an
+    // edge that crosses the triangle and try to remove it
+    int removed = 0;
+    int tri[3] = {u, v, w};
+    for ( int j = 0; j < 3 && !removed; j++ ){
+      int nstar = getVertexStar(tri[j]);
+      for ( int i = 0; i < nstar && !removed; i++ ){
+        int t = star[i];
+        for ( int k = 0; k < 6; k++ ){
+          int x = tets[4*t + tet_edges[k][0]];
+          int y = tets[4*t + tet_edges[k][1]];
+          if (edgeCrossesFace(x, y, u, v, w) &&
+              removeEdge(t, x, y, u, v, w)){
+            removed = 1;
+            break;
+          }
+        }
+      }
+    }
+
+    if (!removed){
+      return 1;
+    }
+  }
+
+  return (findFace(u, v, w) < 0);
+}
+
+/*
+  Recover the boundary triangles
+
+  The code returns the number of triangles that are still missing.
+*/
+int TMRTetrahedralize::recoverFaces(){
+  // Recovering one triangle may help with the recovery of another,
+  // so make several passes.
+  int num_missing = num_boundary_tris;
+  int *missing = new int[ num_boundary_tris ];
+  for ( int i = 0; i < num_boundary_tris; i++ ){
+    missing[i] = i;
+  }
+
+  for ( int pass = 0; pass < 8 && num_missing > 0; pass++ ){
+    int num = 0;
+    for ( int i = 0; i < num_missing; i++ ){
+      const int *tri = &boundary_tris[3*missing[i]];
+      if (findFace(tri[0], tri[1], tri[2]) >= 0 ||
+          recoverFace(tri[0], tri[1], tri[2]) == 0){
+        continue;
+      }
+      missing[num] = missing[i];
+      num++;
+    }
+
+    if (num == num_missing){
+      break;
+    }
+    num_missing = num;
+  }
+  delete [] missing;
+
+  // The recovery of a triangle may remove a triangle recovered
+  // earlier, so check them all again
+  num_missing = 0;
+  for ( int i = 0; i < num_boundary_tris; i++ ){
+    const int *tri = &boundary_tris[3*i];
+    if (findFace(tri[0], tri[1], tri[2]) < 0){
+      num_missing++;
+    }
+  }
+
+  return num_missing;
+}
+
+/*
+  Recover the boundary triangles and delete the tetrahedra that lie
+  outside the domain
+
+  The tetrahedra are classified by crossing the boundary triangles
+  from the enclosing tetrahedron. Regions that are separated from the
+  enclosing tetrahedron by an odd number of boundary surfaces are
+  inside the domain. This allows for internal voids.
+*/
+int TMRTetrahedralize::recoverBoundary(){
+  int num_missing = recoverFaces();
+  if (num_missing > 0){
+    fprintf(stderr, "TMRTetrahedralize Error: Failed to recover "
+            "%d of %d boundary triangles\n",
+            num_missing, num_boundary_tris);
+    return num_missing;
+  }
+
+  // Mark the faces of the tetrahedra that are boundary triangles
+  for ( int t = 0; t < num_tets; t++ ){
+    if (flags[t] & TET_DELETED){
+      continue;
+    }
+    marks[t] = 0;
+    for ( int k = 0; k < 4; k++ ){
+      if (isBoundaryFace(tets[4*t + tet_faces[k][0]],
+                         tets[4*t + tet_faces[k][1]],
+                         tets[4*t + tet_faces[k][2]])){
+        marks[t] |= (1 << k);
+      }
+    }
+  }
+
+  // Find the number of boundary surfaces crossed to reach each
+  // tetrahedron from the enclosing tetrahedron
+  int *depth = new int[ num_tets ];
+  int *queue = new int[ num_tets ];
+  int *next_queue = new int[ 4*num_tets ];
+  for ( int t = 0; t < num_tets; t++ ){
+    depth[t] = -1;
+  }
+
+  int nqueue = 0;
+  int t0 = pts_to_tets[0];
+  depth[t0] = 0;
+  queue[nqueue] = t0;
+  nqueue++;
+
+  for ( int level = 0; nqueue > 0; level++ ){
+    int nnext = 0;
+    for ( int i = 0; i < nqueue; i++ ){
+      int t = queue[i];
+      for ( int k = 0; k < 4; k++ ){
+        int n = adj[4*t+k];
+        if (n < 0 || depth[n] >= 0){
+          continue;
+        }
+        if (marks[t] & (1 << k)){
+          next_queue[nnext] = n;
+          nnext++;
+        }
+        else {
+          depth[n] = level;
+          queue[nqueue] = n;
+          nqueue++;
+        }
+      }
+    }
+
+    // Set the next level of tetrahedra across the boundary
+    nqueue = 0;
+    for ( int i = 0; i < nnext; i++ ){
+      int n = next_queue[i];
+      if (depth[n] < 0){
+        depth[n] = level+1;
+        queue[nqueue] = n;
+        nqueue++;
+      }
+    }
+  }
+
+  // Delete the tetrahedra outside the domain
+  for ( int t = 0; t < num_tets; t++ ){
+    if (!(flags[t] & TET_DELETED) &&
+        (depth[t] < 0 || depth[t] % 2 == 0)){
+      for ( int k = 0; k < 4; k++ ){
+        int n = adj[4*t+k];
+        if (n >= 0){
+          for ( int j = 0; j < 4; j++ ){
+            if (adj[4*n+j] == t){
+              adj[4*n+j] = -1;
+            }
+          }
+        }
+      }
+      deleteTet(t);
+    }
+  }
+
+  delete [] depth;
+  delete [] queue;
+  delete [] next_queue;
+
+  // Reset the point to tetrahedron pointers
+  for ( int i = 0; i < num_points; i++ ){
+    pts_to_tets[i] = -1;
+  }
+  for ( int t = 0; t < num_tets; t++ ){
+    if (!(flags[t] & TET_DELETED)){
+      for ( int k = 0; k < 4; k++ ){
+        pts_to_tets[tets[4*t+k]] = t;
+      }
+      last_tet = t;
+    }
+  }
+
+  return 0;
+}
+
+/*
+  Flip the face k of the tetrahedron t with a 2-3 flip
+
+  The two tetrahedra that share the face are replaced by three
+  tetrahedra about the edge joining their opposite vertices. The flip
+  is only performed if the edge passes through the interior of the
+  face and the minimum quality of the new tetrahedra exceeds that of
+  the old tetrahedra. Boundary triangles are never flipped.
+
+  The code returns 1 if the face is flipped and 0 otherwise.
+*/
+int TMRTetrahedralize::flipFace( int t, int k ){
+  int n = adj[4*t+k];
+  if (n < 0 || (marks[t] & (1 << k))){
+    return 0;
+  }
+
+  int u = tets[4*t + tet_faces[k][0]];
+  int v = tets[4*t + tet_faces[k][1]];
+  int w = tets[4*t + tet_faces[k][2]];
+  int a = tets[4*t+k];
+  int b = -1;
+  for ( int j = 0; j < 4; j++ ){
+    if (adj[4*n+j] == t){
+      b = tets[4*n+j];
+      break;
+    }
+  }
+  if (b < 0){
+    return 0;
+  }
+
+  // The new tetrahedra replace one of the face vertices in (u, v, w, a)
+  // with b so that they have the same orientation
+  int conn[12] = {u, v, b, a,
+                  v, w, b, a,
+                  w, u, b, a};
+
+  const int *ct = &tets[4*t];
+  const int *cn = &tets[4*n];
+  double q0 = tet_quality(&pts[3*ct[0]], &pts[3*ct[1]],
+                          &pts[3*ct[2]], &pts[3*ct[3]]);
+  double q1 = tet_quality(&pts[3*cn[0]], &pts[3*cn[1]],
+                          &pts[3*cn[2]], &pts[3*cn[3]]);
+  double qmin = (q0 < q1 ? q0 : q1);
+
+  for ( int i = 0; i < 3; i++ ){
+    const int *c = &conn[4*i];
+    if (orient(&pts[3*c[0]], &pts[3*c[1]],
+               &pts[3*c[2]], &pts[3*c[3]]) <= 0.0){
+      return 0;
+    }
+    double q = tet_quality(&pts[3*c[0]], &pts[3*c[1]],
+                           &pts[3*c[2]], &pts[3*c[3]]);
+    if (q <= qmin){
+      return 0;
+    }
+  }
+
+  int old[2] = {t, n};
+  replaceTets(2, old, 3, conn);
+
+  return 1;
+}
+
+/*
+  Remove the slivers from the mesh
+
+  Delaunay refinement bounds the radius-edge ratio of the tetrahedra
+  but not their volume: four nearly cocircular points form a sliver
+  with a small circumradius and an almost zero volume. Each
+  tetrahedron with a quality below min_quality is removed, if
+  possible, by removing one of its edges or by a 2-3 flip of one of
+  its faces. Only flips that improve the minimum quality of the
+  tetrahedra that they replace are performed, so the passes over the
+  mesh terminate.
+
+  The code returns the number of flips that were performed.
+*/
+int TMRTetrahedralize::removeSlivers( double min_quality ){
+  const int max_passes = 10;
+
+  int num_flips = 0;
+  for ( int pass = 0; pass < max_passes; pass++ ){
+    int pass_flips = 0;
+    for ( int t = 0; t < num_tets; t++ ){
+      if (flags[t] & TET_DELETED){
+        continue;
+      }
+      const int *c = &tets[4*t];
+      double q = tet_quality(&pts[3*c[0]], &pts[3*c[1]],
+                             &pts[3*c[2]], &pts[3*c[3]]);
+      if (q >= min_quality){
+        continue;
+      }
+
+      // Try to remove each of the edges, and then flip each of the
+      // faces of the tetrahedron
+      int flipped = 0;
+      for ( int k = 0; k < 6 && !flipped; k++ ){
+        int x = tets[4*t + tet_edges[k][0]];
+        int y = tets[4*t + tet_edges[k][1]];
+        flipped = removeEdge(t, x, y, -1, -1, -1, 1);
+      }
+      for ( int k = 0; k < 4 && !flipped; k++ ){
+        flipped = flipFace(t, k);
+      }
+      pass_flips += flipped;
+    }
+
+    num_flips += pass_flips;
+    if (pass_flips == 0){
+      break;
+    }
+  }
+
+  return num_flips;
+}
+
+/*
+  Compute the circumcenter and circumradius of the tetrahedron
+*/
+double TMRTetrahedralize::computeCircumcenter( int t, double c[] ){
+  const double *a = &pts[3*tets[4*t]];
+  const double *b = &pts[3*tets[4*t+1]];
+  const double *d = &pts[3*tets[4*t+2]];
+  const double *e = &pts[3*tets[4*t+3]];
+
+  double d1[3], d2[3], d3[3];
+  for ( int k = 0; k < 3; k++ ){
+    d1[k] = b[k] - a[k];
+    d2[k] = d[k] - a[k];
+    d3[k] = e[k] - a[k];
+  }
+  double l1 = d1[0]*d1[0] + d1[1]*d1[1] + d1[2]*d1[2];
+  double l2 = d2[0]*d2[0] + d2[1]*d2[1] + d2[2]*d2[2];
+  double l3 = d3[0]*d3[0] + d3[1]*d3[1] + d3[2]*d3[2];
+
+  // Compute the cross products
+  double c23[3], c31[3], c12[3];
+  c23[0] = d2[1]*d3[2] - d2[2]*d3[1];
+  c23[1] = d2[2]*d3[0] - d2[0]*d3[2];
+  c23[2] = d2[0]*d3[1] - d2[1]*d3[0];
+  c31[0] = d3[1]*d1[2] - d3[2]*d1[1];
+  c31[1] = d3[2]*d1[0] - d3[0]*d1[2];
+  c31[2] = d3[0]*d1[1] - d3[1]*d1[0];
+  c12[0] = d1[1]*d2[2] - d1[2]*d2[1];
+  c12[1] = d1[2]*d2[0] - d1[0]*d2[2];
+  c12[2] = d1[0]*d2[1] - d1[1]*d2[0];
+
+  double det = 2.0*(d1[0]*c23[0] + d1[1]*c23[1] + d1[2]*c23[2]);
+  if (det == 0.0){
+    c[0] = a[0];  c[1] = a[1];  c[2] = a[2];
+    return 0.0;
+  }
+
+  double r[3];
+  for ( int k = 0; k < 3; k++ ){
+    r[k] = (l1*c23[k] + l2*c31[k] + l3*c12[k])/det;
+    c[k] = a[k] + r[k];
+  }
+
+  return sqrt(r[0]*r[0] + r[1]*r[1] + r[2]*r[2]);
+}
+
+/*
+  Refine the interior of the mesh
+
+  Tetrahedra are refined if their circumradius is too large compared
+  with the circumradius of a regular tetrahedron with an edge length
+  equal to the local element feature size, or if their
+  radius-edge ratio exceeds 2. The circumcenter is inserted if it can
+  be reached without crossing the boundary and is not too close to a
+  boundary triangle. Otherwise, a tetrahedron that is too large is
+  split at its centroid.
+
+  The boundary triangles are never split, so the refinement is
+  limited near the boundary so that it terminates:
+
+  1. A tetrahedron with a boundary vertex is not refined if its
+  circumradius is below the size limit for the local boundary
+  spacing, which is the shortest boundary edge at its boundary
+  vertices.
+
+  2. A point is not inserted if it encroaches on a boundary triangle
+  or if it is closer than a fraction of the local size to an existing
+  point. Both the circumcenter and the centroid are subject to these
+  checks.
+
+  3. The number of inserted points is capped at a multiple of the
+  number of tetrahedra expected from the element feature size.
+*/
+void TMRTetrahedralize::refine( TMRMeshOptions options,
+                                TMRElementFeatureSize *fs ){
+  // The circumradius of a regular tetrahedron is sqrt(6)/4*h where h
+  // is the edge length
+  const double regular_radius = 0.6123724356957945;
+
+  // Set the quality factor in the same manner as the frontal method
+  double quality_factor = options.frontal_quality_factor;
+  if (quality_factor > 2.0){
+    quality_factor = 2.0;
+  }
+  else if (quality_factor < 1.01){
+    quality_factor = 1.01;
+  }
+
+  // Fraction of the feature size that new points must be from the
+  // boundary triangles
+  const double boundary_offset = 0.25;
+
+  // Fraction of the local size that new points must be from the
+  // existing points
+  const double point_offset = 0.5*regular_radius;
+
+  // Tetrahedra with a quality below this value are removed by flips
+  // after the refinement
+  const double sliver_quality = 0.1;
+
+  double tref = MPI_Wtime();
+
+  // Compute the local boundary spacing at each boundary point from
+  // the shortest boundary edge that touches it
+  double *bspacing = new double[ num_boundary_pts ];
+  for ( int i = 0; i < num_boundary_pts; i++ ){
+    bspacing[i] = 1e300;
+  }
+  for ( int i = 0; i < num_boundary_tris; i++ ){
+    const int *tri = &boundary_tris[3*i];
+    for ( int k = 0; k < 3; k++ ){
+      const double *a = &pts[3*tri[k]];
+      const double *b = &pts[3*tri[(k+1) % 3]];
+      double l = sqrt((a[0] - b[0])*(a[0] - b[0]) +
+                      (a[1] - b[1])*(a[1] - b[1]) +
+                      (a[2] - b[2])*(a[2] - b[2]));
+      for ( int j = 0; j < 2; j++ ){
+        int index = tri[(k+j) % 3] - FIXED_POINT_OFFSET;
+        if (l < bspacing[index]){
+          bspacing[index] = l;
+        }
+      }
+    }
+  }
+
+  // Create a queue of the tetrahedra that must be checked. Each
+  // entry stores the tetrahedron and its vertices so that entries
+  // for deleted tetrahedra can be skipped.
+  int queue_size = 0, queue_start = 0;
+  int max_queue_size = 5*(num_tets + 1024);
+  int *queue = new int[ max_queue_size ];
+
+  // Estimate the number of tetrahedra in the final mesh from the
+  // volume of a regular tetrahedron sized by the element feature size
+  double num_expected = 0.0;
+  for ( int t = 0; t < num_tets; t++ ){
+    if (!(flags[t] & TET_DELETED)){
+      queue[queue_size] = t;
+      memcpy(&queue[queue_size+1], &tets[4*t], 4*sizeof(int));
+      queue_size += 5;
+
+      const int *tc = &tets[4*t];
+      TMRPoint centroid;
+      centroid.x = 0.25*(pts[3*tc[0]] + pts[3*tc[1]] +
+                         pts[3*tc[2]] + pts[3*tc[3]]);
+      centroid.y = 0.25*(pts[3*tc[0]+1] + pts[3*tc[1]+1] +
+                         pts[3*tc[2]+1] + pts[3*tc[3]+1]);
+      centroid.z = 0.25*(pts[3*tc[0]+2] + pts[3*tc[1]+2] +
+                         pts[3*tc[2]+2] + pts[3*tc[3]+2]);
+      double h = fs->getFeatureSize(centroid);
+      double vol = fabs(orient(&pts[3*tc[0]], &pts[3*tc[1]],
+                               &pts[3*tc[2]], &pts[3*tc[3]]))/6.0;
+      num_expected += 6.0*sqrt(2.0)*vol/(h*h*h);
+    }
+  }
+
+  // Set the maximum number of points that can be inserted. The
+  // number of points in a good mesh is about one sixth of the number
+  // of tetrahedra.
+  double max_insert = num_expected + 10.0*num_boundary_pts + 1024.0;
+  int max_inserted = (max_insert < 1e9 ? (int)max_insert : 1000000000);
+
+  int num_inserted = 0;
+  while (queue_start < queue_size){
+    if (num_inserted >= max_inserted){
+      fprintf(stderr, "TMRTetrahedralize Warning: Stopped refinement "
+              "after the maximum of %d inserted points\n", max_inserted);
+      break;
+    }
+
+    int t = queue[queue_start];
+    const int *q = &queue[queue_start+1];
+    queue_start += 5;
+    if ((flags[t] & TET_DELETED) ||
+        tets[4*t] != q[0] || tets[4*t+1] != q[1] ||
+        tets[4*t+2] != q[2] || tets[4*t+3] != q[3]){
+      continue;
+    }
+
+    // Compute the circumcenter and the feature size at the centroid
+    double cc[3];
+    double R = computeCircumcenter(t, cc);
+
+    TMRPoint centroid;
+    const double *p0 = &pts[3*tets[4*t]];
+    const double *p1 = &pts[3*tets[4*t+1]];
+    const double *p2 = &pts[3*tets[4*t+2]];
+    const double *p3 = &pts[3*tets[4*t+3]];
+    centroid.x = 0.25*(p0[0] + p1[0] + p2[0] + p3[0]);
+    centroid.y = 0.25*(p0[1] + p1[1] + p2[1] + p3[1]);
+    centroid.z = 0.25*(p0[2] + p1[2] + p2[2] + p3[2]);
+    double h = fs->getFeatureSize(centroid);
+
+    // Compute the shortest edge length
+    double lmin = 1e300;
+    for ( int k = 0; k < 6; k++ ){
+      const double *a = &pts[3*tets[4*t + tet_edges[k][0]]];
+      const double *b = &pts[3*tets[4*t + tet_edges[k][1]]];
+      double l = ((a[0] - b[0])*(a[0] - b[0]) +
+                  (a[1] - b[1])*(a[1] - b[1]) +
+                  (a[2] - b[2])*(a[2] - b[2]));
+      if (l < lmin){
+        lmin = l;
+      }
+    }
+    lmin = sqrt(lmin);
+
+    int size_flag = (R > quality_factor*regular_radius*h);
+    int shape_flag = (R > 2.0*lmin && R > 0.5*h);
+    if (!size_flag && !shape_flag){
+      continue;
+    }
+
+    // Find the local boundary spacing from the boundary vertices. A
+    // tetrahedron that touches the boundary cannot be made smaller
+    // than the boundary triangles, so skip it if it is already close
+    // to this size.
+    double hlocal = h;
+    for ( int k = 0; k < 4; k++ ){
+      int index = tets[4*t+k] - FIXED_POINT_OFFSET;
+      if (index >= 0 && index < num_boundary_pts &&
+          bspacing[index] < 1e300){
+        if (R <= quality_factor*regular_radius*bspacing[index]){
+          size_flag = shape_flag = 0;
+        }
+        if (bspacing[index] < hlocal){
+          hlocal = bspacing[index];
+        }
+      }
+    }
+    if (!size_flag && !shape_flag){
+      continue;
+    }
+
+    // Try to insert the circumcenter, and then the centroid
+    int num_new = 0;
+    int pt = addPoint(cc);
+    int fail = insertPoint(pt, t, 1, boundary_offset*h,
+                           point_offset*hlocal, &num_new);
+    if (fail && size_flag){
+      pts[3*pt] = centroid.x;
+      pts[3*pt+1] = centroid.y;
+      pts[3*pt+2] = centroid.z;
+      fail = insertPoint(pt, t, 1, boundary_offset*h,
+                         point_offset*hlocal, &num_new);
+    }
+
+    if (fail){
+      num_points--;
+      continue;
+    }
+    num_inserted++;
+
+    // Add the new tetrahedra to the queue
+    if (queue_size + 5*num_new > max_queue_size){
+      int size = queue_size - queue_start;
+      if (size + 5*num_new > max_queue_size/2){
+        max_queue_size = 2*(max_queue_size + 5*num_new);
+      }
+      int *tmp = new int[ max_queue_size ];
+      memcpy(tmp, &queue[queue_start], size*sizeof(int));
+      delete [] queue;
+      queue = tmp;
+      queue_size = size;
+      queue_start = 0;
+    }
+    for ( int i = 0; i < num_new; i++ ){
+      int nt = cavity[i];
+      queue[queue_size] = nt;
+      memcpy(&queue[queue_size+1], &tets[4*nt], 4*sizeof(int));
+      queue_size += 5;
+    }
+
+    if (options.triangularize_print_level > 0 &&
+        num_inserted % options.triangularize_print_iter == 0){
+      printf("TMRTetrahedralize: %10d points inserted\n", num_inserted);
+    }
+  }
+
+  delete [] queue;
+  delete [] bspacing;
+
+  // Remove the slivers that are left by the refinement
+  int num_flips = removeSlivers(sliver_quality);
+
+  if (options.triangularize_print_level > 0){
+    int ntets = num_tets - num_free_tets;
+    tref = MPI_Wtime() - tref;
+    printf("TMRTetrahedralize: %d points %d tets %d flips %.3f s\n",
+           num_points - FIXED_POINT_OFFSET, ntets, num_flips, tref);
+  }
+}
+
+/*
+  Retrieve the mesh connectivity
+
+  The boundary points are ordered first, in the order in which they
+  were passed to the constructor, followed by the interior points.
+  Points that are not referenced by any tetrahedron (for instance,
+  points added outside the domain during boundary recovery) are
+  omitted. The arrays are allocated and must be freed by the caller.
+*/
+void TMRTetrahedralize::getMesh( int *_num_points, int *_num_tets,
+                                 int **_conn, TMRPoint **_X ){
+  // Number the points that are referenced by the tetrahedra
+  int *point_nums = new int[ num_points ];
+  for ( int i = 0; i < num_points; i++ ){
+    point_nums[i] = -1;
+  }
+
+  int ntets = 0;
+  for ( int t = 0; t < num_tets; t++ ){
+    if (!(flags[t] & TET_DELETED)){
+      for ( int k = 0; k < 4; k++ ){
+        point_nums[tets[4*t+k]] = 0;
+      }
+      ntets++;
+    }
+  }
+
+  int npts = 0;
+  for ( int i = FIXED_POINT_OFFSET; i < num_points; i++ ){
+    if (i < FIXED_POINT_OFFSET + num_boundary_pts || point_nums[i] == 0){
+      point_nums[i] = npts;
+      npts++;
+    }
+  }
+
+  if (_num_points){ *_num_points = npts; }
+  if (_num_tets){ *_num_tets = ntets; }
+
+  if (_X){
+    *_X = new TMRPoint[ npts ];
+    for ( int i = FIXED_POINT_OFFSET; i < num_points; i++ ){
+      int j = point_nums[i];
+      if (j >= 0){
+        (*_X)[j].x = pts[3*i];
+        (*_X)[j].y = pts[3*i+1];
+        (*_X)[j].z = pts[3*i+2];
+      }
+    }
+  }
+
+  if (_conn){
+    *_conn = new int[ 4*ntets ];
+    int *c = *_conn;
+    for ( int t = 0; t < num_tets; t++ ){
+      if (!(flags[t] & TET_DELETED)){
+        // Swap the last two vertices so that the tetrahedra have a
+        // positive volume using the right-hand rule
+        c[0] = point_nums[tets[4*t]];
+        c[1] = point_nums[tets[4*t+1]];
+        c[2] = point_nums[tets[4*t+3]];
+        c[3] = point_nums[tets[4*t+2]];
+        c += 4;
+      }
+    }
+  }
+
+  delete [] point_nums;
+}
+
+/*
+  Write the tetrahedralization to a VTK file
+*/
+void TMRTetrahedralize::writeToVTK( const char *filename ){
+  int npts, ntets;
+  int *conn;
+  TMRPoint *X;
+  getMesh(&npts, &ntets, &conn, &X);
+
+  FILE *fp = fopen(filename, "w");
+  if (fp){
+    fprintf(fp, "# vtk DataFile Version 3.0\n");
+    fprintf(fp, "vtk output\nASCII\n");
+    fprintf(fp, "DATASET UNSTRUCTURED_GRID\n");
+
+    // Write out the points
+    fprintf(fp, "POINTS %d float\n", npts);
+    for ( int k = 0; k < npts; k++ ){
+      fprintf(fp, "%e %e %e\n", X[k].x, X[k].y, X[k].z);
+    }
+
+    // Write out the cell values
+    fprintf(fp, "\nCELLS %d %d\n", ntets, 5*ntets);
+    for ( int k = 0; k < ntets; k++ ){
+      fprintf(fp, "4 %d %d %d %d\n", conn[4*k], conn[4*k+1],
+              conn[4*k+2], conn[4*k+3]);
+    }
+
+    // All tetrahedra
+    fprintf(fp, "\nCELL_TYPES %d\n", ntets);
+    for ( int k = 0; k < ntets; k++ ){
+      fprintf(fp, "%d\n", 10);
+    }
+    fclose(fp);
+  }
+
+  delete [] conn;
+  delete [] X;
+}
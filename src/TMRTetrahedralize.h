@@ -0,0 +1,180 @@
+/*
+  This file is part of the package TMR for adaptive mesh refinement.
+
+  Copyright (C) 2015 Georgia Tech Research Corporation.
+  Additional copyright (C) 2015 Graeme Kennedy.
+  All rights reserved.
+
+  TMR is licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this software except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef TMR_TETRAHEDRALIZE_H
+#define TMR_TETRAHEDRALIZE_H
+
+#include "TMRBase.h"
+#include "TMRMesh.h"
+
+/*
+  Tetrahedralize the volume enclosed by a closed, triangulated surface
+
+  The boundary points are first inserted into a Delaunay
+  tetrahedralization of an enclosing tetrahedron using the
+  Bowyer-Watson algorithm. The points are inserted in a biased
+  randomized order (random rounds, each sorted along a Morton curve)
+  and are located by walking from the last tetrahedron that was
+  created.
+
+  The boundary triangles are then recovered by removing the edges
+  that cross them. No points are added to the boundary so the volume
+  mesh conforms exactly to the surface meshes. The tetrahedra outside
+  the surface are deleted and the interior is refined by inserting
+  the circumcenters of tetrahedra that are too large compared with
+  the element feature size or that are poorly shaped. Refinement never
+  digs a cavity through a boundary triangle and never inserts a point
+  that encroaches on a boundary triangle. Since the boundary is not
+  split, the mesh near the boundary is not refined below the local
+  boundary spacing.
+  Slivers left by the refinement are then removed by flips that
+  improve the quality of the tetrahedra that they replace.
+
+  All orientation and in-sphere decisions use Shewchuk's robust
+  geometric predicates.
+*/
+class TMRTetrahedralize : public TMREntity {
+ public:
+  TMRTetrahedralize( int npts, const TMRPoint *inpts,
+                     int ntris, const int tris[] );
+  ~TMRTetrahedralize();
+
+  // Recover the boundary triangles and delete the exterior
+  // tetrahedra. This returns the number of triangles that could not
+  // be recovered.
+  int recoverBoundary();
+
+  // Refine the interior mesh with the given mesh spacing
+  void refine( TMRMeshOptions options,
+               TMRElementFeatureSize *fs );
+
+  // Retrieve the mesh connectivity from the object
+  void getMesh( int *_num_points, int *_num_tets,
+                int **_conn, TMRPoint **_X );
+
+  // Write the tetrahedralization to an outputfile
+  void writeToVTK( const char *filename );
+
+ private:
+  // The Bowyer-Watson algorithm is started with a single tetrahedron
+  // that encloses the domain. Its 4 points are not part of the
+  // final mesh.
+  static const int FIXED_POINT_OFFSET = 4;
+
+  // The maximum number of tets about an edge that can be removed
+  static const int MAX_EDGE_RING = 24;
+
+  // Flags for the tetrahedra
+  static const int TET_DELETED = 1;
+  static const int TET_CAVITY = 2;
+
+  // Allocate space for the points and tetrahedra
+  int addPoint( const double pt[] );
+  int newTet();
+  void deleteTet( int t );
+
+  // Locate the tetrahedron that contains the point
+  int locate( const double pt[], int t, int constrained );
+
+  // Insert the point into the mesh
+  int insertPoint( int pt, int t, int constrained, double hmin,
+                   double rmin=0.0, int *num_new=NULL );
+
+  // Replace a set of tetrahedra with a new set that fills the same
+  // region
+  void replaceTets( int nold, const int old[],
+                    int nnew, const int conn[] );
+
+  // Find the tets about the given vertex
+  int getVertexStar( int u );
+
+  // Find a tet containing the given face
+  int findFace( int u, int v, int w );
+
+  // Recover the boundary triangles
+  int recoverFaces();
+  int recoverFace( int u, int v, int w );
+  int edgeCrossesFace( int x, int y, int u, int v, int w );
+  int removeEdge( int t, int x, int y, int u, int v, int w,
+                  int improve=0 );
+  int splitCoplanarRing( int x, int y, int n, const int ring[],
+                         const int ring_tets[], int ia, int ib );
+
+  // Remove poorly shaped tetrahedra with flips
+  int removeSlivers( double min_quality );
+  int flipFace( int t, int k );
+
+  // Hash functions for the boundary triangles and edges
+  int isBoundaryFace( int u, int v, int w );
+  int isBoundaryEdge( int u, int v );
+
+  // Compute the circumcenter of the tetrahedron
+  double computeCircumcenter( int t, double c[] );
+
+  // The points in the mesh
+  int num_points, max_num_points;
+  double *pts;
+  int *pts_to_tets;
+
+  // The tetrahedra in the mesh. The neighbor adj[4*t+k] is across
+  // the face of tet t that is opposite to its k-th vertex and
+  // marks[t] indicates which faces of tet t are boundary triangles.
+  int num_tets, max_num_tets;
+  int *tets;
+  int *adj;
+  unsigned char *flags;
+  unsigned char *marks;
+
+  // The list of tetrahedra that are free to be re-used
+  int num_free_tets;
+  int *free_tets;
+
+  // Search tags for the tetrahedra
+  int search_tag;
+  int *tags;
+
+  // The last tetrahedron that was created (for point location)
+  int last_tet;
+  uint32_t rand_state;
+
+  // The boundary triangles and hash tables for the boundary
+  // triangles and boundary edges
+  int num_boundary_pts;
+  int num_boundary_tris;
+  int *boundary_tris;
+  int face_table_size;
+  int *face_table;
+  int edge_table_size;
+  int *edge_table;
+
+  // Work arrays for the Bowyer-Watson insertion
+  int max_cavity;
+  int *cavity;
+  int max_cavity_faces;
+  int *cavity_faces;
+  int cavity_edge_table_size;
+  int *cavity_edge_table;
+
+  // Work array for the star of a vertex
+  int max_star;
+  int *star;
+};
+
+#endif // TMR_TETRAHEDRALIZE_H
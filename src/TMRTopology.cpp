@@ -149,6 +149,42 @@ int TMREdge::invEvalPoint( TMRPoint p, double *t ){
   return fail;
 }
 
+/*
+  Perform the inverse evaluation for an array of points
+
+  input:
+  n:      the number of points
+  p:      the physical locations of the points
+
+  output:
+  t:      the parametric locations
+*/
+int TMREdge::invEvalPoints( int n, const TMRPoint *p, double *t ){
+  int fail = 0;
+  for ( int i = 0; i < n; i++ ){
+    fail = invEvalPoint(p[i], &t[i]) || fail;
+  }
+  return fail;
+}
+
+/*
+  Evaluate the points at an array of parametric locations
+
+  input:
+  n:      the number of points
+  t:      the parametric locations
+
+  output:
+  X:      the physical locations of the points
+*/
+int TMREdge::evalPoints( int n, const double *t, TMRPoint *X ){
+  int fail = 0;
+  for ( int i = 0; i < n; i++ ){
+    fail = evalPoint(t[i], &X[i]) || fail;
+  }
+  return fail;
+}
+
 /*
   Set the step size for the derivative
 */
@@ -630,6 +666,42 @@ int TMRFace::invEvalPoint( TMRPoint p, double *u, double *v ){
   return fail;
 }
 
+/*
+  Perform the inverse evaluation for an array of points
+
+  input:
+  n:      the number of points
+  p:      the physical locations of the points
+
+  output:
+  uv:     the parametric locations stored as (u,v) pairs
+*/
+int TMRFace::invEvalPoints( int n, const TMRPoint *p, double *uv ){
+  int fail = 0;
+  for ( int i = 0; i < n; i++ ){
+    fail = invEvalPoint(p[i], &uv[2*i], &uv[2*i+1]) || fail;
+  }
+  return fail;
+}
+
+/*
+  Evaluate the points at an array of parametric locations
+
+  input:
+  n:      the number of points
+  uv:     the parametric locations stored as (u,v) pairs
+
+  output:
+  X:      the physical locations of the points
+*/
+int TMRFace::evalPoints( int n, const double *uv, TMRPoint *X ){
+  int fail = 0;
+  for ( int i = 0; i < n; i++ ){
+    fail = evalPoint(uv[2*i], uv[2*i+1], &X[i]) || fail;
+  }
+  return fail;
+}
+
 /*
   Add the curves that bound the surface
 */
@@ -921,6 +993,24 @@ int TMRVolume::evalPoint( double u, double v, double w, TMRPoint *X ){
   return 1;
 }
 
+/*
+  Evaluate the points at an array of parametric locations
+
+  input:
+  n:      the number of points
+  uvw:    the parametric locations stored as (u,v,w) triplets
+
+  output:
+  X:      the physical locations of the points
+*/
+int TMRVolume::evalPoints( int n, const double *uvw, TMRPoint *X ){
+  int fail = 0;
+  for ( int i = 0; i < n; i++ ){
+    fail = evalPoint(uvw[3*i], uvw[3*i+1], uvw[3*i+2], &X[i]) || fail;
+  }
+  return fail;
+}
+
 /*
   Get the faces that enclose this volume
 */
@@ -90,9 +90,15 @@ class TMREdge : public TMREntity {
   // Given the parametric point, compute the x,y,z location
   virtual int evalPoint( double t, TMRPoint *X ) = 0;
 
+  // Evaluate the x,y,z locations at an array of parametric points
+  virtual int evalPoints( int n, const double *t, TMRPoint *X );
+
   // Perform the inverse evaluation
   virtual int invEvalPoint( TMRPoint p, double *t );
 
+  // Perform the inverse evaluation for an array of points
+  virtual int invEvalPoints( int n, const TMRPoint *p, double *t );
+
   // Given the parametric point, evaluate the first derivative
   virtual int evalDeriv( double t, TMRPoint *X,
                          TMRPoint *Xt );
@@ -188,9 +194,15 @@ class TMRFace : public TMREntity {
   // Given the parametric point, compute the x,y,z location
   virtual int evalPoint( double u, double v, TMRPoint *X ) = 0;
 
+  // Evaluate the x,y,z locations at an array of (u,v) points
+  virtual int evalPoints( int n, const double *uv, TMRPoint *X );
+
   // Perform the inverse evaluation
   virtual int invEvalPoint( TMRPoint p, double *u, double *v );
 
+  // Perform the inverse evaluation for an array of points
+  virtual int invEvalPoints( int n, const TMRPoint *p, double *uv );
+
   // Given the parametric point, evaluate the first derivative
   virtual int evalDeriv( double u, double v,
                          TMRPoint *X,
@@ -272,6 +284,9 @@ class TMRVolume : public TMREntity {
   // Given the parametric point u,v,w compute the physical location x,y,z
   virtual int evalPoint( double u, double v, double w, TMRPoint *X );
 
+  // Evaluate the x,y,z locations at an array of (u,v,w) points
+  virtual int evalPoints( int n, const double *uvw, TMRPoint *X );
+
   // Get the faces that enclose this volume
   void getFaces( int *_num_faces, TMRFace ***_faces );
 
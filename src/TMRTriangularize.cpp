@@ -32,6 +32,7 @@
 // Include C++ stdlib for priority queue
 #include <queue>
 #include <vector>
+#include <algorithm>
 
 // Define the maximum distance
 const double MAX_QUAD_DISTANCE = 1e40;
@@ -69,6 +70,49 @@ static int compare_edges( const void *avoid, const void *bvoid ){
   return discrim;
 }
 
+/*
+  Compute the index of the integer point (x, y) along a Hilbert curve
+  that fills the 2^16 x 2^16 square
+*/
+static uint32_t hilbert_index( uint32_t x, uint32_t y ){
+  const uint32_t n = 1U << 16;
+  uint32_t d = 0;
+  for ( uint32_t s = n/2; s > 0; s /= 2 ){
+    uint32_t rx = (x & s) > 0;
+    uint32_t ry = (y & s) > 0;
+    d += s*s*((3*rx) ^ ry);
+
+    // Rotate the quadrant so that the curve is continuous
+    if (ry == 0){
+      if (rx == 1){
+        x = n-1 - x;
+        y = n-1 - y;
+      }
+      uint32_t t = x;
+      x = y;
+      y = t;
+    }
+  }
+
+  return d;
+}
+
+/*
+  Point index and Hilbert curve key used to order the points
+*/
+class TMRHilbertPoint {
+ public:
+  uint32_t key;
+  uint32_t index;
+};
+
+class TMRHilbertPointLess {
+ public:
+  bool operator()( const TMRHilbertPoint& a, const TMRHilbertPoint& b ){
+    return a.key < b.key;
+  }
+};
+
 /*
   A light-weight queue for keeping track of groups of triangles
 */
@@ -605,10 +649,90 @@ void TMRTriangularize::initialize( int npts, const double inpts[], int nholes,
   addTriangle(TMRTriangle(2, 1, 3));
 
   // Add the points to the triangle. This creates a CDT of the
-  // original set of points.
-  for ( int i = 0; i < npts; i++ ){
-    addPointToMesh(&inpts[2*i], NULL);
+  // original set of points. The points are numbered in the order
+  // they are given, but are inserted into the mesh in a biased
+  // randomized order: the points are shuffled and split into rounds
+  // that double in size and the points in each round are sorted
+  // along a Hilbert curve. Each point is located by walking from the
+  // last triangle that was created, which is close by.
+  double t0 = MPI_Wtime();
+  if (npts > 0){
+    for ( int i = 0; i < npts; i++ ){
+      addPoint(&inpts[2*i]);
+    }
+
+    uint32_t *order = new uint32_t[ npts ];
+    for ( int i = 0; i < npts; i++ ){
+      order[i] = i;
+    }
+    uint32_t rand_state = 2463534242U;
+    for ( int i = npts-1; i > 0; i-- ){
+      rand_state ^= rand_state << 13;
+      rand_state ^= rand_state >> 17;
+      rand_state ^= rand_state << 5;
+      int j = rand_state % (i+1);
+      uint32_t tmp = order[i];
+      order[i] = order[j];
+      order[j] = tmp;
+    }
+
+    // Compute the Hilbert keys relative to the bounds of the input
+    double xlow = inpts[0], xhigh = inpts[0];
+    double ylow = inpts[1], yhigh = inpts[1];
+    for ( int i = 1; i < npts; i++ ){
+      if (inpts[2*i] < xlow){ xlow = inpts[2*i]; }
+      if (inpts[2*i] > xhigh){ xhigh = inpts[2*i]; }
+      if (inpts[2*i+1] < ylow){ ylow = inpts[2*i+1]; }
+      if (inpts[2*i+1] > yhigh){ yhigh = inpts[2*i+1]; }
+    }
+    double scale = xhigh - xlow;
+    if (yhigh - ylow > scale){
+      scale = yhigh - ylow;
+    }
+    if (scale > 0.0){
+      scale = 65535.0/scale;
+    }
+
+    TMRHilbertPoint *hilbert = new TMRHilbertPoint[ npts ];
+    for ( int i = 0; i < npts; i++ ){
+      const double *p = &inpts[2*order[i]];
+      hilbert[i].key = hilbert_index((uint32_t)(scale*(p[0] - xlow)),
+                                     (uint32_t)(scale*(p[1] - ylow)));
+      hilbert[i].index = order[i];
+    }
+
+    int end = npts;
+    while (end > 0){
+      int start = end/2;
+      if (end <= 64){
+        start = 0;
+      }
+      std::sort(&hilbert[start], &hilbert[end], TMRHilbertPointLess());
+      end = start;
+    }
+
+    int num_failed = 0;
+    for ( int i = 0; i < npts; i++ ){
+      uint32_t u = hilbert[i].index + FIXED_POINT_OFFSET;
+      TMRTriangle *tri;
+      findEnclosing(&pts[2*u], &tri, &list_end->tri);
+      if (tri){
+        insertPoint(u, tri, NULL);
+      }
+      else {
+        num_failed++;
+      }
+    }
+
+    if (num_failed > 0){
+      fprintf(stderr, "TMRTriangularize Error: Failed to locate %d "
+              "points in the initial triangulation\n", num_failed);
+    }
+
+    delete [] hilbert;
+    delete [] order;
   }
+  init_insert_time = MPI_Wtime() - t0;
 
   // Ensure that all the segments are in the triangulation to
   // recover a CDT
@@ -1186,8 +1310,10 @@ int TMRTriangularize::addTriangle( TMRTriangle tri ){
   // Add the triangle to the triangle count
   num_triangles++;
 
-  // Redistribute the members in the hash table if required
-  if (num_hash_nodes > 10*num_buckets){
+  // Redistribute the members in the hash table if required. Keep the
+  // load factor low: every lookup walks the chain of separately
+  // allocated nodes, so long chains are dominated by cache misses.
+  if (num_hash_nodes > num_buckets){
     // Create a new array of buckets, twice the size of the old array
     // of buckets and re-insert the entries back into the new array
     int num_old_buckets = num_buckets;
@@ -1597,18 +1723,7 @@ void TMRTriangularize::addPointToMesh( const double pt[],
 
   // Add the point to the quadtree
   uint32_t u = addPoint(pt);
-
-  if (tri){
-    uint32_t v = tri->u;
-    uint32_t w = tri->v;
-    uint32_t x = tri->w;
-    deleteTriangle(*tri);
-    digCavity(u, v, w, metric);
-    digCavity(u, w, x, metric);
-    digCavity(u, x, v, metric);
-  }
-
-  return;
+  insertPoint(u, tri, metric);
 }
 
 /*
@@ -1619,7 +1734,15 @@ void TMRTriangularize::addPointToMesh( const double pt[],
                                        TMRTriangle *tri,
                                        TMRFace *metric ){
   uint32_t u = addPoint(pt);
+  insertPoint(u, tri, metric);
+}
 
+/*
+  Insert the point u, which is already in the point list, into the
+  mesh given the triangle that encloses it
+*/
+void TMRTriangularize::insertPoint( uint32_t u, TMRTriangle *tri,
+                                    TMRFace *metric ){
   if (tri){
     uint32_t v = tri->u;
     uint32_t w = tri->v;
@@ -1859,41 +1982,93 @@ void TMRTriangularize::giftWrap( const uint32_t v[], int size,
 /*
   Find the enclosing triangle within the mesh.
 
-  This code uses a quadtree for geometric searching. First, we find
-  the node that is closest to the query point. This node is not
-  necessarily connected with the enclosing triangle that we
-  want. Next, we find one triangle associated with this node. If this
-  triangle does not contain the point, we march over the mesh, marking
-  the triangles that we have visited.
+  This code uses a jump-and-walk strategy. If no starting triangle is
+  provided, we use the quadtree to find the node that is closest to
+  the query point and start from a triangle attached to this node.
+  The closest node may not be in the mesh yet, since the input points
+  are added to the quadtree before they are inserted. In this case
+  we start from the most recently created triangle instead. We
+  then walk towards the point, crossing an edge of the current
+  triangle that separates it from the point, until we find the
+  enclosing triangle. The walk may fail if it runs into the boundary
+  of the domain, for instance when the domain is not convex. In this
+  case we fall back to a breadth-first search over the mesh from the
+  starting triangle, marking the triangles that we have visited.
 */
 void TMRTriangularize::findEnclosing( const double pt[],
-                                      TMRTriangle **ptr ){
+                                      TMRTriangle **ptr,
+                                      TMRTriangle *start ){
   *ptr = NULL;
-  if (search_tag == UINT_MAX){
+
+  // Find the triangle that we'll start from
+  TMRTriangle *tri = start;
+  if (!tri || tri->status == DELETE_ME){
+    // Find the closest point to the given
+    uint32_t u = root->findClosest(pt);
+
+    // Obtain the triangle associated with the node u. This triangle
+    // may not contain the node, but will hopefully be close to the
+    // node.
+    tri = pts_to_tris[u];
+  }
+  if (!tri || tri->status == DELETE_ME){
+    // Start from the most recently created triangle that is still in
+    // the mesh. The newest triangles are rarely deleted, so this
+    // search is short.
+    tri = NULL;
+    for ( TriListNode *node = list_end; node; node = node->prev ){
+      if (node->tri.status != DELETE_ME){
+        tri = &(node->tri);
+        break;
+      }
+    }
+  }
+  if (!tri){
+    return;
+  }
+
+  if (search_tag >= UINT_MAX-1){
     search_tag = 0;
     setTriangleTags(0);
   }
   search_tag++;
 
-  // Find the closest point to the given
-  uint32_t u = root->findClosest(pt);
+  // Walk from the starting triangle towards the point. Start the
+  // edge checks from a different edge each time so that the walk
+  // does not cycle.
+  double p[2] = {pt[0], pt[1]};
+  TMRTriangle *t = tri;
+  int k0 = search_tag % 3;
+  while (t && t->tag != search_tag){
+    t->tag = search_tag;
 
-  // Obtain the triangle associated with the node u. This triangle may
-  // not contain the node, but will hopefully be close to the node.
-  // We'll walk the mesh to nearby elements until we find the proper
-  // enclosing triangle.
-  TMRTriangle *tri = pts_to_tris[u];
+    uint32_t edge_pairs[][2] = {{t->u, t->v},
+                                {t->v, t->w},
+                                {t->w, t->u}};
 
-  if (enclosed(pt, tri->u, tri->v, tri->w)){
-    *ptr = tri;
-    return;
-  }
-  else {
-    tri->tag = search_tag;
+    // Find an edge that separates the triangle from the point
+    int k = 0;
+    for ( ; k < 3; k++ ){
+      uint32_t a = edge_pairs[(k0 + k) % 3][0];
+      uint32_t b = edge_pairs[(k0 + k) % 3][1];
+      if (orient2d(&pts[2*a], &pts[2*b], p) < 0.0){
+        completeMe(b, a, &t);
+        break;
+      }
+    }
+
+    // The point is on the positive side of all the edges
+    if (k == 3){
+      *ptr = t;
+      return;
+    }
+    k0 = (k0 + 1) % 3;
   }
 
-  // Members of the list do not enclose the point and have been
-  // labeled that they are searched
+  // The walk failed. Members of the list do not enclose the point and
+  // have been labeled that they are searched
+  search_tag++;
+  tri->tag = search_tag;
   TriQueue queue;
   queue.append(tri);
 
@@ -2091,10 +2266,16 @@ void TMRTriangularize::frontal( TMRMeshOptions options,
   }
 
   if (options.triangularize_print_level > 0){
-    printf("%10s %10s %10s\n", "Iteration", "Triangles", "Active");
+    int npts = num_points - FIXED_POINT_OFFSET;
+    printf("Inserted %d initial points in %.4e s (%.4e points/s)\n",
+           npts, init_insert_time,
+           (init_insert_time > 0.0 ? npts/init_insert_time : 0.0));
+    printf("%10s %10s %10s %12s\n",
+           "Iteration", "Triangles", "Active", "Points/s");
   }
 
   int num_newton_fail = 0;
+  int num_start_points = num_points;
   double t0 = MPI_Wtime();
   double t0_enclose = 0.0, t1_enclose = 0.0;
   double t0_update = 0.0, t1_update = 0.0;
@@ -2104,7 +2285,9 @@ void TMRTriangularize::frontal( TMRMeshOptions options,
     if (options.triangularize_print_level > 0 &&
         iter % options.triangularize_print_iter == 0){
       int queue_size = active.size();
-      printf("%10d %10d %10d\n", iter, num_triangles, queue_size);
+      double dt = MPI_Wtime() - t0;
+      printf("%10d %10d %10d %12.4e\n", iter, num_triangles, queue_size,
+             (dt > 0.0 ? (num_points - num_start_points)/dt : 0.0));
       if (options.write_triangularize_intermediate){
         char filename[256];
         if (face){
@@ -2319,7 +2502,7 @@ void TMRTriangularize::frontal( TMRMeshOptions options,
       pt_tri = tri;
       if (!enclosed(pt, pt_tri->u, pt_tri->v, pt_tri->w)){
         t0_enclose += MPI_Wtime();
-        findEnclosing(pt, &pt_tri);
+        findEnclosing(pt, &pt_tri, tri);
         t1_enclose += MPI_Wtime();
       }
 
@@ -2524,7 +2707,8 @@ void TMRTriangularize::frontal( TMRMeshOptions options,
   deleteTrianglesFromList();
 
   if (options.triangularize_print_level > 0){
-    printf("%10d %10d\n", iter, num_triangles);
+    printf("%10d %10d %10s %12.4e\n", iter, num_triangles, "",
+           (t0 > 0.0 ? (num_points - num_start_points)/t0 : 0.0));
   }
   if (options.triangularize_print_level > 1){
     printf("Time breakdown\n");
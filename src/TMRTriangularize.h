@@ -187,6 +187,10 @@ class TMRTriangularize : public TMREntity {
   void addPointToMesh( const double pt[], TMRTriangle *tri,
                        TMRFace *metric );
 
+  // Insert a point that has already been added to the point list
+  // into the mesh, given the triangle that encloses it
+  void insertPoint( uint32_t u, TMRTriangle *tri, TMRFace *metric );
+
   // Get a hash value for the given edge
   inline uint32_t getEdgeHash( uint32_t u, uint32_t v );
 
@@ -220,8 +224,10 @@ class TMRTriangularize : public TMREntity {
   double inCircle( uint32_t u, uint32_t v, uint32_t w, uint32_t x,
                    TMRFace *metric=NULL);
 
-  // Find the enclosing triangle
-  void findEnclosing( const double pt[], TMRTriangle **tri );
+  // Find the enclosing triangle, walking from the start triangle (if
+  // provided) or from a triangle attached to the closest point
+  void findEnclosing( const double pt[], TMRTriangle **tri,
+                      TMRTriangle *start=NULL );
 
   // Compute the maximum edge length of the triangle
   double computeSizeRatio( uint32_t u, uint32_t v, uint32_t w,
@@ -242,6 +248,9 @@ class TMRTriangularize : public TMREntity {
   // Initial number of boundary points
   uint32_t init_boundary_points;
 
+  // Time spent inserting the initial points into the mesh
+  double init_insert_time;
+
   // Keep track of the points
   int num_points; // The current number of points
   int max_num_points; // The maximum number of points
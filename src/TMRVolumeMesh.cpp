@@ -20,19 +20,13 @@
 
 #include <math.h>
 #include <stdio.h>
+#include <map>
 #include "TMRMesh.h"
 #include "TMRNativeTopology.h"
 #include "TMRVolumeMesh.h"
+#include "TMRTetrahedralize.h"
 #include "tmrlapack.h"
 
-#ifdef TMR_USE_NETGEN
-// The namespace is required because of the way nglib is compiled by
-// default. This is a funny way to do it, but who am I to complain.
-namespace nglib {
-#include "nglib.h"
-}
-#endif // TMR_USE_NETGEN
-
 /*
   Try to create a volume mesh based on the structured/unstructured
   surface meshes
@@ -61,6 +55,11 @@ TMRVolumeMesh::TMRVolumeMesh( MPI_Comm _comm,
   tet = NULL;
   vars = NULL;
 
+  // Set the boundary information for the tetrahedral mesh
+  num_boundary_pts = 0;
+  bound_face = NULL;
+  bound_index = NULL;
+
   // Set the additional connectivity information that is required for
   // the volume mesh.
   source = target = NULL;
@@ -73,6 +72,8 @@ TMRVolumeMesh::~TMRVolumeMesh(){
   if (hex){ delete [] hex; }
   if (tet){ delete [] tet; }
   if (vars){ delete [] vars; }
+  if (bound_face){ delete [] bound_face; }
+  if (bound_index){ delete [] bound_index; }
   if (swept_faces){
     for ( int k = 0; k < num_swept_faces; k++ ){
       swept_faces[k]->decref();
@@ -150,12 +151,13 @@ void TMRVolumeMesh::writeToVTK( const char *filename ){
 /*
   Mesh the volume via sweeping (or tetrahedral meshing)
 */
-int TMRVolumeMesh::mesh( TMRMeshOptions options ){
+int TMRVolumeMesh::mesh( TMRMeshOptions options,
+                         TMRElementFeatureSize *fs ){
   int mpi_rank;
   MPI_Comm_rank(comm, &mpi_rank);
 
   if (options.mesh_type_default == TMR_TRIANGLE){
-    return tetMesh(options);
+    return tetMesh(options, fs);
   }
 
   // Keep track of whether the mesh has failed at any time. Try and
@@ -687,76 +689,175 @@ int TMRVolumeMesh::getSweptMapping( int source_plane,
 
 /*
   Create a tetrahedral mesh
-*/
-int TMRVolumeMesh::tetMesh( TMRMeshOptions options ){
-#ifdef TMR_USE_NETGEN
-  nglib::Ng_Init();
-  nglib::Ng_Mesh *m = nglib::Ng_NewMesh();
 
-  // First count up the total number of unique points that bound this
-  // volume that is about to be meshed
-  int num_boundary_pts = 0;
+  The boundary points are collected from the triangular surface
+  meshes. Points on the vertices and edges are shared between faces
+  and are identified by the entity and the index along the edge,
+  following the same traversal used to number the face nodes in
+  TMRFaceMesh::setNodeNums. The volume is then tetrahedralized so
+  that the mesh conforms to the surface triangles.
+*/
+int TMRVolumeMesh::tetMesh( TMRMeshOptions options,
+                            TMRElementFeatureSize *fs ){
+  if (!fs){
+    fprintf(stderr,
+            "TMRVolumeMesh Error: Tetrahedral meshing requires a feature size\n");
+    return 1;
+  }
 
   // Get the faces associated with the volume
   int num_faces;
   TMRFace **faces;
-  const int *face_dir;
-  volume->getFaces(&num_faces, &faces, &face_dir);
+  volume->getFaces(&num_faces, &faces);
 
-  // Count up the number of boundary nodes for this volume
-  for ( int i = 0; i < ; i++ ){
-    double pt[3] = {0.0, 0.0, 0.0};
-    nglib::Ng_AddPoint(m, pt);
-  }
+  // Count up the number of boundary triangles and check that each
+  // face has a triangular surface mesh
+  int num_face_pts = 0;
+  int num_tris = 0;
+  for ( int i = 0; i < num_faces; i++ ){
+    TMRFaceMesh *mesh = NULL;
+    faces[i]->getMesh(&mesh);
+    if (!mesh){
+      fprintf(stderr,
+              "TMRVolumeMesh Error: Surface mesh does not exist\n");
+      return 1;
+    }
+    if (mesh->getQuadConnectivity(NULL) > 0){
+      fprintf(stderr,
+              "TMRVolumeMesh Error: Tetrahedral meshing requires "
+              "triangular surface meshes\n");
+      return 1;
+    }
 
-  // Add the surface elements
-  for ( int i = 0; i < ntris; i++ ){
-    int tri[3];
-    tri[0] = tris[3*i]+1;
-    tri[1] = tris[3*i+1]+1;
-    tri[2] = tris[3*i+2]+1;
-    nglib::Ng_AddSurfaceElement(m, NG_TRIG, tri);
+    int npts;
+    mesh->getMeshPoints(&npts, NULL, NULL);
+    num_face_pts += npts;
+    num_tris += mesh->getTriConnectivity(NULL);
   }
 
-  // Set the mesh parameters
-  nglib::Ng_Meshing_Parameters mp;
-  mp.maxh = htarget;
-  mp.fineness = 1;
-  mp.second_order = 0;
+  // Allocate the space for the boundary points and triangles
+  TMRPoint *Xb = new TMRPoint[ num_face_pts ];
+  int *tris = new int[ 3*num_tris ];
+  bound_face = new int[ num_face_pts ];
+  bound_index = new int[ num_face_pts ];
+  num_boundary_pts = 0;
 
-  // Generate the volume mesh
-  nglib::Ng_GenerateVolumeMesh(m, &mp);
+  // Map the shared vertex and edge points to the boundary points
+  std::map<std::pair<TMREntity*, int>, int> point_map;
 
-  // Get the total number of points and tets in the volume
-  num_points = nglib::Ng_GetNP(m);
-  num_tet = nglib::Ng_GetNE(m);
+  int *t = tris;
+  for ( int i = 0; i < num_faces; i++ ){
+    TMRFaceMesh *mesh = NULL;
+    faces[i]->getMesh(&mesh);
+
+    int npts;
+    TMRPoint *Xf;
+    mesh->getMeshPoints(&npts, NULL, &Xf);
+
+    // Find the boundary point index for each face point
+    int *local = new int[ npts ];
+    int face_orient = faces[i]->getOrientation();
+
+    int pt = 0;
+    for ( int k = 0; k < faces[i]->getNumEdgeLoops(); k++ ){
+      TMREdgeLoop *loop;
+      faces[i]->getEdgeLoop(k, &loop);
+
+      int nedges;
+      TMREdge **edges;
+      const int *edge_orient;
+      loop->getEdgeLoop(&nedges, &edges, &edge_orient);
+
+      int edge_index = nedges-1;
+      if (face_orient > 0){
+        edge_index = 0;
+      }
 
-  // Allocate space to store everything
-  X = new TMRPoint[ num_points ];
-  tet = new int[ 4*num_tet ];
-
-  // Retrieve the points
-  for ( int i = 0; i < num_points; i++ ){
-    double x[3];
-    nglib::Ng_GetPoint(m, i+1, x);
-    X[i].x = x[0];
-    X[i].y = x[1];
-    X[i].z = x[2];
-  }
+      for ( int j = 0; j < nedges; j++, edge_index += face_orient ){
+        TMREdge *edge = edges[edge_index];
+        if (edge->isDegenerate()){
+          continue;
+        }
+
+        TMREdgeMesh *edge_mesh = NULL;
+        edge->getMesh(&edge_mesh);
+        int nedge_pts;
+        edge_mesh->getMeshPoints(&nedge_pts, NULL, NULL);
+
+        TMRVertex *v1, *v2;
+        edge->getVertices(&v1, &v2);
+
+        int orientation = face_orient*edge_orient[edge_index];
+        int index = nedge_pts-1;
+        if (orientation > 0){
+          index = 0;
+        }
+
+        for ( int ii = 0; ii < nedge_pts-1;
+              ii++, index += orientation, pt++ ){
+          std::pair<TMREntity*, int> key(edge, index);
+          if (index == 0){
+            key = std::pair<TMREntity*, int>(v1, 0);
+          }
+          else if (index == nedge_pts-1){
+            key = std::pair<TMREntity*, int>(v2, 0);
+          }
+
+          std::map<std::pair<TMREntity*, int>, int>::iterator it =
+            point_map.find(key);
+          if (it == point_map.end()){
+            point_map[key] = num_boundary_pts;
+            local[pt] = num_boundary_pts;
+            Xb[num_boundary_pts] = Xf[pt];
+            bound_face[num_boundary_pts] = i;
+            bound_index[num_boundary_pts] = pt;
+            num_boundary_pts++;
+          }
+          else {
+            local[pt] = it->second;
+          }
+        }
+      }
+    }
+
+    // The remaining points are in the interior of the face
+    for ( ; pt < npts; pt++ ){
+      local[pt] = num_boundary_pts;
+      Xb[num_boundary_pts] = Xf[pt];
+      bound_face[num_boundary_pts] = i;
+      bound_index[num_boundary_pts] = pt;
+      num_boundary_pts++;
+    }
 
-  // Retrieve the tets
-  for ( int i = 0; i < num_tet; i++ ){
-    nglib::Ng_GetVolumeElement(m, i+1, &tet[4*i]);
-    for ( int k = 0; k < 4; k++ ){
-      tet[4*i+k] -= 1;
+    // Add the triangles
+    const int *face_tris;
+    int ntris = mesh->getTriConnectivity(&face_tris);
+    for ( int j = 0; j < 3*ntris; j++, t++ ){
+      t[0] = local[face_tris[j]];
     }
+
+    delete [] local;
   }
 
-  // Free the memory and exit from netgen
-  nglib::Ng_DeleteMesh(m);
-  nglib::Ng_Exit();
-#endif // TMR_USE_NETGEN
-  return 0;
+  // Tetrahedralize the volume
+  TMRTetrahedralize *tetra =
+    new TMRTetrahedralize(num_boundary_pts, Xb, num_tris, tris);
+  tetra->incref();
+  delete [] Xb;
+  delete [] tris;
+
+  int fail = tetra->recoverBoundary();
+  if (fail){
+    fprintf(stderr,
+            "TMRVolumeMesh Error: Failed to recover the surface mesh\n");
+  }
+  else {
+    tetra->refine(options, fs);
+    tetra->getMesh(&num_points, &num_tet, &tet, &X);
+  }
+  tetra->decref();
+
+  return fail;
 }
 
 /*
@@ -770,7 +871,32 @@ int TMRVolumeMesh::tetMesh( TMRMeshOptions options ){
   within the connectivity.
 */
 int TMRVolumeMesh::setNodeNums( int *num ){
-  if (!vars){
+  if (!vars && tet){
+    int start = *num;
+    vars = new int[ num_points ];
+
+    // Copy the node numbers from the surface meshes
+    int num_faces;
+    TMRFace **faces;
+    volume->getFaces(&num_faces, &faces);
+    for ( int k = 0; k < num_boundary_pts; k++ ){
+      TMRFaceMesh *mesh = NULL;
+      faces[bound_face[k]]->getMesh(&mesh);
+
+      const int *face_vars;
+      mesh->getNodeNums(&face_vars);
+      vars[k] = face_vars[bound_index[k]];
+    }
+
+    // Order the interior points
+    for ( int k = num_boundary_pts; k < num_points; k++ ){
+      vars[k] = *num;
+      (*num)++;
+    }
+
+    return *num - start;
+  }
+  else if (!vars){
     // Initially, set all of the nodes to zero
     vars = new int[ num_points ];
     for ( int k = 0; k < num_points; k++ ){
@@ -36,7 +36,8 @@ class TMRVolumeMesh : public TMREntity {
   ~TMRVolumeMesh();
 
   // Create the volume mesh
-  int mesh( TMRMeshOptions options );
+  int mesh( TMRMeshOptions options,
+            TMRElementFeatureSize *fs=NULL );
 
   // Retrieve the mesh points
   void getMeshPoints( int *_npts, TMRPoint **X );
@@ -54,7 +55,8 @@ class TMRVolumeMesh : public TMREntity {
 
  private:
   // Create a tetrahedral mesh (if possible)
-  int tetMesh( TMRMeshOptions options );
+  int tetMesh( TMRMeshOptions options,
+               TMRElementFeatureSize *fs );
 
   // Set the node locations based on the surface node locations
   int setNodeLocations( TMRMeshOptions options );
@@ -94,6 +96,12 @@ class TMRVolumeMesh : public TMREntity {
   // Tetrahedral mesh information
   int num_tet;
   int *tet;
+
+  // The face and local face index for each boundary point of the
+  // tetrahedral mesh. The boundary points are ordered first.
+  int num_boundary_pts;
+  int *bound_face;
+  int *bound_index;
 };
 
 #endif // TMR_VOLUME_MESH_H
@@ -19,6 +19,7 @@
 */
 
 #include "TMR_RefinementTools.h"
+#include "TMRInterpolation.h"
 #include "TensorToolbox.h"
 #include "TACSElementAlgebra.h"
 #include "tacslapack.h"
@@ -38,7 +39,8 @@ void TMR_CreateTACSMg( int num_levels, TACSAssembler *tacs[],
                        TMROctForest *forest[], TACSMg **_mg,
                        double omega,
                        int use_coarse_direct_solve,
-                       int use_chebyshev_smoother ){
+                       int use_chebyshev_smoother,
+                       TMROctInterpCache *cache[] ){
   // Get the communicator
   MPI_Comm comm = tacs[0]->getMPIComm();
 
@@ -58,8 +60,14 @@ void TMR_CreateTACSMg( int num_levels, TACSAssembler *tacs[],
     TACSBVecInterp *interp =
       new TACSBVecInterp(tacs[level+1], tacs[level]);
 
-    // Set the interpolation
-    forest[level]->createInterpolation(forest[level+1], interp);
+    // Set the interpolation, using the cache if one is provided
+    if (cache){
+      forest[level]->createInterpolation(forest[level+1], interp,
+                                         cache[level]);
+    }
+    else {
+      forest[level]->createInterpolation(forest[level+1], interp);
+    }
 
     // Initialize the interpolation
     interp->initialize();
@@ -115,7 +123,8 @@ void TMR_CreateTACSMg( int num_levels, TACSAssembler *tacs[],
                        TMRQuadForest *forest[], TACSMg **_mg,
                        double omega,
                        int use_coarse_direct_solve,
-                       int use_chebyshev_smoother ){
+                       int use_chebyshev_smoother,
+                       TMRQuadInterpCache *cache[] ){
   // Get the communicator
   MPI_Comm comm = tacs[0]->getMPIComm();
 
@@ -135,8 +144,14 @@ void TMR_CreateTACSMg( int num_levels, TACSAssembler *tacs[],
     TACSBVecInterp *interp =
       new TACSBVecInterp(tacs[level+1], tacs[level]);
 
-    // Set the interpolation
-    forest[level]->createInterpolation(forest[level+1], interp);
+    // Set the interpolation, using the cache if one is provided
+    if (cache){
+      forest[level]->createInterpolation(forest[level+1], interp,
+                                         cache[level]);
+    }
+    else {
+      forest[level]->createInterpolation(forest[level+1], interp);
+    }
 
     // Initialize the interpolation
     interp->initialize();
@@ -817,6 +832,244 @@ static void computeElemRecon2D( const int vars_per_node,
   }
 }
 
+/*
+  Set the least-squares weights at the nodes for the 3D reconstruction
+*/
+static void getReconWeights3D( const int order, double wvals[] ){
+  if (order == 2){
+    wvals[0] = wvals[1] = 1.0;
+  }
+  else if (order == 3){
+    wvals[0] = wvals[2] = 0.5;
+    wvals[1] = 1.0;
+  }
+}
+
+/*
+  Cached data for the 3D enrichment reconstruction
+
+  The reconstruction solves a weighted least-squares problem at the
+  nodes of the element. When the Jacobian X,xi = s*Q at every node for
+  a common scale s and an orthogonal matrix Q (uniformly scaled, but
+  possibly rotated elements, which includes all axis-aligned octants),
+  the least-squares solution is unchanged by transforming the
+  right-hand-side to the parametric directions. The system matrix is
+  then independent of the element and its pseudo-inverse only depends
+  on the order. It is computed once here so that the per-element work
+  is a small matrix-matrix product for all components at once.
+
+  The 1-D shape functions at the knots are also stored so that the
+  Jacobian and the parametric derivatives can be computed using sum
+  factorization. Elements that are not uniformly scaled use the SVD
+  path in computeElemRecon3D.
+*/
+class ElemReconCache3D {
+ public:
+  ElemReconCache3D( const int _vars_per_node,
+                    TMROctForest *forest,
+                    TMROctForest *refined_forest ){
+    vars_per_node = _vars_per_node;
+    const double *knots;
+    order = forest->getInterpKnots(&knots);
+    refined_order = refined_forest->getMeshOrder();
+    nenrich = getNum3dEnrich(order);
+    neq = 3*order*order*order;
+    const int nnodes = order*order*order;
+
+    // Evaluate the 1-D shape functions at the knots
+    N = new double[ order*order ];
+    Nd = new double[ order*order ];
+    forest->evalInterp1D(order, knots, N, Nd);
+    Nr = new double[ refined_order*order ];
+    Nrd = new double[ refined_order*order ];
+    refined_forest->evalInterp1D(order, knots, Nr, Nrd);
+
+    // Allocate the per-element data
+    Xd = new TacsScalar[ 9*nnodes ];
+    Ud = new TacsScalar[ 3*vars_per_node*nnodes ];
+    b = new TacsScalar[ neq*vars_per_node ];
+    int nmax = (refined_order > order ? refined_order : order);
+    int nvars = (vars_per_node > 3 ? vars_per_node : 3);
+    work = new TacsScalar[ nvars*order*nmax*(nmax + order) ];
+
+    // Set the parametric system matrix
+    double wvals[3];
+    getReconWeights3D(order, wvals);
+    TacsScalar *G = new TacsScalar[ neq*nenrich ];
+    for ( int c = 0, kk = 0; kk < order; kk++ ){
+      for ( int jj = 0; jj < order; jj++ ){
+        for ( int ii = 0; ii < order; ii++, c += 3 ){
+          double pt[3];
+          pt[0] = knots[ii];
+          pt[1] = knots[jj];
+          pt[2] = knots[kk];
+
+          double Nrc[MAX_3D_ENRICH];
+          double Nar[MAX_3D_ENRICH], Nbr[MAX_3D_ENRICH], Ncr[MAX_3D_ENRICH];
+          if (order == 2){
+            eval2ndEnrichmentFuncs3D(pt, Nrc, Nar, Nbr, Ncr);
+          }
+          else {
+            eval3rdEnrichmentFuncs3D(pt, Nrc, Nar, Nbr, Ncr);
+          }
+
+          double w = wvals[ii]*wvals[jj]*wvals[kk];
+          for ( int i = 0; i < nenrich; i++ ){
+            G[neq*i+c] = w*Nar[i];
+            G[neq*i+c+1] = w*Nbr[i];
+            G[neq*i+c+2] = w*Ncr[i];
+          }
+        }
+      }
+    }
+
+    // Compute the pseudo-inverse by solving with the identity
+    TacsScalar *B = new TacsScalar[ neq*neq ];
+    memset(B, 0, neq*neq*sizeof(TacsScalar));
+    for ( int i = 0; i < neq; i++ ){
+      B[(neq+1)*i] = 1.0;
+    }
+
+    TacsScalar s[MAX_3D_ENRICH];
+    int m = neq, n = nenrich, nrhs = neq;
+    double rcond = -1.0;
+    int rank, info;
+    int lwork = 4*neq*nenrich;
+    TacsScalar *lwork_array = new TacsScalar[ lwork ];
+    LAPACKdgelss(&m, &n, &nrhs, G, &m, B, &m, s,
+                 &rcond, &rank, lwork_array, &lwork, &info);
+    delete [] lwork_array;
+
+    // Copy the pseudo-inverse, stored column-major with dimension
+    // nenrich x neq
+    pinv = new TacsScalar[ nenrich*neq ];
+    for ( int j = 0; j < neq; j++ ){
+      for ( int i = 0; i < nenrich; i++ ){
+        pinv[nenrich*j + i] = B[neq*j + i];
+      }
+    }
+
+    delete [] G;
+    delete [] B;
+  }
+  ~ElemReconCache3D(){
+    delete [] N;
+    delete [] Nd;
+    delete [] Nr;
+    delete [] Nrd;
+    delete [] Xd;
+    delete [] Ud;
+    delete [] b;
+    delete [] work;
+    delete [] pinv;
+  }
+
+  // Compute the reconstruction if the element is uniformly scaled
+  int computeRecon( const TacsScalar Xpts[],
+                    const TacsScalar uvals[],
+                    const TacsScalar uderiv[],
+                    TacsScalar ubar[] );
+
+  int vars_per_node, order, refined_order;
+  int nenrich, neq;
+
+  // The 1-D shape functions at the knots
+  double *N, *Nd, *Nr, *Nrd;
+
+  // The pseudo-inverse of the parametric system
+  TacsScalar *pinv;
+
+  // Temporary data for the element computations
+  TacsScalar *Xd, *Ud, *b, *work;
+};
+
+/*
+  Compute the reconstruction for a uniformly scaled element using the
+  cached pseudo-inverse. Returns 1 if the element is uniformly scaled
+  and ubar was computed, 0 otherwise.
+*/
+int ElemReconCache3D::computeRecon( const TacsScalar Xpts[],
+                                    const TacsScalar uvals[],
+                                    const TacsScalar uderiv[],
+                                    TacsScalar ubar[] ){
+  const int nnodes = order*order*order;
+  const int deriv_per_node = 3*vars_per_node;
+
+  // Compute the derivatives X,xi at the nodes using sum factorization
+  TacsScalar *Xa = &Xd[0];
+  TacsScalar *Xb = &Xd[3*nnodes];
+  TacsScalar *Xc = &Xd[6*nnodes];
+  tensor_interp3d(refined_order, order, order, order,
+                  Nrd, Nr, Nr, 3, Xpts, Xa, work);
+  tensor_interp3d(refined_order, order, order, order,
+                  Nr, Nrd, Nr, 3, Xpts, Xb, work);
+  tensor_interp3d(refined_order, order, order, order,
+                  Nr, Nr, Nrd, 3, Xpts, Xc, work);
+
+  // Check that X,xi*X,xi^{T} = s^2*I at all nodes
+  TacsScalar s2 = Xa[0]*Xa[0] + Xa[1]*Xa[1] + Xa[2]*Xa[2];
+  double tol = 1e-10*TacsRealPart(s2);
+  for ( int c = 0; c < nnodes; c++ ){
+    const TacsScalar *xa = &Xa[3*c], *xb = &Xb[3*c], *xc = &Xc[3*c];
+    TacsScalar g[6];
+    g[0] = xa[0]*xa[0] + xa[1]*xa[1] + xa[2]*xa[2] - s2;
+    g[1] = xb[0]*xb[0] + xb[1]*xb[1] + xb[2]*xb[2] - s2;
+    g[2] = xc[0]*xc[0] + xc[1]*xc[1] + xc[2]*xc[2] - s2;
+    g[3] = xa[0]*xb[0] + xa[1]*xb[1] + xa[2]*xb[2];
+    g[4] = xa[0]*xc[0] + xa[1]*xc[1] + xa[2]*xc[2];
+    g[5] = xb[0]*xc[0] + xb[1]*xc[1] + xb[2]*xc[2];
+    for ( int i = 0; i < 6; i++ ){
+      if (fabs(TacsRealPart(g[i])) > tol){
+        return 0;
+      }
+    }
+  }
+
+  // Compute the parametric derivatives of the solution at the nodes
+  TacsScalar *Ua = &Ud[0];
+  TacsScalar *Ub = &Ud[vars_per_node*nnodes];
+  TacsScalar *Uc = &Ud[2*vars_per_node*nnodes];
+  tensor_interp3d(order, order, order, order,
+                  Nd, N, N, vars_per_node, uvals, Ua, work);
+  tensor_interp3d(order, order, order, order,
+                  N, Nd, N, vars_per_node, uvals, Ub, work);
+  tensor_interp3d(order, order, order, order,
+                  N, N, Nd, vars_per_node, uvals, Uc, work);
+
+  // Set the right-hand-side in the parametric directions
+  double wvals[3];
+  getReconWeights3D(order, wvals);
+  for ( int c = 0, kk = 0; kk < order; kk++ ){
+    for ( int jj = 0; jj < order; jj++ ){
+      for ( int ii = 0; ii < order; ii++, c++ ){
+        double w = wvals[ii]*wvals[jj]*wvals[kk];
+        const TacsScalar *xa = &Xa[3*c], *xb = &Xb[3*c], *xc = &Xc[3*c];
+        const TacsScalar *ud = &uderiv[deriv_per_node*c];
+        for ( int k = 0; k < vars_per_node; k++ ){
+          b[neq*k+3*c] =
+            w*(xa[0]*ud[0] + xa[1]*ud[1] + xa[2]*ud[2] -
+               Ua[vars_per_node*c + k]);
+          b[neq*k+3*c+1] =
+            w*(xb[0]*ud[0] + xb[1]*ud[1] + xb[2]*ud[2] -
+               Ub[vars_per_node*c + k]);
+          b[neq*k+3*c+2] =
+            w*(xc[0]*ud[0] + xc[1]*ud[1] + xc[2]*ud[2] -
+               Uc[vars_per_node*c + k]);
+          ud += 3;
+        }
+      }
+    }
+  }
+
+  // Compute ubar^{T} = b^{T}*pinv^{T} for all components at once
+  int m = vars_per_node, n = nenrich, k = neq;
+  TacsScalar alpha = 1.0, beta = 0.0;
+  BLASgemm("T", "T", &m, &n, &k, &alpha, b, &k, pinv, &n,
+           &beta, ubar, &m);
+
+  return 1;
+}
+
 /*
   Given the values of the derivatives of one component of the
   displacement at the nodes, compute the reconstruction over the
@@ -826,6 +1079,7 @@ static void computeElemRecon2D( const int vars_per_node,
   Xpts:    the element node locations
   uvals:   the solution at the nodes
   uderiv:  the derivative of the solution in x/y/z at the nodes
+  cache:   (optional) cached pseudo-inverse for uniformly scaled elements
 
   output:
   ubar:    the values of the coefficients on the enrichment functions
@@ -837,7 +1091,13 @@ static void computeElemRecon3D( const int vars_per_node,
                                 const TacsScalar uvals[],
                                 const TacsScalar uderiv[],
                                 TacsScalar ubar[],
-                                TacsScalar *tmp ){
+                                TacsScalar *tmp,
+                                ElemReconCache3D *cache=NULL ){
+  // Use the cached pseudo-inverse for uniformly scaled elements
+  if (cache && cache->computeRecon(Xpts, uvals, uderiv, ubar)){
+    return;
+  }
+
   // Get information about the interpolation
   const double *knots;
   const int order = forest->getInterpKnots(&knots);
@@ -860,13 +1120,7 @@ static void computeElemRecon3D( const int vars_per_node,
 
   // Set the weights
   double wvals[3];
-  if (order == 2){
-    wvals[0] = wvals[1] = 1.0;
-  }
-  else if (order == 3){
-    wvals[0] = wvals[2] = 0.5;
-    wvals[1] = 1.0;
-  }
+  getReconWeights3D(order, wvals);
 
   for ( int c = 0, kk = 0; kk < order; kk++ ){
     for ( int jj = 0; jj < order; jj++ ){
@@ -1228,9 +1482,21 @@ static void computeNodeDeriv3D( TMROctForest *forest,
   }
 
   // Allocate space for the element-wise values and derivatives
-  TacsScalar *Ud = new TacsScalar[ 3*vars_per_node ];
-  TacsScalar *uelem = new TacsScalar[ order*order*order*vars_per_node ];
-  TacsScalar *delem = new TacsScalar[ order*order*order*deriv_per_node ];
+  const int nnodes = order*order*order;
+  TacsScalar *uelem = new TacsScalar[ nnodes*vars_per_node ];
+  TacsScalar *delem = new TacsScalar[ nnodes*deriv_per_node ];
+
+  // Evaluate the 1-D shape functions at the knots so that the
+  // derivatives at the nodes can be computed by sum factorization
+  double *N = new double[ order*order ];
+  double *Nd = new double[ order*order ];
+  forest->evalInterp1D(order, knots, N, Nd);
+
+  // Allocate space for the parametric derivatives at the nodes
+  TacsScalar *Xd = new TacsScalar[ 9*nnodes ];
+  TacsScalar *Ud = new TacsScalar[ 3*vars_per_node*nnodes ];
+  int nvars = (vars_per_node > 3 ? vars_per_node : 3);
+  TacsScalar *work = new TacsScalar[ 2*nvars*order*order*order ];
 
   // Perform the reconstruction for the local
   for ( int index = 0; index < nelems; index++ ){
@@ -1257,61 +1523,60 @@ static void computeNodeDeriv3D( TMROctForest *forest,
     TacsScalar Xpts[3*MAX_ORDER*MAX_ORDER*MAX_ORDER];
     tacs->getElement(elem, Xpts);
 
+    // Compute the derivatives of the node locations and the solution
+    // along the parametric directions at all the nodes
+    TacsScalar *Xa = &Xd[0], *Xb = &Xd[3*nnodes], *Xc = &Xd[6*nnodes];
+    tensor_interp3d(order, order, order, order,
+                    Nd, N, N, 3, Xpts, Xa, work);
+    tensor_interp3d(order, order, order, order,
+                    N, Nd, N, 3, Xpts, Xb, work);
+    tensor_interp3d(order, order, order, order,
+                    N, N, Nd, 3, Xpts, Xc, work);
+
+    TacsScalar *Ua = &Ud[0];
+    TacsScalar *Ub = &Ud[vars_per_node*nnodes];
+    TacsScalar *Uc = &Ud[2*vars_per_node*nnodes];
+    tensor_interp3d(order, order, order, order,
+                    Nd, N, N, vars_per_node, uelem, Ua, work);
+    tensor_interp3d(order, order, order, order,
+                    N, Nd, N, vars_per_node, uelem, Ub, work);
+    tensor_interp3d(order, order, order, order,
+                    N, N, Nd, vars_per_node, uelem, Uc, work);
+
     // Compute the derivative of the components of the variables along
     // each of the 3-coordinate directions
     TacsScalar *d = delem;
 
     // Compute the contributions to the derivative from this side of
     // the element
-    for ( int kk = 0; kk < order; kk++ ){
-      for ( int jj = 0; jj < order; jj++ ){
-        for ( int ii = 0; ii < order; ii++ ){
-          double pt[3];
-          pt[0] = knots[ii];
-          pt[1] = knots[jj];
-          pt[2] = knots[kk];
-
-          // Evaluate the the shape functions
-          double N[MAX_ORDER*MAX_ORDER*MAX_ORDER];
-          double Na[MAX_ORDER*MAX_ORDER*MAX_ORDER];
-          double Nb[MAX_ORDER*MAX_ORDER*MAX_ORDER];
-          double Nc[MAX_ORDER*MAX_ORDER*MAX_ORDER];
-          forest->evalInterp(pt, N, Na, Nb, Nc);
-
-          // Evaluate the Jacobian transformation at this point
-          TacsScalar Xd[9], J[9];
-          computeJacobianTrans3D(Xpts, Na, Nb, Nc, Xd, J,
-                                 order*order*order);
-
-          // Compute the derivatives from the interpolated solution
-          memset(Ud, 0, 3*vars_per_node*sizeof(TacsScalar));
-          for ( int k = 0; k < vars_per_node; k++ ){
-            const TacsScalar *ue = &uelem[k];
-            for ( int i = 0; i < order*order*order; i++ ){
-              Ud[3*k] += ue[0]*Na[i];
-              Ud[3*k+1] += ue[0]*Nb[i];
-              Ud[3*k+2] += ue[0]*Nc[i];
-              ue += vars_per_node;
-            }
-          }
+    for ( int c = 0; c < nnodes; c++ ){
+      // Evaluate the Jacobian transformation at this node
+      TacsScalar Xn[9], J[9];
+      for ( int i = 0; i < 3; i++ ){
+        Xn[i] = Xa[3*c+i];
+        Xn[3+i] = Xb[3*c+i];
+        Xn[6+i] = Xc[3*c+i];
+      }
+      FElibrary::jacobian3d(Xn, J);
 
-          // Evaluate the x/y/z derivatives of each value at the
-          // independent nodes
-          TacsScalar winv = 1.0/welem[ii + jj*order + kk*order*order];
-          if (nodes[ii + jj*order + kk*order*order] >= 0){
-            for ( int k = 0; k < vars_per_node; k++ ){
-              d[0] = winv*(Ud[3*k]*J[0] + Ud[3*k+1]*J[1] + Ud[3*k+2]*J[2]);
-              d[1] = winv*(Ud[3*k]*J[3] + Ud[3*k+1]*J[4] + Ud[3*k+2]*J[5]);
-              d[2] = winv*(Ud[3*k]*J[6] + Ud[3*k+1]*J[7] + Ud[3*k+2]*J[8]);
-              d += 3;
-            }
-          }
-          else {
-            for ( int k = 0; k < vars_per_node; k++ ){
-              d[0] = d[1] = d[2] = 0.0;
-              d += 3;
-            }
-          }
+      // Evaluate the x/y/z derivatives of each value at the
+      // independent nodes
+      TacsScalar winv = 1.0/welem[c];
+      if (nodes[c] >= 0){
+        for ( int k = 0; k < vars_per_node; k++ ){
+          TacsScalar ua = Ua[vars_per_node*c + k];
+          TacsScalar ub = Ub[vars_per_node*c + k];
+          TacsScalar uc = Uc[vars_per_node*c + k];
+          d[0] = winv*(ua*J[0] + ub*J[1] + uc*J[2]);
+          d[1] = winv*(ua*J[3] + ub*J[4] + uc*J[5]);
+          d[2] = winv*(ua*J[6] + ub*J[7] + uc*J[8]);
+          d += 3;
+        }
+      }
+      else {
+        for ( int k = 0; k < vars_per_node; k++ ){
+          d[0] = d[1] = d[2] = 0.0;
+          d += 3;
         }
       }
     }
@@ -1324,6 +1589,10 @@ static void computeNodeDeriv3D( TMROctForest *forest,
   delete [] Ud;
   delete [] uelem;
   delete [] delem;
+  delete [] N;
+  delete [] Nd;
+  delete [] Xd;
+  delete [] work;
 
   // Add the values in parallel
   uderiv->beginSetValues(TACS_ADD_VALUES);
@@ -1376,6 +1645,12 @@ void addRefinedSolution2D( TMRQuadForest *forest,
   // Refined element solution
   TacsScalar *uref = new TacsScalar[ vars_per_node*num_refined_nodes ];
 
+  // Evaluate the 1-D interpolant at the refined knots once so that
+  // the refined solution can be computed using sum factorization
+  double *Nref = new double[ order*refined_order ];
+  forest->evalInterp1D(refined_order, refined_knots, Nref);
+  TacsScalar *work = new TacsScalar[ vars_per_node*refined_order*order ];
+
   // The maximum number of nodes for any element
   TacsScalar Xpts[3*MAX_ORDER*MAX_ORDER];
 
@@ -1458,8 +1733,9 @@ void addRefinedSolution2D( TMRQuadForest *forest,
       const int *refined_nodes;
       tacs_refined->getElement(elem, &refined_nodes, &len);
 
-      // Zero the refined element contribution
-      memset(uref, 0, vars_per_node*num_refined_nodes*sizeof(TacsScalar));
+      // Interpolate the element solution to the refined nodes
+      tensor_interp2d(order, refined_order, refined_order,
+                      Nref, Nref, vars_per_node, uelem, uref, work);
 
       // Compute the element order
       for ( int m = 0; m < refined_order; m++ ){
@@ -1469,21 +1745,6 @@ void addRefinedSolution2D( TMRQuadForest *forest,
           pt[0] = refined_knots[n];
           pt[1] = refined_knots[m];
 
-          // Evaluate the shape functions
-          double N[MAX_ORDER*MAX_ORDER];
-          forest->evalInterp(pt, N);
-
-          // Set the values of the variables at this point
-          for ( int i = 0; i < vars_per_node; i++ ){
-            const TacsScalar *ue = &uelem[i];
-            TacsScalar *u = &uref[vars_per_node*(n + refined_order*m) + i];
-
-            for ( int k = 0; k < num_nodes; k++ ){
-              u[0] += N[k]*ue[0];
-              ue += vars_per_node;
-            }
-          }
-
           // Evaluate the enrichment functions and add them to the
           // solution
           double Nr[MAX_2D_ENRICH];
@@ -1521,6 +1782,8 @@ void addRefinedSolution2D( TMRQuadForest *forest,
   delete [] delem;
   delete [] ubar;
   delete [] uref;
+  delete [] Nref;
+  delete [] work;
 }
 
 /*
@@ -1556,13 +1819,24 @@ void addRefinedSolution3D( TMROctForest *forest,
   // Allocate space for the element reconstruction problem
   TacsScalar *tmp = new TacsScalar[ neq*(nenrich + vars_per_node) ];
 
+  // Cache the reconstruction for uniformly scaled elements
+  ElemReconCache3D *cache =
+    new ElemReconCache3D(vars_per_node, forest, refined_forest);
+
   // Element solution on the coarse TACS mesh
   TacsScalar *uelem = new TacsScalar[ vars_per_node*order*order*order ];
   TacsScalar *delem = new TacsScalar[ deriv_per_node*order*order*order ];
   TacsScalar *ubar = new TacsScalar[ vars_per_node*nenrich ];
 
   // Refined element solution
-  TacsScalar *uref = new TacsScalar[ vars_per_node*order*order*order ];
+  TacsScalar *uref = new TacsScalar[ vars_per_node*num_refined_nodes ];
+
+  // Evaluate the 1-D interpolant at the refined knots once so that
+  // the refined solution can be computed using sum factorization
+  double *Nref = new double[ order*refined_order ];
+  forest->evalInterp1D(refined_order, refined_knots, Nref);
+  TacsScalar *work =
+    new TacsScalar[ vars_per_node*refined_order*order*(order + refined_order) ];
 
   // The maximum number of nodes for any element
   TacsScalar Xpts[3*MAX_ORDER*MAX_ORDER*MAX_ORDER];
@@ -1594,7 +1868,7 @@ void addRefinedSolution3D( TMROctForest *forest,
 
     // Compute the reconstruction weights for the enrichment functions
     computeElemRecon3D(vars_per_node, forest, refined_forest,
-                       Xpts, uelem, delem, ubar, tmp);
+                       Xpts, uelem, delem, ubar, tmp, cache);
 
     if (compute_difference){
       // Get the refined element nodes
@@ -1654,8 +1928,9 @@ void addRefinedSolution3D( TMROctForest *forest,
       const int *refined_nodes;
       refined_tacs->getElement(elem, &refined_nodes, &len);
 
-      // Zero the refined element contribution
-      memset(uref, 0, vars_per_node*num_refined_nodes*sizeof(TacsScalar));
+      // Interpolate the element solution to the refined nodes
+      tensor_interp3d(order, refined_order, refined_order, refined_order,
+                      Nref, Nref, Nref, vars_per_node, uelem, uref, work);
 
       for ( int p = 0; p < refined_order; p++ ){
         for ( int m = 0; m < refined_order; m++ ){
@@ -1666,23 +1941,12 @@ void addRefinedSolution3D( TMROctForest *forest,
             pt[1] = refined_knots[m];
             pt[2] = refined_knots[p];
 
-            // Evaluate the shape functions and the enrichment
-            // functions at the new parametric point
-            double N[MAX_ORDER*MAX_ORDER*MAX_ORDER];
-            forest->evalInterp(pt, N);
-
-            // Add the portion from the enrichment functions
+            // Evaluate the enrichment functions at the new
+            // parametric point
             int offset = (n + refined_order*m +
                           refined_order*refined_order*p);
             TacsScalar *u = &uref[vars_per_node*offset];
 
-            for ( int i = 0; i < vars_per_node; i++ ){
-              const TacsScalar *ue = &uelem[i];
-              for ( int k = 0; k < order*order*order; k++ ){
-                u[i] += N[k]*ue[vars_per_node*k];
-              }
-            }
-
             double Nr[MAX_3D_ENRICH];
             if (order == 2){
               eval2ndEnrichmentFuncs3D(pt, Nr);
@@ -1718,10 +1982,13 @@ void addRefinedSolution3D( TMROctForest *forest,
 
   // Free allocated data
   delete [] tmp;
+  delete cache;
   delete [] uelem;
   delete [] delem;
   delete [] ubar;
   delete [] uref;
+  delete [] Nref;
+  delete [] work;
 }
 
 /*
@@ -2603,6 +2870,8 @@ double TMR_StrainEnergyErrorEst( TMROctForest *forest,
 
   // Allocate space for the element reconstruction problem
   TacsScalar *tmp = new TacsScalar[ neq*(nenrich + vars_per_node) ];
+  ElemReconCache3D *cache =
+    new ElemReconCache3D(vars_per_node, forest, refined_forest);
   TacsScalar *ubar = new TacsScalar[ vars_per_node*nenrich ];
   TacsScalar *delem = new TacsScalar[ deriv_per_node*num_nodes ];
 
@@ -2662,7 +2931,7 @@ double TMR_StrainEnergyErrorEst( TMROctForest *forest,
 
     // Compute the enrichment functions for each degree of freedom
     computeElemRecon3D(vars_per_node, forest, refined_forest,
-                       Xpts, vars_elem, delem, ubar, tmp);
+                       Xpts, vars_elem, delem, ubar, tmp, cache);
 
     // Set the variables to zero
     memset(vars_interp, 0, vars_per_node*num_refined_nodes*sizeof(TacsScalar));
@@ -2719,6 +2988,7 @@ double TMR_StrainEnergyErrorEst( TMROctForest *forest,
 
   // Free the element-related data
   delete [] tmp;
+  delete cache;
   delete [] ubar;
   delete [] delem;
   delete [] vars_elem;
@@ -2822,6 +3092,263 @@ void TMR_PrintErrorBins( MPI_Comm comm,
   }
 }
 
+/*
+  Find the largest threshold such that the weights of the elements
+  with values at or above the threshold sum to at least the target.
+
+  This is a parallel selection that avoids sorting the values. Each
+  round bins the values within the current interval into a histogram,
+  sums the histogram across all processors and narrows the interval to
+  the bin that contains the target. Each round reduces the interval
+  by a factor of NUM_BINS so that only a few reductions are required
+  to resolve the threshold to machine precision.
+
+  When use_weights is true, the values themselves are the weights,
+  otherwise each element has a unit weight. The sign flips the values
+  so that the smallest values can be selected.
+*/
+static double selectThreshold( MPI_Comm comm, int nelems,
+                               const double *values, double sign,
+                               int use_weights, double target ){
+  const int NUM_BINS = 256;
+  const int MAX_ROUNDS = 8;
+  double bins[NUM_BINS];
+
+  // Find the range of the values across all processors
+  double range[2] = {-HUGE_VAL, -HUGE_VAL};
+  for ( int i = 0; i < nelems; i++ ){
+    double v = sign*values[i];
+    if (-v > range[0]){ range[0] = -v; }
+    if (v > range[1]){ range[1] = v; }
+  }
+  MPI_Allreduce(MPI_IN_PLACE, range, 2, MPI_DOUBLE, MPI_MAX, comm);
+  double low = -range[0];
+  double high = range[1];
+
+  // The upper bound is included only until the top bin is discarded
+  int include_high = 1;
+  double remaining = target;
+
+  for ( int round = 0; round < MAX_ROUNDS; round++ ){
+    double width = (high - low)/NUM_BINS;
+    if (!(width > 1e-15*fmax(fabs(low), fabs(high)))){
+      break;
+    }
+
+    // Bin the values that lie within the current interval
+    memset(bins, 0, NUM_BINS*sizeof(double));
+    for ( int i = 0; i < nelems; i++ ){
+      double v = sign*values[i];
+      if (v >= low && (v < high || (include_high && v == high))){
+        int k = (int)((v - low)/width);
+        if (k < 0){ k = 0; }
+        if (k >= NUM_BINS){ k = NUM_BINS-1; }
+        bins[k] += (use_weights ? values[i] : 1.0);
+      }
+    }
+    MPI_Allreduce(MPI_IN_PLACE, bins, NUM_BINS, MPI_DOUBLE, MPI_SUM, comm);
+
+    // Find the bin that contains the target, starting from the top
+    int k = NUM_BINS-1;
+    double above = 0.0;
+    for ( ; k > 0; k-- ){
+      if (above + bins[k] >= remaining){
+        break;
+      }
+      above += bins[k];
+    }
+    remaining -= above;
+
+    // Narrow the interval to the selected bin
+    if (k < NUM_BINS-1){
+      include_high = 0;
+      high = low + (k+1)*width;
+    }
+    low = low + k*width;
+  }
+
+  return sign*low;
+}
+
+/*
+  Mark the elements whose values lie at or above the threshold for
+  refinement and return the number of marked elements on all procs
+*/
+static int markAboveThreshold( MPI_Comm comm, int nelems,
+                               const double *values, double sign,
+                               double threshold, int flag, int refine[] ){
+  int count = 0;
+  for ( int i = 0; i < nelems; i++ ){
+    if (sign*values[i] >= sign*threshold){
+      refine[i] = flag;
+      count++;
+    }
+  }
+  MPI_Allreduce(MPI_IN_PLACE, &count, 1, MPI_INT, MPI_SUM, comm);
+  return count;
+}
+
+/*
+  Mark the elements for refinement using the given criterion. This is
+  the implementation shared by the quadtree and octree versions.
+*/
+static int markRefinement( MPI_Comm comm, TACSAssembler *tacs,
+                           int num_children,
+                           TMRMarkCriterion criterion,
+                           const double thresholds[],
+                           const double *values,
+                           int refine[], int dv_index ){
+  const int nelems = tacs->getNumElements();
+  memset(refine, 0, nelems*sizeof(int));
+
+  if (criterion == TMR_MARK_DENSITY_BANDS ||
+      criterion == TMR_MARK_DENSITY_BANDS_REVERSE){
+    const double lower = thresholds[0];
+    const double upper = thresholds[1];
+    const int flag = (criterion == TMR_MARK_DENSITY_BANDS ? 1 : -1);
+
+    // Evaluate the density at the parametric origin of each element
+    const double pt[3] = {0.0, 0.0, 0.0};
+    TACSElement **elements = tacs->getElements();
+
+    int count = 0;
+    for ( int i = 0; i < nelems; i++ ){
+      double value = 0.0;
+      if (values){
+        value = values[i];
+      }
+      else {
+        TACSConstitutive *con = NULL;
+        if (elements[i]){
+          con = elements[i]->getConstitutive();
+        }
+        if (!con){
+          continue;
+        }
+        value = TacsRealPart(con->getDVOutputValue(dv_index, pt));
+      }
+
+      if (value >= upper){
+        refine[i] = flag;
+        count++;
+      }
+      else if (value <= lower){
+        refine[i] = -flag;
+        count++;
+      }
+    }
+    MPI_Allreduce(MPI_IN_PLACE, &count, 1, MPI_INT, MPI_SUM, comm);
+    return count;
+  }
+
+  if (!values){
+    fprintf(stderr, "TMR_MarkRefinement Error: The element error "
+            "values must be provided\n");
+    return 0;
+  }
+
+  // Compute the total number of elements and the total error
+  double totals[2] = {1.0*nelems, 0.0};
+  for ( int i = 0; i < nelems; i++ ){
+    totals[1] += values[i];
+  }
+  MPI_Allreduce(MPI_IN_PLACE, totals, 2, MPI_DOUBLE, MPI_SUM, comm);
+  const double ntotal = totals[0];
+  const double error_total = totals[1];
+
+  if (criterion == TMR_MARK_ERROR_FRACTION){
+    // Mark the smallest set of elements with the largest errors whose
+    // errors sum to the given fraction of the total (Dorfler marking)
+    double target = thresholds[0]*error_total;
+    if (target <= 0.0){
+      return 0;
+    }
+    double t = selectThreshold(comm, nelems, values, 1.0, 1, target);
+    return markAboveThreshold(comm, nelems, values, 1.0, t, 1, refine);
+  }
+  else if (criterion == TMR_MARK_FIXED_FRACTION){
+    // Mark the given fraction of elements with the largest errors
+    double target = ceil(thresholds[0]*ntotal);
+    if (target <= 0.0){
+      return 0;
+    }
+    double t = selectThreshold(comm, nelems, values, 1.0, 0, target);
+    return markAboveThreshold(comm, nelems, values, 1.0, t, 1, refine);
+  }
+  else if (criterion == TMR_MARK_TARGET_COUNT){
+    // Each refined element adds num_children-1 elements, while each
+    // complete set of coarsened siblings removes num_children-1
+    double ntarget = thresholds[0];
+    if (ntarget > ntotal){
+      double target = ceil((ntarget - ntotal)/(num_children-1));
+      if (target > ntotal){
+        target = ntotal;
+      }
+      double t = selectThreshold(comm, nelems, values, 1.0, 0, target);
+      return markAboveThreshold(comm, nelems, values, 1.0, t, 1, refine);
+    }
+    else if (ntarget < ntotal){
+      double target =
+        ceil(num_children*(ntotal - ntarget)/(num_children-1));
+      if (target > ntotal){
+        target = ntotal;
+      }
+      double t = selectThreshold(comm, nelems, values, -1.0, 0, target);
+      return markAboveThreshold(comm, nelems, values, -1.0, t, -1, refine);
+    }
+  }
+
+  return 0;
+}
+
+/*
+  Mark the elements in the forest for refinement or coarsening
+
+  The refine[] array is set for all of the local elements and can be
+  passed directly to the forest's refine() call. The criteria are:
+
+  TMR_MARK_DENSITY_BANDS: Refine elements whose density is at or
+  above thresholds[1] and coarsen those at or below thresholds[0]. The
+  density is taken from the values or, when the values are NULL, from
+  the constitutive design output at the element's parametric origin.
+
+  TMR_MARK_DENSITY_BANDS_REVERSE: As above, with refinement and
+  coarsening reversed.
+
+  TMR_MARK_ERROR_FRACTION: Refine the smallest set of elements with
+  the largest errors whose errors sum to at least the fraction
+  thresholds[0] of the total error.
+
+  TMR_MARK_FIXED_FRACTION: Refine the fraction thresholds[0] of the
+  elements with the largest errors.
+
+  TMR_MARK_TARGET_COUNT: Refine the elements with the largest errors
+  or coarsen those with the smallest errors so that the mesh has
+  approximately thresholds[0] elements.
+
+  The selection for the error-based criteria is performed in parallel
+  without sorting the errors. Elements with tied values at the
+  threshold are all marked. The function returns the number of
+  elements marked across all processors.
+*/
+int TMR_MarkRefinement( TMRQuadForest *forest, TACSAssembler *tacs,
+                        TMRMarkCriterion criterion,
+                        const double thresholds[],
+                        const double *values, int refine[],
+                        int dv_index ){
+  return markRefinement(forest->getMPIComm(), tacs, 4, criterion,
+                        thresholds, values, refine, dv_index);
+}
+
+int TMR_MarkRefinement( TMROctForest *forest, TACSAssembler *tacs,
+                        TMRMarkCriterion criterion,
+                        const double thresholds[],
+                        const double *values, int refine[],
+                        int dv_index ){
+  return markRefinement(forest->getMPIComm(), tacs, 8, criterion,
+                        thresholds, values, refine, dv_index);
+}
+
 /*!
   Create a nodal vector from the forest
 */
@@ -3259,6 +3786,13 @@ double TMR_AdjointErrorEst( TMROctForest *forest,
   return total_error_remain;
 }
 
+/*
+  The number of values stored at each quadrature point by the stress
+  constraint: the Jacobian transformation, the strain, the determinant
+  times the quadrature weight and the failure value
+*/
+static const int STRESS_QUAD_CACHE_SIZE = 17;
+
 /*
   Evaluate the stress constraints on a more-refined mesh
 */
@@ -3327,6 +3861,17 @@ TMRStressConstraint::TMRStressConstraint( TMROctForest *_forest,
   varderiv = new TacsScalar[ deriv_per_node*max_nodes ];
   ubar = new TacsScalar[ vars_per_node*max_enrich ];
   tmp = new TacsScalar[ neq*(max_enrich + vars_per_node) ];
+
+  // The cache of the values at the quadrature points is allocated
+  // and filled by evalConstraint()
+  const double *gaussPts, *gaussWts;
+  num_quad_pts = FElibrary::getGaussPtsWts(order+1, &gaussPts, &gaussWts);
+  use_quad_cache = 1;
+  quad_cache = NULL;
+
+  // Set the KS values until the constraint is evaluated
+  ks_max_fail = 0.0;
+  ks_fail_sum = 1.0;
 }
 
 /*
@@ -3347,14 +3892,38 @@ TMRStressConstraint::~TMRStressConstraint(){
   delete [] varderiv;
   delete [] ubar;
   delete [] tmp;
+  if (quad_cache){ delete [] quad_cache; }
+}
+
+/*
+  Set whether to cache the values at the quadrature points in
+  evalConstraint() for use in evalConDeriv(). Disabling the cache
+  frees it, and evalConDeriv() then re-computes the reconstruction and
+  the strain for each element.
+*/
+void TMRStressConstraint::setUseQuadCache( int truth ){
+  use_quad_cache = truth;
+  if (!use_quad_cache && quad_cache){
+    delete [] quad_cache;
+    quad_cache = NULL;
+  }
 }
 
 /*
   Evaluate the constraint on the refined mesh
+
+  The KS function is aggregated in a single pass over the elements
+  using a running maximum. When a new maximum failure value is found,
+  the partial sum is rescaled so that all the terms remain relative to
+  the current maximum. The local sums are then shifted to the global
+  maximum, requiring only one reduction for the maximum and one for
+  the sum. Unless the cache is disabled, the Jacobian, strain and
+  failure value at each quadrature point are cached for the subsequent
+  call to evalConDeriv().
 */
 TacsScalar TMRStressConstraint::evalConstraint( TACSBVec *_uvec ){
   const int vars_per_node = tacs->getVarsPerNode();
-  
+
   // Copy the values
   uvec->copyValues(_uvec);
 
@@ -3372,20 +3941,10 @@ TacsScalar TMRStressConstraint::evalConstraint( TACSBVec *_uvec ){
   // Set the communicator
   MPI_Comm comm = tacs->getMPIComm();
 
-  // First, go through and evaluate the maximum stress
-  // in all of the elements
-  ks_max_fail = -1e20;
-
   // Get the quadrature points/weights
   const double *gaussPts, *gaussWts;
-
-  //int num_quad_pts = FElibrary::getGaussPtsWts(order+1, &gaussPts, &gaussWts);
-  int num_quad_pts =
-    FElibrary::getGaussPtsWts(order+1, &gaussPts, &gaussWts);
-
-  // int num_quad_pts =
-  //   FElibrary::getGaussPtsWts(LOBATTO_QUADRATURE, order+2,
-  //                             &gaussPts, &gaussWts);
+  FElibrary::getGaussPtsWts(order+1, &gaussPts, &gaussWts);
+  const int nquad = num_quad_pts*num_quad_pts*num_quad_pts;
 
   // Get the local connectivity for the higher-order mesh
   const int *conn = NULL;
@@ -3395,72 +3954,17 @@ TacsScalar TMRStressConstraint::evalConstraint( TACSBVec *_uvec ){
   TMRPoint *X;
   interp_forest->getPoints(&X);
 
-  for ( int i = 0; i < nelems; i++ ){
-    // Get the element class and the variables associated with it
-    TACSElement *elem = tacs->getElement(i, Xpts, vars, dvars, ddvars);
+  // Cache the reconstruction for uniformly scaled elements
+  ElemReconCache3D *cache =
+    new ElemReconCache3D(vars_per_node, forest, interp_forest);
 
-    // Get the constitutive relationship
-    TACSConstitutive *con = elem->getConstitutive();
-
-    // Get the node numbers and node locations for this element
-    int len;
-    const int *nodes;
-    tacs->getElement(i, &nodes, &len);
-    tacs->getElement(i, Xpts);
-
-    // Retrieve the nodal values and nodal derivatives
-    uvec->getValues(len, nodes, vars);
-    uderiv->getValues(len, nodes, varderiv);
-
-    // Now get the node locations for the locally refined mesh
-    const int interp_elem_size = (order+1)*(order+1)*(order+1);
-    for ( int j = 0; j < interp_elem_size; j++ ){
-      int c = conn[interp_elem_size*i + j];
-      int node = interp_forest->getLocalNodeNumber(c);
-      Xpts[3*j] = X[node].x;
-      Xpts[3*j+1] = X[node].y;
-      Xpts[3*j+2] = X[node].z;
-    }
-
-    // Compute the values of the enrichment coefficient for each
-    // degree of freedom
-    computeElemRecon3D(vars_per_node, forest, interp_forest,
-                       Xpts, vars, varderiv, ubar, tmp);
-
-    // For each quadrature point, evaluate the strain at the
-    // quadrature point and evaluate the stress constraint
-    for ( int kk = 0; kk < num_quad_pts; kk++ ){
-      for ( int jj = 0; jj < num_quad_pts; jj++ ){
-        for ( int ii = 0; ii < num_quad_pts; ii++ ){
-          // Pick the quadrature point at which we will
-          // evaluate the strain
-          double pt[3];
-          pt[0] = gaussPts[ii];
-          pt[1] = gaussPts[jj];
-          pt[2] = gaussPts[kk];
-
-          // Evaluate the strain
-          TacsScalar J[9], e[6];
-          evalStrain(pt, Xpts, vars, ubar, J, e);
-
-          // Evaluate the failure criteria
-          TacsScalar fval;
-          con->failure(pt, e, &fval);
-
-          if (TacsRealPart(fval) >
-              TacsRealPart(ks_max_fail)){
-            ks_max_fail = fval;
-          }
-        }
-      }
-    }
+  // Allocate the cache of the values at the quadrature points
+  if (use_quad_cache && !quad_cache){
+    quad_cache = new TacsScalar[ nelems*nquad*STRESS_QUAD_CACHE_SIZE ];
   }
 
-  // Find the maximum failure value across all of the processors
-  MPI_Allreduce(MPI_IN_PLACE, &ks_max_fail, 1, TACS_MPI_TYPE, MPI_MAX, comm);
-
-  // Compute the sum over all the element - integrate the sum over all
-  // elements/procs
+  // The running maximum and the sum relative to the maximum
+  ks_max_fail = -1e20;
   ks_fail_sum = 0.0;
 
   for ( int i = 0; i < nelems; i++ ){
@@ -3474,7 +3978,6 @@ TacsScalar TMRStressConstraint::evalConstraint( TACSBVec *_uvec ){
     int len;
     const int *nodes;
     tacs->getElement(i, &nodes, &len);
-    tacs->getElement(i, Xpts);
 
     // Retrieve the nodal values and nodal derivatives
     uvec->getValues(len, nodes, vars);
@@ -3493,10 +3996,14 @@ TacsScalar TMRStressConstraint::evalConstraint( TACSBVec *_uvec ){
     // Compute the values of the enrichment coefficient for each
     // degree of freedom
     computeElemRecon3D(vars_per_node, forest, interp_forest,
-                       Xpts, vars, varderiv, ubar, tmp);
+                       Xpts, vars, varderiv, ubar, tmp, cache);
 
     // For each quadrature point, evaluate the strain at the
     // quadrature point and evaluate the stress constraint
+    TacsScalar *q = NULL;
+    if (quad_cache){
+      q = &quad_cache[STRESS_QUAD_CACHE_SIZE*nquad*i];
+    }
     for ( int kk = 0; kk < num_quad_pts; kk++ ){
       for ( int jj = 0; jj < num_quad_pts; jj++ ){
         for ( int ii = 0; ii < num_quad_pts; ii++ ){
@@ -3508,21 +4015,44 @@ TacsScalar TMRStressConstraint::evalConstraint( TACSBVec *_uvec ){
           pt[2] = gaussPts[kk];
 
           // Evaluate the strain
-          TacsScalar J[9], e[6];
+          TacsScalar Jtmp[9], etmp[6];
+          TacsScalar *J = Jtmp, *e = etmp;
+          if (q){
+            J = &q[0];
+            e = &q[9];
+          }
           TacsScalar detJ = evalStrain(pt, Xpts, vars, ubar, J, e);
           detJ *= gaussWts[ii]*gaussWts[jj]*gaussWts[kk];
 
           // Evaluate the failure criteria
           TacsScalar fval;
           con->failure(pt, e, &fval);
+          if (q){
+            q[15] = detJ;
+            q[16] = fval;
+            q += STRESS_QUAD_CACHE_SIZE;
+          }
+
+          // Shift the sum if this is the new maximum
+          if (TacsRealPart(fval) > TacsRealPart(ks_max_fail)){
+            ks_fail_sum *= exp(ks_weight*(ks_max_fail - fval));
+            ks_max_fail = fval;
+          }
 
-          // Compute the sum of KS failure values
+          // Add the KS contribution relative to the current maximum
           ks_fail_sum += detJ*exp(ks_weight*(fval - ks_max_fail));
         }
       }
     }
   }
 
+  delete cache;
+
+  // Find the maximum failure value across all of the processors and
+  // shift the local sum relative to the global maximum
+  TacsScalar local_max = ks_max_fail;
+  MPI_Allreduce(MPI_IN_PLACE, &ks_max_fail, 1, TACS_MPI_TYPE, MPI_MAX, comm);
+  ks_fail_sum *= exp(ks_weight*(local_max - ks_max_fail));
   MPI_Allreduce(MPI_IN_PLACE, &ks_fail_sum, 1, TACS_MPI_TYPE, MPI_SUM, comm);
 
   TacsScalar ks_func_val = ks_max_fail + log(ks_fail_sum)/ks_weight;
@@ -3539,6 +4069,11 @@ TacsScalar TMRStressConstraint::evalConstraint( TACSBVec *_uvec ){
 
 /*
   Evaluate the derivative w.r.t. state and design vectors
+
+  The derivative is evaluated for the solution passed to the last call
+  to evalConstraint(). The values at the quadrature points are taken
+  from the cache if it was filled by that call, otherwise they are
+  re-computed from the stored copy of that solution.
 */
 void TMRStressConstraint::evalConDeriv( TacsScalar *dfdx, int size,
                                         TACSBVec *dfdu ){
@@ -3576,11 +4111,8 @@ void TMRStressConstraint::evalConDeriv( TacsScalar *dfdx, int size,
 
   // Get the quadrature points/weights
   const double *gaussPts, *gaussWts;
-  int num_quad_pts =
-    FElibrary::getGaussPtsWts(order+1, &gaussPts, &gaussWts);
-  // int num_quad_pts =
-  //   FElibrary::getGaussPtsWts(LOBATTO_QUADRATURE, order+2,
-  //                             &gaussPts, &gaussWts);
+  FElibrary::getGaussPtsWts(order+1, &gaussPts, &gaussWts);
+  const int nquad = num_quad_pts*num_quad_pts*num_quad_pts;
 
   // Get the local connectivity for the higher-order mesh
   const int *conn = NULL;
@@ -3605,6 +4137,12 @@ void TMRStressConstraint::evalConDeriv( TacsScalar *dfdx, int size,
   TacsScalar *dfduderiv_elem = new TacsScalar[3*n];
   TacsScalar *duderiv_du = new TacsScalar[3*n*3*p];
 
+  // Cache the reconstruction when the values must be re-computed
+  ElemReconCache3D *cache = NULL;
+  if (!quad_cache){
+    cache = new ElemReconCache3D(vars_per_node, forest, interp_forest);
+  }
+
   for ( int i = 0; i < nelems; i++ ){
     // Get the element class and the variables associated with it
     TACSElement *elem = tacs->getElement(i, Xpts, vars, dvars, ddvars);
@@ -3621,10 +4159,6 @@ void TMRStressConstraint::evalConDeriv( TacsScalar *dfdx, int size,
     TacsScalar welem[order*order*order];
     weights->getValues(len, nodes, welem);
 
-    // Retrieve the nodal values and nodal derivatives
-    uvec->getValues(len, nodes, vars);
-    uderiv->getValues(len, nodes, varderiv);
-
     // Now get the node locations for the locally refined mesh
     const int interp_elem_size = (order+1)*(order+1)*(order+1);
     for ( int j = 0; j < interp_elem_size; j++ ){
@@ -3635,10 +4169,18 @@ void TMRStressConstraint::evalConDeriv( TacsScalar *dfdx, int size,
       Xpts[3*j+2] = X[node].z;
     }
 
-    // Compute the values of the enrichment coefficient for each
-    // degree of freedom
-    computeElemRecon3D(vars_per_node, forest, interp_forest,
-                       Xpts, vars, varderiv, ubar, tmp);
+    // Get the cached values at the quadrature points, or compute the
+    // reconstruction required to re-compute them
+    const TacsScalar *q = NULL;
+    if (quad_cache){
+      q = &quad_cache[STRESS_QUAD_CACHE_SIZE*nquad*i];
+    }
+    else {
+      uvec->getValues(len, nodes, vars);
+      uderiv->getValues(len, nodes, varderiv);
+      computeElemRecon3D(vars_per_node, forest, interp_forest,
+                         Xpts, vars, varderiv, ubar, tmp, cache);
+    }
 
     // Zero variables before elementwise operations begin
     memset(dfdu_elem, 0, 3*p*sizeof(TacsScalar));
@@ -3660,14 +4202,22 @@ void TMRStressConstraint::evalConDeriv( TacsScalar *dfdx, int size,
           pt[1] = gaussPts[jj];
           pt[2] = gaussPts[kk];
 
-          // Evaluate the strain
-          TacsScalar J[9], e[6];
-          TacsScalar detJ = evalStrain(pt, Xpts, vars, ubar, J, e);
-          detJ *= gaussWts[ii]*gaussWts[jj]*gaussWts[kk];
-
-          // Evaluate the failure criteria
-          TacsScalar fval;
-          con->failure(pt, e, &fval);
+          // Retrieve or evaluate the strain and failure value
+          TacsScalar Jtmp[9], etmp[6];
+          const TacsScalar *J = Jtmp, *e = etmp;
+          TacsScalar detJ, fval;
+          if (q){
+            J = &q[0];
+            e = &q[9];
+            detJ = q[15];
+            fval = q[16];
+            q += STRESS_QUAD_CACHE_SIZE;
+          }
+          else {
+            detJ = evalStrain(pt, Xpts, vars, ubar, Jtmp, etmp);
+            detJ *= gaussWts[ii]*gaussWts[jj]*gaussWts[kk];
+            con->failure(pt, etmp, &fval);
+          }
 
           // Compute the weight at this point
           TacsScalar kw = detJ*exp(ks_weight*(fval - ks_max_fail))/ks_fail_sum;
@@ -3785,6 +4335,10 @@ void TMRStressConstraint::evalConDeriv( TacsScalar *dfdx, int size,
     dfduderiv->setValues(len, nodes, dfduderiv_elem, TACS_ADD_VALUES);
   }
 
+  if (cache){
+    delete cache;
+  }
+
   // Add the values across all processors
   dfduderiv->beginSetValues(TACS_ADD_VALUES);
   dfduderiv->endSetValues(TACS_ADD_VALUES);
@@ -5302,6 +5856,11 @@ TacsScalar TMRCurvatureConstraint::evalConstraint( TACSBVec *_xvec ){
 
 /*
   Evaluate the derivative w.r.t. state and design vectors
+
+  The derivative is evaluated for the solution passed to the last call
+  to evalConstraint(). The values at the quadrature points are taken
+  from the cache if it was filled by that call, otherwise they are
+  re-computed from the stored copy of that solution.
 */
 /*
 void TMRStressConstraint::evalConDeriv( TacsScalar *dfdx, int size,
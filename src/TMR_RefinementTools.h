@@ -28,17 +28,23 @@
 
 /*
   Create a TACS multigrid object
+
+  The optional array of nlevels-1 interpolation caches is used to
+  avoid re-computing the interpolation between levels for octants
+  or quadrants that have not changed since the last call.
 */
 void TMR_CreateTACSMg( int nlevels, TACSAssembler *tacs[],
                        TMROctForest *forest[], TACSMg **_mg,
                        double omega=1.0,
                        int use_coarse_direct_solve=1,
-                       int use_chebyshev_smoother=0 );
+                       int use_chebyshev_smoother=0,
+                       TMROctInterpCache *cache[]=NULL );
 void TMR_CreateTACSMg( int nlevels, TACSAssembler *tacs[],
                        TMRQuadForest *forest[], TACSMg **_mg,
                        double omega=1.0,
                        int use_coarse_direct_solve=1,
-                       int use_chebyshev_smoother=0 );
+                       int use_chebyshev_smoother=0,
+                       TMRQuadInterpCache *cache[]=NULL );
 
 /*
   Compute a direct interpolation from a lower-order mesh to a
@@ -82,6 +88,30 @@ void TMR_PrintErrorBins( MPI_Comm comm, const double *error,
                          const int nelems, double *mean=NULL,
                          double *stddev=NULL );
 
+/*
+  The criteria used to mark elements for refinement
+*/
+enum TMRMarkCriterion { TMR_MARK_DENSITY_BANDS,
+                        TMR_MARK_DENSITY_BANDS_REVERSE,
+                        TMR_MARK_ERROR_FRACTION,
+                        TMR_MARK_FIXED_FRACTION,
+                        TMR_MARK_TARGET_COUNT };
+
+/*
+  Mark the elements for refinement (1) or coarsening (-1) based on
+  element densities or element error values
+*/
+int TMR_MarkRefinement( TMRQuadForest *forest, TACSAssembler *tacs,
+                        TMRMarkCriterion criterion,
+                        const double thresholds[],
+                        const double *values, int refine[],
+                        int dv_index=0 );
+int TMR_MarkRefinement( TMROctForest *forest, TACSAssembler *tacs,
+                        TMRMarkCriterion criterion,
+                        const double thresholds[],
+                        const double *values, int refine[],
+                        int dv_index=0 );
+
 /*
   Perform a mesh refinement based on the strain engery refinement
   criteria.
@@ -123,6 +153,13 @@ double TMR_AdjointErrorEst( TMROctForest *forest,
 
   This makes strong assumptions about the element type and constitutive
   matrix. Be careful when using this method
+
+  By default, evalConstraint() caches the Jacobian, strain and failure
+  value at each quadrature point for evalConDeriv(). This is 17
+  scalars at each of the (order+1)^3 quadrature points, or about
+  3.7 KB per element for order 2 and 8.7 KB per element for order 3.
+  When the cache is disabled, evalConDeriv() re-computes these values
+  from the solution passed to the last call to evalConstraint().
 */
 class TMRStressConstraint : public TMREntity {
  public:
@@ -131,6 +168,9 @@ class TMRStressConstraint : public TMREntity {
                        TacsScalar _ks_weight=30.0 );
   ~TMRStressConstraint();
 
+  // Set whether to cache the quadrature point values
+  void setUseQuadCache( int truth );
+
   // Evaluate the aggregated stress constraint across all processors
   TacsScalar evalConstraint( TACSBVec *_uvec );
 
@@ -193,6 +233,12 @@ class TMRStressConstraint : public TMREntity {
 
   // Temporary vector
   TacsScalar *tmp;
+
+  // The Jacobian, strain and failure value at each quadrature point
+  // of each element, cached by evalConstraint() for evalConDeriv()
+  int num_quad_pts;
+  int use_quad_cache;
+  TacsScalar *quad_cache;
 };
 
 /*
@@ -474,9 +474,11 @@ void compute_normal( Triangle tri, double n[] ){
   n[2] = a[0]*b[1] - a[1]*b[0];
 
   double norm = sqrt(n[0]*n[0] + n[1]*n[1] + n[2]*n[2]);
-  n[0] /= norm;
-  n[1] /= norm;
-  n[2] /= norm;
+  if (norm != 0.0){
+    n[0] /= norm;
+    n[1] /= norm;
+    n[2] /= norm;
+  }
 }
 
 /*
@@ -537,10 +539,20 @@ int face_polygonize( Point *p, double vals[], double cutoff,
   return ntri;
 }
 
+/*
+  Base class for the objects that receive the triangles generated
+  from the level set
+*/
+class TriangleSink {
+ public:
+  virtual ~TriangleSink(){}
+  virtual void addTriangle( Triangle *tri ) = 0;
+};
+
 /*
   Keep a list of all the triangles
 */
-class TriangleList {
+class TriangleList : public TriangleSink {
  public:
   TriangleList( Triangle *tris, int ntris ){
     triangles = tris;
@@ -620,7 +632,7 @@ class TriangleList {
 /*
   Write out the triangular volume elements within the STL file
 */
-void add_volume( TriangleList *list, Cell *grid, double cutoff ){
+void add_volume( TriangleSink *list, Cell *grid, double cutoff ){
   Triangle triangles[5];
   int ntri = polygonise(*grid, cutoff, triangles);
 
@@ -633,7 +645,8 @@ void add_volume( TriangleList *list, Cell *grid, double cutoff ){
 /*
   Write out the intersection of the face with the boundaries
 */
-void add_faces( TriangleList *list, Cell *grid, double cutoff, int bound[] ){
+void add_faces( TriangleSink *list, Cell *grid, double cutoff,
+                int bound[] ){
   // Loop over each of the faces
   for ( int face = 0; face < 6; face++ ){
     // Extract the points and values from the face
@@ -688,19 +701,14 @@ void TMR_MPICommitSTLTypes(){
 
 const int ordering_transform[] = {0, 1, 3, 2, 4, 5, 7, 6};
 
-int TMR_GenerateBinFile( const char *filename,
-                         TMROctForest *filter,
-                         TACSBVec *x, int x_offset,
-                         double cutoff ){
-  // Set the return flag
-  int fail = 0;
-
-  // Get the MPI communicator
-  int mpi_size, mpi_rank;  
-  MPI_Comm comm = filter->getMPIComm();
-  MPI_Comm_size(comm, &mpi_size);
-  MPI_Comm_rank(comm, &mpi_rank);
-
+/*
+  Generate the triangles from the intersection of the level set with
+  the locally owned octants and pass them to the sink as they are
+  created.
+*/
+static void generate_triangles( TMROctForest *filter,
+                                TACSBVec *x, int x_offset,
+                                double cutoff, TriangleSink *list ){
   // Retrieve the mesh order
   const int mesh_order = filter->getMeshOrder();
 
@@ -717,9 +725,6 @@ int TMR_GenerateBinFile( const char *filename,
   // Set the maximum length of any of the block sides
   const int32_t hmax = 1 << TMR_MAX_LEVEL;
 
-  // Create the list of Triangles
-  TriangleList *list = new TriangleList(4096);
-
   // Get the block -> face information and the face -> block info.
   // This will be used to determine which faces lie on the boundaries
   // of the domain
@@ -801,7 +806,7 @@ int TMR_GenerateBinFile( const char *filename,
             Xe[index] = X[node];
           }
           else {
-            printf("TMR_GenerateBinFile: Failed at node with block: "
+            printf("TMR_GenerateTriangles: Failed at node with block: "
                    "%d x %d y: %d z: %d\n",
                    octs[i].block, octs[i].x, octs[i].y, octs[i].z);
           }
@@ -909,6 +914,24 @@ int TMR_GenerateBinFile( const char *filename,
   delete [] xvars;
   delete [] levelvals;
   delete [] Xe;
+}
+
+int TMR_GenerateBinFile( const char *filename,
+                         TMROctForest *filter,
+                         TACSBVec *x, int x_offset,
+                         double cutoff ){
+  // Set the return flag
+  int fail = 0;
+
+  // Get the MPI communicator
+  int mpi_size, mpi_rank;
+  MPI_Comm comm = filter->getMPIComm();
+  MPI_Comm_size(comm, &mpi_size);
+  MPI_Comm_rank(comm, &mpi_rank);
+
+  // Create the list of Triangles
+  TriangleList *list = new TriangleList(4096);
+  generate_triangles(filter, x, x_offset, cutoff, list);
 
   // Commit the types if they are not defined
   if (!MPI_Point_type){
@@ -991,3 +1014,166 @@ int TMR_ConvertBinToSTL( const char *binfile,
 
   return 0;
 }
+
+/*
+  Count the triangles without storing them
+*/
+class TriangleCounter : public TriangleSink {
+ public:
+  TriangleCounter(){
+    count = 0;
+  }
+  void addTriangle( Triangle *tri ){
+    count++;
+  }
+
+  long long count;
+};
+
+/*
+  Write the triangles as binary STL facets at the given offset in the
+  file. The facets are packed into a fixed-size buffer that is written
+  out each time it is full so that the memory required is independent
+  of the number of triangles.
+*/
+class TriangleSTLWriter : public TriangleSink {
+ public:
+  static const int FACET_SIZE = 50;
+
+  TriangleSTLWriter( MPI_File _fp, MPI_Offset _offset, int _max_len ){
+    fp = _fp;
+    offset = _offset;
+    fail = 0;
+    len = 0;
+    max_len = _max_len;
+    if (max_len < 100){ max_len = 100; }
+    buffer = new char[ FACET_SIZE*max_len ];
+  }
+  ~TriangleSTLWriter(){
+    delete [] buffer;
+  }
+
+  // Pack the facet: the normal and vertices as single precision
+  // followed by a two-byte attribute count
+  void addTriangle( Triangle *tri ){
+    if (len >= max_len){
+      flush();
+    }
+
+    double n[3];
+    compute_normal(*tri, n);
+    float data[12];
+    for ( int k = 0; k < 3; k++ ){
+      data[k] = n[k];
+      data[3+3*k] = tri->p[k].x;
+      data[4+3*k] = tri->p[k].y;
+      data[5+3*k] = tri->p[k].z;
+    }
+    uint16_t attr = 0;
+
+    char *facet = &buffer[FACET_SIZE*len];
+    memcpy(facet, data, 12*sizeof(float));
+    memcpy(&facet[12*sizeof(float)], &attr, sizeof(uint16_t));
+    len++;
+  }
+
+  // Write out the buffered facets
+  void flush(){
+    if (len > 0){
+      if (MPI_File_write_at(fp, offset, buffer, FACET_SIZE*len, MPI_BYTE,
+                            MPI_STATUS_IGNORE) != MPI_SUCCESS){
+        fail = 1;
+      }
+      offset += FACET_SIZE*len;
+      len = 0;
+    }
+  }
+
+  int fail;
+
+ private:
+  MPI_File fp;
+  MPI_Offset offset;
+  int len, max_len;
+  char *buffer;
+};
+
+/*
+  Write the level set directly to a binary STL file in parallel.
+
+  The triangles are generated twice: once to count the number of
+  triangles on each processor, which fixes the offset of each
+  processor's facets in the file, and a second time to write them to
+  the file in fixed-size chunks.
+*/
+int TMR_WriteSTLFile( const char *filename,
+                      TMROctForest *filter,
+                      TACSBVec *x, int x_offset,
+                      double cutoff ){
+  // Get the MPI communicator
+  int mpi_rank;
+  MPI_Comm comm = filter->getMPIComm();
+  MPI_Comm_rank(comm, &mpi_rank);
+
+  // Count the number of local triangles
+  TriangleCounter counter;
+  generate_triangles(filter, x, x_offset, cutoff, &counter);
+
+  // Find the offset for the triangles on this processor and the total
+  // number of triangles
+  long long ntris = counter.count;
+  long long start = 0, total = 0;
+  MPI_Exscan(&ntris, &start, 1, MPI_LONG_LONG_INT, MPI_SUM, comm);
+  if (mpi_rank == 0){
+    start = 0;
+  }
+  MPI_Allreduce(&ntris, &total, 1, MPI_LONG_LONG_INT, MPI_SUM, comm);
+
+  // Copy the filename to a non-const array
+  char *fname = new char[ strlen(filename)+1 ];
+  strcpy(fname, filename);
+
+  // Create the file, removing any existing contents
+  MPI_File fp = NULL;
+  int fail = 0;
+  if (MPI_File_open(comm, fname, MPI_MODE_WRONLY | MPI_MODE_CREATE,
+                    MPI_INFO_NULL, &fp) != MPI_SUCCESS){
+    fail = 1;
+  }
+  delete [] fname;
+  if (fail){
+    return fail;
+  }
+  MPI_File_set_size(fp, 0);
+
+  // Write the 80 byte header and the number of triangles
+  const int header_size = 84;
+  if (mpi_rank == 0){
+    char header[header_size];
+    memset(header, 0, header_size);
+    snprintf(header, 80, "TMR level set %g", cutoff);
+    uint32_t count = total;
+    memcpy(&header[80], &count, sizeof(uint32_t));
+    if (MPI_File_write_at(fp, 0, header, header_size, MPI_BYTE,
+                          MPI_STATUS_IGNORE) != MPI_SUCCESS){
+      fail = 1;
+    }
+  }
+
+  // Write out the facets from this processor
+  MPI_Offset offset = header_size;
+  offset += TriangleSTLWriter::FACET_SIZE*((MPI_Offset)start);
+  TriangleSTLWriter *writer = new TriangleSTLWriter(fp, offset, 4096);
+  generate_triangles(filter, x, x_offset, cutoff, writer);
+  writer->flush();
+  fail = fail || writer->fail;
+  delete writer;
+
+  MPI_File_close(&fp);
+
+  // Make the return flag consistent across all processors
+  int flag = fail;
+  MPI_Allreduce(&flag, &fail, 1, MPI_INT, MPI_MAX, comm);
+
+  return fail;
+}
@@ -29,7 +29,9 @@
   file for visualization from the data contained in the TMROctForest
   object.
 
-  The generation of the STL file requires two steps:
+  TMR_WriteSTLFile writes a binary STL file directly in parallel
+  using MPI/IO. Alternatively, the generation of an ASCII STL file
+  requires two steps:
 
   1) The data is written in parallel across all processors to an
   intermediate binary file format that contains the point loops
@@ -77,4 +79,26 @@ extern int TMR_GenerateBinFile( const char *filename,
 extern int TMR_ConvertBinToSTL( const char *binfile,
                                 const char *stlfile );
 
+/*
+  Write the intersection of the level set with the grid directly to a
+  binary STL file.
+
+  This is a collective call. Each processor writes its facets at its
+  own offset in the file using MPI/IO, generating the triangles in
+  chunks, so no processor stores the full surface. The facets are
+  written in the native byte order, which is little endian on the
+  platforms of interest, as required by the binary STL format.
+
+  input:
+  filename:   the filename (the same on all processors)
+  filter:     the octant forest
+  x:          the vertex-values of the design variables
+  x_offset:   the offset variable values
+  cutoff      the level set design variable value
+*/
+extern int TMR_WriteSTLFile( const char *filename,
+                             TMROctForest *filter,
+                             TACSBVec *x, int x_offset,
+                             double cutoff );
+
 #endif // TMR_STL_TOOLS_H
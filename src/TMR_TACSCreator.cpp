@@ -330,6 +330,10 @@ void TMRQuadTACSCreator::setNodeLocations( TMRQuadForest *forest,
 TMROctTACSCreator::TMROctTACSCreator( TMRBoundaryConditions *_bcs ){
   bcs = _bcs;
   if (bcs){ bcs->incref(); }
+
+  num_prototypes = 0;
+  prototype_blocks = NULL;
+  prototypes = NULL;
 }
 
 /*
@@ -337,6 +341,110 @@ TMROctTACSCreator::TMROctTACSCreator( TMRBoundaryConditions *_bcs ){
 */
 TMROctTACSCreator::~TMROctTACSCreator(){
   if (bcs){ bcs->decref(); }
+  for ( int i = 0; i < num_prototypes; i++ ){
+    prototypes[i]->decref();
+  }
+  if (prototype_blocks){ delete [] prototype_blocks; }
+  if (prototypes){ delete [] prototypes; }
+}
+
+/*
+  Set the element that will be used for all octants in the given block
+
+  When element prototypes are set, createTACS() assigns the elements
+  directly based on the block index of each octant and the
+  createElements() call is skipped. The block index is the index of
+  the volume in the topology. The octant tags are not used since the
+  forest overwrites them. The same element object is shared by all of
+  the octants in the block. Setting a prototype for a block that
+  already has one replaces the previous element.
+*/
+void TMROctTACSCreator::setElementPrototype( int block, TACSElement *elem ){
+  if (!elem){
+    return;
+  }
+  elem->incref();
+
+  // Replace the element if the block already has a prototype
+  for ( int i = 0; i < num_prototypes; i++ ){
+    if (prototype_blocks[i] == block){
+      prototypes[i]->decref();
+      prototypes[i] = elem;
+      return;
+    }
+  }
+
+  // Extend the arrays
+  int *new_blocks = new int[ num_prototypes+1 ];
+  TACSElement **new_prototypes = new TACSElement*[ num_prototypes+1 ];
+  if (num_prototypes > 0){
+    memcpy(new_blocks, prototype_blocks, num_prototypes*sizeof(int));
+    memcpy(new_prototypes, prototypes, num_prototypes*sizeof(TACSElement*));
+    delete [] prototype_blocks;
+    delete [] prototypes;
+  }
+  new_blocks[num_prototypes] = block;
+  new_prototypes[num_prototypes] = elem;
+  num_prototypes++;
+  prototype_blocks = new_blocks;
+  prototypes = new_prototypes;
+}
+
+/*
+  Create the elements using the element prototypes
+*/
+void TMROctTACSCreator::createElements( int order,
+                                        TMROctForest *forest,
+                                        int num_elements,
+                                        TACSElement **elements ){
+  setElementsFromPrototypes(forest, num_elements, elements);
+}
+
+/*
+  Assign the elements from the prototypes based on the octant block
+
+  The octants are ordered by block, so the last matching block is
+  checked first before searching the full list. The function returns
+  the number of octants without a matching prototype.
+*/
+int TMROctTACSCreator::setElementsFromPrototypes( TMROctForest *forest,
+                                                  int num_elements,
+                                                  TACSElement **elements ){
+  // Get the array of octants
+  int size;
+  TMROctant *array;
+  TMROctantArray *octants;
+  forest->getOctants(&octants);
+  octants->getArray(&array, &size);
+
+  int fail = 0;
+  int last = 0;
+  for ( int i = 0; i < num_elements; i++ ){
+    elements[i] = NULL;
+    if (num_prototypes > 0){
+      if (prototype_blocks[last] != array[i].block){
+        for ( int j = 0; j < num_prototypes; j++ ){
+          if (prototype_blocks[j] == array[i].block){
+            last = j;
+            break;
+          }
+        }
+      }
+      if (prototype_blocks[last] == array[i].block){
+        elements[i] = prototypes[last];
+      }
+    }
+    if (!elements[i]){
+      fail++;
+    }
+  }
+
+  if (fail){
+    fprintf(stderr, "TMROctTACSCreator Error: No element prototype "
+            "for %d octants\n", fail);
+  }
+
+  return fail;
 }
 
 /*
@@ -374,17 +482,58 @@ TACSAssembler*
   int num_dep_nodes = forest->getDepNodeConn(&dep_ptr, &dep_conn,
                                              &dep_weights);
 
-  // Create the elements using the virtual call
+  // Create the elements from the prototypes if they are set,
+  // otherwise use the virtual call
   TACSElement **elements = NULL;
   if (num_elements > 0){
     elements = new TACSElement*[ num_elements ];
   }
-  createElements(order, forest, num_elements, elements);
+  if (num_prototypes > 0){
+    setElementsFromPrototypes(forest, num_elements, elements);
+  }
+  else {
+    createElements(order, forest, num_elements, elements);
+  }
+
+  // Check that every octant has an element on all processors
+  int fail = 0;
+  for ( int i = 0; i < num_elements; i++ ){
+    if (!elements[i]){
+      fail = 1;
+      break;
+    }
+  }
+  MPI_Allreduce(MPI_IN_PLACE, &fail, 1, MPI_INT, MPI_MAX, comm);
+  if (fail){
+    if (mpi_rank == 0){
+      fprintf(stderr, "TMROctTACSCreator Error: Elements were not created "
+              "for all octants, cannot create TACSAssembler\n");
+    }
+    // Free the elements that were created. Each element is incref'd
+    // before any are decref'd so that an element shared by several
+    // octants is freed once, and elements that are still referenced
+    // elsewhere, such as the prototypes, are not freed.
+    for ( int i = 0; i < num_elements; i++ ){
+      if (elements[i]){
+        elements[i]->incref();
+      }
+    }
+    for ( int i = 0; i < num_elements; i++ ){
+      if (elements[i]){
+        elements[i]->decref();
+      }
+    }
+    delete [] ptr;
+    if (elements){
+      delete [] elements;
+    }
+    return NULL;
+  }
 
   // Create the first element - and read out the number of
   // variables-per-node
   int vars_per_node = 0;
-  if (num_elements > 0){
+  if (num_elements > 0 && elements[0]){
     vars_per_node = elements[0]->numDisplacements();
   }
   MPI_Allreduce(MPI_IN_PLACE, &vars_per_node, 1, MPI_INT, MPI_MAX, comm);
@@ -30,7 +30,9 @@
   These are virtual base classes. It is necessary to override the
   createElement() and optionally the createAuxElement()
   functions. These functions create the appropriate TACS element
-  objects needed for TACSAssembler.
+  objects needed for TACSAssembler. Alternatively, for octree meshes,
+  an element prototype can be set for each block (volume) so that the
+  elements are assigned without a per-element call.
 */
 
 #include "TMRQuadForest.h"
@@ -126,11 +128,12 @@ class TMROctTACSCreator : public TMREntity {
   TMROctTACSCreator( TMRBoundaryConditions *_bcs );
   virtual ~TMROctTACSCreator();
 
-  // Create an array of elements for the given forest
+  // Create an array of elements for the given forest. By default,
+  // the element prototypes are used.
   virtual void createElements( int order,
                                TMROctForest *forest,
                                int num_elements,
-                               TACSElement **elements ) = 0;
+                               TACSElement **elements );
 
   // Create any auxiliary element for the given quadrant
   virtual TACSAuxElements *createAuxElements( int order,
@@ -142,6 +145,9 @@ class TMROctTACSCreator : public TMREntity {
   void addBoundaryCondition( const char *name, 
                              int num_bcs, const int bc_nums[] );
 
+  // Set the element used for all octants in the given block
+  void setElementPrototype( int block, TACSElement *elem );
+
   // Create the TACSAssembler object with the given order for this forest
   TACSAssembler *createTACS( TMROctForest *forest,
                              TACSAssembler::OrderingType 
@@ -156,7 +162,17 @@ class TMROctTACSCreator : public TMREntity {
   void setNodeLocations( TMROctForest *forest, 
                          TACSAssembler *tacs );
 
+  // Set the elements from the prototypes based on the octant blocks
+  int setElementsFromPrototypes( TMROctForest *forest,
+                                 int num_elements,
+                                 TACSElement **elements );
+
   TMRBoundaryConditions *bcs;
+
+  // The element prototypes and their associated blocks
+  int num_prototypes;
+  int *prototype_blocks;
+  TACSElement **prototypes;
 };
 
 #endif // TMR_TACS_CREATOR
@@ -0,0 +1,215 @@
+/*
+  This file is part of the package TMR for adaptive mesh refinement.
+
+  Copyright (C) 2015 Georgia Tech Research Corporation.
+  Additional copyright (C) 2015 Graeme Kennedy.
+  All rights reserved.
+
+  TMR is licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this software except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+  
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <stdio.h>
+#include "TMR_VTKTools.h"
+
+/*
+  Write the XML header of the .vtu file. The appended data arrays are
+  listed in the order: points, connectivity, offsets, types and then
+  the cell data. Each array is preceded by its size in bytes stored as
+  an unsigned 64-bit integer. The offsets of the arrays are computed
+  from the global number of points and cells and are stored in
+  offset.
+
+  This is evaluated on all processors so that every processor knows
+  the length of the header.
+*/
+static int write_vtu_header( char *header, int max_len,
+                             int64_t num_points, int64_t num_cells,
+                             int nodes_per_cell,
+                             int ncell_data, const char *cell_data_names[],
+                             int64_t *offset ){
+  // Determine the byte order of this machine
+  uint16_t one = 1;
+  const char *byte_order = "BigEndian";
+  if (*(char*)&one){
+    byte_order = "LittleEndian";
+  }
+
+  // Compute the offsets to the arrays in the appended data
+  const int64_t size_prefix = sizeof(uint64_t);
+  offset[0] = 0;
+  offset[1] = offset[0] + size_prefix + 3*sizeof(double)*num_points;
+  offset[2] = offset[1] + size_prefix +
+    sizeof(int64_t)*nodes_per_cell*num_cells;
+  offset[3] = offset[2] + size_prefix + sizeof(int64_t)*num_cells;
+  offset[4] = offset[3] + size_prefix + sizeof(uint8_t)*num_cells;
+  for ( int k = 0; k < ncell_data; k++ ){
+    offset[5+k] = offset[4+k] + size_prefix + sizeof(int32_t)*num_cells;
+  }
+
+  int len = 0;
+  len += snprintf(&header[len], max_len-len,
+                  "<?xml version=\"1.0\"?>\n"
+                  "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" "
+                  "byte_order=\"%s\" header_type=\"UInt64\">\n"
+                  "<UnstructuredGrid>\n"
+                  "<Piece NumberOfPoints=\"%lld\" NumberOfCells=\"%lld\">\n"
+                  "<Points>\n"
+                  "<DataArray type=\"Float64\" NumberOfComponents=\"3\" "
+                  "format=\"appended\" offset=\"%lld\"/>\n"
+                  "</Points>\n"
+                  "<Cells>\n"
+                  "<DataArray type=\"Int64\" Name=\"connectivity\" "
+                  "format=\"appended\" offset=\"%lld\"/>\n"
+                  "<DataArray type=\"Int64\" Name=\"offsets\" "
+                  "format=\"appended\" offset=\"%lld\"/>\n"
+                  "<DataArray type=\"UInt8\" Name=\"types\" "
+                  "format=\"appended\" offset=\"%lld\"/>\n"
+                  "</Cells>\n"
+                  "<CellData>\n",
+                  byte_order, (long long)num_points, (long long)num_cells,
+                  (long long)offset[0], (long long)offset[1],
+                  (long long)offset[2], (long long)offset[3]);
+  for ( int k = 0; k < ncell_data; k++ ){
+    len += snprintf(&header[len], max_len-len,
+                    "<DataArray type=\"Int32\" Name=\"%s\" "
+                    "format=\"appended\" offset=\"%lld\"/>\n",
+                    cell_data_names[k], (long long)offset[4+k]);
+  }
+  len += snprintf(&header[len], max_len-len,
+                  "</CellData>\n"
+                  "</Piece>\n"
+                  "</UnstructuredGrid>\n"
+                  "<AppendedData encoding=\"raw\">\n_");
+
+  return len;
+}
+
+/*
+  Write an unstructured mesh to a VTK XML (.vtu) file in parallel
+*/
+int TMR_WriteVTUFile( MPI_Comm comm, const char *filename,
+                      int npts, const TMRPoint *X,
+                      int ncells, int nodes_per_cell, int cell_type,
+                      const int64_t *conn,
+                      int ncell_data, const char *cell_data_names[],
+                      const int *cell_data[] ){
+  int mpi_rank;
+  MPI_Comm_rank(comm, &mpi_rank);
+
+  // Compute the offsets of the points and cells on this processor and
+  // the total number of points and cells
+  int64_t counts[2], start[2] = {0, 0}, totals[2];
+  counts[0] = npts;
+  counts[1] = ncells;
+  MPI_Exscan(counts, start, 2, MPI_INT64_T, MPI_SUM, comm);
+  if (mpi_rank == 0){
+    start[0] = start[1] = 0;
+  }
+  MPI_Allreduce(counts, totals, 2, MPI_INT64_T, MPI_SUM, comm);
+
+  // Compute the header and the offsets into the appended data
+  int max_len = 2048;
+  for ( int k = 0; k < ncell_data; k++ ){
+    max_len += 128 + strlen(cell_data_names[k]);
+  }
+  char *header = new char[ max_len ];
+  int64_t *offset = new int64_t[ 5+ncell_data ];
+  int header_len = write_vtu_header(header, max_len, totals[0], totals[1],
+                                    nodes_per_cell, ncell_data,
+                                    cell_data_names, offset);
+
+  // Copy the filename to a non-const array
+  char *fname = new char[ strlen(filename)+1 ];
+  strcpy(fname, filename);
+
+  // Create the file, removing any existing contents
+  MPI_File fp = NULL;
+  int fail = 0;
+  if (MPI_File_open(comm, fname, MPI_MODE_WRONLY | MPI_MODE_CREATE,
+                    MPI_INFO_NULL, &fp) != MPI_SUCCESS){
+    fail = 1;
+  }
+  delete [] fname;
+  if (fail){
+    delete [] header;
+    delete [] offset;
+    return fail;
+  }
+  MPI_File_set_size(fp, 0);
+
+  // The absolute offsets of the arrays in the file
+  const int num_arrays = 5+ncell_data;
+  for ( int k = 0; k < num_arrays; k++ ){
+    offset[k] += header_len;
+  }
+
+  // Write the header, the size of each array and the footer
+  if (mpi_rank == 0){
+    MPI_File_write_at(fp, 0, header, header_len, MPI_CHAR,
+                      MPI_STATUS_IGNORE);
+
+    for ( int k = 0; k < num_arrays-1; k++ ){
+      uint64_t size = offset[k+1] - offset[k] - sizeof(uint64_t);
+      MPI_File_write_at(fp, offset[k], &size, sizeof(uint64_t), MPI_BYTE,
+                        MPI_STATUS_IGNORE);
+    }
+
+    const char footer[] = "\n</AppendedData>\n</VTKFile>\n";
+    MPI_File_write_at(fp, offset[num_arrays-1], (void*)footer,
+                      strlen(footer), MPI_CHAR, MPI_STATUS_IGNORE);
+  }
+
+  // Write the points
+  MPI_Offset pos = offset[0] + sizeof(uint64_t) +
+    3*sizeof(double)*start[0];
+  MPI_File_write_at_all(fp, pos, (void*)X, 3*npts, MPI_DOUBLE,
+                        MPI_STATUS_IGNORE);
+
+  // Write the connectivity
+  pos = offset[1] + sizeof(uint64_t) +
+    sizeof(int64_t)*nodes_per_cell*start[1];
+  MPI_File_write_at_all(fp, pos, (void*)conn, nodes_per_cell*ncells,
+                        MPI_INT64_T, MPI_STATUS_IGNORE);
+
+  // Write the offsets
+  int64_t *cell_offset = new int64_t[ ncells ];
+  for ( int i = 0; i < ncells; i++ ){
+    cell_offset[i] = nodes_per_cell*(start[1] + i + 1);
+  }
+  pos = offset[2] + sizeof(uint64_t) + sizeof(int64_t)*start[1];
+  MPI_File_write_at_all(fp, pos, cell_offset, ncells, MPI_INT64_T,
+                        MPI_STATUS_IGNORE);
+  delete [] cell_offset;
+
+  // Write the cell types
+  uint8_t *types = new uint8_t[ ncells ];
+  memset(types, cell_type, ncells*sizeof(uint8_t));
+  pos = offset[3] + sizeof(uint64_t) + sizeof(uint8_t)*start[1];
+  MPI_File_write_at_all(fp, pos, types, ncells, MPI_BYTE,
+                        MPI_STATUS_IGNORE);
+  delete [] types;
+
+  // Write the cell data
+  for ( int k = 0; k < ncell_data; k++ ){
+    pos = offset[4+k] + sizeof(uint64_t) + sizeof(int32_t)*start[1];
+    MPI_File_write_at_all(fp, pos, (void*)cell_data[k], ncells, MPI_INT,
+                          MPI_STATUS_IGNORE);
+  }
+
+  MPI_File_close(&fp);
+
+  delete [] header;
+  delete [] offset;
+
+  return fail;
+}
@@ -0,0 +1,60 @@
+/*
+  This file is part of the package TMR for adaptive mesh refinement.
+
+  Copyright (C) 2015 Georgia Tech Research Corporation.
+  Additional copyright (C) 2015 Graeme Kennedy.
+  All rights reserved.
+
+  TMR is licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this software except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+  
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef TMR_VTK_TOOLS_H
+#define TMR_VTK_TOOLS_H
+
+#include "TMRBase.h"
+
+/*
+  Write an unstructured mesh to a VTK XML (.vtu) file in parallel.
+
+  The mesh data is written in the appended raw binary format using
+  MPI/IO. Each processor writes its own points and cells at offsets
+  computed from the counts on the lower ranks, so no data is gathered
+  to a single processor. The points on each processor are numbered
+  contiguously after the points on the lower ranks, and the
+  connectivity must be given in terms of this global point numbering.
+  This is a collective call.
+
+  input:
+  comm:            the MPI communicator
+  filename:        the file name (the same on all processors)
+  npts:            the number of points on this processor
+  X:               the point locations
+  ncells:          the number of cells on this processor
+  nodes_per_cell:  the number of nodes for each cell
+  cell_type:       the VTK cell type
+  conn:            the global connectivity for each cell
+  ncell_data:      the number of integer cell data fields
+  cell_data_names: the names of the cell data fields
+  cell_data:       the cell data values
+
+  returns:
+  fail:            non-zero if the file could not be written
+*/
+int TMR_WriteVTUFile( MPI_Comm comm, const char *filename,
+                      int npts, const TMRPoint *X,
+                      int ncells, int nodes_per_cell, int cell_type,
+                      const int64_t *conn,
+                      int ncell_data, const char *cell_data_names[],
+                      const int *cell_data[] );
+
+#endif // TMR_VTK_TOOLS_H
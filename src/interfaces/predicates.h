@@ -9,6 +9,9 @@ TMR_EXTERN_C_BEGIN
 void exactinit();
 double orient2d( double pa[], double pb[], double pc[] );
 double incircle( double pa[], double pb[], double pc[], double pd[] );
+double orient3d( double pa[], double pb[], double pc[], double pd[] );
+double insphere( double pa[], double pb[], double pc[], double pd[],
+                 double pe[] );
 TMR_EXTERN_C_END
 
 #endif // TMR_GEOMETRIC_PREDICATES_H
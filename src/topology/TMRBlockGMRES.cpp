@@ -0,0 +1,397 @@
+/*
+  This file is part of the package TMR for adaptive mesh refinement.
+
+  Copyright (C) 2015 Georgia Tech Research Corporation.
+  Additional copyright (C) 2015 Graeme Kennedy.
+  All rights reserved.
+
+  TMR is licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this software except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "TMRBlockGMRES.h"
+#include <string.h>
+
+/*
+  Create the block GMRES object
+
+  input:
+  mat:            the matrix operator
+  pc:             the preconditioner
+  subspace_size:  the subspace size per right-hand side
+  nrestart:       the number of restarts
+*/
+TMRBlockGMRES::TMRBlockGMRES( TACSMat *_mat, TACSPc *_pc,
+                              int _subspace_size, int _nrestart ){
+  mat = _mat;
+  pc = _pc;
+  mat->incref();
+  pc->incref();
+  monitor = NULL;
+
+  subspace_size = (_subspace_size > 1 ? _subspace_size : 1);
+  nrestart = (_nrestart > 1 ? _nrestart : 1);
+  rtol = 1e-8;
+  atol = 1e-30;
+
+  // The subspace is allocated when the block size is known
+  max_block_size = 0;
+  block_size = 0;
+  ncols = 0;
+  W = NULL;
+  work = work2 = NULL;
+  H = G = hcol = tmp = NULL;
+  cs = sn = NULL;
+  res_tol = NULL;
+}
+
+/*
+  Free the data
+*/
+TMRBlockGMRES::~TMRBlockGMRES(){
+  deallocate();
+  mat->decref();
+  pc->decref();
+  if (monitor){ monitor->decref(); }
+}
+
+/*
+  Set the relative and absolute tolerances
+*/
+void TMRBlockGMRES::setTolerances( double _rtol, double _atol ){
+  rtol = _rtol;
+  atol = _atol;
+}
+
+/*
+  Set the object that prints the residual history
+*/
+void TMRBlockGMRES::setMonitor( KSMPrint *_monitor ){
+  if (_monitor){
+    _monitor->incref();
+  }
+  if (monitor){
+    monitor->decref();
+  }
+  monitor = _monitor;
+}
+
+/*
+  Allocate the subspace for the given block size. The largest
+  subspace allocated so far is kept and re-used for all smaller block
+  sizes, so that alternating between block sizes does not re-allocate
+  the vectors.
+*/
+void TMRBlockGMRES::allocate( int nrhs ){
+  if (nrhs <= max_block_size){
+    block_size = nrhs;
+    ncols = subspace_size*block_size;
+    return;
+  }
+
+  // Free the existing subspace
+  deallocate();
+
+  max_block_size = nrhs;
+  block_size = nrhs;
+  ncols = subspace_size*block_size;
+
+  const int nrows = ncols + block_size;
+  W = new TACSVec*[ nrows ];
+  for ( int i = 0; i < nrows; i++ ){
+    W[i] = mat->createVec();
+    W[i]->incref();
+  }
+  work = mat->createVec();
+  work->incref();
+  work2 = mat->createVec();
+  work2->incref();
+
+  H = new TacsScalar[ nrows*ncols ];
+  G = new TacsScalar[ nrows*block_size ];
+  hcol = new TacsScalar[ nrows ];
+  tmp = new TacsScalar[ nrows ];
+  cs = new TacsScalar[ ncols*block_size ];
+  sn = new TacsScalar[ ncols*block_size ];
+  res_tol = new TacsScalar[ block_size ];
+}
+
+/*
+  Free the subspace
+*/
+void TMRBlockGMRES::deallocate(){
+  if (W){
+    const int nrows = (subspace_size + 1)*max_block_size;
+    for ( int i = 0; i < nrows; i++ ){
+      W[i]->decref();
+    }
+    delete [] W;
+    work->decref();
+    work2->decref();
+    delete [] H;
+    delete [] G;
+    delete [] hcol;
+    delete [] tmp;
+    delete [] cs;
+    delete [] sn;
+    delete [] res_tol;
+  }
+
+  max_block_size = 0;
+  block_size = 0;
+  ncols = 0;
+  W = NULL;
+  work = work2 = NULL;
+  H = G = hcol = tmp = NULL;
+  cs = sn = NULL;
+  res_tol = NULL;
+}
+
+/*
+  Orthogonalize w against the first nvecs vectors in the subspace
+  using classical Gram-Schmidt with one re-orthogonalization. The
+  coefficients are returned in h. The vector is normalized, unless it
+  is (numerically) in the span of the subspace, in which case it is
+  set to zero.
+*/
+TacsScalar TMRBlockGMRES::orthogonalize( TACSVec *w, int nvecs,
+                                         TacsScalar *h ){
+  for ( int i = 0; i < nvecs; i++ ){
+    h[i] = 0.0;
+  }
+
+  for ( int k = 0; k < 2 && nvecs > 0; k++ ){
+    w->mdot(W, tmp, nvecs);
+    for ( int i = 0; i < nvecs; i++ ){
+      w->axpy(-tmp[i], W[i]);
+      h[i] += tmp[i];
+    }
+  }
+
+  // Compare the norm to the norm before orthogonalization
+  TacsScalar hnorm = w->norm();
+  TacsScalar wnorm2 = hnorm*hnorm;
+  for ( int i = 0; i < nvecs; i++ ){
+    wnorm2 += h[i]*h[i];
+  }
+
+  if (TacsRealPart(hnorm) <= 1e-12*sqrt(TacsRealPart(wnorm2))){
+    w->zeroEntries();
+    hnorm = 0.0;
+  }
+  else {
+    w->scale(1.0/hnorm);
+  }
+
+  return hnorm;
+}
+
+/*
+  Solve the linear systems A*x[j] = b[j] for j = 0,...,nrhs-1.
+
+  The residuals R = B - A*X are orthonormalized to give the initial
+  block V*S. Residuals that are linearly dependent on the previous
+  ones are dropped from the block, so the band width q of the Arnoldi
+  process may be less than the number of right-hand sides. The band
+  Hessenberg matrix is reduced to upper triangular form with q Givens
+  rotations per column, and the same rotations are applied to S. The
+  residual norm of each right-hand side is then available after each
+  column without forming the solution.
+
+  input:
+  nrhs:        the number of right-hand sides
+  b:           the right-hand sides
+  zero_guess:  flag to indicate whether to zero the initial guess
+
+  output:
+  x:           the solutions
+*/
+int TMRBlockGMRES::solve( int nrhs, TACSVec **b, TACSVec **x,
+                          int zero_guess ){
+  if (nrhs <= 0){
+    return 1;
+  }
+
+  // Allocate the subspace
+  allocate(nrhs);
+
+  const int p = block_size;
+  const int nrows = ncols + p;
+
+  int converged = 0;
+  int iter = 0;
+
+  for ( int count = 0; count < nrestart && !converged; count++ ){
+    // Compute the residuals R = B - A*X and orthonormalize them such
+    // that R = V*S, where V has q <= p columns
+    int q = 0;
+    memset(G, 0, nrows*p*sizeof(TacsScalar));
+    for ( int j = 0; j < p; j++ ){
+      if (count == 0 && zero_guess){
+        x[j]->zeroEntries();
+        W[q]->copyValues(b[j]);
+      }
+      else {
+        mat->mult(x[j], W[q]);
+        W[q]->scale(-1.0);
+        W[q]->axpy(1.0, b[j]);
+      }
+
+      TacsScalar *g = &G[nrows*j];
+      g[q] = orthogonalize(W[q], q, g);
+      if (g[q] != 0.0){
+        q++;
+      }
+    }
+
+    // Set the tolerances based on the initial residual norms and
+    // check for convergence
+    TacsScalar res_max = 0.0;
+    converged = 1;
+    for ( int j = 0; j < p; j++ ){
+      TacsScalar res = 0.0;
+      for ( int i = 0; i < q; i++ ){
+        res += G[i + nrows*j]*G[i + nrows*j];
+      }
+      res = sqrt(res);
+
+      if (count == 0){
+        res_tol[j] = rtol*res;
+        if (TacsRealPart(res_tol[j]) < atol){
+          res_tol[j] = atol;
+        }
+      }
+      if (TacsRealPart(res) > TacsRealPart(res_tol[j])){
+        converged = 0;
+      }
+      if (TacsRealPart(res) > TacsRealPart(res_max)){
+        res_max = res;
+      }
+    }
+
+    if (monitor){
+      monitor->printResidual(iter, res_max);
+    }
+
+    // Build the subspace one column at a time
+    int k = 0;
+    int breakdown = 0;
+    for ( ; k < ncols && !converged && !breakdown; k++ ){
+      // Compute the next direction w = A*M^{-1}*v[k]
+      pc->applyFactor(W[k], work);
+      mat->mult(work, W[k+q]);
+
+      // Orthogonalize against the current subspace. If the new
+      // direction lies in the subspace, this is the last column.
+      TacsScalar *h = &H[nrows*k];
+      h[k+q] = orthogonalize(W[k+q], k+q, h);
+      for ( int i = k+q+1; i < nrows; i++ ){
+        h[i] = 0.0;
+      }
+      if (h[k+q] == 0.0){
+        breakdown = 1;
+      }
+
+      // Apply the rotations from the previous columns
+      for ( int kk = 0; kk < k; kk++ ){
+        for ( int l = q; l >= 1; l-- ){
+          const int r1 = kk + l-1, r2 = kk + l;
+          const TacsScalar c = cs[kk*p + l-1];
+          const TacsScalar s = sn[kk*p + l-1];
+          TacsScalar h1 = h[r1];
+          TacsScalar h2 = h[r2];
+          h[r1] = c*h1 + s*h2;
+          h[r2] = -s*h1 + c*h2;
+        }
+      }
+
+      // Compute the new rotations that eliminate the entries below
+      // the diagonal and apply them to the right-hand sides
+      for ( int l = q; l >= 1; l-- ){
+        const int r1 = k + l-1, r2 = k + l;
+        TacsScalar c = 1.0, s = 0.0;
+        if (h[r2] != 0.0){
+          TacsScalar rho = sqrt(h[r1]*h[r1] + h[r2]*h[r2]);
+          c = h[r1]/rho;
+          s = h[r2]/rho;
+          h[r1] = rho;
+          h[r2] = 0.0;
+        }
+        cs[k*p + l-1] = c;
+        sn[k*p + l-1] = s;
+
+        for ( int j = 0; j < p; j++ ){
+          TacsScalar g1 = G[r1 + nrows*j];
+          TacsScalar g2 = G[r2 + nrows*j];
+          G[r1 + nrows*j] = c*g1 + s*g2;
+          G[r2 + nrows*j] = -s*g1 + c*g2;
+        }
+      }
+      iter++;
+
+      // The residual norms are given by the last q rotated entries,
+      // plus the entries for any columns with a zero diagonal
+      res_max = 0.0;
+      converged = 1;
+      for ( int j = 0; j < p; j++ ){
+        TacsScalar res = 0.0;
+        for ( int i = 0; i <= k; i++ ){
+          if (H[i + nrows*i] == 0.0){
+            res += G[i + nrows*j]*G[i + nrows*j];
+          }
+        }
+        for ( int i = k+1; i <= k+q; i++ ){
+          res += G[i + nrows*j]*G[i + nrows*j];
+        }
+        res = sqrt(res);
+
+        if (TacsRealPart(res) > TacsRealPart(res_tol[j])){
+          converged = 0;
+        }
+        if (TacsRealPart(res) > TacsRealPart(res_max)){
+          res_max = res;
+        }
+      }
+
+      if (monitor){
+        monitor->printResidual(iter, res_max);
+      }
+    }
+
+    // Compute the solution update for each right-hand side
+    for ( int j = 0; j < p && k > 0; j++ ){
+      // Solve the upper triangular system in place
+      TacsScalar *y = &G[nrows*j];
+      for ( int i = k-1; i >= 0; i-- ){
+        for ( int ii = i+1; ii < k; ii++ ){
+          y[i] -= H[i + nrows*ii]*y[ii];
+        }
+        if (H[i + nrows*i] != 0.0){
+          y[i] /= H[i + nrows*i];
+        }
+        else {
+          y[i] = 0.0;
+        }
+      }
+
+      // x[j] += M^{-1}*V*y
+      work->zeroEntries();
+      for ( int i = 0; i < k; i++ ){
+        work->axpy(y[i], W[i]);
+      }
+      pc->applyFactor(work, work2);
+      x[j]->axpy(1.0, work2);
+    }
+  }
+
+  return converged;
+}
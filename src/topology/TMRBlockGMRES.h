@@ -0,0 +1,93 @@
+/*
+  This file is part of the package TMR for adaptive mesh refinement.
+
+  Copyright (C) 2015 Georgia Tech Research Corporation.
+  Additional copyright (C) 2015 Graeme Kennedy.
+  All rights reserved.
+
+  TMR is licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this software except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef TMR_BLOCK_GMRES_H
+#define TMR_BLOCK_GMRES_H
+
+#include "TMRBase.h"
+#include "KSM.h"
+
+/*
+  Right-preconditioned, restarted block GMRES for multiple right-hand
+  sides that share the same matrix.
+
+  All right-hand sides share a single Krylov subspace, built one
+  column at a time using a band Arnoldi process. Each new direction is
+  orthogonalized against the whole subspace using a single mdot
+  reduction (repeated once for stability), so the number of global
+  reductions per column is independent of the number of right-hand
+  sides. The preconditioner and matrix are applied to one vector at a
+  time, but the shared subspace can reduce the total number of
+  applications compared to solving each right-hand side separately.
+
+  The subspace size is given per right-hand side, so the subspace
+  stores subspace_size*nrhs + nrhs vectors. The subspace is allocated
+  for the largest block size seen so far and re-used for smaller
+  blocks.
+*/
+class TMRBlockGMRES : public TMREntity {
+ public:
+  TMRBlockGMRES( TACSMat *_mat, TACSPc *_pc,
+                 int _subspace_size, int _nrestart );
+  ~TMRBlockGMRES();
+
+  // Set the tolerances and the monitor
+  void setTolerances( double _rtol, double _atol );
+  void setMonitor( KSMPrint *_monitor );
+
+  // Solve the system of equations for each right-hand side. Returns
+  // non-zero if all of the right-hand sides converged.
+  int solve( int nrhs, TACSVec **b, TACSVec **x, int zero_guess=1 );
+
+ private:
+  // Allocate/free the subspace for the given block size
+  void allocate( int nrhs );
+  void deallocate();
+
+  // Orthogonalize the vector against the first nvecs vectors of the
+  // subspace, returning the coefficients and the final norm
+  TacsScalar orthogonalize( TACSVec *w, int nvecs, TacsScalar *h );
+
+  // The matrix, preconditioner and monitor
+  TACSMat *mat;
+  TACSPc *pc;
+  KSMPrint *monitor;
+
+  // Solver parameters
+  int subspace_size, nrestart;
+  double rtol, atol;
+
+  // The block size the subspace is allocated for, and the block size
+  // and number of columns used in the current solve
+  int max_block_size;
+  int block_size, ncols;
+
+  // The subspace vectors and work vectors
+  TACSVec **W;
+  TACSVec *work, *work2;
+
+  // The band Hessenberg matrix, the rotated right-hand sides and the
+  // Givens rotations
+  TacsScalar *H, *G, *hcol, *tmp;
+  TacsScalar *cs, *sn;
+  TacsScalar *res_tol;
+};
+
+#endif // TMR_BLOCK_GMRES_H
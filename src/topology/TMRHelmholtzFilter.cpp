@@ -167,11 +167,15 @@ void TMRHelmholtzFilter::initialize_helmholtz( double helmholtz_radius ){
     helmholtz_creator2d->decref();
   }
 
-  // Create the vectors
-  helmholtz_rhs = helmholtz_tacs[0]->createVec();
-  helmholtz_psi = helmholtz_tacs[0]->createVec();
-  helmholtz_rhs->incref();
-  helmholtz_psi->incref();
+  // Create the vectors for each component
+  helmholtz_rhs = new TACSBVec*[ vars_per_node ];
+  helmholtz_psi = new TACSBVec*[ vars_per_node ];
+  for ( int k = 0; k < vars_per_node; k++ ){
+    helmholtz_rhs[k] = helmholtz_tacs[0]->createVec();
+    helmholtz_psi[k] = helmholtz_tacs[0]->createVec();
+    helmholtz_rhs[k]->incref();
+    helmholtz_psi[k]->incref();
+  }
 
   // Create the multigrid object
   double helmholtz_omega = 0.5;
@@ -201,11 +205,63 @@ void TMRHelmholtzFilter::initialize_helmholtz( double helmholtz_radius ){
   helmholtz_ksm->setMonitor(new KSMPrintStdout("Filter GMRES", mpi_rank, 10));
   helmholtz_ksm->setTolerances(1e-12, 1e-30);
 
+  // Create the block GMRES object used to solve for all components
+  // at once
+  helmholtz_block_ksm = NULL;
+  if (vars_per_node > 1){
+    helmholtz_block_ksm = new TMRBlockGMRES(helmholtz_mg->getMat(0),
+                                            helmholtz_mg,
+                                            gmres_iters, nrestart);
+    helmholtz_block_ksm->incref();
+    helmholtz_block_ksm->setMonitor(new KSMPrintStdout("Filter BlockGMRES",
+                                                       mpi_rank, 10));
+    helmholtz_block_ksm->setTolerances(1e-12, 1e-30);
+  }
+
   // Create the multigrid solver and factor it
   double alpha = 1.0, beta = 0.0, gamma = 0.0;
   helmholtz_mg->assembleJacobian(alpha, beta, gamma, NULL);
   helmholtz_mg->factor();
 
+  // Get the number of local elements
+  int num_elements = helmholtz_tacs[0]->getNumElements();
+
+  // Get the maximum number of nodes per element (all elements in
+  // this assembler object have the same number of nodes)
+  int max_nodes = helmholtz_tacs[0]->getMaxElementNodes();
+
+  // Get all of the elements in the filter
+  TACSElement **elements = helmholtz_tacs[0]->getElements();
+
+  // Compute the shape functions at the quadrature points. All the
+  // elements share the same element type.
+  num_quad_pts = 0;
+  if (num_elements > 0){
+    num_quad_pts = elements[0]->getNumGaussPts();
+  }
+  helmholtz_N = new double[ num_quad_pts*max_nodes ];
+  for ( int n = 0; n < num_quad_pts; n++ ){
+    double pt[3];
+    elements[0]->getGaussWtsPts(n, pt);
+    elements[0]->getShapeFunctions(pt, &helmholtz_N[max_nodes*n]);
+  }
+
+  // Compute the quadrature weight times the determinant of the
+  // Jacobian for each element
+  TacsScalar *Xpts = new TacsScalar[ 3*max_nodes ];
+  helmholtz_h = new TacsScalar[ num_elements*num_quad_pts ];
+  for ( int i = 0; i < num_elements; i++ ){
+    helmholtz_tacs[0]->getElement(i, Xpts);
+
+    TacsScalar *h = &helmholtz_h[num_quad_pts*i];
+    for ( int n = 0; n < num_quad_pts; n++ ){
+      double pt[3];
+      double wt = elements[i]->getGaussWtsPts(n, pt);
+      h[n] = wt*elements[i]->getDetJacobian(pt, Xpts);
+    }
+  }
+  delete [] Xpts;
+
   // Create a temporary vector
   temp = createVec();
   temp->incref();
@@ -214,9 +270,18 @@ void TMRHelmholtzFilter::initialize_helmholtz( double helmholtz_radius ){
 TMRHelmholtzFilter::~TMRHelmholtzFilter(){
   helmholtz_mg->decref();
   helmholtz_ksm->decref();
+  if (helmholtz_block_ksm){
+    helmholtz_block_ksm->decref();
+  }
   helmholtz_vec->decref();
-  helmholtz_rhs->decref();
-  helmholtz_psi->decref();
+  for ( int k = 0; k < vars_per_node; k++ ){
+    helmholtz_rhs[k]->decref();
+    helmholtz_psi[k]->decref();
+  }
+  delete [] helmholtz_rhs;
+  delete [] helmholtz_psi;
+  delete [] helmholtz_N;
+  delete [] helmholtz_h;
 
   for ( int k = 0; k < nlevels; k++ ){
     helmholtz_tacs[k]->decref();
@@ -225,10 +290,39 @@ TMRHelmholtzFilter::~TMRHelmholtzFilter(){
   temp->decref();
 }
 
+/*
+  Solve the Helmholtz equation for each component. When there is more
+  than one component, the right-hand sides are solved together using
+  block GMRES.
+*/
+void TMRHelmholtzFilter::solveHelmholtz(){
+  if (helmholtz_block_ksm){
+    TACSVec **b = new TACSVec*[ vars_per_node ];
+    TACSVec **x = new TACSVec*[ vars_per_node ];
+    for ( int k = 0; k < vars_per_node; k++ ){
+      b[k] = helmholtz_rhs[k];
+      x[k] = helmholtz_psi[k];
+    }
+    helmholtz_block_ksm->solve(vars_per_node, b, x);
+    delete [] b;
+    delete [] x;
+  }
+  else {
+    helmholtz_ksm->solve(helmholtz_rhs[0], helmholtz_psi[0]);
+  }
+
+  for ( int k = 0; k < vars_per_node; k++ ){
+    helmholtz_tacs[0]->reorderVec(helmholtz_psi[k]);
+  }
+}
+
 /*
   Apply the Helmholtz filter to the design variables.
 
-  Here the input/output vector are the same
+  Here the input/output vector are the same. The right-hand sides for
+  all components are assembled in a single pass over the elements
+  using the shape functions and quadrature data computed when the
+  filter was created.
 */
 void TMRHelmholtzFilter::applyFilter( TACSBVec *xvars ){
   // Get the number of local elements
@@ -238,87 +332,91 @@ void TMRHelmholtzFilter::applyFilter( TACSBVec *xvars ){
   // this assembler object have the same number of nodes)
   int max_nodes = helmholtz_tacs[0]->getMaxElementNodes();
 
-  // Get all of the elements in the filter
-  TACSElement **elements = helmholtz_tacs[0]->getElements();
-
   // Allocate space for element-level data
-  double *N = new double[ max_nodes ];
-  TacsScalar *Xpts = new TacsScalar[ 3*max_nodes ];
   TacsScalar *x_values = new TacsScalar[ vars_per_node*max_nodes ];
-  TacsScalar *rhs_values = new TacsScalar[ max_nodes ];
+  TacsScalar *rhs_values = new TacsScalar[ vars_per_node*max_nodes ];
+  TacsScalar *q = new TacsScalar[ vars_per_node ];
 
+  // Zero the entries in the RHS vectors
   for ( int k = 0; k < vars_per_node; k++ ){
-    // Zero the entries in the RHS vector
-    helmholtz_rhs->zeroEntries();
-    helmholtz_tacs[0]->zeroVariables();
-
-    for ( int i = 0; i < num_elements; i++ ){
-      // Get the values for this element
-      int len;
-      const int *nodes;
-      helmholtz_tacs[0]->getElement(i, &nodes, &len);
-      helmholtz_tacs[0]->getElement(i, Xpts);
-
-      // Get the values of the design variables at the nodes
-      xvars->getValues(len, nodes, x_values);
-
-      // Zero the values on the right-hand-side
-      memset(rhs_values, 0, max_nodes*sizeof(TacsScalar));
-
-      // Get the number of quadrature points
-      const int num_quad_pts = elements[i]->getNumGaussPts();
-
-      // Perform the integration over the element
-      for ( int n = 0; n < num_quad_pts; n++ ){
-        double pt[3];
-        double wt = elements[i]->getGaussWtsPts(n, pt);
-        TacsScalar h = elements[i]->getDetJacobian(pt, Xpts);
-        h *= wt;
-
-        elements[i]->getShapeFunctions(pt, N);
+    helmholtz_rhs[k]->zeroEntries();
+  }
+  helmholtz_tacs[0]->zeroVariables();
+
+  for ( int i = 0; i < num_elements; i++ ){
+    // Get the values for this element
+    int len;
+    const int *nodes;
+    helmholtz_tacs[0]->getElement(i, &nodes, &len);
+
+    // Get the values of the design variables at the nodes
+    xvars->getValues(len, nodes, x_values);
+
+    // Zero the values on the right-hand-side
+    memset(rhs_values, 0, vars_per_node*max_nodes*sizeof(TacsScalar));
+
+    // Perform the integration over the element
+    const TacsScalar *h = &helmholtz_h[num_quad_pts*i];
+    for ( int n = 0; n < num_quad_pts; n++ ){
+      const double *N = &helmholtz_N[max_nodes*n];
+
+      // Interpolate all the components at the quadrature point
+      memset(q, 0, vars_per_node*sizeof(TacsScalar));
+      const TacsScalar *xs = x_values;
+      for ( int jj = 0; jj < max_nodes; jj++ ){
+        for ( int k = 0; k < vars_per_node; k++ ){
+          q[k] += N[jj]*xs[k];
+        }
+        xs += vars_per_node;
+      }
 
+      // Add the contribution to the right-hand-side
+      for ( int k = 0; k < vars_per_node; k++ ){
+        q[k] *= h[n];
+      }
+      for ( int k = 0; k < vars_per_node; k++ ){
+        TacsScalar *r = &rhs_values[max_nodes*k];
         for ( int ii = 0; ii < max_nodes; ii++ ){
-          const double *ns = N;
-          const TacsScalar *xs = &x_values[k];
-          TacsScalar v = 0.0;
-          for ( int jj = 0; jj < max_nodes; jj++ ){
-            v += ns[0]*xs[0];
-            ns++;
-            xs += vars_per_node;
-          }
-          rhs_values[ii] += h*N[ii]*v;
+          r[ii] += N[ii]*q[k];
         }
       }
+    }
 
-      helmholtz_rhs->setValues(len, nodes, rhs_values, TACS_ADD_VALUES);
+    for ( int k = 0; k < vars_per_node; k++ ){
+      helmholtz_rhs[k]->setValues(len, nodes, &rhs_values[max_nodes*k],
+                                  TACS_ADD_VALUES);
     }
+  }
 
-    // Complete the assembly process
-    helmholtz_rhs->beginSetValues(TACS_ADD_VALUES);
-    helmholtz_rhs->endSetValues(TACS_ADD_VALUES);
+  // Complete the assembly process
+  for ( int k = 0; k < vars_per_node; k++ ){
+    helmholtz_rhs[k]->beginSetValues(TACS_ADD_VALUES);
+  }
+  for ( int k = 0; k < vars_per_node; k++ ){
+    helmholtz_rhs[k]->endSetValues(TACS_ADD_VALUES);
+  }
 
-    // Solve for the filtered values of the design variables
-    helmholtz_ksm->solve(helmholtz_rhs, helmholtz_psi);
-    helmholtz_tacs[0]->reorderVec(helmholtz_psi);
-    helmholtz_tacs[0]->setVariables(helmholtz_psi);
+  // Solve for the filtered values of the design variables
+  solveHelmholtz();
+  helmholtz_tacs[0]->setVariables(helmholtz_psi[vars_per_node-1]);
 
-    // Get the output array
-    TacsScalar *xarr;
-    xvars->getArray(&xarr);
+  // Get the output array
+  TacsScalar *xarr;
+  xvars->getArray(&xarr);
 
+  for ( int k = 0; k < vars_per_node; k++ ){
     // Get the Helmholtz solution vector
     TacsScalar *hpsi;
-    const int size = helmholtz_psi->getArray(&hpsi);
+    const int size = helmholtz_psi[k]->getArray(&hpsi);
 
     for ( int i = 0; i < size; i++ ){
       xarr[vars_per_node*i + k] = hpsi[i];
     }
   }
 
-  delete [] N;
-  delete [] Xpts;
   delete [] x_values;
   delete [] rhs_values;
+  delete [] q;
 }
 
 /*
@@ -334,83 +432,81 @@ void TMRHelmholtzFilter::applyTranspose( TACSBVec *input,
   // this assembler object have the same number of nodes)
   int max_nodes = helmholtz_tacs[0]->getMaxElementNodes();
 
-  // Get all of the elements in the filter
-  TACSElement **elements = helmholtz_tacs[0]->getElements();
-
   // Allocate space for element-level data
-  double *N = new double[ max_nodes ];
-  TacsScalar *Xpts = new TacsScalar[ 3*max_nodes ];
   TacsScalar *x_values = new TacsScalar[ vars_per_node*max_nodes ];
-  TacsScalar *psi_values = new TacsScalar[ max_nodes ];
+  TacsScalar *psi_values = new TacsScalar[ vars_per_node*max_nodes ];
+  TacsScalar *q = new TacsScalar[ vars_per_node ];
 
-  for ( int k = 0; k < vars_per_node; k++ ){
-    // Get the input array
-    TacsScalar *xarr;
-    input->getArray(&xarr);
+  // Get the input array
+  TacsScalar *xarr;
+  input->getArray(&xarr);
 
-    // Get the Helmholtz solution vector
+  for ( int k = 0; k < vars_per_node; k++ ){
+    // Get the Helmholtz right-hand-side vector
     TacsScalar *hrhs;
-    const int size = helmholtz_rhs->getArray(&hrhs);
+    const int size = helmholtz_rhs[k]->getArray(&hrhs);
 
     for ( int i = 0; i < size; i++ ){
       hrhs[i] = xarr[vars_per_node*i + k];
     }
+  }
 
-    // Solve for the filtered values of the design variables
-    helmholtz_ksm->solve(helmholtz_rhs, helmholtz_psi);
-    helmholtz_tacs[0]->reorderVec(helmholtz_psi);
-
-    // Distribute the values from the solution
-    helmholtz_psi->beginDistributeValues();
-    helmholtz_psi->endDistributeValues();
-
-    for ( int i = 0; i < num_elements; i++ ){
-      // Get the values for this element
-      int len;
-      const int *nodes;
-      helmholtz_tacs[0]->getElement(i, &nodes, &len);
-      helmholtz_tacs[0]->getElement(i, Xpts);
+  // Solve for the adjoint of each component
+  solveHelmholtz();
 
-      // Get the values of the design variables at the nodes
-      helmholtz_psi->getValues(len, nodes, psi_values);
+  // Distribute the values from the solution
+  for ( int k = 0; k < vars_per_node; k++ ){
+    helmholtz_psi[k]->beginDistributeValues();
+  }
+  for ( int k = 0; k < vars_per_node; k++ ){
+    helmholtz_psi[k]->endDistributeValues();
+  }
 
-      // Zero the values on the right-hand-side
-      memset(x_values, 0, vars_per_node*max_nodes*sizeof(TacsScalar));
+  for ( int i = 0; i < num_elements; i++ ){
+    // Get the values for this element
+    int len;
+    const int *nodes;
+    helmholtz_tacs[0]->getElement(i, &nodes, &len);
 
-      // Get the number of quadrature points
-      const int num_quad_pts = elements[i]->getNumGaussPts();
+    // Get the values of the adjoint at the nodes
+    for ( int k = 0; k < vars_per_node; k++ ){
+      helmholtz_psi[k]->getValues(len, nodes, &psi_values[max_nodes*k]);
+    }
 
-      // Perform the integration over the element
-      for ( int n = 0; n < num_quad_pts; n++ ){
-        double pt[3];
-        double wt = elements[i]->getGaussWtsPts(n, pt);
-        TacsScalar h = elements[i]->getDetJacobian(pt, Xpts);
-        h *= wt;
+    // Zero the values on the right-hand-side
+    memset(x_values, 0, vars_per_node*max_nodes*sizeof(TacsScalar));
 
-        elements[i]->getShapeFunctions(pt, N);
+    // Perform the integration over the element
+    const TacsScalar *h = &helmholtz_h[num_quad_pts*i];
+    for ( int n = 0; n < num_quad_pts; n++ ){
+      const double *N = &helmholtz_N[max_nodes*n];
 
-        for ( int ii = 0; ii < max_nodes; ii++ ){
-          const double *ns = N;
-          const TacsScalar *psi = &psi_values[0];
-          TacsScalar v = 0.0;
-          for ( int jj = 0; jj < max_nodes; jj++ ){
-            v += ns[0]*psi[0];
-            ns++;
-            psi++;
-          }
-
-          x_values[vars_per_node*ii + k] += h*N[ii]*v;
+      // Interpolate the adjoint for each component
+      for ( int k = 0; k < vars_per_node; k++ ){
+        const TacsScalar *psi = &psi_values[max_nodes*k];
+        TacsScalar v = 0.0;
+        for ( int jj = 0; jj < max_nodes; jj++ ){
+          v += N[jj]*psi[jj];
         }
+        q[k] = h[n]*v;
       }
 
-      output->setValues(len, nodes, x_values, TACS_ADD_VALUES);
+      // Add the contribution to the output
+      TacsScalar *xs = x_values;
+      for ( int ii = 0; ii < max_nodes; ii++ ){
+        for ( int k = 0; k < vars_per_node; k++ ){
+          xs[k] += N[ii]*q[k];
+        }
+        xs += vars_per_node;
+      }
     }
+
+    output->setValues(len, nodes, x_values, TACS_ADD_VALUES);
   }
 
-  delete [] N;
-  delete [] Xpts;
   delete [] x_values;
   delete [] psi_values;
+  delete [] q;
 
   output->beginSetValues(TACS_ADD_VALUES);
   output->endSetValues(TACS_ADD_VALUES);
@@ -24,6 +24,7 @@
 #include "TMRConformFilter.h"
 #include "TACSAssembler.h"
 #include "TACSMg.h"
+#include "TMRBlockGMRES.h"
 
 /*
   Create a Helmholtz filter object
@@ -55,13 +56,24 @@ class TMRHelmholtzFilter : public TMRConformFilter {
   void applyFilter( TACSBVec *vec );
   void applyTranspose( TACSBVec *input, TACSBVec *output );
 
+  // Solve the Helmholtz equation for all components
+  void solveHelmholtz();
+
   // Data (that may be NULL) for the Helmholtz-based PDE filter
   TACSAssembler **helmholtz_tacs;
   TACSKsm *helmholtz_ksm;
+  TMRBlockGMRES *helmholtz_block_ksm;
   TACSMg *helmholtz_mg;
-  TACSBVec *helmholtz_rhs, *helmholtz_psi;
+  TACSBVec **helmholtz_rhs, **helmholtz_psi;
   TACSBVec *helmholtz_vec;
 
+  // The shape functions at each quadrature point (the same for all
+  // elements) and the quadrature weight times the determinant of the
+  // Jacobian for each element and quadrature point
+  int num_quad_pts;
+  double *helmholtz_N;
+  TacsScalar *helmholtz_h;
+
   // Temporary vector
   TACSBVec *temp;
 };
@@ -77,7 +77,7 @@ class TMRLagrangeFilter : public TMRTopoFilter {
   // Write the STL file
   void writeSTLFile( int k, double cutoff, const char *filename ){
     if (oct_filter){
-      TMR_GenerateBinFile(filename, oct_filter[0], x[0], k, cutoff);
+      TMR_WriteSTLFile(filename, oct_filter[0], x[0], k, cutoff);
     }
   }
  private:
@@ -185,12 +185,13 @@ void TMRMatrixFilter::initialize_matrix( double _s, int _N,
   // Compute D_{i} = sum_{j=1}^{n} M_{ij}
   M->mult(y2, Dinv);
 
-  // Create the inverse of the diagonal matrix
+  // Create the inverse of the diagonal matrix, scaled by 1/s so that
+  // the scaling is not re-applied for each term
   TacsScalar *D;
   int size = Dinv->getArray(&D);
   for ( int i = 0; i < size; i++ ){
     if (D[0] != 0.0){
-      D[0] = 1.0/D[0];
+      D[0] = 1.0/(s*D[0]);
     }
     else {
       D[0] = 0.0;
@@ -241,87 +242,110 @@ TMRMatrixFilter::~TMRMatrixFilter(){
   out = t1
   for n in range(N):
   .   out += t1 + 1/s*D^{-1}*M*out
+  out = Tinv*out
+
+  The scaling and the vector updates for each term are performed in a
+  single pass over the arrays following each matrix-vector product.
+  The component comp of the input vector, with the given stride, is
+  filtered and written to the same component of the output vector. In
+  this case, the Horner iteration is performed in y1.
 */
-void TMRMatrixFilter::applyFilter( TACSBVec *in, TACSBVec *out ){
-  // Compute t1 = 1/s*Dinv*in
-  t1->copyValues(in);
-  kronecker(Dinv, t1);
-  t1->scale(1.0/s);
+void TMRMatrixFilter::applyFilter( TACSBVec *in, TACSBVec *out,
+                                   int comp, int stride ){
+  TACSBVec *w = out;
+  if (stride != 1){
+    w = y1;
+  }
+
+  // Get the arrays. Note that Dinv stores 1/s*D^{-1}.
+  TacsScalar *d, *t, *u, *x;
+  int size = Dinv->getArray(&d);
+  t1->getArray(&t);
+  w->getArray(&u);
+  in->getArray(&x);
+  x = &x[comp];
 
-  // Set out = 1/s*Dinv*in
-  out->copyValues(t1);
+  // Set t1 = out = 1/s*Dinv*in
+  for ( int i = 0; i < size; i++ ){
+    t[i] = u[i] = d[i]*x[0];
+    x += stride;
+  }
 
   // Apply Horner's method
+  TacsScalar *v;
+  t2->getArray(&v);
   for ( int n = 0; n < N; n++ ){
-    // Compute t2 = 1/s*D^{-1}*M*out
-    M->mult(out, t2);
-    kronecker(Dinv, t2);
-    out->axpy(1.0/s, t2);
+    // Compute t2 = M*out
+    M->mult(w, t2);
 
-    // Compute out = t1 + 1/s*D^{-1}*M*out
-    out->axpy(1.0, t1);
+    // Compute out += t1 + 1/s*D^{-1}*t2
+    for ( int i = 0; i < size; i++ ){
+      u[i] += t[i] + d[i]*v[i];
+    }
   }
 
-  // Multiply by Tinv
-  kronecker(Tinv, out);
+  // Multiply by Tinv and store the result in the output
+  TacsScalar *tinv, *y;
+  Tinv->getArray(&tinv);
+  out->getArray(&y);
+  y = &y[comp];
+  for ( int i = 0; i < size; i++ ){
+    y[0] = tinv[i]*u[i];
+    y += stride;
+  }
 }
 
 /*
-  Compute the transpose of the filter operation
-*/
-void TMRMatrixFilter::applyTranspose( TACSBVec *in, TACSBVec *out ){
-  t1->copyValues(in);
-  kronecker(Tinv, t1);
+  Add the transpose of the filter operation to the output vector
+
+  t1 = Tinv*in
+  out = t1
+  for n in range(N):
+  .   out += t1 + M*(1/s*D^{-1}*out)
+  out += 1/s*D^{-1}*out
 
-  // Copy the values from t1 to the out vector
-  out->copyValues(t1);
+  The product 1/s*D^{-1}*out required by the next term is computed in
+  the same pass as the update. The Horner iteration is performed in
+  y2, and the result is added to the component comp of the output.
+*/
+void TMRMatrixFilter::applyTranspose( TACSBVec *in, TACSBVec *out,
+                                      int comp, int stride ){
+  TacsScalar *d, *tinv, *t, *u, *v, *w, *x;
+  int size = Dinv->getArray(&d);
+  Tinv->getArray(&tinv);
+  t1->getArray(&t);
+  t2->getArray(&v);
+  t3->getArray(&w);
+  y2->getArray(&u);
+  in->getArray(&x);
+  x = &x[comp];
+
+  // Set t1 = out = Tinv*in and t2 = 1/s*D^{-1}*out
+  for ( int i = 0; i < size; i++ ){
+    t[i] = u[i] = tinv[i]*x[0];
+    v[i] = d[i]*u[i];
+    x += stride;
+  }
 
   // Apply Horner's method
   for ( int n = 0; n < N; n++ ){
-    // Compute M*D^{-1}*out
-    kronecker(Dinv, out, t2);
+    // Compute t3 = M*t2
     M->mult(t2, t3);
-    out->axpy(1.0/s, t3);
-
-    // Compute out = t1 + 1/s*M*D^{-1}*out
-    out->axpy(1.0, t1);
-  }
-
-  // Multiply by 1/s*Dinv
-  kronecker(Dinv, out);
-  out->scale(1.0/s);
-}
-
-/*
-  Compute the Kronecker product of the input vectors c and x and store
-  the result in either y (if it is provided) or otherwise x
-
-  y = (c o x)
-*/
-void TMRMatrixFilter::kronecker( TACSBVec *c, TACSBVec *x, TACSBVec *y ){
-  if (c && x && y){
-    TacsScalar *cvals, *xvals, *yvals;
-    int size = c->getArray(&cvals);
-    x->getArray(&xvals);
-    y->getArray(&yvals);
 
+    // Compute out += t1 + t3 and t2 = 1/s*D^{-1}*out
     for ( int i = 0; i < size; i++ ){
-      yvals[0] = cvals[0]*xvals[0];
-      yvals++;
-      xvals++;
-      cvals++;
+      u[i] += t[i] + w[i];
+      v[i] = d[i]*u[i];
     }
   }
-  else if (c && x){
-    TacsScalar *cvals, *xvals;
-    int size = c->getArray(&cvals);
-    x->getArray(&xvals);
 
-    for ( int i = 0; i < size; i++ ){
-      xvals[0] *= cvals[0];
-      xvals++;
-      cvals++;
-    }
+  // Add 1/s*D^{-1}*out to the output, which is stored in t2
+  TacsScalar *y;
+  out->getArray(&y);
+  y = &y[comp];
+  for ( int i = 0; i < size; i++ ){
+    y[0] += v[i];
+    y += stride;
   }
 }
 
@@ -329,43 +353,15 @@ void TMRMatrixFilter::kronecker( TACSBVec *c, TACSBVec *x, TACSBVec *y ){
   Set the design variables for each level
 */
 void TMRMatrixFilter::setDesignVars( TACSBVec *xvec ){
-  if (getVarsPerNode() == 1){
-    applyFilter(xvec, x[0]);
-  }
-  else {
-    const int vpn = getVarsPerNode();
-
-    for ( int k = 0; k < vpn; k++ ){
-      TacsScalar *xin, *xout;
-      xvec->getArray(&xin);
-      x[0]->getArray(&xout);
-
-      // Set the pointers offset by the vars per node
-      xin = &xin[k];
-      xout = &xout[k];
-
-      // Copy the values to the input vector (y1)
-      TacsScalar *yin;
-      int size = y1->getArray(&yin);
-      for ( int i = 0; i < size; i++ ){
-        yin[0] = xin[0];
-        yin++;
-        xin += vpn;
-      }
-
-      // Apply the matrix filter from the input y1 to the
-      // output y2
-      applyFilter(y1, y2);
-
-      // Copy the values from y2 to the output vector x[0]
-      TacsScalar *yout;
-      y2->getArray(&yout);
-      for ( int i = 0; i < size; i++ ){
-        xout[0] = yout[0];
-        yout++;
-        xout += vpn;
-      }
-    }
+  // Filter each component directly from the strided input. M is a
+  // scalar TACS matrix and TACSMat::mult only accepts vectors with
+  // its block size, so M is applied once per component. Applying all
+  // of the components in one pass would need M assembled with a block
+  // size of vpn, which stores vpn*vpn entries for each non-zero and
+  // streams more data than vpn passes over the scalar matrix.
+  const int vpn = getVarsPerNode();
+  for ( int k = 0; k < vpn; k++ ){
+    applyFilter(xvec, x[0], k, vpn);
   }
 
   // Distribute the design variable values
@@ -404,44 +400,10 @@ void TMRMatrixFilter::addValues( TacsScalar *xlocal, TACSBVec *vec ){
   temp->beginSetValues(TACS_ADD_VALUES);
   temp->endSetValues(TACS_ADD_VALUES);
 
-  if (getVarsPerNode() == 1){
-    applyTranspose(temp, y1);
-    vec->axpy(1.0, y1);
-  }
-  else {
-    const int vpn = getVarsPerNode();
-
-    for ( int k = 0; k < vpn; k++ ){
-      TacsScalar *xin, *xout;
-
-      // Get the pointer to the array and offset by vars per node
-      temp->getArray(&xin);
-      xin = &xin[k];
-
-      // Copy the values to the input vector (y1)
-      TacsScalar *yin;
-      int size = y1->getArray(&yin);
-      for ( int i = 0; i < size; i++ ){
-        yin[0] = xin[0];
-        yin++;
-        xin += vpn;
-      }
-
-      // Apply the matrix filter from the input y1 to the
-      // output y2
-      applyTranspose(y1, y2);
-
-      // Add the values from y2 back to the output vector vec
-      vec->getArray(&xout);
-      xout = &xout[k];
-
-      TacsScalar *yout;
-      y2->getArray(&yout);
-      for ( int i = 0; i < size; i++ ){
-        xout[0] += yout[0];
-        yout++;
-        xin += vpn;
-      }
-    }
+  // Add the contribution from each component to the output. As in
+  // setDesignVars, M is applied once per component.
+  const int vpn = getVarsPerNode();
+  for ( int k = 0; k < vpn; k++ ){
+    applyTranspose(temp, vec, k, vpn);
   }
 }
@@ -79,11 +79,15 @@ class TMRMatrixFilter : public TMRConformFilter {
                           TMROctForest *oct_filter,
                           TMRQuadForest *quad_filter);
 
-  // Apply the filter to get the density values
-  void applyFilter( TACSBVec *in, TACSBVec *out );
+  // Apply the filter to the component comp of the input to get the
+  // density values
+  void applyFilter( TACSBVec *in, TACSBVec *out,
+                    int comp=0, int stride=1 );
 
-  // Apply the transpose of the filter for sensitivities
-  void applyTranspose( TACSBVec *in, TACSBVec *out );
+  // Add the transpose of the filter to the component comp of the
+  // output for sensitivities
+  void applyTranspose( TACSBVec *in, TACSBVec *out,
+                       int comp=0, int stride=1 );
 
   // The non-negative matrix M
   TACSMat *M;
@@ -94,7 +98,8 @@ class TMRMatrixFilter : public TMRConformFilter {
   // The scalar > 1.0
   double s;
 
-  // Store the inverse of the diagonal matrices
+  // Store the inverse of the diagonal matrices. Note that Dinv stores
+  // 1/s*D^{-1}.
   TACSBVec *Dinv, *Tinv;
 
   // Temporary vectors required for the matrix computation
@@ -105,9 +110,6 @@ class TMRMatrixFilter : public TMRConformFilter {
 
   // Temporary design variable vector
   TACSBVec *temp;
-
-  // Compute the Kronecker product
-  void kronecker( TACSBVec *c, TACSBVec *x, TACSBVec *y=NULL );
 };
 
 #endif // TMR_MATRIX_FILTER_H
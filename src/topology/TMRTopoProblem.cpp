@@ -199,17 +199,24 @@ TMRTopoProblem::TMRTopoProblem( TMRTopoFilter *_filter,
   // Set the maximum local size
   xlocal = new TacsScalar[ max_local_size ];
 
-  // The initial design variable values (may not be set)
-  xinit = NULL;
-  xlb = NULL;
-  xub = NULL;
-
   // Allocate an adjoint and df/du vector
   dfdu = tacs->createVec();
   adjoint = tacs->createVec();
   dfdu->incref();
   adjoint->incref();
 
+  // The vectors for the block adjoint solve are allocated when needed
+  num_block_vecs = 0;
+  num_block_dfdx = 0;
+  block_rhs = NULL;
+  block_adj = NULL;
+  block_dfdx = NULL;
+
+  // The initial design variable values (may not be set)
+  xinit = NULL;
+  xlb = NULL;
+  xub = NULL;
+
   int mpi_rank;
   MPI_Comm_rank(tacs->getMPIComm(), &mpi_rank);
 
@@ -224,6 +231,16 @@ TMRTopoProblem::TMRTopoProblem( TMRTopoFilter *_filter,
   ksm->setMonitor(new KSMPrintStdout("GMRES", mpi_rank, 10));
   ksm->setTolerances(rtol, atol);
 
+  // Set up the solver for multiple load cases. The block solver is
+  // off by default since its subspace grows with the number of load
+  // cases. The subspace is only allocated when it is first used.
+  use_block_solve = 0;
+  block_ksm = new TMRBlockGMRES(mg->getMat(0), mg,
+                                gmres_iters, nrestart);
+  block_ksm->incref();
+  block_ksm->setMonitor(new KSMPrintStdout("BlockGMRES", mpi_rank, 10));
+  block_ksm->setTolerances(rtol, atol);
+
   // Set the iteration count
   iter_count = 0;
 
@@ -289,12 +306,15 @@ TMRTopoProblem::~TMRTopoProblem(){
   // Free the local temp array
   delete [] xlocal;
 
+  // Free the adjoint vectors
+  dfdu->decref();
+  adjoint->decref();
+  freeBlockVecs();
+
   // Free the solver/multigrid information
   mg->decref();
   ksm->decref();
-
-  dfdu->decref();
-  adjoint->decref();
+  block_ksm->decref();
 
   // Free the variables/forces
   if (forces){
@@ -847,6 +867,95 @@ void TMRTopoProblem::setUseRecycledSolution( int truth ){
   use_recyc_sol = truth;
 }
 
+/*
+  Set the flag to solve the systems of equations for all load cases
+  together with block GMRES. This is off by default. The block
+  subspace stores (gmres_iters+1)*nrhs vectors, compared to
+  gmres_iters+1 vectors for the single right-hand side solver, so the
+  memory grows linearly with the number of load cases.
+*/
+void TMRTopoProblem::setUseBlockSolve( int truth ){
+  use_block_solve = truth;
+  if (!use_block_solve){
+    block_ksm->deallocate();
+    freeBlockVecs();
+  }
+}
+
+/*
+  Allocate the right-hand sides and solutions for the block adjoint
+  solve, and the storage for the partial derivatives of the stress
+  constraints. The existing vectors are kept if there are enough of
+  them, so these are allocated once for a fixed set of load cases.
+*/
+void TMRTopoProblem::allocateBlockVecs( int nvecs, int nstress ){
+  if (nvecs > num_block_vecs){
+    freeBlockVecs();
+    num_block_vecs = nvecs;
+    block_rhs = new TACSBVec*[ nvecs ];
+    block_adj = new TACSBVec*[ nvecs ];
+    for ( int i = 0; i < nvecs; i++ ){
+      block_rhs[i] = tacs->createVec();
+      block_adj[i] = tacs->createVec();
+      block_rhs[i]->incref();
+      block_adj[i]->incref();
+    }
+  }
+  if (nstress > num_block_dfdx){
+    if (block_dfdx){
+      delete [] block_dfdx;
+    }
+    num_block_dfdx = nstress;
+    block_dfdx = new TacsScalar[ nstress*max_local_size ];
+  }
+}
+
+/*
+  Free the vectors for the block adjoint solve
+*/
+void TMRTopoProblem::freeBlockVecs(){
+  for ( int i = 0; i < num_block_vecs; i++ ){
+    block_rhs[i]->decref();
+    block_adj[i]->decref();
+  }
+  if (block_rhs){
+    delete [] block_rhs;
+    delete [] block_adj;
+  }
+  if (block_dfdx){
+    delete [] block_dfdx;
+  }
+  num_block_vecs = 0;
+  num_block_dfdx = 0;
+  block_rhs = NULL;
+  block_adj = NULL;
+  block_dfdx = NULL;
+}
+
+/*
+  Solve K(x)*sol[i] = rhs[i] for all right-hand sides using the
+  current factorization of the multigrid preconditioner
+*/
+void TMRTopoProblem::solveAll( int nrhs, TACSBVec **rhs, TACSBVec **sol,
+                               int zero_guess ){
+  if (use_block_solve && nrhs > 1){
+    TACSVec **b = new TACSVec*[ nrhs ];
+    TACSVec **x = new TACSVec*[ nrhs ];
+    for ( int i = 0; i < nrhs; i++ ){
+      b[i] = rhs[i];
+      x[i] = sol[i];
+    }
+    block_ksm->solve(nrhs, b, x, zero_guess);
+    delete [] b;
+    delete [] x;
+  }
+  else {
+    for ( int i = 0; i < nrhs; i++ ){
+      ksm->solve(rhs[i], sol[i], zero_guess);
+    }
+  }
+}
+
 /*
   Set the initial design variables
 */
@@ -955,15 +1064,23 @@ int TMRTopoProblem::evalObjCon( ParOptVec *pxvec,
     cons[count] = linear_offset[i] + Alinear[i]->dot(pxvec);
   }
 
+  // Solve the system K(x)*u = forces for all load cases
+  int nrhs = 0;
+  TACSBVec **rhs = new TACSBVec*[ num_load_cases ];
+  TACSBVec **sol = new TACSBVec*[ num_load_cases ];
+  for ( int i = 0; i < num_load_cases; i++ ){
+    if (forces[i]){
+      rhs[nrhs] = forces[i];
+      sol[nrhs] = vars[i];
+      nrhs++;
+    }
+  }
+  solveAll(nrhs, rhs, sol, !use_recyc_sol);
+  delete [] rhs;
+  delete [] sol;
+
   for ( int i = 0; i < num_load_cases; i++ ){
     if (forces[i]){
-      // Solve the system: K(x)*u = forces
-      if (use_recyc_sol){
-        ksm->solve(forces[i], vars[i], 0);
-      }
-      else {
-	ksm->solve(forces[i], vars[i]);
-      }
       tacs->setBCs(vars[i]);
 
       // Set the variables into TACSAssembler
@@ -1182,31 +1299,73 @@ int TMRTopoProblem::evalObjConGradient( ParOptVec *xvec,
     memset(xlocal, 0, max_local_size*sizeof(TacsScalar));
 
     if (obj_funcs){
+      // Assemble and factor the transpose of the Jacobian once if any
+      // of the objective functions requires an adjoint
+      int nadj = 0;
       for ( int i = 0; i < num_load_cases; i++ ){
-        tacs->setVariables(vars[i]);
-        int use_adjoint = 1;
-        if (dynamic_cast<TACSStructuralMass*>(obj_funcs[i])){
-          use_adjoint = 0;
+        if (!dynamic_cast<TACSStructuralMass*>(obj_funcs[i])){
+          nadj++;
         }
+      }
+      if (nadj > 0){
+        double alpha = 1.0, beta = 0.0, gamma = 0.0;
+        mg->assembleJacobian(alpha, beta, gamma, NULL, TRANSPOSE);
+        mg->factor();
+      }
 
-        if (use_adjoint){
-          dfdu->zeroEntries();
-          double alpha = 1.0, beta = 0.0, gamma = 0.0;
-          mg->assembleJacobian(alpha, beta, gamma, NULL, TRANSPOSE);
-          mg->factor();
-          tacs->addSVSens(alpha, beta, gamma, &obj_funcs[i], 1, &dfdu);
-          tacs->applyBCs(dfdu);
+      if (use_block_solve && nadj > 1){
+        // Evaluate the right-hand-sides and solve the adjoint
+        // equations for all load cases together
+        allocateBlockVecs(nadj, 0);
+        for ( int i = 0, k = 0; i < num_load_cases; i++ ){
+          if (!dynamic_cast<TACSStructuralMass*>(obj_funcs[i])){
+            block_rhs[k]->zeroEntries();
+            tacs->setVariables(vars[i]);
+            double alpha = 1.0, beta = 0.0, gamma = 0.0;
+            tacs->addSVSens(alpha, beta, gamma, &obj_funcs[i], 1,
+                            &block_rhs[k]);
+            tacs->applyBCs(block_rhs[k]);
+            k++;
+          }
+        }
+        solveAll(nadj, block_rhs, block_adj, 1);
 
-          // Solve the system of adjoint equations
-          ksm->solve(dfdu, adjoint);
+        for ( int i = 0, k = 0; i < num_load_cases; i++ ){
+          tacs->setVariables(vars[i]);
           tacs->addDVSens(obj_weights[i], &obj_funcs[i],
                           1, xlocal, max_local_size);
-          tacs->addAdjointResProducts(-obj_weights[i], &adjoint,
-                                      1, xlocal, max_local_size);
+          if (!dynamic_cast<TACSStructuralMass*>(obj_funcs[i])){
+            tacs->addAdjointResProducts(-obj_weights[i], &block_adj[k],
+                                        1, xlocal, max_local_size);
+            k++;
+          }
         }
-        else {
-          tacs->addDVSens(obj_weights[i], &obj_funcs[i], 1, xlocal,
-                          max_local_size);
+      }
+      else {
+        for ( int i = 0; i < num_load_cases; i++ ){
+          tacs->setVariables(vars[i]);
+          int use_adjoint = 1;
+          if (dynamic_cast<TACSStructuralMass*>(obj_funcs[i])){
+            use_adjoint = 0;
+          }
+
+          if (use_adjoint){
+            dfdu->zeroEntries();
+            double alpha = 1.0, beta = 0.0, gamma = 0.0;
+            tacs->addSVSens(alpha, beta, gamma, &obj_funcs[i], 1, &dfdu);
+            tacs->applyBCs(dfdu);
+
+            // Solve the system of adjoint equations
+            ksm->solve(dfdu, adjoint);
+            tacs->addDVSens(obj_weights[i], &obj_funcs[i],
+                            1, xlocal, max_local_size);
+            tacs->addAdjointResProducts(-obj_weights[i], &adjoint,
+                                        1, xlocal, max_local_size);
+          }
+          else {
+            tacs->addDVSens(obj_weights[i], &obj_funcs[i], 1, xlocal,
+                            max_local_size);
+          }
         }
       }
 
@@ -1234,7 +1393,56 @@ int TMRTopoProblem::evalObjConGradient( ParOptVec *xvec,
     Acvec[count]->copyValues(Alinear[i]);
   }
 
+  // Count the number of adjoint equations for the constraints
+  int nadj = 0, nstress = 0;
+  for ( int i = 0; i < num_load_cases; i++ ){
+    for ( int j = 0; j < load_case_info[i].num_funcs; j++ ){
+      if (!dynamic_cast<TACSStructuralMass*>(load_case_info[i].funcs[j])){
+        nadj++;
+      }
+    }
+    if (load_case_info[i].stress_func){
+      nadj++;
+      nstress++;
+    }
+  }
+
+  // If the block solve is used, evaluate the right-hand-sides of the
+  // adjoint equations for all load cases, and the partial derivatives
+  // of the stress constraints w.r.t. the design variables, and solve
+  // the adjoint equations together. Otherwise, each adjoint equation
+  // is solved in turn below.
+  int block_solve = (use_block_solve && nadj > 1);
+  if (block_solve){
+    allocateBlockVecs(nadj, nstress);
+    for ( int i = 0, k = 0, ks = 0; i < num_load_cases; i++ ){
+      tacs->setVariables(vars[i]);
+
+      for ( int j = 0; j < load_case_info[i].num_funcs; j++ ){
+        TACSFunction *func = load_case_info[i].funcs[j];
+        if (!dynamic_cast<TACSStructuralMass*>(func)){
+          block_rhs[k]->zeroEntries();
+          double alpha = 1.0, beta = 0.0, gamma = 0.0;
+          tacs->addSVSens(alpha, beta, gamma, &func, 1, &block_rhs[k]);
+          tacs->applyBCs(block_rhs[k]);
+          k++;
+        }
+      }
+
+      if (load_case_info[i].stress_func){
+        load_case_info[i].stress_func->evalConDeriv(
+          &block_dfdx[ks*max_local_size], max_local_size, block_rhs[k]);
+        tacs->applyBCs(block_rhs[k]);
+        k++;
+        ks++;
+      }
+    }
+
+    solveAll(nadj, block_rhs, block_adj, 1);
+  }
+
   // Compute the derivative of the constraint functions
+  int adj_index = 0, stress_index = 0;
   for ( int i = 0; i < num_load_cases; i++ ){
     tacs->setVariables(vars[i]);
 
@@ -1260,19 +1468,25 @@ int TMRTopoProblem::evalObjConGradient( ParOptVec *xvec,
           use_adjoint = 0;
         }
         if (use_adjoint){
-          // Evaluate the right-hand-side
-          dfdu->zeroEntries();
-          double alpha = 1.0, beta = 0.0, gamma = 0.0;
-          tacs->addSVSens(alpha, beta, gamma, &func, 1, &dfdu);
-          tacs->applyBCs(dfdu);
-
-          // Solve the system of equations
-          ksm->solve(dfdu, adjoint);
+          TACSBVec *psi = adjoint;
+          if (block_solve){
+            psi = block_adj[adj_index];
+          }
+          else {
+            // Evaluate the right-hand-side
+            dfdu->zeroEntries();
+            double alpha = 1.0, beta = 0.0, gamma = 0.0;
+            tacs->addSVSens(alpha, beta, gamma, &func, 1, &dfdu);
+            tacs->applyBCs(dfdu);
+
+            // Solve the system of equations
+            ksm->solve(dfdu, adjoint);
+          }
 
           // Compute the total derivative using the adjoint
           memset(xlocal, 0, max_local_size*sizeof(TacsScalar));
           tacs->addDVSens(scale, &func, 1, xlocal, max_local_size);
-          tacs->addAdjointResProducts(-scale, &adjoint,
+          tacs->addAdjointResProducts(-scale, &psi,
                                       1, xlocal, max_local_size);
         }
         else {
@@ -1282,6 +1496,10 @@ int TMRTopoProblem::evalObjConGradient( ParOptVec *xvec,
 
         filter->addValues(xlocal, A);
       }
+
+      if (!dynamic_cast<TACSStructuralMass*>(func)){
+        adj_index++;
+      }
     }
     count += num_funcs;
 
@@ -1295,17 +1513,26 @@ int TMRTopoProblem::evalObjConGradient( ParOptVec *xvec,
         // Get the underlying TACS vector for the design variables
         TACSBVec *A = wrap->vec;
 
-        // Evaluate the partial derivatives required for the adjoint
-        load_case_info[i].stress_func->evalConDeriv(xlocal,
-                                                    max_local_size,
-                                                    dfdu);
-        tacs->applyBCs(dfdu);
+        TACSBVec *psi = adjoint;
+        if (block_solve){
+          // Retrieve the partial derivatives w.r.t. the design variables
+          memcpy(xlocal, &block_dfdx[stress_index*max_local_size],
+                 max_local_size*sizeof(TacsScalar));
+          psi = block_adj[adj_index];
+        }
+        else {
+          // Evaluate the partial derivatives required for the adjoint
+          load_case_info[i].stress_func->evalConDeriv(xlocal,
+                                                      max_local_size,
+                                                      dfdu);
+          tacs->applyBCs(dfdu);
 
-        // Solve the system of equations
-        ksm->solve(dfdu, adjoint);
+          // Solve the system of equations
+          ksm->solve(dfdu, adjoint);
+        }
 
         // Compute the total derivative using the adjoint
-        tacs->addAdjointResProducts(-1.0, &adjoint,
+        tacs->addAdjointResProducts(-1.0, &psi,
                                     1, xlocal, max_local_size);
 
         // Add the local values to obtain the filtered sensitivity
@@ -1316,6 +1543,8 @@ int TMRTopoProblem::evalObjConGradient( ParOptVec *xvec,
         A->scale(-load_case_info[i].stress_func_scale);
       }
 
+      adj_index++;
+      stress_index++;
       count++;
     }
 
@@ -1546,7 +1775,7 @@ void TMRTopoProblem::writeOutput( int iter, ParOptVec *xvec ){
 
     for ( int k = 0; k < filter->getVarsPerNode(); k++ ){
       double cutoff = 0.5;
-      sprintf(filename, "%s/levelset05_var%d_binary%04d.bstl",
+      sprintf(filename, "%s/levelset05_var%d_%04d.stl",
               prefix, k, iter_count);
 
       // Write the STL file
@@ -1611,3 +1840,362 @@ void TMRTopoProblem::writeOutput( int iter, ParOptVec *xvec ){
   // Update the iteration count
   iter_count++;
 }
+
+/*
+  Get the elements of the filter mesh and their node numbers
+
+  The elements are returned with a key that identifies them
+  independently of the partition. The key is the block, the x, y and
+  z coordinates (z is zero for a quadtree) and the level of the
+  octant or quadrant.
+
+  output:
+  keys:            the keys for the local elements (allocated here)
+  conn:            the global node numbers of the element nodes
+  nodes_per_elem:  the number of nodes for each element
+
+  returns:         the number of local elements
+*/
+static int get_filter_elements( TMRTopoFilter *filter,
+                                int **_keys, const int **conn,
+                                int *nodes_per_elem ){
+  int num_elements = 0;
+  int *keys = NULL;
+  *conn = NULL;
+  *nodes_per_elem = 0;
+
+  TMROctForest *oct_forest = filter->getFilterOctForest();
+  TMRQuadForest *quad_forest = filter->getFilterQuadForest();
+  if (oct_forest){
+    TMROctantArray *octants;
+    TMROctant *array;
+    oct_forest->getOctants(&octants);
+    octants->getArray(&array, &num_elements);
+    oct_forest->getNodeConn(conn);
+    int order = oct_forest->getMeshOrder();
+    *nodes_per_elem = order*order*order;
+
+    keys = new int[ 5*num_elements ];
+    for ( int i = 0; i < num_elements; i++ ){
+      keys[5*i] = array[i].block;
+      keys[5*i+1] = array[i].x;
+      keys[5*i+2] = array[i].y;
+      keys[5*i+3] = array[i].z;
+      keys[5*i+4] = array[i].level;
+    }
+  }
+  else if (quad_forest){
+    TMRQuadrantArray *quadrants;
+    TMRQuadrant *array;
+    quad_forest->getQuadrants(&quadrants);
+    quadrants->getArray(&array, &num_elements);
+    quad_forest->getNodeConn(conn);
+    int order = quad_forest->getMeshOrder();
+    *nodes_per_elem = order*order;
+
+    keys = new int[ 5*num_elements ];
+    for ( int i = 0; i < num_elements; i++ ){
+      keys[5*i] = array[i].face;
+      keys[5*i+1] = array[i].x;
+      keys[5*i+2] = array[i].y;
+      keys[5*i+3] = 0;
+      keys[5*i+4] = array[i].level;
+    }
+  }
+
+  *_keys = keys;
+  return num_elements;
+}
+
+/*
+  Write the design variables to a checkpoint file
+
+  The global ordering of the filter variables depends on the
+  partition, so the design variables are stored element by element.
+  For each element of the filter mesh, the file stores the key of the
+  octant (or quadrant) and the design variable values at its nodes.
+  The elements of the forest are ordered globally, so the elements
+  are written in the same order on any number of processors. The
+  values at the dependent nodes are not used and are written as zero.
+  The file layout is:
+
+  char[8]:          "TMRDVEC"
+  int32[5]:         version, sizeof(TacsScalar), block size, the
+                    iteration counter and the nodes per element
+  int64[1]:         the total number of elements
+  int32[5*nelems]:  the block, x, y, z and level of each element
+  TacsScalar[]:     the values at the nodes of each element
+
+  This is a collective call.
+*/
+int TMRTopoProblem::writeDesignCheckpoint( const char *filename,
+                                           ParOptVec *xvec ){
+  ParOptBVecWrap *wrap = dynamic_cast<ParOptBVecWrap*>(xvec);
+  if (!wrap){
+    fprintf(stderr, "TMRTopoProblem Error: Cannot call "
+            "writeDesignCheckpoint(), incorrect vector type\n");
+    return 1;
+  }
+
+  MPI_Comm comm = tacs->getMPIComm();
+  int mpi_rank;
+  MPI_Comm_rank(comm, &mpi_rank);
+  TACSBVec *vec = wrap->vec;
+  const int bsize = vec->getBlockSize();
+
+  // Get the elements of the filter mesh
+  int *keys;
+  const int *conn;
+  int nodes_per_elem;
+  int num_elements = get_filter_elements(filter, &keys, &conn,
+                                         &nodes_per_elem);
+
+  // Find the offset to the local elements and the total number
+  int64_t elem_offset = 0, total = 0;
+  int64_t nelems = num_elements;
+  MPI_Scan(&nelems, &elem_offset, 1, MPI_INT64_T, MPI_SUM, comm);
+  elem_offset -= nelems;
+  MPI_Allreduce(&nelems, &total, 1, MPI_INT64_T, MPI_SUM, comm);
+
+  // Distribute the values so that the values at the nodes owned by
+  // other processors are available
+  vec->beginDistributeValues();
+  vec->endDistributeValues();
+
+  // Collect the values at the element nodes
+  const int elem_size = bsize*nodes_per_elem;
+  TacsScalar *values = new TacsScalar[ elem_size*num_elements ];
+  memset(values, 0, elem_size*num_elements*sizeof(TacsScalar));
+  for ( int i = 0; i < num_elements; i++ ){
+    for ( int j = 0; j < nodes_per_elem; j++ ){
+      int node = conn[nodes_per_elem*i + j];
+      if (node >= 0){
+        vec->getValues(1, &node, &values[elem_size*i + bsize*j]);
+      }
+    }
+  }
+
+  // Copy the filename to a non-const array
+  char *fname = new char[ strlen(filename)+1 ];
+  strcpy(fname, filename);
+
+  MPI_File fp = NULL;
+  int fail = 0;
+  if (MPI_File_open(comm, fname, MPI_MODE_WRONLY | MPI_MODE_CREATE,
+                    MPI_INFO_NULL, &fp) != MPI_SUCCESS){
+    fail = 1;
+  }
+  delete [] fname;
+  if (fail){
+    fprintf(stderr, "TMRTopoProblem Error: Could not open file %s\n",
+            filename);
+    delete [] keys;
+    delete [] values;
+    return fail;
+  }
+  MPI_File_set_size(fp, 0);
+
+  MPI_Offset key_offset = 8 + 5*sizeof(int32_t) + sizeof(int64_t);
+  MPI_Offset data_offset = key_offset + 5*total*sizeof(int32_t);
+
+  if (mpi_rank == 0){
+    char magic[8] = "TMRDVEC";
+    int header[5];
+    header[0] = TMR_CHECKPOINT_VERSION;
+    header[1] = sizeof(TacsScalar);
+    header[2] = bsize;
+    header[3] = iter_count;
+    header[4] = nodes_per_elem;
+    MPI_File_write_at(fp, 0, magic, 8, MPI_CHAR, MPI_STATUS_IGNORE);
+    MPI_File_write_at(fp, 8, header, 5, MPI_INT, MPI_STATUS_IGNORE);
+    MPI_File_write_at(fp, 8 + 5*sizeof(int32_t), &total, 1,
+                      MPI_INT64_T, MPI_STATUS_IGNORE);
+  }
+
+  // Write the keys and values of the local elements
+  MPI_Offset offset = key_offset + 5*elem_offset*sizeof(int32_t);
+  MPI_File_write_at_all(fp, offset, keys, 5*num_elements, MPI_INT,
+                        MPI_STATUS_IGNORE);
+  offset = data_offset + elem_size*elem_offset*sizeof(TacsScalar);
+  MPI_File_write_at_all(fp, offset, values, elem_size*num_elements,
+                        TACS_MPI_TYPE, MPI_STATUS_IGNORE);
+  MPI_File_close(&fp);
+
+  delete [] keys;
+  delete [] values;
+
+  return fail;
+}
+
+/*
+  Read the design variables from a checkpoint file written by
+  writeDesignCheckpoint()
+
+  The filter must be created from the same forest, for instance the
+  forest read with TMROctForest::readCheckpoint() (or the quadtree
+  equivalent), but the number of processors and the partition may be
+  different. The elements of the forest are ordered globally, so each
+  processor reads the elements at its offset in the global order and
+  checks that their keys match its elements. The values at the
+  element nodes are then set into the locally owned design variables.
+  If the mesh does not match the file, a non-zero value is returned
+  on all processors. The iteration counter is restored so that the
+  output files continue from the checkpoint. This is a collective
+  call.
+*/
+int TMRTopoProblem::readDesignCheckpoint( const char *filename,
+                                          ParOptVec *xvec ){
+  ParOptBVecWrap *wrap = dynamic_cast<ParOptBVecWrap*>(xvec);
+  if (!wrap){
+    fprintf(stderr, "TMRTopoProblem Error: Cannot call "
+            "readDesignCheckpoint(), incorrect vector type\n");
+    return 1;
+  }
+
+  MPI_Comm comm = tacs->getMPIComm();
+  int mpi_rank;
+  MPI_Comm_rank(comm, &mpi_rank);
+  TACSBVec *vec = wrap->vec;
+  const int bsize = vec->getBlockSize();
+
+  // Copy the filename to a non-const array
+  char *fname = new char[ strlen(filename)+1 ];
+  strcpy(fname, filename);
+
+  MPI_File fp = NULL;
+  int fail = 0;
+  if (MPI_File_open(comm, fname, MPI_MODE_RDONLY,
+                    MPI_INFO_NULL, &fp) != MPI_SUCCESS){
+    fail = 1;
+  }
+  delete [] fname;
+  if (fail){
+    fprintf(stderr, "TMRTopoProblem Error: Could not open file %s\n",
+            filename);
+    return fail;
+  }
+
+  // Get the elements of the filter mesh
+  int *keys;
+  const int *conn;
+  int nodes_per_elem;
+  int num_elements = get_filter_elements(filter, &keys, &conn,
+                                         &nodes_per_elem);
+
+  // Find the offset to the local elements and the total number
+  int64_t elem_offset = 0, total = 0;
+  int64_t nelems = num_elements;
+  MPI_Scan(&nelems, &elem_offset, 1, MPI_INT64_T, MPI_SUM, comm);
+  elem_offset -= nelems;
+  MPI_Allreduce(&nelems, &total, 1, MPI_INT64_T, MPI_SUM, comm);
+
+  // Read and check the header
+  char magic[8];
+  int header[5];
+  int64_t file_total = 0;
+  memset(magic, 0, sizeof(magic));
+  memset(header, 0, sizeof(header));
+  MPI_File_read_at_all(fp, 0, magic, 8, MPI_CHAR, MPI_STATUS_IGNORE);
+  MPI_File_read_at_all(fp, 8, header, 5, MPI_INT, MPI_STATUS_IGNORE);
+  MPI_File_read_at_all(fp, 8 + 5*sizeof(int32_t), &file_total, 1,
+                       MPI_INT64_T, MPI_STATUS_IGNORE);
+  if (strncmp(magic, "TMRDVEC", 8) != 0 ||
+      header[0] != TMR_CHECKPOINT_VERSION ||
+      header[1] != (int)sizeof(TacsScalar)){
+    if (mpi_rank == 0){
+      fprintf(stderr, "TMRTopoProblem Error: %s is not a valid "
+              "checkpoint file\n", filename);
+    }
+    fail = 1;
+  }
+  else if (header[2] != bsize || header[4] != nodes_per_elem ||
+           file_total != total){
+    if (mpi_rank == 0){
+      fprintf(stderr, "TMRTopoProblem Error: Design variables in %s "
+              "do not match the filter\n", filename);
+    }
+    fail = 1;
+  }
+  if (fail){
+    MPI_File_close(&fp);
+    delete [] keys;
+    return fail;
+  }
+
+  // Read the keys of the local elements and check that they match
+  MPI_Offset key_offset = 8 + 5*sizeof(int32_t) + sizeof(int64_t);
+  MPI_Offset data_offset = key_offset + 5*total*sizeof(int32_t);
+  int *file_keys = new int[ 5*num_elements ];
+  MPI_Offset offset = key_offset + 5*elem_offset*sizeof(int32_t);
+  MPI_File_read_at_all(fp, offset, file_keys, 5*num_elements, MPI_INT,
+                       MPI_STATUS_IGNORE);
+  for ( int i = 0; i < 5*num_elements; i++ ){
+    if (file_keys[i] != keys[i]){
+      fail = 1;
+      break;
+    }
+  }
+  delete [] file_keys;
+  delete [] keys;
+
+  // Read the values at the element nodes
+  const int elem_size = bsize*nodes_per_elem;
+  TacsScalar *values = new TacsScalar[ elem_size*num_elements ];
+  offset = data_offset + elem_size*elem_offset*sizeof(TacsScalar);
+  MPI_File_read_at_all(fp, offset, values, elem_size*num_elements,
+                       TACS_MPI_TYPE, MPI_STATUS_IGNORE);
+  MPI_File_close(&fp);
+
+  MPI_Allreduce(MPI_IN_PLACE, &fail, 1, MPI_INT, MPI_MAX, comm);
+  if (fail){
+    if (mpi_rank == 0){
+      fprintf(stderr, "TMRTopoProblem Error: The elements in %s do "
+              "not match the filter mesh\n", filename);
+    }
+    delete [] values;
+    return fail;
+  }
+
+  // Set the values at the locally owned nodes. A node is owned by a
+  // processor that has it as an element node, so every owned node is
+  // set from the local elements.
+  const int *range;
+  vec->getVarMap()->getOwnerRange(&range);
+  TacsScalar *xvals;
+  int size = vec->getArray(&xvals);
+  int num_owned = size/bsize;
+  int *is_set = new int[ num_owned ];
+  memset(is_set, 0, num_owned*sizeof(int));
+  for ( int i = 0; i < num_elements; i++ ){
+    for ( int j = 0; j < nodes_per_elem; j++ ){
+      int node = conn[nodes_per_elem*i + j] - range[mpi_rank];
+      if (node >= 0 && node < num_owned){
+        memcpy(&xvals[bsize*node], &values[elem_size*i + bsize*j],
+               bsize*sizeof(TacsScalar));
+        is_set[node] = 1;
+      }
+    }
+  }
+  for ( int i = 0; i < num_owned; i++ ){
+    if (!is_set[i]){
+      fail = 1;
+      break;
+    }
+  }
+  delete [] is_set;
+  delete [] values;
+
+  MPI_Allreduce(MPI_IN_PLACE, &fail, 1, MPI_INT, MPI_MAX, comm);
+  if (fail){
+    if (mpi_rank == 0){
+      fprintf(stderr, "TMRTopoProblem Error: Not all design variables "
+              "were set from %s\n", filename);
+    }
+    return fail;
+  }
+
+  // Restore the iteration counter
+  iter_count = header[3];
+
+  return fail;
+}
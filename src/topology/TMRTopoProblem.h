@@ -32,6 +32,7 @@
 #include "Compliance.h"
 #include "KSFailure.h"
 #include "TACSBuckling.h"
+#include "TMRBlockGMRES.h"
 
 /*
   Wrap a TACSBVec object with the ParOptVec interface
@@ -158,6 +159,11 @@ class TMRTopoProblem : public ParOptProblem {
   // Ku=f as the starting point for the current iteration
   // ----------------------------------------------------
   void setUseRecycledSolution( int truth );
+
+  // Set the option to solve all load cases (and the adjoint
+  // equations) together using block GMRES
+  // --------------------------------------------------------
+  void setUseBlockSolve( int truth );
   
   // Get the initial variables and bounds
   // ------------------------------------
@@ -207,6 +213,11 @@ class TMRTopoProblem : public ParOptProblem {
   // ---------------------
   void writeOutput( int iter, ParOptVec *x );
 
+  // Write/read the design variables to/from a checkpoint file
+  // ---------------------------------------------------------
+  int writeDesignCheckpoint( const char *filename, ParOptVec *x );
+  int readDesignCheckpoint( const char *filename, ParOptVec *x );
+
  private:
   // Set the design variables across all multigrid levels
   void setDesignVars( ParOptVec *xvec );
@@ -216,6 +227,15 @@ class TMRTopoProblem : public ParOptProblem {
 
   // Solver parameters
   int use_recyc_sol;
+  int use_block_solve;
+
+  // Solve the system of equations for all right-hand sides
+  void solveAll( int nrhs, TACSBVec **rhs, TACSBVec **sol,
+                 int zero_guess );
+
+  // Allocate/free the vectors for the block adjoint solve
+  void allocateBlockVecs( int nvecs, int nstress );
+  void freeBlockVecs();
   
   // Set the iteration count for printing to the file
   int iter_count;
@@ -255,9 +275,6 @@ class TMRTopoProblem : public ParOptProblem {
   TacsScalar buck_ks_weight;
   TacsScalar buck_offset, buck_scale;
 
-  // The derivative of f(x,u) w.r.t. u and the adjoint variables
-  TACSBVec *dfdu, *adjoint;
-
   // The objective weights
   TacsScalar *obj_weights;
   TACSFunction **obj_funcs;
@@ -283,8 +300,19 @@ class TMRTopoProblem : public ParOptProblem {
   int max_local_size;
   TacsScalar *xlocal;
 
-  // Store the Krylov solver and the multigrid object
+  // The derivative of f(x,u) w.r.t. u and the adjoint variables
+  TACSBVec *dfdu, *adjoint;
+
+  // The right-hand sides and the solutions of the adjoint equations
+  // and the partial derivatives of the stress constraints for the
+  // block solve. These are only allocated when the block solve is used.
+  int num_block_vecs, num_block_dfdx;
+  TACSBVec **block_rhs, **block_adj;
+  TacsScalar *block_dfdx;
+
+  // Store the Krylov solvers and the multigrid object
   TACSKsm *ksm;
+  TMRBlockGMRES *block_ksm;
   TACSMg *mg;
 
   // The initial design variable values
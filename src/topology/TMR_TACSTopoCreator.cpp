@@ -403,15 +403,32 @@ void TMROctTACSTopoCreator::createElements( int order,
     weights[i].index = node;
   }
 
-  // Loop over the octants
+  // Create the elements for all the octants
   octants->getArray(&octs, &num_octs);
+  createTopoElements(order, num_octs, octs, weights, nweights, elements);
+
+  delete [] weights;
+}
+
+/*
+  Create the elements for all of the local octants
+
+  The weights for the i-th octant are stored in the range
+  weights[nweights*i:nweights*(i+1)] and are in the local filter
+  ordering. Override this function to create all the elements at
+  once, instead of through one createElement() call per octant.
+*/
+void TMROctTACSTopoCreator::createTopoElements( int order,
+                                                int num_octs,
+                                                TMROctant *octs,
+                                                TMRIndexWeight *weights,
+                                                int nweights,
+                                                TACSElement **elements ){
   for ( int i = 0; i < num_octs; i++ ){
     // Allocate the stiffness object
     elements[i] = createElement(order, &octs[i],
                                 &weights[nweights*i], nweights);
   }
-
-  delete [] weights;
 }
 
 /*
@@ -864,9 +881,7 @@ void TMROctConformTACSTopoCreator::createElements( int order,
   filter->getNodeConn(&conn);
 
   // Get the local node index on this processor
-  for ( int i = 0; i < nweights*num_octs; i++ ){
-    index[i] = filter->getLocalNodeNumber(conn[i]);
-  }
+  filter->getLocalNodeNumbers(nweights*num_octs, conn, index);
 
   // Loop over the octants
   octants->getArray(&octs, &num_octs);
@@ -953,9 +968,7 @@ void TMRQuadConformTACSTopoCreator::createElements( int order,
   filter->getNodeConn(&conn);
 
   // Get the local node index on this processor
-  for ( int i = 0; i < nweights*num_quads; i++ ){
-    index[i] = filter->getLocalNodeNumber(conn[i]);
-  }
+  filter->getLocalNodeNumbers(nweights*num_quads, conn, index);
 
   // Loop over the octants
   quadrants->getArray(&quads, &num_quads);
@@ -49,6 +49,15 @@ class TMROctTACSTopoCreator : public TMROctTACSCreator {
                                       TMRIndexWeight *weights,
                                       int nweights ) = 0;
 
+  // Create all the local elements given the filter weights. By
+  // default this calls createElement() for each octant.
+  virtual void createTopoElements( int order,
+                                   int num_octs,
+                                   TMROctant *octs,
+                                   TMRIndexWeight *weights,
+                                   int nweights,
+                                   TACSElement **elements );
+
   // Get the underlying objects that define the filter
   void getFilter( TMROctForest **filter );
   void getMap( TACSVarMap **_map );
@@ -339,6 +339,11 @@ cdef extern from "TMRQuadrant.h":
         TMRQuadrant* contains(TMRQuadrant *q, int)
 
 cdef extern from "TMRQuadForest.h":
+    cdef cppclass TMRQuadInterpCache(TMREntity):
+        TMRQuadInterpCache()
+        void getStatistics(int*, int*)
+        void resetStatistics()
+
     cdef cppclass TMRQuadForest(TMREntity):
         TMRQuadForest(MPI_Comm, int, TMRInterpolationType)
         MPI_Comm getMPIComm()
@@ -346,7 +351,8 @@ cdef extern from "TMRQuadForest.h":
         TMRTopology* getTopology()
         void setConnectivity(int, const int*, int)
         void setFullConnectivity(int, int, int, const int*, const int*)
-        void repartition()
+        void repartition(int)
+        void repartition(const double*, int, double*, double*)
         void createTrees(int)
         void createRandomTrees(int, int, int)
         void refine(int*, int, int)
@@ -361,13 +367,18 @@ cdef extern from "TMRQuadForest.h":
         int getDepNodeConn(const int**, const int**, const double**)
         TMRQuadrantArray* getQuadsWithName(const char*)
         int getNodesWithName(const char*, int**)
-        void createInterpolation(TMRQuadForest*, TACSBVecInterp*)
+        void createInterpolation(TMRQuadForest*, TACSBVecInterp*,
+                                 TMRQuadInterpCache*)
         int getOwnedNodeRange(const int**)
         void getQuadrants(TMRQuadrantArray**)
         int getPoints(TMRPoint**)
-        int getLocalNodeNumber(int);
+        int getLocalNodeNumber(int)
+        void getLocalNodeNumbers(int, const int*, int*)
         void writeToVTK(const char*)
         void writeForestToVTK(const char*)
+        int writeForestToVTU(const char*)
+        int writeCheckpoint(const char*)
+        int readCheckpoint(const char*)
 
 cdef extern from "TMROctant.h":
     cdef cppclass TMROctant:
@@ -394,6 +405,11 @@ cdef extern from "TMROctant.h":
         TMROctant* contains(TMROctant*, int)
 
 cdef extern from "TMROctForest.h":
+    cdef cppclass TMROctInterpCache(TMREntity):
+        TMROctInterpCache()
+        void getStatistics(int*, int*)
+        void resetStatistics()
+
     cdef cppclass TMROctForest(TMREntity):
         TMROctForest(MPI_Comm, int, TMRInterpolationType)
         MPI_Comm getMPIComm()
@@ -402,6 +418,7 @@ cdef extern from "TMROctForest.h":
         void setConnectivity(int, const int*, int)
         void setFullConnectivity(int, int, int, const int*, const int*)
         void repartition(int)
+        void repartition(const double*, int, double*, double*)
         void createTrees(int)
         void createRandomTrees(int, int, int)
         void refine(int*, int, int)
@@ -416,12 +433,18 @@ cdef extern from "TMROctForest.h":
         int getDepNodeConn(const int**, const int**, const double**)
         TMROctantArray* getOctsWithName(const char*)
         int getNodesWithName(const char*, int**)
-        void createInterpolation(TMROctForest*, TACSBVecInterp*)
+        void createInterpolation(TMROctForest*, TACSBVecInterp*,
+                                 TMROctInterpCache*)
         int getOwnedNodeRange(const int**)
         void getOctants(TMROctantArray**)
         int getPoints(TMRPoint**)
+        int getLocalNodeNumber(int)
+        void getLocalNodeNumbers(int, const int*, int*)
         void writeToVTK(const char*)
         void writeForestToVTK(const char*)
+        int writeForestToVTU(const char*)
+        int writeCheckpoint(const char*)
+        int readCheckpoint(const char*)
 
 cdef extern from "TMR_TACSCreator.h":
     cdef cppclass TMRBoundaryConditions(TMREntity):
@@ -435,6 +458,7 @@ cdef extern from "TMR_TACSCreator.h":
 
     cdef cppclass TMROctTACSCreator(TMREntity):
         TMROctTACSCreator(TMRBoundaryConditions*)
+        void setElementPrototype(int, TACSElement*)
 
 cdef extern from "TMROctStiffness.h":
     cdef cppclass TMRStiffnessProperties(TMREntity):
@@ -512,8 +536,16 @@ cdef extern from "TMREgads.h" namespace "TMR_EgadsInterface":
     cdef TMRModel* TMR_LoadModelFromEGADSFile"TMR_EgadsInterface::TMR_LoadModelFromEGADSFile"(const char*, int)
 
 cdef extern from "TMR_RefinementTools.h":
+    enum TMRMarkCriterion:
+        TMR_MARK_DENSITY_BANDS
+        TMR_MARK_DENSITY_BANDS_REVERSE
+        TMR_MARK_ERROR_FRACTION
+        TMR_MARK_FIXED_FRACTION
+        TMR_MARK_TARGET_COUNT
+
     void TMR_CreateTACSMg(int, TACSAssembler**,
-                          TMRQuadForest**, TACSMg**, double, int, int)
+                          TMRQuadForest**, TACSMg**, double, int, int,
+                          TMRQuadInterpCache**)
     void TMR_ComputeInterpSolution(TMRQuadForest*, TACSAssembler*,
                                    TMRQuadForest*, TACSAssembler*,
                                    TACSBVec*, TACSBVec*)
@@ -528,7 +560,8 @@ cdef extern from "TMR_RefinementTools.h":
                                TACSBVec*, TACSBVec*, double*, double*)
 
     void TMR_CreateTACSMg(int, TACSAssembler**,
-                          TMROctForest**, TACSMg**, double, int, int)
+                          TMROctForest**, TACSMg**, double, int, int,
+                          TMROctInterpCache**)
     void TMR_ComputeInterpSolution(TMROctForest*, TACSAssembler*,
                                    TMROctForest*, TACSAssembler*,
                                    TACSBVec*, TACSBVec*)
@@ -541,8 +574,15 @@ cdef extern from "TMR_RefinementTools.h":
     double TMR_AdjointErrorEst(TMROctForest*, TACSAssembler*,
                                TMROctForest*, TACSAssembler*,
                                TACSBVec*, TACSBVec*, double*, double*)
+    int TMR_MarkRefinement(TMRQuadForest*, TACSAssembler*,
+                           TMRMarkCriterion, const double*,
+                           const double*, int*, int)
+    int TMR_MarkRefinement(TMROctForest*, TACSAssembler*,
+                           TMRMarkCriterion, const double*,
+                           const double*, int*, int)
     cdef cppclass TMRStressConstraint(TMREntity):
          TMRStressConstraint(TMROctForest*, TACSAssembler*, TacsScalar)
+         void setUseQuadCache(int)
          TacsScalar evalConstraint(TACSBVec*)
          void evalConDeriv(TacsScalar*, int, TACSBVec*)
 
@@ -556,6 +596,10 @@ cdef extern from "TMRCyCreator.h":
         void*, int, TMRQuadrant*, TMRIndexWeight*, int)
     ctypedef TACSElement* (*createocttopoelements)(
         void*, int, TMROctant*, TMRIndexWeight*, int)
+    ctypedef int (*createoctelementarray)(
+        void*, int, int, TMROctant*, TACSElement**)
+    ctypedef int (*createocttopoelementarray)(
+        void*, int, int, TMROctant*, TMRIndexWeight*, int, TACSElement**)
 
     cdef cppclass TMRCyQuadCreator(TMREntity):
         TMRCyQuadCreator(TMRBoundaryConditions*)
@@ -569,6 +613,10 @@ cdef extern from "TMRCyCreator.h":
         void setSelfPointer(void*)
         void setCreateOctElement(
             TACSElement* (*createoctelements)(void*, int, TMROctant*))
+        void setCreateOctElementArray(
+            int (*createoctelementarray)(
+                void*, int, int, TMROctant*, TACSElement**))
+        void setElementPrototype(int, TACSElement*)
         TACSAssembler *createTACS(TMROctForest*, OrderingType)
 
     cdef cppclass TMRCyTopoQuadCreator(TMREntity):
@@ -588,6 +636,10 @@ cdef extern from "TMRCyCreator.h":
         void setCreateOctTopoElement(
             TACSElement* (*createocttopoelements)(
                 void*, int, TMROctant*, TMRIndexWeight*, int))
+        void setCreateOctTopoElementArray(
+            int (*createocttopoelementarray)(
+                void*, int, int, TMROctant*, TMRIndexWeight*, int,
+                TACSElement**))
         TACSAssembler *createTACS(TMROctForest*, OrderingType)
         void getFilter(TMROctForest**)
         void getMap(TACSVarMap**)
@@ -684,10 +736,13 @@ cdef extern from "TMRTopoProblem.h":
         void setPrefix(const char*)
         void setInitDesignVars(ParOptVec*,ParOptVec*,ParOptVec*)
         void setIterationCounter(int)
+        int writeDesignCheckpoint(const char*, ParOptVec*)
+        int readDesignCheckpoint(const char*, ParOptVec*)
         ParOptVec* createDesignVec()
         void setF5OutputFlags(int, ElementType, int)
         void setF5EigenOutputFlags(int, ElementType, int)
         void setUseRecycledSolution(int)
+        void setUseBlockSolve(int)
 
     cdef cppclass ParOptBVecWrap(ParOptVec):
         ParOptBVecWrap(TACSBVec*)
@@ -696,3 +751,5 @@ cdef extern from "TMRTopoProblem.h":
 cdef extern from "TMR_STLTools.h":
     int TMR_GenerateBinFile(const char*, TMROctForest*,
                             TACSBVec*, int, double)
+    int TMR_WriteSTLFile(const char*, TMROctForest*,
+                         TACSBVec*, int, double)
@@ -78,6 +78,13 @@ UNIFORM_POINTS = TMR_UNIFORM_POINTS
 GAUSS_LOBATTO_POINTS = TMR_GAUSS_LOBATTO_POINTS
 BERNSTEIN_POINTS = TMR_BERNSTEIN_POINTS
 
+# Set the criteria used to mark elements for refinement
+MARK_DENSITY_BANDS = TMR_MARK_DENSITY_BANDS
+MARK_DENSITY_BANDS_REVERSE = TMR_MARK_DENSITY_BANDS_REVERSE
+MARK_ERROR_FRACTION = TMR_MARK_ERROR_FRACTION
+MARK_FIXED_FRACTION = TMR_MARK_FIXED_FRACTION
+MARK_TARGET_COUNT = TMR_MARK_TARGET_COUNT
+
 cdef class Vertex:
     """
     The vertex class is used to store both the point and to
@@ -2593,6 +2600,45 @@ cdef _init_Topology(TMRTopology *ptr):
         topo.ptr.incref()
     return topo
 
+# Wrap memory owned by a forest in a read-only numpy array. The
+# array holds a reference to the owner so that the forest is not
+# deallocated while the view exists.
+cdef _forest_view(owner, int nptype, int ndim, np.npy_intp *shape,
+                  void *data_ptr):
+    cdef np.ndarray ndarray
+    if data_ptr == NULL:
+        ndarray = np.PyArray_ZEROS(ndim, shape, nptype, 0)
+    else:
+        ndarray = np.PyArray_SimpleNewFromData(ndim, shape, nptype, data_ptr)
+        np.set_array_base(ndarray, owner)
+    ndarray.flags.writeable = False
+    return ndarray
+
+cdef _quadrant_dtype():
+    '''Return the numpy structured type matching TMRQuadrant'''
+    cdef TMRQuadrant q
+    cdef char *b = <char*>&q
+    return np.dtype({'names': ['face', 'x', 'y', 'tag', 'level', 'info'],
+                     'formats': [np.int32, np.int32, np.int32, np.int32,
+                                 np.int16, np.int16],
+                     'offsets': [<char*>&q.face - b, <char*>&q.x - b,
+                                 <char*>&q.y - b, <char*>&q.tag - b,
+                                 <char*>&q.level - b, <char*>&q.info - b],
+                     'itemsize': sizeof(TMRQuadrant)})
+
+cdef _octant_dtype():
+    '''Return the numpy structured type matching TMROctant'''
+    cdef TMROctant o
+    cdef char *b = <char*>&o
+    return np.dtype({'names': ['block', 'x', 'y', 'z', 'tag', 'level', 'info'],
+                     'formats': [np.int32, np.int32, np.int32, np.int32,
+                                 np.int32, np.int16, np.int16],
+                     'offsets': [<char*>&o.block - b, <char*>&o.x - b,
+                                 <char*>&o.y - b, <char*>&o.z - b,
+                                 <char*>&o.tag - b, <char*>&o.level - b,
+                                 <char*>&o.info - b],
+                     'itemsize': sizeof(TMROctant)})
+
 cdef class QuadrantArray:
     cdef TMRQuadrantArray *ptr
     cdef int self_owned
@@ -2706,6 +2752,44 @@ cdef class Quadrant:
         def __set__(self, value):
             self.quad.info = value
 
+cdef class QuadInterpCache:
+    """
+    This class caches the coarse quadrants used to interpolate between
+    two quadtree forests. Passing the same cache to repeated calls to
+    QuadForest.createInterpolation or createMg skips the search for the
+    rows of fine quadrants that have not changed since the last call.
+    """
+    cdef TMRQuadInterpCache *ptr
+    def __cinit__(self):
+        self.ptr = new TMRQuadInterpCache()
+        self.ptr.incref()
+
+    def __dealloc__(self):
+        if self.ptr:
+            self.ptr.decref()
+
+    def getStatistics(self):
+        """
+        getStatistics(self)
+
+        Get the number of interpolation rows on this processor that were
+        found in the cache and the number that had to be searched for
+
+        Returns:
+            tuple: The number of cache hits and misses
+        """
+        cdef int num_hits = 0, num_misses = 0
+        self.ptr.getStatistics(&num_hits, &num_misses)
+        return num_hits, num_misses
+
+    def resetStatistics(self):
+        """
+        resetStatistics(self)
+
+        Reset the cache hit and miss counts
+        """
+        self.ptr.resetStatistics()
+
 cdef class QuadForest:
     """
     This class defines a parallel forest of quadrtrees. The connectivity
@@ -2787,15 +2871,53 @@ cdef class QuadForest:
             return _init_Topology(topo)
         return None
 
-    def repartition(self):
+    def repartition(self, int max_rank=-1,
+                    np.ndarray[double, ndim=1, mode='c'] weights=None):
         """
-        repartition(self)
+        repartition(self, max_rank=-1, weights=None)
 
         Repartition the mesh across processors. This redistributes the elements
         so that there are an equal, or nearly equal, number of elements on each
-        processor.
+        processor. If weights are supplied, the elements are distributed so
+        that each processor has a nearly equal total weight.
+
+        Args:
+            max_rank (int): Number of processors to distribute the mesh across.
+            If negative, the mesh is distributed across all processors
+            weights (np.ndarray): Weight for each local element (optional)
+
+        Returns:
+            tuple: The imbalance ratio before and after repartitioning, if the
+            weights are supplied
         """
-        self.ptr.repartition()
+        cdef double imbalance = 1.0
+        cdef double new_imbalance = 1.0
+        cdef TMRQuadrantArray *array = NULL
+        cdef int size = 0
+        cdef int fail = 0
+        if weights is None:
+            self.ptr.repartition(max_rank)
+            return
+        self.ptr.getQuadrants(&array)
+        if array != NULL:
+            array.getArray(NULL, &size)
+        if weights.shape[0] != size:
+            fail = 1
+
+        # The repartitioning is collective, so all processors must
+        # agree on the failure before raising the error
+        MPI_Allreduce(MPI_IN_PLACE, &fail, 1, MPI_INT, MPI_MAX,
+                      self.ptr.getMPIComm())
+        if fail:
+            if weights.shape[0] != size:
+                errmsg = 'QuadForest: Expected %d weights, one for each local quadrant, got %d'%(
+                    size, weights.shape[0])
+            else:
+                errmsg = 'QuadForest: Incorrect number of weights on another processor'
+            raise ValueError(errmsg)
+        self.ptr.repartition(<double*>weights.data, max_rank,
+                             &imbalance, &new_imbalance)
+        return imbalance, new_imbalance
 
     def createTrees(self, int depth=0):
         """
@@ -2943,6 +3065,100 @@ cdef class QuadForest:
         self.ptr.getQuadrants(&array)
         return _init_QuadrantArray(array, 0)
 
+    def getQuadrantView(self):
+        """
+        getQuadrantView(self)
+
+        Get a read-only view of the locally owned quadrants
+
+        The view is a numpy structured array with the fields face, x, y, tag, level and info
+        that references the memory owned by the forest. The view keeps
+        the forest alive, but is invalidated by any call that modifies
+        the quadrants, such as refine(), balance() or repartition().
+
+        Returns:
+            np.ndarray: A structured array of the quadrants
+        """
+        cdef TMRQuadrantArray *array = NULL
+        cdef TMRQuadrant *array_ptr = NULL
+        cdef int size = 0
+        cdef np.npy_intp shape[1]
+        self.ptr.getQuadrants(&array)
+        if array != NULL:
+            array.getArray(&array_ptr, &size)
+        shape[0] = <np.npy_intp>(size*sizeof(TMRQuadrant))
+        raw = _forest_view(self, np.NPY_UINT8, 1, shape, <void*>array_ptr)
+        return raw.view(_quadrant_dtype())
+
+    def getPointView(self):
+        """
+        getPointView(self)
+
+        Get a read-only (npts, 3) view of the node locations that
+        references the memory owned by the forest. The view is
+        invalidated when the nodes are re-created.
+
+        Returns:
+            np.ndarray: The node locations
+        """
+        cdef TMRPoint *X = NULL
+        cdef int npts = 0
+        cdef np.npy_intp shape[2]
+        npts = self.ptr.getPoints(&X)
+        shape[0] = <np.npy_intp>npts
+        shape[1] = 3
+        return _forest_view(self, np.NPY_DOUBLE, 2, shape, <void*>X)
+
+    def getMeshConnView(self):
+        """
+        getMeshConnView(self)
+
+        Get a read-only (nelems, nodes_per_elem) view of the local part
+        of the connectivity that references the memory owned by the
+        forest. The view is invalidated when the nodes are re-created.
+
+        Returns:
+            np.ndarray: The local connectivity using global node numbers
+        """
+        cdef const int *conn = NULL
+        cdef int nelems = 0
+        cdef int order = self.ptr.getMeshOrder()
+        cdef np.npy_intp shape[2]
+        self.ptr.getNodeConn(&conn, &nelems)
+        shape[0] = <np.npy_intp>nelems
+        shape[1] = <np.npy_intp>(order*order)
+        return _forest_view(self, np.NPY_INT, 2, shape, <void*>conn)
+
+    def getDepNodeConnView(self):
+        """
+        getDepNodeConnView(self)
+
+        Get read-only views of the dependent node pointer, connectivity
+        and weights that reference the memory owned by the forest. The
+        views are invalidated when the nodes are re-created.
+
+        Returns:
+            ptr (np.ndarray), conn (np.ndarray), weight (np.ndarray):
+            Array of dependent nodes, Array of connectivity of dependent nodes
+            Array of weights associated with the dependent nodes
+        """
+        cdef int ndep = 0
+        cdef const int *_ptr = NULL
+        cdef const int *_conn = NULL
+        cdef const double *_weights = NULL
+        cdef np.npy_intp shape[1]
+        ndep = self.ptr.getDepNodeConn(&_ptr, &_conn, &_weights)
+        shape[0] = <np.npy_intp>(ndep+1)
+        if _ptr == NULL:
+            shape[0] = 0
+        ptr = _forest_view(self, np.NPY_INT, 1, shape, <void*>_ptr)
+        shape[0] = 0
+        if _ptr != NULL:
+            shape[0] = <np.npy_intp>_ptr[ndep]
+        conn = _forest_view(self, np.NPY_INT, 1, shape, <void*>_conn)
+        weights = _forest_view(self, np.NPY_DOUBLE, 1, shape, <void*>_weights)
+        return ptr, conn, weights
+
     def getPoints(self):
         """
         getPoints(self)
@@ -2953,15 +3169,9 @@ cdef class QuadForest:
             np.ndarray: An array of node locations
         """
         cdef TMRPoint *X = NULL
-        cdef int npts = 0
-        npts = self.ptr.getPoints(&X)
+        self.ptr.getPoints(&X)
         if X != NULL:
-            Xp = np.zeros((npts, 3), dtype=np.double)
-            for i in range(npts):
-                Xp[i,0] = X[i].x
-                Xp[i,1] = X[i].y
-                Xp[i,2] = X[i].z
-            return Xp
+            return np.array(self.getPointView())
         else:
             errmsg = 'TMRQuadForest: No node locations'
             raise RuntimeError(errmsg)
@@ -2969,6 +3179,24 @@ cdef class QuadForest:
     def getLocalNodeNumber(self, int node):
         return self.ptr.getLocalNodeNumber(node)
 
+    def getLocalNodeNumbers(self, np.ndarray[int, ndim=1, mode='c'] nodes):
+        """
+        getLocalNodeNumbers(self, nodes)
+
+        Get the local node numbers for an array of global node numbers
+
+        Args:
+            nodes (np.ndarray): The global node numbers
+
+        Returns:
+            np.ndarray: The local node numbers (-1 if not on this processor)
+        """
+        cdef int size = nodes.shape[0]
+        cdef np.ndarray local = np.zeros(size, dtype=np.intc)
+        self.ptr.getLocalNodeNumbers(size, <int*>nodes.data,
+                                     <int*>local.data)
+        return local
+
     def getNodeRange(self):
         """
         getNodeRange(self)
@@ -2999,15 +3227,11 @@ cdef class QuadForest:
         Returns:
             np.ndarray: The local part of the connectivity using global node numbers
         """
-        cdef const int *conn
-        cdef int nelems
-        cdef int order = self.ptr.getMeshOrder()
+        cdef const int *conn = NULL
+        cdef int nelems = 0
         self.ptr.getNodeConn(&conn, &nelems)
         if conn != NULL:
-            quads = np.zeros((order*order*nelems), dtype=np.intc)
-            for i in range(order*order*nelems):
-                quads[i] = conn[i]
-            return quads.reshape((nelems, order*order))
+            return np.array(self.getMeshConnView())
         else:
             errmsg = 'TMRQuadForest: No mesh connectivity'
             raise RuntimeError(errmsg)
@@ -3024,20 +3248,8 @@ cdef class QuadForest:
             Array of dependent nodes, Array of connectivity of dependent nodes
             Array of weights associated with the dependent nodes
         """
-        cdef int ndep = 0
-        cdef const int *_ptr = NULL
-        cdef const int *_conn = NULL
-        cdef const double *_weights = NULL
-        ndep = self.ptr.getDepNodeConn(&_ptr, &_conn, &_weights)
-        ptr = np.zeros(ndep+1, dtype=np.intc)
-        conn = np.zeros(_ptr[ndep], dtype=np.intc)
-        weights = np.zeros(_ptr[ndep], dtype=np.double)
-        for i in range(ndep+1):
-            ptr[i] = _ptr[i]
-        for i in range(ptr[ndep]):
-            conn[i] = _conn[i]
-            weights[i] = _weights[i]
-        return ptr, conn, weights
+        ptr, conn, weights = self.getDepNodeConnView()
+        return np.array(ptr), np.array(conn), np.array(weights)
 
     def writeToVTK(self, fname):
         """
@@ -3055,9 +3267,42 @@ cdef class QuadForest:
         cdef char *filename = tmr_convert_str_to_chars(fname)
         self.ptr.writeForestToVTK(filename)
 
-    def createInterpolation(self, QuadForest forest, VecInterp vec):
+    def writeForestToVTU(self, fname):
+        """
+        writeForestToVTU(self, fname)
+
+        Write the refined forest to a binary .vtu file in parallel.
+        This is collective and requires that the nodes have been
+        created.
+        """
+        cdef char *filename = tmr_convert_str_to_chars(fname)
+        return self.ptr.writeForestToVTU(filename)
+
+    def writeCheckpoint(self, fname):
+        """
+        writeCheckpoint(self, fname)
+
+        Write the connectivity and the refined forest to a binary
+        checkpoint file in parallel. This is collective.
+        """
+        cdef char *filename = tmr_convert_str_to_chars(fname)
+        return self.ptr.writeCheckpoint(filename)
+
+    def readCheckpoint(self, fname):
+        """
+        readCheckpoint(self, fname)
+
+        Read the forest from a checkpoint file. If the file was written
+        on a different number of processors, the forest is repartitioned
+        as it is read. This is collective.
+        """
+        cdef char *filename = tmr_convert_str_to_chars(fname)
+        return self.ptr.readCheckpoint(filename)
+
+    def createInterpolation(self, QuadForest forest, VecInterp vec,
+                            QuadInterpCache cache=None):
         """
-        createInterpolation(self, forest, vec)
+        createInterpolation(self, forest, vec, cache=None)
 
         Create an interpolation object between two quadtrees that share a common
         topology.
@@ -3065,11 +3310,15 @@ cdef class QuadForest:
         Args:
             forest (QuadForest): The quadtree forest that has the common topology
             vec (VecInterp): The interpolation operator
+            cache (QuadInterpCache): Optional cache of the enclosing quadrants
         """
+        cdef TMRQuadInterpCache *cache_ptr = NULL
         if self.ptr == forest.ptr:
             errmsg = 'Cannot interpolate between the same object'
             raise ValueError(errmsg)
-        self.ptr.createInterpolation(forest.ptr, vec.ptr)
+        if cache is not None:
+            cache_ptr = cache.ptr
+        self.ptr.createInterpolation(forest.ptr, vec.ptr, cache_ptr)
 
 cdef _init_QuadForest(TMRQuadForest* ptr):
     forest = QuadForest()
@@ -3201,6 +3450,44 @@ cdef class Octant:
         def __set__(self, value):
             self.octant.info = value
 
+cdef class OctInterpCache:
+    """
+    This class caches the coarse octants used to interpolate between
+    two octree forests. Passing the same cache to repeated calls to
+    OctForest.createInterpolation or createMg skips the search for the
+    rows of fine octants that have not changed since the last call.
+    """
+    cdef TMROctInterpCache *ptr
+    def __cinit__(self):
+        self.ptr = new TMROctInterpCache()
+        self.ptr.incref()
+
+    def __dealloc__(self):
+        if self.ptr:
+            self.ptr.decref()
+
+    def getStatistics(self):
+        """
+        getStatistics(self)
+
+        Get the number of interpolation rows on this processor that were
+        found in the cache and the number that had to be searched for
+
+        Returns:
+            tuple: The number of cache hits and misses
+        """
+        cdef int num_hits = 0, num_misses = 0
+        self.ptr.getStatistics(&num_hits, &num_misses)
+        return num_hits, num_misses
+
+    def resetStatistics(self):
+        """
+        resetStatistics(self)
+
+        Reset the cache hit and miss counts
+        """
+        self.ptr.resetStatistics()
+
 cdef class OctForest:
     """
     This class defines a forest of octrees. The octrees within the
@@ -3305,19 +3592,53 @@ cdef class OctForest:
         num_nodes = np.max(conn)+1
         self.ptr.setConnectivity(num_nodes, <int*>conn.data, num_blocks)
 
-    def repartition(self, int max_rank=-1):
+    def repartition(self, int max_rank=-1,
+                    np.ndarray[double, ndim=1, mode='c'] weights=None):
         """
-        repartition(self, max_rank=-1)
+        repartition(self, max_rank=-1, weights=None)
 
         Repartition the mesh across processors. This redistributes the elements
         so that there are an equal, or nearly equal, number of elements on each
-        processor.
+        processor. If weights are supplied, the elements are distributed so
+        that each processor has a nearly equal total weight.
 
         Args:
             max_rank (int): Number of processors to distribute the mesh across.
             If negative, the mesh is distributed across all processors
+            weights (np.ndarray): Weight for each local element (optional)
+
+        Returns:
+            tuple: The imbalance ratio before and after repartitioning, if the
+            weights are supplied
         """
-        self.ptr.repartition(max_rank)
+        cdef double imbalance = 1.0
+        cdef double new_imbalance = 1.0
+        cdef TMROctantArray *array = NULL
+        cdef int size = 0
+        cdef int fail = 0
+        if weights is None:
+            self.ptr.repartition(max_rank)
+            return
+        self.ptr.getOctants(&array)
+        if array != NULL:
+            array.getArray(NULL, &size)
+        if weights.shape[0] != size:
+            fail = 1
+
+        # The repartitioning is collective, so all processors must
+        # agree on the failure before raising the error
+        MPI_Allreduce(MPI_IN_PLACE, &fail, 1, MPI_INT, MPI_MAX,
+                      self.ptr.getMPIComm())
+        if fail:
+            if weights.shape[0] != size:
+                errmsg = 'OctForest: Expected %d weights, one for each local octant, got %d'%(
+                    size, weights.shape[0])
+            else:
+                errmsg = 'OctForest: Incorrect number of weights on another processor'
+            raise ValueError(errmsg)
+        self.ptr.repartition(<double*>weights.data, max_rank,
+                             &imbalance, &new_imbalance)
+        return imbalance, new_imbalance
 
     def createTrees(self, int depth=0):
         """
@@ -3465,6 +3786,100 @@ cdef class OctForest:
         self.ptr.getOctants(&array)
         return _init_OctantArray(array, 0)
 
+    def getOctantView(self):
+        """
+        getOctantView(self)
+
+        Get a read-only view of the locally owned octants
+
+        The view is a numpy structured array with the fields block, x, y, z, tag, level and info
+        that references the memory owned by the forest. The view keeps
+        the forest alive, but is invalidated by any call that modifies
+        the octants, such as refine(), balance() or repartition().
+
+        Returns:
+            np.ndarray: A structured array of the octants
+        """
+        cdef TMROctantArray *array = NULL
+        cdef TMROctant *array_ptr = NULL
+        cdef int size = 0
+        cdef np.npy_intp shape[1]
+        self.ptr.getOctants(&array)
+        if array != NULL:
+            array.getArray(&array_ptr, &size)
+        shape[0] = <np.npy_intp>(size*sizeof(TMROctant))
+        raw = _forest_view(self, np.NPY_UINT8, 1, shape, <void*>array_ptr)
+        return raw.view(_octant_dtype())
+
+    def getPointView(self):
+        """
+        getPointView(self)
+
+        Get a read-only (npts, 3) view of the node locations that
+        references the memory owned by the forest. The view is
+        invalidated when the nodes are re-created.
+
+        Returns:
+            np.ndarray: The node locations
+        """
+        cdef TMRPoint *X = NULL
+        cdef int npts = 0
+        cdef np.npy_intp shape[2]
+        npts = self.ptr.getPoints(&X)
+        shape[0] = <np.npy_intp>npts
+        shape[1] = 3
+        return _forest_view(self, np.NPY_DOUBLE, 2, shape, <void*>X)
+
+    def getMeshConnView(self):
+        """
+        getMeshConnView(self)
+
+        Get a read-only (nelems, nodes_per_elem) view of the local part
+        of the connectivity that references the memory owned by the
+        forest. The view is invalidated when the nodes are re-created.
+
+        Returns:
+            np.ndarray: The local connectivity using global node numbers
+        """
+        cdef const int *conn = NULL
+        cdef int nelems = 0
+        cdef int order = self.ptr.getMeshOrder()
+        cdef np.npy_intp shape[2]
+        self.ptr.getNodeConn(&conn, &nelems)
+        shape[0] = <np.npy_intp>nelems
+        shape[1] = <np.npy_intp>(order*order*order)
+        return _forest_view(self, np.NPY_INT, 2, shape, <void*>conn)
+
+    def getDepNodeConnView(self):
+        """
+        getDepNodeConnView(self)
+
+        Get read-only views of the dependent node pointer, connectivity
+        and weights that reference the memory owned by the forest. The
+        views are invalidated when the nodes are re-created.
+
+        Returns:
+            ptr (np.ndarray), conn (np.ndarray), weight (np.ndarray):
+            Array of dependent nodes, Array of connectivity of dependent nodes
+            Array of weights associated with the dependent nodes
+        """
+        cdef int ndep = 0
+        cdef const int *_ptr = NULL
+        cdef const int *_conn = NULL
+        cdef const double *_weights = NULL
+        cdef np.npy_intp shape[1]
+        ndep = self.ptr.getDepNodeConn(&_ptr, &_conn, &_weights)
+        shape[0] = <np.npy_intp>(ndep+1)
+        if _ptr == NULL:
+            shape[0] = 0
+        ptr = _forest_view(self, np.NPY_INT, 1, shape, <void*>_ptr)
+        shape[0] = 0
+        if _ptr != NULL:
+            shape[0] = <np.npy_intp>_ptr[ndep]
+        conn = _forest_view(self, np.NPY_INT, 1, shape, <void*>_conn)
+        weights = _forest_view(self, np.NPY_DOUBLE, 1, shape, <void*>_weights)
+        return ptr, conn, weights
+
     def getPoints(self):
         """
         getPoints(self)
@@ -3474,15 +3889,28 @@ cdef class OctForest:
         Returns:
             np.ndarray: An array of node locations
         """
-        cdef TMRPoint *X = NULL
-        cdef int npts = 0
-        npts = self.ptr.getPoints(&X)
-        Xp = np.zeros((npts, 3), dtype=np.double)
-        for i in range(npts):
-            Xp[i,0] = X[i].x
-            Xp[i,1] = X[i].y
-            Xp[i,2] = X[i].z
-        return Xp
+        return np.array(self.getPointView())
+
+    def getLocalNodeNumber(self, int node):
+        return self.ptr.getLocalNodeNumber(node)
+
+    def getLocalNodeNumbers(self, np.ndarray[int, ndim=1, mode='c'] nodes):
+        """
+        getLocalNodeNumbers(self, nodes)
+
+        Get the local node numbers for an array of global node numbers
+
+        Args:
+            nodes (np.ndarray): The global node numbers
+
+        Returns:
+            np.ndarray: The local node numbers (-1 if not on this processor)
+        """
+        cdef int size = nodes.shape[0]
+        cdef np.ndarray local = np.zeros(size, dtype=np.intc)
+        self.ptr.getLocalNodeNumbers(size, <int*>nodes.data,
+                                     <int*>local.data)
+        return local
 
     def getNodeRange(self):
         """
@@ -3510,14 +3938,7 @@ cdef class OctForest:
         Returns:
             np.ndarray: The local part of the connectivity using global node numbers
         """
-        cdef const int *conn
-        cdef int nelems
-        cdef int order = self.ptr.getMeshOrder()
-        self.ptr.getNodeConn(&conn, &nelems)
-        octs = np.zeros((order*order*order*nelems), dtype=np.intc)
-        for i in range(order*order*order*nelems):
-            octs[i] = conn[i]
-        return octs.reshape((nelems, order*order*order))
+        return np.array(self.getMeshConnView())
 
     def getDepNodeConn(self):
         """
@@ -3531,20 +3952,8 @@ cdef class OctForest:
             Array of dependent nodes, Array of connectivity of dependent nodes
             Array of weights associated with the dependent nodes
         """
-        cdef int ndep = 0
-        cdef const int *_ptr = NULL
-        cdef const int *_conn = NULL
-        cdef const double *_weights = NULL
-        ndep = self.ptr.getDepNodeConn(&_ptr, &_conn, &_weights)
-        ptr = np.zeros(ndep+1, dtype=np.intc)
-        conn = np.zeros(_ptr[ndep], dtype=np.intc)
-        weights = np.zeros(_ptr[ndep], dtype=np.double)
-        for i in range(ndep+1):
-            ptr[i] = _ptr[i]
-        for i in range(ptr[ndep]):
-            conn[i] = _conn[i]
-            weights[i] = _weights[i]
-        return ptr, conn, weights
+        ptr, conn, weights = self.getDepNodeConnView()
+        return np.array(ptr), np.array(conn), np.array(weights)
 
     def writeToVTK(self, fname):
         """
@@ -3562,9 +3971,42 @@ cdef class OctForest:
         cdef char *filename = tmr_convert_str_to_chars(fname)
         self.ptr.writeForestToVTK(filename)
 
-    def createInterpolation(self, OctForest forest, VecInterp vec):
+    def writeForestToVTU(self, fname):
+        """
+        writeForestToVTU(self, fname)
+
+        Write the refined forest to a binary .vtu file in parallel.
+        This is collective and requires that the nodes have been
+        created.
+        """
+        cdef char *filename = tmr_convert_str_to_chars(fname)
+        return self.ptr.writeForestToVTU(filename)
+
+    def writeCheckpoint(self, fname):
+        """
+        writeCheckpoint(self, fname)
+
+        Write the connectivity and the refined forest to a binary
+        checkpoint file in parallel. This is collective.
+        """
+        cdef char *filename = tmr_convert_str_to_chars(fname)
+        return self.ptr.writeCheckpoint(filename)
+
+    def readCheckpoint(self, fname):
         """
-        createInterpolation(self, forest, vec)
+        readCheckpoint(self, fname)
+
+        Read the forest from a checkpoint file. If the file was written
+        on a different number of processors, the forest is repartitioned
+        as it is read. This is collective.
+        """
+        cdef char *filename = tmr_convert_str_to_chars(fname)
+        return self.ptr.readCheckpoint(filename)
+
+    def createInterpolation(self, OctForest forest, VecInterp vec,
+                            OctInterpCache cache=None):
+        """
+        createInterpolation(self, forest, vec, cache=None)
 
         Create an interpolation object between two octrees that share a common
         topology.
@@ -3572,11 +4014,15 @@ cdef class OctForest:
         Args:
             forest (OctForest): The octree forest that has the common topology
             vec (VecInterp): The interpolation operator
+            cache (OctInterpCache): Optional cache of the enclosing octants
         """
+        cdef TMROctInterpCache *cache_ptr = NULL
         if self.ptr == forest.ptr:
             errmsg = 'Cannot interpolate between the same object'
             raise ValueError(errmsg)
-        self.ptr.createInterpolation(forest.ptr, vec.ptr)
+        if cache is not None:
+            cache_ptr = cache.ptr
+        self.ptr.createInterpolation(forest.ptr, vec.ptr, cache_ptr)
 
 cdef _init_OctForest(TMROctForest* ptr):
     forest = OctForest()
@@ -3768,6 +4214,76 @@ cdef TACSElement* _createOctElement(void *_self, int order,
         return elem
     return NULL
 
+cdef _getOctantFieldArrays(int num, TMROctant *octs):
+    """Copy the fields of an array of octants into numpy arrays"""
+    cdef int i = 0
+    cdef np.ndarray[np.int32_t, ndim=1] x = np.empty(num, dtype=np.int32)
+    cdef np.ndarray[np.int32_t, ndim=1] y = np.empty(num, dtype=np.int32)
+    cdef np.ndarray[np.int32_t, ndim=1] z = np.empty(num, dtype=np.int32)
+    cdef np.ndarray[np.int16_t, ndim=1] level = np.empty(num, dtype=np.int16)
+    cdef np.ndarray[np.int32_t, ndim=1] block = np.empty(num, dtype=np.int32)
+    cdef np.ndarray[np.int32_t, ndim=1] tag = np.empty(num, dtype=np.int32)
+    for i in range(num):
+        x[i] = octs[i].x
+        y[i] = octs[i].y
+        z[i] = octs[i].z
+        level[i] = octs[i].level
+        block[i] = octs[i].block
+        tag[i] = octs[i].tag
+    return x, y, z, level, block, tag
+
+cdef int _setElementArray(result, int num, TACSElement **elements):
+    """
+    Set the elements returned from a batch createElements() call.
+
+    The result is either a sequence of num elements, or a tuple
+    (elems, index) where elems is a sequence of elements and index is an
+    integer array of length num such that element i is elems[index[i]].
+    """
+    cdef int i = 0
+    cdef int fail = 0
+    cdef TACSElement *elem = NULL
+    if (isinstance(result, tuple) and len(result) == 2 and
+        not isinstance(result[0], Element)):
+        elems = result[0]
+        index = np.asarray(result[1], dtype=np.intc)
+        if len(index) != num:
+            return 1
+        for i in range(num):
+            e = elems[index[i]]
+            if e is None:
+                fail = 1
+            else:
+                elem = (<Element>e).ptr
+                elem.incref()
+                elements[i] = elem
+    else:
+        if len(result) != num:
+            return 1
+        for i in range(num):
+            e = result[i]
+            if e is None:
+                fail = 1
+            else:
+                elem = (<Element>e).ptr
+                elem.incref()
+                elements[i] = elem
+    return fail
+
+cdef int _createOctElementArray(void *_self, int order, int num,
+                                TMROctant *octs, TACSElement **elements):
+    cdef int fail = 0
+    try:
+        x, y, z, level, block, tag = _getOctantFieldArrays(num, octs)
+        result = (<object>_self).createElements(order, x, y, z,
+                                                level, block, tag)
+        fail = _setElementArray(result, num, elements)
+    except:
+        tb = traceback.format_exc()
+        print(tb)
+        fail = 1
+    return fail
+
 cdef class OctCreator:
     """
     Generates a OctCreator object
@@ -3779,6 +4295,16 @@ cdef class OctCreator:
 
     This function takes the order of the mesh and a TMR.Octant and returns a
     TACS.Element object that will be placed into an Assembler object.
+
+    Alternatively, implement the member function:
+
+    createElements(self, order, x, y, z, level, block, tag)
+
+    This function is called once with numpy arrays of the fields of all the
+    local octants. It returns either a list of elements, one for each octant,
+    or a tuple (elems, index) where the element for the i-th octant is
+    elems[index[i]]. When element prototypes are set for the blocks with
+    setElementPrototype(), neither function is called.
     """
     cdef TMRCyOctCreator *ptr
     def __cinit__(self, BoundaryConditions bcs, *args, **kwargs):
@@ -3786,11 +4312,28 @@ cdef class OctCreator:
         self.ptr.incref()
         self.ptr.setSelfPointer(<void*>self)
         self.ptr.setCreateOctElement(_createOctElement)
+        if hasattr(self, 'createElements'):
+            self.ptr.setCreateOctElementArray(_createOctElementArray)
         return
 
     def __dealloc__(self):
         self.ptr.decref()
 
+    def setElementPrototype(self, int block, Element elem):
+        """
+        setElementPrototype(self, block, elem)
+
+        Use the given element for all the octants in the specified block
+        (the index of the volume in the topology). The element object is
+        shared between all of these octants. Every block must have a
+        prototype, otherwise createTACS() fails.
+
+        Args:
+            block (int): The block index
+            elem (Element): The element object
+        """
+        self.ptr.setElementPrototype(block, elem.ptr)
+
     def createTACS(self, OctForest forest,
                    OrderingType ordering=TACS.PY_NATURAL_ORDER):
         """
@@ -3805,6 +4348,9 @@ cdef class OctCreator:
         """
         cdef TACSAssembler *assembler = NULL
         assembler = self.ptr.createTACS(forest.ptr, ordering)
+        if assembler == NULL:
+            errmsg = 'Failed to create the elements for all octants'
+            raise ValueError(errmsg)
         return _init_Assembler(assembler)
 
 cdef TACSElement* _createQuadTopoElement(void *_self, int order,
@@ -3942,7 +4488,50 @@ cdef TACSElement* _createOctTopoElement(void *_self, int order,
         return elem
     return NULL
 
+cdef int _createOctTopoElementArray(void *_self, int order, int num,
+                                    TMROctant *octs,
+                                    TMRIndexWeight *weights,
+                                    int nweights,
+                                    TACSElement **elements):
+    cdef int i = 0
+    cdef int fail = 0
+    cdef np.ndarray[int, ndim=1] idx
+    cdef np.ndarray[double, ndim=1] wvals
+    try:
+        x, y, z, level, block, tag = _getOctantFieldArrays(num, octs)
+        ptr = np.arange(0, nweights*(num+1), nweights, dtype=np.intc)
+        idx = np.empty(nweights*num, dtype=np.intc)
+        wvals = np.empty(nweights*num, dtype=np.double)
+        for i in range(nweights*num):
+            idx[i] = weights[i].index
+            wvals[i] = weights[i].weight
+        result = (<object>_self).createElements(order, x, y, z, level,
+                                                block, tag, ptr, idx, wvals)
+        fail = _setElementArray(result, num, elements)
+    except:
+        tb = traceback.format_exc()
+        print(tb)
+        fail = 1
+    return fail
+
 cdef class OctTopoCreator:
+    """
+    Create the elements for topology optimization with a filter
+
+    Inherit from TMR.OctTopoCreator and implement either the member function:
+
+    createElement(self, order, oct, idx, wvals)
+
+    which is called for each octant with the filter indices and weights, or:
+
+    createElements(self, order, x, y, z, level, block, tag, ptr, idx, wvals)
+
+    which is called once with numpy arrays for all the local octants. The
+    filter indices and weights for the i-th octant are idx[ptr[i]:ptr[i+1]]
+    and wvals[ptr[i]:ptr[i+1]]. This function returns either a list of
+    elements, one for each octant, or a tuple (elems, index) where the
+    element for the i-th octant is elems[index[i]].
+    """
     cdef TMRCyTopoOctCreator *ptr
     def __cinit__(self, BoundaryConditions bcs, OctForest filt,
                   *args, **kwargs):
@@ -3951,6 +4540,8 @@ cdef class OctTopoCreator:
         self.ptr.incref()
         self.ptr.setSelfPointer(<void*>self)
         self.ptr.setCreateOctTopoElement(_createOctTopoElement)
+        if hasattr(self, 'createElements'):
+            self.ptr.setCreateOctTopoElementArray(_createOctTopoElementArray)
         return
 
     def __dealloc__(self):
@@ -4399,11 +4990,13 @@ cdef class AnisotropicStiffness(SolidStiff):
 
 def createMg(list assemblers, list forests, double omega=1.0,
              use_coarse_direct_solve=True,
-             use_chebyshev_smoother=False):
+             use_chebyshev_smoother=False, list caches=None):
     cdef int nlevels = 0
     cdef TACSAssembler **assm = NULL
     cdef TMRQuadForest **qforest = NULL
     cdef TMROctForest **oforest = NULL
+    cdef TMRQuadInterpCache **qcache = NULL
+    cdef TMROctInterpCache **ocache = NULL
     cdef TACSMg *mg = NULL
     cdef int isqforest = 0
     cdef int coarse_direct = 0
@@ -4430,17 +5023,37 @@ def createMg(list assemblers, list forests, double omega=1.0,
         for i in range(nlevels):
             assm[i] = (<Assembler>assemblers[i]).ptr
             qforest[i] = (<QuadForest>forests[i]).ptr
+        if caches is not None:
+            if len(caches) != nlevels-1:
+                errstr = 'Number of QuadInterpCache objects must be nlevels-1'
+                raise ValueError(errstr)
+            qcache = <TMRQuadInterpCache**>malloc((nlevels-1)*
+                                                  sizeof(TMRQuadInterpCache*))
+            for i in range(nlevels-1):
+                qcache[i] = (<QuadInterpCache>caches[i]).ptr
         TMR_CreateTACSMg(nlevels, assm, qforest, &mg, omega,
-                         coarse_direct, use_cheb)
+                         coarse_direct, use_cheb, qcache)
         free(qforest)
+        if qcache != NULL:
+            free(qcache)
     else:
         oforest = <TMROctForest**>malloc(nlevels*sizeof(TMROctForest*))
         for i in range(nlevels):
             assm[i] = (<Assembler>assemblers[i]).ptr
             oforest[i] = (<OctForest>forests[i]).ptr
+        if caches is not None:
+            if len(caches) != nlevels-1:
+                errstr = 'Number of OctInterpCache objects must be nlevels-1'
+                raise ValueError(errstr)
+            ocache = <TMROctInterpCache**>malloc((nlevels-1)*
+                                                 sizeof(TMROctInterpCache*))
+            for i in range(nlevels-1):
+                ocache[i] = (<OctInterpCache>caches[i]).ptr
         TMR_CreateTACSMg(nlevels, assm, oforest, &mg, omega,
-                         coarse_direct, use_cheb)
+                         coarse_direct, use_cheb, ocache)
         free(oforest)
+        if ocache != NULL:
+            free(ocache)
     free(assm)
     if mg != NULL:
         return _init_Mg(mg)
@@ -4517,6 +5130,57 @@ def strainEnergyError(forest, Assembler coarse,
                                        <double*>err.data)
     return ans, err
 
+def markRefinement(forest, Assembler assembler, TMRMarkCriterion criterion,
+                   thresholds, values=None, int index=0):
+    """
+    markRefinement(forest, assembler, criterion, thresholds, values=None,
+                   index=0)
+
+    Mark the elements for refinement (1) or coarsening (-1). The
+    returned array can be passed directly to forest.refine().
+
+    The criteria are MARK_DENSITY_BANDS and MARK_DENSITY_BANDS_REVERSE
+    with thresholds = [lower, upper], where the density is taken from
+    values or, when values is None, from the design output index of the
+    constitutive objects; MARK_ERROR_FRACTION with thresholds = [theta]
+    (Dorfler marking); MARK_FIXED_FRACTION with thresholds = [fraction];
+    and MARK_TARGET_COUNT with thresholds = [num_elements]. The
+    error-based criteria require the element error values.
+
+    Args:
+        forest (QuadForest or OctForest): The forest for the assembler
+        assembler (Assembler): The TACS.Assembler object for the forest
+        criterion (int): The marking criterion
+        thresholds (list): The thresholds for the criterion
+        values (np.ndarray): The element densities or errors
+        index (int): The design output index used for the density
+
+    Returns:
+        np.ndarray, int: The refinement array and the total number of
+        marked elements
+    """
+    cdef int nelems = assembler.ptr.getNumElements()
+    cdef int count = 0
+    cdef np.ndarray refine = np.zeros(nelems, dtype=np.intc)
+    cdef np.ndarray thresh = np.zeros(2, dtype=np.double)
+    cdef np.ndarray vals = None
+    cdef double *vals_ptr = NULL
+    thresh[:len(thresholds)] = thresholds
+    if values is not None:
+        vals = np.ascontiguousarray(values, dtype=np.double)
+        if vals.shape[0] != nelems:
+            raise ValueError('Expected %d element values'%(nelems))
+        vals_ptr = <double*>vals.data
+    if isinstance(forest, OctForest):
+        count = TMR_MarkRefinement((<OctForest>forest).ptr, assembler.ptr,
+                                   criterion, <double*>thresh.data, vals_ptr,
+                                   <int*>refine.data, index)
+    elif isinstance(forest, QuadForest):
+        count = TMR_MarkRefinement((<QuadForest>forest).ptr, assembler.ptr,
+                                   criterion, <double*>thresh.data, vals_ptr,
+                                   <int*>refine.data, index)
+    return refine, count
+
 def adjointError(forest, Assembler coarse,
                  forest_refined, Assembler refined,
                  Vec solution, Vec adjoint):
@@ -4643,6 +5307,11 @@ def writeSTLToBin(fname, OctForest forest,
     TMR_GenerateBinFile(filename, forest.ptr, x.ptr, offset, cutoff)
     return
 
+def writeSTLFile(fname, OctForest forest,
+                 Vec x, int offset=0, double cutoff=0.5):
+    cdef char *filename = tmr_convert_str_to_chars(fname)
+    return TMR_WriteSTLFile(filename, forest.ptr, x.ptr, offset, cutoff)
+
 cdef class StressConstraint:
     cdef TMRStressConstraint *ptr
     def __cinit__(self, OctForest oct, Assembler assembler,
@@ -4657,6 +5326,20 @@ cdef class StressConstraint:
         if self.ptr:
            self.ptr.decref()
 
+    def setUseQuadCache(self, int truth):
+        """
+        setUseQuadCache(self, truth)
+
+        Set whether evalCon() caches the values at the quadrature points
+        for evalConDeriv(). The cache uses about 3.7 KB per element for
+        order 2 and 8.7 KB per element for order 3. Without the cache,
+        evalConDeriv() re-computes these values.
+
+        Args:
+            truth (int): Flag to enable the cache (enabled by default)
+        """
+        self.ptr.setUseQuadCache(truth)
+
     def evalCon(self, Vec uvec):
         return self.ptr.evalConstraint(uvec.ptr)
 
@@ -5424,6 +6107,51 @@ cdef class TopoProblem(ProblemBase):
             ub = ubvec.ptr
         prob.setInitDesignVars(pvec.ptr,lb,ub)
 
+    def writeDesignCheckpoint(self, fname, PVec pvec):
+        """
+        writeDesignCheckpoint(self, fname, pvec)
+
+        Write the design variables and the iteration counter to a
+        binary checkpoint file in parallel. The values are stored at
+        the nodes of each element of the filter mesh, which does not
+        depend on the partition.
+
+        Args:
+            fname (str): The checkpoint file name
+            pvec (PVec): The design vector to write
+        """
+        cdef char *filename = tmr_convert_str_to_chars(fname)
+        cdef TMRTopoProblem *prob = NULL
+        prob = _dynamicTopoProblem(self.ptr)
+        if prob == NULL:
+            errmsg = 'Expected TMRTopoProblem got other type'
+            raise ValueError(errmsg)
+        return prob.writeDesignCheckpoint(filename, pvec.ptr)
+
+    def readDesignCheckpoint(self, fname, PVec pvec):
+        """
+        readDesignCheckpoint(self, fname, pvec)
+
+        Read the design variables and the iteration counter from a
+        checkpoint file written with writeDesignCheckpoint(). The
+        design variables are stored for each element of the filter
+        mesh, so the file can be read on a different number of
+        processors or with a different partition. The filter must be
+        created from the same forest. Otherwise the file is not read
+        and a non-zero value is returned.
+
+        Args:
+            fname (str): The checkpoint file name
+            pvec (PVec): The design vector to read into
+        """
+        cdef char *filename = tmr_convert_str_to_chars(fname)
+        cdef TMRTopoProblem *prob = NULL
+        prob = _dynamicTopoProblem(self.ptr)
+        if prob == NULL:
+            errmsg = 'Expected TMRTopoProblem got other type'
+            raise ValueError(errmsg)
+        return prob.readDesignCheckpoint(filename, pvec.ptr)
+
     def setUseRecycledSolution(self, int truth):
         cdef TMRTopoProblem *prob = NULL
         prob = _dynamicTopoProblem(self.ptr)
@@ -5433,6 +6161,15 @@ cdef class TopoProblem(ProblemBase):
         prob.setUseRecycledSolution(truth)
         return
 
+    def setUseBlockSolve(self, int truth):
+        cdef TMRTopoProblem *prob = NULL
+        prob = _dynamicTopoProblem(self.ptr)
+        if prob == NULL:
+            errmsg = 'Expected TMRTopoProblem got other type'
+            raise ValueError(errmsg)
+        prob.setUseBlockSolve(truth)
+        return
+
 def setMatchingFaces(model_list, double tol=1e-6):
     """
     Take in a list of TMRModel classes, find the matching faces,
@@ -24,6 +24,22 @@
 #include "TMR_TACSCreator.h"
 #include "TMR_TACSTopoCreator.h"
 
+/*
+  Release the elements created by a batch call that failed partway
+
+  The callback increfs each element that it sets, so the elements
+  created before the failure are decref'd here. The array is reset so
+  that the caller sees that the elements were not created.
+*/
+static inline void release_elements( int num, TACSElement **elements ){
+  for ( int i = 0; i < num; i++ ){
+    if (elements[i]){
+      elements[i]->decref();
+      elements[i] = NULL;
+    }
+  }
+}
+
 /*
   This is a light-weight wrapper for creating elements in python
 */
@@ -75,7 +91,10 @@ class TMRCyQuadCreator : public TMRQuadTACSCreator {
 class TMRCyOctCreator : public TMROctTACSCreator {
  public:
   TMRCyOctCreator( TMRBoundaryConditions *_bcs ):
-    TMROctTACSCreator(_bcs){}
+    TMROctTACSCreator(_bcs){
+    createoctelement = NULL;
+    createoctelementarray = NULL;
+  }
 
   void setSelfPointer( void *_self ){
     self = _self;
@@ -83,6 +102,10 @@ class TMRCyOctCreator : public TMROctTACSCreator {
   void setCreateOctElement( TACSElement* (*func)(void*, int, TMROctant*) ){
     createoctelement = func;
   }
+  void setCreateOctElementArray( 
+    int (*func)(void*, int, int, TMROctant*, TACSElement**) ){
+    createoctelementarray = func;
+  }
 
   void createElements( int order,
                        TMROctForest *forest,
@@ -97,21 +120,38 @@ class TMRCyOctCreator : public TMROctTACSCreator {
 
     // Set the element types into the matrix
     memset(elements, 0, num_elements*sizeof(TACSElement*));
+
+    // Create all of the elements with a single call
+    if (createoctelementarray){
+      int fail = createoctelementarray(self, order, num_elements,
+                                       array, elements);
+      if (fail){
+        release_elements(num_elements, elements);
+      }
+      return;
+    }
+
+    int fail = 0;
     for ( int i = 0; i < num_elements; i++ ){
       TACSElement *elem =
         createoctelement(self, order, &array[i]);
       if (!elem){
         fprintf(stderr, "TMRCyOctCreator error: Element not created\n");
+        fail = 1;
       }
       else {
         elements[i] = elem;
       }
     }
+    if (fail){
+      release_elements(num_elements, elements);
+    }
   }
 
  private:
   void *self;
   TACSElement* (*createoctelement)( void*, int, TMROctant* );
+  int (*createoctelementarray)( void*, int, int, TMROctant*, TACSElement** );
 };
 
 /*
@@ -154,7 +194,10 @@ class TMRCyTopoOctCreator : public TMROctTACSTopoCreator {
  public:
   TMRCyTopoOctCreator( TMRBoundaryConditions *_bcs,
                        TMROctForest *_filter ):
-  TMROctTACSTopoCreator(_bcs, _filter){}
+  TMROctTACSTopoCreator(_bcs, _filter){
+    createocttopoelement = NULL;
+    createocttopoelementarray = NULL;
+  }
 
   void setSelfPointer( void *_self ){
     self = _self;
@@ -163,6 +206,32 @@ class TMRCyTopoOctCreator : public TMROctTACSTopoCreator {
     TACSElement* (*func)(void*, int, TMROctant*, TMRIndexWeight*, int) ){
     createocttopoelement = func;
   }
+  void setCreateOctTopoElementArray( 
+    int (*func)(void*, int, int, TMROctant*, TMRIndexWeight*, int,
+                TACSElement**) ){
+    createocttopoelementarray = func;
+  }
+
+  // Create all of the elements with a single call
+  void createTopoElements( int order,
+                           int num_octs,
+                           TMROctant *octs,
+                           TMRIndexWeight *weights,
+                           int nweights,
+                           TACSElement **elements ){
+    if (createocttopoelementarray){
+      memset(elements, 0, num_octs*sizeof(TACSElement*));
+      int fail = createocttopoelementarray(self, order, num_octs, octs,
+                                           weights, nweights, elements);
+      if (fail){
+        release_elements(num_octs, elements);
+      }
+    }
+    else {
+      TMROctTACSTopoCreator::createTopoElements(order, num_octs, octs,
+                                                weights, nweights, elements);
+    }
+  }
 
   // Create the element
   TACSElement *createElement( int order, 
@@ -178,6 +247,9 @@ class TMRCyTopoOctCreator : public TMROctTACSTopoCreator {
   void *self; // Pointer to the python-level object
   TACSElement* (*createocttopoelement)( 
     void*, int, TMROctant*, TMRIndexWeight *weights, int nweights );
+  int (*createocttopoelementarray)( 
+    void*, int, int, TMROctant*, TMRIndexWeight *weights, int nweights,
+    TACSElement** );
 };
 
 /*
@@ -381,35 +381,14 @@ def densityBasedRefine(forest, assembler, index=0,
         max_lev (int): Maximum refinement level
     """
 
-    # Create refinement array
-    num_elems = assembler.getNumElements()
-    refine = np.zeros(num_elems, dtype=np.int32)
-
-    # Get the elements from the Assembler object
-    elems = assembler.getElements()
-
-    # Set the parametric point where the density will be evaluated. Use the
-    # parametric origin within the element.
-    pt = np.zeros(3, dtype=float)
-
-    for i in range(num_elems):
-        # Extract the constitutive object from the element, if it is defined, otherwise
-        # skip the refinement.
-        c = elems[i].getConstitutive()
-        if c is not None:
-            value = c.getDVOutputValue(index, pt)
-
-            # Apply the refinement criteria
-            if reverse:
-                if value >= upper:
-                    refine[i] = -1
-                elif value <= lower:
-                    refine[i] = 1
-            else:
-                if value >= upper:
-                    refine[i] = 1
-                elif value <= lower:
-                    refine[i] = -1
+    # Mark the elements using the density evaluated at the parametric origin
+    # of each element
+    if reverse:
+        criterion = TMR.MARK_DENSITY_BANDS_REVERSE
+    else:
+        criterion = TMR.MARK_DENSITY_BANDS
+    refine, count = TMR.markRefinement(forest, assembler, criterion,
+                                       [lower, upper], index=index)
 
     # Refine the forest
     forest.refine(refine, min_lev=min_lev, max_lev=max_lev)